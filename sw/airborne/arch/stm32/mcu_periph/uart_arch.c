@@ -133,6 +133,39 @@ void uart_put_byte(struct uart_periph *p, long fd __attribute__((unused)), uint8
 
 }
 
+/**
+ * Uart transmit buffer implementation
+ * Copy the complete block at once with TX interrupt disabled
+ * instead of calling uart_put_byte for each byte.
+ */
+void uart_put_buffer(struct uart_periph *p, long fd __attribute__((unused)), const uint8_t *data, uint16_t len)
+{
+  if (len == 0) {
+    return;
+  }
+
+  int16_t space = p->tx_extract_idx - p->tx_insert_idx;
+  if (space <= 0) {
+    space += UART_TX_BUFFER_SIZE;
+  }
+  if ((uint16_t)(space - 1) < len) {
+    return;  // no room
+  }
+
+  USART_CR1((uint32_t)p->reg_addr) &= ~USART_CR1_TXEIE; // Disable TX interrupt
+
+  // check if in process of sending data
+  if (p->tx_running) { // yes, add everything to queue
+    uart_tx_buffer_write(p, data, len);
+  } else { // no, set running flag, write first byte to output register and queue the rest
+    p->tx_running = true;
+    usart_send((uint32_t)p->reg_addr, data[0]);
+    uart_tx_buffer_write(p, &data[1], len - 1);
+  }
+
+  USART_CR1((uint32_t)p->reg_addr) |= USART_CR1_TXEIE; // Enable TX interrupt
+}
+
 static inline void usart_isr(struct uart_periph *p)
 {
 
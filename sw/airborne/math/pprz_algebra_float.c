@@ -25,6 +25,7 @@
  */
 
 #include "pprz_algebra_float.h"
+#include "pprz_trig_float.h"
 
 /** in place first order integration of a 3D-vector */
 void float_vect3_integrate_fi(struct FloatVect3 *vec, struct FloatVect3 *dv, float dt)
@@ -44,9 +45,12 @@ void float_rates_integrate_fi(struct FloatRates *r, struct FloatRates *dr, float
 
 void float_rates_of_euler_dot(struct FloatRates *r, struct FloatEulers *e, struct FloatEulers *edot)
 {
-  r->p = edot->phi                             -                sinf(e->theta) * edot->psi;
-  r->q =            cosf(e->phi) * edot->theta + sinf(e->phi) * cosf(e->theta) * edot->psi;
-  r->r =           -sinf(e->phi) * edot->theta + cosf(e->phi) * cosf(e->theta) * edot->psi;
+  float sphi, cphi, stheta, ctheta;
+  pprz_sincosf(e->phi, &sphi, &cphi);
+  pprz_sincosf(e->theta, &stheta, &ctheta);
+  r->p = edot->phi                 -                stheta * edot->psi;
+  r->q =            cphi * edot->theta + sphi * ctheta * edot->psi;
+  r->r =           -sphi * edot->theta + cphi * ctheta * edot->psi;
 }
 
 
@@ -174,8 +178,8 @@ void float_rmat_of_axis_angle(struct FloatRMat *rm, struct FloatVect3 *uv, float
   const float uxuy = uv->x * uv->y;
   const float uyuz = uv->y * uv->z;
   const float uxuz = uv->x * uv->z;
-  const float can  = cosf(angle);
-  const float san  = sinf(angle);
+  float san, can;
+  pprz_sincosf(angle, &san, &can);
   const float one_m_can = (1. - can);
 
   RMAT_ELMT(*rm, 0, 0) = ux2 + (1. - ux2) * can;
@@ -193,12 +197,12 @@ void float_rmat_of_axis_angle(struct FloatRMat *rm, struct FloatVect3 *uv, float
 /* C n->b rotation matrix */
 void float_rmat_of_eulers_321(struct FloatRMat *rm, struct FloatEulers *e)
 {
-  const float sphi   = sinf(e->phi);
-  const float cphi   = cosf(e->phi);
-  const float stheta = sinf(e->theta);
-  const float ctheta = cosf(e->theta);
-  const float spsi   = sinf(e->psi);
-  const float cpsi   = cosf(e->psi);
+  float sphi, cphi;
+  pprz_sincosf(e->phi, &sphi, &cphi);
+  float stheta, ctheta;
+  pprz_sincosf(e->theta, &stheta, &ctheta);
+  float spsi, cpsi;
+  pprz_sincosf(e->psi, &spsi, &cpsi);
 
   RMAT_ELMT(*rm, 0, 0) = ctheta * cpsi;
   RMAT_ELMT(*rm, 0, 1) = ctheta * spsi;
@@ -213,12 +217,12 @@ void float_rmat_of_eulers_321(struct FloatRMat *rm, struct FloatEulers *e)
 
 void float_rmat_of_eulers_312(struct FloatRMat *rm, struct FloatEulers *e)
 {
-  const float sphi   = sinf(e->phi);
-  const float cphi   = cosf(e->phi);
-  const float stheta = sinf(e->theta);
-  const float ctheta = cosf(e->theta);
-  const float spsi   = sinf(e->psi);
-  const float cpsi   = cosf(e->psi);
+  float sphi, cphi;
+  pprz_sincosf(e->phi, &sphi, &cphi);
+  float stheta, ctheta;
+  pprz_sincosf(e->theta, &stheta, &ctheta);
+  float spsi, cpsi;
+  pprz_sincosf(e->psi, &spsi, &cpsi);
 
   RMAT_ELMT(*rm, 0, 0) =  ctheta * cpsi - sphi * stheta * spsi;
   RMAT_ELMT(*rm, 0, 1) =  ctheta * spsi + sphi * stheta * cpsi;
@@ -402,8 +406,9 @@ void float_quat_integrate(struct FloatQuat *q, struct FloatRates *omega, float d
   const float no = FLOAT_RATES_NORM(*omega);
   if (no > FLT_MIN) {
     const float a  = 0.5 * no * dt;
-    const float ca = cosf(a);
-    const float sa_ov_no = sinf(a) / no;
+    float sa, ca;
+    pprz_sincosf(a, &sa, &ca);
+    const float sa_ov_no = sa / no;
     const float dp = sa_ov_no * omega->p;
     const float dq = sa_ov_no * omega->q;
     const float dr = sa_ov_no * omega->r;
@@ -481,12 +486,12 @@ void float_quat_of_eulers(struct FloatQuat *q, struct FloatEulers *e)
   const float theta2 = e->theta / 2.f;
   const float psi2   = e->psi / 2.f;
 
-  const float s_phi2   = sinf(phi2);
-  const float c_phi2   = cosf(phi2);
-  const float s_theta2 = sinf(theta2);
-  const float c_theta2 = cosf(theta2);
-  const float s_psi2   = sinf(psi2);
-  const float c_psi2   = cosf(psi2);
+  float s_phi2, c_phi2;
+  pprz_sincosf(phi2, &s_phi2, &c_phi2);
+  float s_theta2, c_theta2;
+  pprz_sincosf(theta2, &s_theta2, &c_theta2);
+  float s_psi2, c_psi2;
+  pprz_sincosf(psi2, &s_psi2, &c_psi2);
 
   q->qi =  c_phi2 * c_theta2 * c_psi2 + s_phi2 * s_theta2 * s_psi2;
   q->qx = -c_phi2 * s_theta2 * s_psi2 + s_phi2 * c_theta2 * c_psi2;
@@ -507,12 +512,12 @@ void float_quat_of_eulers_zxy(struct FloatQuat *q, struct FloatEulers *e)
   const float theta2 = e->theta / 2.f;
   const float psi2   = e->psi / 2.f;
 
-  const float s_phi2   = sinf(phi2);
-  const float c_phi2   = cosf(phi2);
-  const float s_theta2 = sinf(theta2);
-  const float c_theta2 = cosf(theta2);
-  const float s_psi2   = sinf(psi2);
-  const float c_psi2   = cosf(psi2);
+  float s_phi2, c_phi2;
+  pprz_sincosf(phi2, &s_phi2, &c_phi2);
+  float s_theta2, c_theta2;
+  pprz_sincosf(theta2, &s_theta2, &c_theta2);
+  float s_psi2, c_psi2;
+  pprz_sincosf(psi2, &s_psi2, &c_psi2);
 
   q->qi =  c_phi2 * c_theta2 * c_psi2 - s_phi2 * s_theta2 * s_psi2;
   q->qx =  s_phi2 * c_theta2 * c_psi2 - c_phi2 * s_theta2 * s_psi2;
@@ -535,12 +540,12 @@ void float_quat_of_eulers_yxz(struct FloatQuat *q, struct FloatEulers *e)
   const float theta2 = e->theta / 2.f;
   const float psi2   = e->psi / 2.f;
 
-  const float s_phi2   = sinf(phi2);
-  const float c_phi2   = cosf(phi2);
-  const float s_theta2 = sinf(theta2);
-  const float c_theta2 = cosf(theta2);
-  const float s_psi2   = sinf(psi2);
-  const float c_psi2   = cosf(psi2);
+  float s_phi2, c_phi2;
+  pprz_sincosf(phi2, &s_phi2, &c_phi2);
+  float s_theta2, c_theta2;
+  pprz_sincosf(theta2, &s_theta2, &c_theta2);
+  float s_psi2, c_psi2;
+  pprz_sincosf(psi2, &s_psi2, &c_psi2);
 
   q->qi =  c_theta2 * c_phi2 * c_psi2 + s_theta2 * s_phi2 * s_psi2;
   q->qx =  c_theta2 * s_phi2 * c_psi2 + s_theta2 * c_phi2 * s_psi2;
@@ -550,8 +555,8 @@ void float_quat_of_eulers_yxz(struct FloatQuat *q, struct FloatEulers *e)
 
 void float_quat_of_axis_angle(struct FloatQuat *q, const struct FloatVect3 *uv, float angle)
 {
-  const float san = sinf(angle / 2.f);
-  q->qi = cosf(angle / 2.f);
+  float san;
+  pprz_sincosf(angle / 2.f, &san, &q->qi);
   q->qx = san * uv->x;
   q->qy = san * uv->y;
   q->qz = san * uv->z;
@@ -566,8 +571,9 @@ void float_quat_of_orientation_vect(struct FloatQuat *q, const struct FloatVect3
     q->qy = 0;
     q->qz = 0;
   } else {
-    const float s2_normalized = sinf(ov_norm / 2.0) / ov_norm;
-    q->qi = cosf(ov_norm / 2.0);
+    float s2;
+    pprz_sincosf(ov_norm / 2.f, &s2, &q->qi);
+    const float s2_normalized = s2 / ov_norm;
     q->qx = ov->x * s2_normalized;
     q->qy = ov->y * s2_normalized;
     q->qz = ov->z * s2_normalized;
@@ -674,9 +680,9 @@ void float_eulers_of_rmat(struct FloatEulers *e, struct FloatRMat *rm)
   // asinf does not exist outside [-1,1]
   BoundAbs(dcm02, 1.0);
 
-  e->phi   = atan2f(dcm12, dcm22);
+  e->phi   = pprz_atan2f(dcm12, dcm22);
   e->theta = -asinf(dcm02);
-  e->psi   = atan2f(dcm01, dcm00);
+  e->psi   = pprz_atan2f(dcm01, dcm00);
 }
 
 /**
@@ -705,9 +711,9 @@ void float_eulers_of_quat(struct FloatEulers *e, struct FloatQuat *q)
   // asinf does not exist outside [-1,1]
   BoundAbs(dcm02, 1.0);
 
-  e->phi = atan2f(dcm12, dcm22);
+  e->phi = pprz_atan2f(dcm12, dcm22);
   e->theta = -asinf(dcm02);
-  e->psi = atan2f(dcm01, dcm00);
+  e->psi = pprz_atan2f(dcm01, dcm00);
 }
 
 /**
@@ -740,9 +746,9 @@ void float_eulers_of_quat_yxz(struct FloatEulers *e, struct FloatQuat *q)
   // asinf does not exist outside [-1,1]
   BoundAbs(r21, 1.0);
 
-  e->theta = atan2f(r11, r12);
+  e->theta = pprz_atan2f(r11, r12);
   e->phi = asinf(r21);
-  e->psi = atan2f(r31, r32);
+  e->psi = pprz_atan2f(r31, r32);
 }
 
 /**
@@ -773,9 +779,9 @@ void float_eulers_of_quat_zxy(struct FloatEulers *e, struct FloatQuat *q)
   // asinf does not exist outside [-1,1]
   BoundAbs(r21, 1.0);
 
-  e->psi = atan2f(r11, r12);
+  e->psi = pprz_atan2f(r11, r12);
   e->phi = asinf(r21);
-  e->theta = atan2f(r31, r32);
+  e->theta = pprz_atan2f(r31, r32);
 }
 
 /**
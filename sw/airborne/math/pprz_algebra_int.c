@@ -325,6 +325,23 @@ void int32_quat_derivative(struct Int32Quat *qd, const struct Int32Rates *r, str
   qd->qz = (-(-r->r * q->qi - r->q * q->qx + r->p * q->qy)) >> (INT32_RATE_FRAC + 1);
 }
 
+/** Division of the integration remainder, quotient added to the quaternion element.
+ * 64 bit divisions are done in software on 32 bit MCUs, use the hardware
+ * 32 bit one when the remainder fits (same result as lldiv).
+ */
+static inline void int32_quat_integrate_div(int32_t *q, int64_t *hr, int32_t div)
+{
+  if (*hr >= INT32_MIN && *hr <= INT32_MAX) {
+    const int32_t h = (int32_t) * hr;
+    *q += h / div;
+    *hr = h % div;
+  } else {
+    lldiv_t _div = lldiv(*hr, div);
+    *q += (int32_t) _div.quot;
+    *hr = _div.rem;
+  }
+}
+
 /** in place quaternion first order integration with constant rotational velocity. */
 void int32_quat_integrate_fi(struct Int32Quat *q, struct Int64Quat *hr, struct Int32Rates *omega, int freq)
 {
@@ -333,21 +350,11 @@ void int32_quat_integrate_fi(struct Int32Quat *q, struct Int64Quat *hr, struct I
   hr->qy += ((int64_t) omega->q) * q->qi - ((int64_t) omega->r) * q->qx + ((int64_t) omega->p) * q->qz;
   hr->qz += ((int64_t) omega->r) * q->qi + ((int64_t) omega->q) * q->qx - ((int64_t) omega->p) * q->qy;
 
-  lldiv_t _div = lldiv(hr->qi, ((1 << INT32_RATE_FRAC) * freq * 2));
-  q->qi += (int32_t) _div.quot;
-  hr->qi = _div.rem;
-
-  _div = lldiv(hr->qx, ((1 << INT32_RATE_FRAC) * freq * 2));
-  q->qx += (int32_t) _div.quot;
-  hr->qx = _div.rem;
-
-  _div = lldiv(hr->qy, ((1 << INT32_RATE_FRAC) * freq * 2));
-  q->qy += (int32_t) _div.quot;
-  hr->qy = _div.rem;
-
-  _div = lldiv(hr->qz, ((1 << INT32_RATE_FRAC) * freq * 2));
-  q->qz += (int32_t) _div.quot;
-  hr->qz = _div.rem;
+  const int32_t div = (1 << INT32_RATE_FRAC) * freq * 2;
+  int32_quat_integrate_div(&q->qi, &hr->qi, div);
+  int32_quat_integrate_div(&q->qx, &hr->qx, div);
+  int32_quat_integrate_div(&q->qy, &hr->qy, div);
+  int32_quat_integrate_div(&q->qz, &hr->qz, div);
 }
 
 void int32_quat_vmult(struct Int32Vect3 *v_out, struct Int32Quat *q, struct Int32Vect3 *v_in)
@@ -206,6 +206,167 @@ void ned_of_lla_point_d(struct NedCoor_d *ned, struct LtpDef_d *def, struct LlaC
 }
 
 
+/*
+ * Batch conversions
+ */
+
+void lla_of_ecef_array_d(double *restrict lat, double *restrict lon, double *restrict alt,
+                         const double *restrict x, const double *restrict y, const double *restrict z, int n)
+{
+  // same algorithm as lla_of_ecef_d
+  static const double a = 6378137.0;
+  static const double f = 1. / 298.257223563;
+  const double b = a * (1. - f);
+  const double b2 = b * b;
+  const double e2 = 2.*f - (f * f);
+  const double ep2 = f * (2. - f) / ((1. - f) * (1. - f));
+  const double E2 = a * a - b2;
+
+  for (int i = 0; i < n; i++) {
+    const double z2 = z[i] * z[i];
+    const double r2 = x[i] * x[i] + y[i] * y[i];
+    const double r = sqrt(r2);
+    const double F = 54.*b2 * z2;
+    const double G = r2 + (1 - e2) * z2 - e2 * E2;
+    const double c = (e2 * e2 * F * r2) / (G * G * G);
+    const double s = cbrt(1 + c + sqrt(c * c + 2 * c));
+    const double s1 = 1 + s + 1 / s;
+    const double P = F / (3 * s1 * s1 * G * G);
+    const double Q = sqrt(1 + 2 * e2 * e2 * P);
+    const double ro = -(e2 * P * r) / (1 + Q) + sqrt((a * a / 2) * (1 + 1 / Q) - ((1 - e2) * P * z2) / (Q *
+                      (1 + Q)) - P * r2 / 2);
+    const double tmp = (r - e2 * ro) * (r - e2 * ro);
+    const double U = sqrt(tmp + z2);
+    const double V = sqrt(tmp + (1 - e2) * z2);
+    const double zo = (b2 * z[i]) / (a * V);
+
+    alt[i] = U * (1 - b2 / (a * V));
+    lat[i] = atan((z[i] + ep2 * zo) / r);
+    lon[i] = atan2(y[i], x[i]);
+  }
+}
+
+void ecef_of_lla_array_d(double *restrict x, double *restrict y, double *restrict z,
+                         const double *restrict lat, const double *restrict lon, const double *restrict alt, int n)
+{
+  static const double a = 6378137.0;
+  static const double f = 1. / 298.257223563;
+  const double e2 = 2.*f - (f * f);
+
+  for (int i = 0; i < n; i++) {
+    const double sin_lat = sin(lat[i]);
+    const double cos_lat = cos(lat[i]);
+    const double sin_lon = sin(lon[i]);
+    const double cos_lon = cos(lon[i]);
+    const double a_chi = a / sqrt(1. - e2 * sin_lat * sin_lat);
+    x[i] = (a_chi + alt[i]) * cos_lat * cos_lon;
+    y[i] = (a_chi + alt[i]) * cos_lat * sin_lon;
+    z[i] = (a_chi * (1. - e2) + alt[i]) * sin_lat;
+  }
+}
+
+/** Rotate ECEF points to the local frame, as ENU or NED */
+static inline void ltp_of_ecef_point_array_d(double *restrict o0, double *restrict o1, double *restrict o2,
+    struct LtpDef_d *def, const double *restrict x, const double *restrict y, const double *restrict z,
+    int nb, bool ned)
+{
+  const double *m = def->ltp_of_ecef.m;
+  const double x0 = def->ecef.x, y0 = def->ecef.y, z0 = def->ecef.z;
+  for (int i = 0; i < nb; i++) {
+    const double dx = x[i] - x0;
+    const double dy = y[i] - y0;
+    const double dz = z[i] - z0;
+    const double e = m[0] * dx + m[1] * dy + m[2] * dz;
+    const double n = m[3] * dx + m[4] * dy + m[5] * dz;
+    const double u = m[6] * dx + m[7] * dy + m[8] * dz;
+    o0[i] = ned ? n : e;
+    o1[i] = ned ? e : n;
+    o2[i] = ned ? -u : u;
+  }
+}
+
+void enu_of_ecef_point_array_d(double *e, double *n, double *u, struct LtpDef_d *def,
+                               const double *x, const double *y, const double *z, int nb)
+{
+  ltp_of_ecef_point_array_d(e, n, u, def, x, y, z, nb, false);
+}
+
+void ned_of_ecef_point_array_d(double *n, double *e, double *d, struct LtpDef_d *def,
+                               const double *x, const double *y, const double *z, int nb)
+{
+  ltp_of_ecef_point_array_d(n, e, d, def, x, y, z, nb, true);
+}
+
+/** Rotate local points, ENU or NED, to ECEF */
+static inline void ecef_of_ltp_point_array_d(double *restrict x, double *restrict y, double *restrict z,
+    struct LtpDef_d *def, const double *restrict i0, const double *restrict i1, const double *restrict i2,
+    int nb, bool ned)
+{
+  const double *m = def->ltp_of_ecef.m;
+  const double x0 = def->ecef.x, y0 = def->ecef.y, z0 = def->ecef.z;
+  for (int i = 0; i < nb; i++) {
+    const double e = ned ? i1[i] : i0[i];
+    const double n = ned ? i0[i] : i1[i];
+    const double u = ned ? -i2[i] : i2[i];
+    x[i] = m[0] * e + m[3] * n + m[6] * u + x0;
+    y[i] = m[1] * e + m[4] * n + m[7] * u + y0;
+    z[i] = m[2] * e + m[5] * n + m[8] * u + z0;
+  }
+}
+
+void ecef_of_enu_point_array_d(double *x, double *y, double *z, struct LtpDef_d *def,
+                               const double *e, const double *n, const double *u, int nb)
+{
+  ecef_of_ltp_point_array_d(x, y, z, def, e, n, u, nb, false);
+}
+
+void ecef_of_ned_point_array_d(double *x, double *y, double *z, struct LtpDef_d *def,
+                               const double *n, const double *e, const double *d, int nb)
+{
+  ecef_of_ltp_point_array_d(x, y, z, def, n, e, d, nb, true);
+}
+
+/** LLA to local frame in a single pass, the ECEF point stays in registers */
+static inline void ltp_of_lla_point_array_d(double *restrict o0, double *restrict o1, double *restrict o2,
+    struct LtpDef_d *def, const double *restrict lat, const double *restrict lon, const double *restrict alt,
+    int nb, bool ned)
+{
+  static const double a = 6378137.0;
+  static const double f = 1. / 298.257223563;
+  const double e2 = 2.*f - (f * f);
+  const double *m = def->ltp_of_ecef.m;
+  const double x0 = def->ecef.x, y0 = def->ecef.y, z0 = def->ecef.z;
+
+  for (int i = 0; i < nb; i++) {
+    const double sin_lat = sin(lat[i]);
+    const double cos_lat = cos(lat[i]);
+    const double sin_lon = sin(lon[i]);
+    const double cos_lon = cos(lon[i]);
+    const double a_chi = a / sqrt(1. - e2 * sin_lat * sin_lat);
+    const double dx = (a_chi + alt[i]) * cos_lat * cos_lon - x0;
+    const double dy = (a_chi + alt[i]) * cos_lat * sin_lon - y0;
+    const double dz = (a_chi * (1. - e2) + alt[i]) * sin_lat - z0;
+    const double e = m[0] * dx + m[1] * dy + m[2] * dz;
+    const double n = m[3] * dx + m[4] * dy + m[5] * dz;
+    const double u = m[6] * dx + m[7] * dy + m[8] * dz;
+    o0[i] = ned ? n : e;
+    o1[i] = ned ? e : n;
+    o2[i] = ned ? -u : u;
+  }
+}
+
+void enu_of_lla_point_array_d(double *e, double *n, double *u, struct LtpDef_d *def,
+                              const double *lat, const double *lon, const double *alt, int nb)
+{
+  ltp_of_lla_point_array_d(e, n, u, def, lat, lon, alt, nb, false);
+}
+
+void ned_of_lla_point_array_d(double *n, double *e, double *d, struct LtpDef_d *def,
+                              const double *lat, const double *lon, const double *alt, int nb)
+{
+  ltp_of_lla_point_array_d(n, e, d, def, lat, lon, alt, nb, true);
+}
+
 /* geocentric latitude of geodetic latitude */
 double gc_of_gd_lat_d(double gd_lat, double hmsl)
 {
@@ -125,6 +125,35 @@ extern void ned_of_lla_point_d(struct NedCoor_d *ned, struct LtpDef_d *def, stru
 
 extern double gc_of_gd_lat_d(double gd_lat, double hmsl);
 
+/**
+ * @name Batch conversions
+ * Convert n points stored as separate arrays of coordinates (structure of arrays).
+ * The loops have no branches so that the compiler can vectorize them,
+ * the local frame rotation is taken once from the LtpDef.
+ * Input and output arrays must not overlap.
+ * @{
+ */
+extern void lla_of_ecef_array_d(double *lat, double *lon, double *alt,
+                                const double *x, const double *y, const double *z, int n);
+extern void ecef_of_lla_array_d(double *x, double *y, double *z,
+                                const double *lat, const double *lon, const double *alt, int n);
+
+extern void enu_of_ecef_point_array_d(double *e, double *n, double *u, struct LtpDef_d *def,
+                                      const double *x, const double *y, const double *z, int nb);
+extern void ned_of_ecef_point_array_d(double *n, double *e, double *d, struct LtpDef_d *def,
+                                      const double *x, const double *y, const double *z, int nb);
+
+extern void ecef_of_enu_point_array_d(double *x, double *y, double *z, struct LtpDef_d *def,
+                                      const double *e, const double *n, const double *u, int nb);
+extern void ecef_of_ned_point_array_d(double *x, double *y, double *z, struct LtpDef_d *def,
+                                      const double *n, const double *e, const double *d, int nb);
+
+extern void enu_of_lla_point_array_d(double *e, double *n, double *u, struct LtpDef_d *def,
+                                     const double *lat, const double *lon, const double *alt, int nb);
+extern void ned_of_lla_point_array_d(double *n, double *e, double *d, struct LtpDef_d *def,
+                                     const double *lat, const double *lon, const double *alt, int nb);
+/** @}*/
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -28,6 +28,7 @@
 #include "pprz_geodetic_float.h"
 
 #include "pprz_algebra_float.h"
+#include "pprz_trig_float.h"
 #include <math.h>
 
 /* for ecef_of_XX functions the double versions are needed */
@@ -40,10 +41,9 @@ void ltp_def_from_ecef_f(struct LtpDef_f *def, struct EcefCoor_f *ecef)
   /* compute the lla representation of the origin */
   lla_of_ecef_f(&def->lla, &def->ecef);
   /* store the rotation matrix                    */
-  const float sin_lat = sinf(def->lla.lat);
-  const float cos_lat = cosf(def->lla.lat);
-  const float sin_lon = sinf(def->lla.lon);
-  const float cos_lon = cosf(def->lla.lon);
+  float sin_lat, cos_lat, sin_lon, cos_lon;
+  pprz_sincosf(def->lla.lat, &sin_lat, &cos_lat);
+  pprz_sincosf(def->lla.lon, &sin_lon, &cos_lon);
   def->ltp_of_ecef.m[0] = -sin_lon;
   def->ltp_of_ecef.m[1] =  cos_lon;
   /* this element is always zero http://en.wikipedia.org/wiki/Geodetic_system#From_ECEF_to_ENU */
@@ -65,10 +65,9 @@ void ltp_def_from_lla_f(struct LtpDef_f *def, struct LlaCoor_f *lla)
   ecef_of_lla_f(&def->ecef, &def->lla);
 
   /* store the rotation matrix                    */
-  const float sin_lat = sinf(def->lla.lat);
-  const float cos_lat = cosf(def->lla.lat);
-  const float sin_lon = sinf(def->lla.lon);
-  const float cos_lon = cosf(def->lla.lon);
+  float sin_lat, cos_lat, sin_lon, cos_lon;
+  pprz_sincosf(def->lla.lat, &sin_lat, &cos_lat);
+  pprz_sincosf(def->lla.lon, &sin_lon, &cos_lon);
 
   def->ltp_of_ecef.m[0] = -sin_lon;
   def->ltp_of_ecef.m[1] =  cos_lon;
@@ -200,6 +199,85 @@ void ecef_of_ned_vect_f(struct EcefCoor_f *ecef, struct LtpDef_f *def, struct Ne
 
 
 
+/*
+ * Batch conversions
+ */
+
+static inline void ltp_of_ecef_point_array_f(float *restrict o0, float *restrict o1, float *restrict o2,
+    struct LtpDef_f *def, const float *restrict x, const float *restrict y, const float *restrict z,
+    int nb, bool ned)
+{
+  const float *m = def->ltp_of_ecef.m;
+  const float x0 = def->ecef.x, y0 = def->ecef.y, z0 = def->ecef.z;
+  for (int i = 0; i < nb; i++) {
+    const float dx = x[i] - x0;
+    const float dy = y[i] - y0;
+    const float dz = z[i] - z0;
+    const float e = m[0] * dx + m[1] * dy + m[2] * dz;
+    const float n = m[3] * dx + m[4] * dy + m[5] * dz;
+    const float u = m[6] * dx + m[7] * dy + m[8] * dz;
+    o0[i] = ned ? n : e;
+    o1[i] = ned ? e : n;
+    o2[i] = ned ? -u : u;
+  }
+}
+
+void enu_of_ecef_point_array_f(float *e, float *n, float *u, struct LtpDef_f *def,
+                               const float *x, const float *y, const float *z, int nb)
+{
+  ltp_of_ecef_point_array_f(e, n, u, def, x, y, z, nb, false);
+}
+
+void ned_of_ecef_point_array_f(float *n, float *e, float *d, struct LtpDef_f *def,
+                               const float *x, const float *y, const float *z, int nb)
+{
+  ltp_of_ecef_point_array_f(n, e, d, def, x, y, z, nb, true);
+}
+
+static inline void ltp_of_lla_point_array_f(float *restrict o0, float *restrict o1, float *restrict o2,
+    struct LtpDef_f *def, const float *restrict lat, const float *restrict lon, const float *restrict alt,
+    int nb, bool ned)
+{
+  static const double a = 6378137.0;
+  static const double f = 1. / 298.257223563;
+  const double e2 = 2.*f - (f * f);
+  double m[9];
+  for (int k = 0; k < 9; k++) {
+    m[k] = (double) def->ltp_of_ecef.m[k];
+  }
+  const double x0 = def->ecef.x, y0 = def->ecef.y, z0 = def->ecef.z;
+
+  for (int i = 0; i < nb; i++) {
+    const double sin_lat = sin(lat[i]);
+    const double cos_lat = cos(lat[i]);
+    const double sin_lon = sin(lon[i]);
+    const double cos_lon = cos(lon[i]);
+    const double a_chi = a / sqrt(1. - e2 * sin_lat * sin_lat);
+    const double dx = (a_chi + alt[i]) * cos_lat * cos_lon - x0;
+    const double dy = (a_chi + alt[i]) * cos_lat * sin_lon - y0;
+    const double dz = (a_chi * (1. - e2) + alt[i]) * sin_lat - z0;
+    const float e = m[0] * dx + m[1] * dy + m[2] * dz;
+    const float n = m[3] * dx + m[4] * dy + m[5] * dz;
+    const float u = m[6] * dx + m[7] * dy + m[8] * dz;
+    o0[i] = ned ? n : e;
+    o1[i] = ned ? e : n;
+    o2[i] = ned ? -u : u;
+  }
+}
+
+void enu_of_lla_point_array_f(float *e, float *n, float *u, struct LtpDef_f *def,
+                              const float *lat, const float *lon, const float *alt, int nb)
+{
+  ltp_of_lla_point_array_f(e, n, u, def, lat, lon, alt, nb, false);
+}
+
+void ned_of_lla_point_array_f(float *n, float *e, float *d, struct LtpDef_f *def,
+                              const float *lat, const float *lon, const float *alt, int nb)
+{
+  ltp_of_lla_point_array_f(n, e, d, def, lat, lon, alt, nb, true);
+}
+
+
 /* http://en.wikipedia.org/wiki/Geodetic_system */
 void lla_of_ecef_f(struct LlaCoor_f *out, struct EcefCoor_f *in)
 {
@@ -234,7 +312,7 @@ void lla_of_ecef_f(struct LlaCoor_f *out, struct EcefCoor_f *in)
 
   out->alt = U * (1 - b2 / (a * V));
   out->lat = atanf((in->z + ep2 * zo) / r);
-  out->lon = atan2f(in->y, in->x);
+  out->lon = pprz_atan2f(in->y, in->x);
 
 }
 
@@ -246,10 +324,9 @@ void ecef_of_lla_f(struct EcefCoor_f *out, struct LlaCoor_f *in)
   static const float f = 1. / 298.257223563;  /* reciprocal flattening          */
   const float e2 = 2.*f - (f * f);            /* first eccentricity squared     */
 
-  const float sin_lat = sinf(in->lat);
-  const float cos_lat = cosf(in->lat);
-  const float sin_lon = sinf(in->lon);
-  const float cos_lon = cosf(in->lon);
+  float sin_lat, cos_lat, sin_lon, cos_lon;
+  pprz_sincosf(in->lat, &sin_lat, &cos_lat);
+  pprz_sincosf(in->lon, &sin_lon, &cos_lon);
   const float chi = sqrtf(1. - e2 * sin_lat * sin_lat);
   const float a_chi = a / chi;
 
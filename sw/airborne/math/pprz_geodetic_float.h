@@ -117,6 +117,23 @@ extern void ecef_of_enu_vect_f(struct EcefCoor_f *ecef, struct LtpDef_f *def, st
 extern void ecef_of_ned_vect_f(struct EcefCoor_f *ecef, struct LtpDef_f *def, struct NedCoor_f *ned);
 /* end use double versions */
 
+/**
+ * @name Batch conversions
+ * Convert nb points stored as separate arrays of coordinates (structure of arrays),
+ * see the double versions. Input and output arrays must not overlap.
+ * @{
+ */
+extern void enu_of_ecef_point_array_f(float *e, float *n, float *u, struct LtpDef_f *def,
+                                      const float *x, const float *y, const float *z, int nb);
+extern void ned_of_ecef_point_array_f(float *n, float *e, float *d, struct LtpDef_f *def,
+                                      const float *x, const float *y, const float *z, int nb);
+/* not enough precision with floats for the intermediate ECEF points, computed in double */
+extern void enu_of_lla_point_array_f(float *e, float *n, float *u, struct LtpDef_f *def,
+                                     const float *lat, const float *lon, const float *alt, int nb);
+extern void ned_of_lla_point_array_f(float *n, float *e, float *d, struct LtpDef_f *def,
+                                     const float *lat, const float *lon, const float *alt, int nb);
+/** @}*/
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -28,6 +28,7 @@
 
 #include "std.h"
 #include "math/pprz_geodetic_wmm2020.h"
+#include "math/pprz_geodetic_wmm2020_grid.h"
 
 const double gh1[MAXCOEFF] = {
   //WMM 2020 data
@@ -256,3 +257,172 @@ int16_t mag_calc(int16_t igdgc, double flat, double flon, double elev, int16_t n
   *geo_mag_z = *geo_mag_z * cd - aa * sd;
   return (ios);
 }
+
+void wmm2020_cache_init(struct Wmm2020Cache *cache, double date)
+{
+  cache->nmax = extrapsh(date, GEO_EPOCH, NMAX_1, NMAX_2, cache->gh);
+  cache->valid = false;
+}
+
+/** Legendre recursion of mag_calc, summed per order m */
+static void wmm2020_cache_update(struct Wmm2020Cache *c, double lat, double alt)
+{
+  const double earths_radius = 6371.2;
+  const double a2 = 40680631.59;            /* WGS84 */
+  const double b2 = 40408299.98;            /* WGS84 */
+  double p[119];
+  double q[119];
+
+  double slat = sin(RadOfDeg(lat));
+  double clat;
+  if ((90.0 - lat) < 0.001) {
+    clat = cos(RadOfDeg(89.999));
+  } else if ((90.0 + lat) < 0.001) {
+    clat = cos(RadOfDeg(-89.999));
+  } else {
+    clat = cos(RadOfDeg(lat));
+  }
+
+  /* geodetic to geocentric */
+  double aa = a2 * clat * clat;
+  double bb = b2 * slat * slat;
+  double cc = aa + bb;
+  double dd = sqrt(cc);
+  double r = sqrt(alt * (alt + 2.0 * dd) + (a2 * aa + b2 * bb) / cc);
+  c->cd = (alt + dd) / r;
+  c->sd = (a2 - b2) / dd * slat * clat / r;
+  aa = slat;
+  slat = slat * c->cd - clat * c->sd;
+  clat = clat * c->cd + aa * c->sd;
+
+  for (int m = 0; m < MAXDEG; m++) {
+    c->xa[m] = c->xb[m] = 0.;
+    c->ya[m] = c->yb[m] = 0.;
+    c->za[m] = c->zb[m] = 0.;
+  }
+
+  const double ratio = earths_radius / r;
+  aa = sqrt(3.0);
+  p[1] = 2.0 * slat;
+  p[2] = 2.0 * clat;
+  p[3] = 4.5 * slat * slat - 1.5;
+  p[4] = 3.0 * aa * clat * slat;
+  q[1] = -clat;
+  q[2] = slat;
+  q[3] = -3.0 * clat * slat;
+  q[4] = aa * (slat * slat - clat * clat);
+
+  const int npq = (c->nmax * (c->nmax + 3)) / 2;
+  int l = 1, n = 0, m = 1;
+  double rr = 0., fn = 0.;
+  for (int k = 1; k <= npq; ++k) {
+    if (n < m) {
+      m = 0;
+      n = n + 1;
+      rr = pow(ratio, n + 2);
+      fn = n;
+    }
+    const double fm = m;
+    if (k >= 5) {
+      if (m == n) {
+        aa = sqrt(1.0 - 0.5 / fm);
+        const int j = k - n - 1;
+        p[k] = (1.0 + 1.0 / fm) * aa * clat * p[j];
+        q[k] = aa * (clat * q[j] + slat / fm * p[j]);
+      } else {
+        aa = sqrt(fn * fn - fm * fm);
+        bb = sqrt(((fn - 1.0) * (fn - 1.0)) - (fm * fm)) / aa;
+        cc = (2.0 * fn - 1.0) / aa;
+        const int ii = k - n;
+        const int j = k - 2 * n + 1;
+        p[k] = (fn + 1.0) * (cc * slat / fn * p[ii] - bb / (fn - 1.0) * p[j]);
+        q[k] = cc * (slat * q[ii] - clat / fn * p[ii]) - bb * q[j];
+      }
+    }
+
+    const double g = rr * c->gh[l];
+    if (m == 0) {
+      c->xa[0] += g * q[k];
+      c->za[0] -= g * p[k];
+      l = l + 1;
+    } else {
+      const double h = rr * c->gh[l + 1];
+      c->xa[m] += g * q[k];
+      c->xb[m] += h * q[k];
+      c->za[m] -= g * p[k];
+      c->zb[m] -= h * p[k];
+      const double w = clat > 0 ? fm * p[k] / ((fn + 1.0) * clat) : q[k] * slat;
+      c->ya[m] += g * w;
+      c->yb[m] += h * w;
+      l = l + 2;
+    }
+    m = m + 1;
+  }
+
+  c->lat0 = lat;
+  c->alt0 = alt;
+  c->valid = true;
+}
+
+bool wmm2020_cache_field(struct Wmm2020Cache *cache, double lat, double lon, double alt,
+                         double *x, double *y, double *z)
+{
+  bool updated = false;
+  if (!cache->valid || fabs(lat - cache->lat0) > WMM2020_CACHE_LAT_BAND ||
+      fabs(alt - cache->alt0) > WMM2020_CACHE_ALT_BAND) {
+    wmm2020_cache_update(cache, lat, alt);
+    updated = true;
+  }
+
+  /* longitude terms, sin(m lon) and cos(m lon) by recursion */
+  const double sl1 = sin(RadOfDeg(lon));
+  const double cl1 = cos(RadOfDeg(lon));
+  double sl = 0., cl = 1.;
+  double gx = cache->xa[0];
+  double gy = 0.;
+  double gz = cache->za[0];
+  for (int m = 1; m <= cache->nmax; m++) {
+    const double s = sl * cl1 + cl * sl1;
+    cl = cl * cl1 - sl * sl1;
+    sl = s;
+    gx += cache->xa[m] * cl + cache->xb[m] * sl;
+    gy += cache->ya[m] * sl - cache->yb[m] * cl;
+    gz += cache->za[m] * cl + cache->zb[m] * sl;
+  }
+
+  /* geocentric to geodetic */
+  *x = gx * cache->cd + gz * cache->sd;
+  *y = gy;
+  *z = gz * cache->cd - gx * cache->sd;
+  return updated;
+}
+
+void wmm2020_grid_field(double date, float lat, float lon, float alt, float *x, float *y, float *z)
+{
+  /* cell and position in the cell */
+  float fi = (Clip(lat, -90.f, 90.f) + 90.f) / WMM2020_GRID_RES;
+  float fj = (lon - 360.f * floorf((lon + 180.f) / 360.f) + 180.f) / WMM2020_GRID_RES;
+  int i = Min((int)fi, WMM2020_GRID_NLAT - 2);
+  int j = Min((int)fj, WMM2020_GRID_NLON - 2);
+  const float u = fi - i;
+  const float v = fj - j;
+  const float w[4] = { (1.f - u) * (1.f - v), (1.f - u) * v, u * (1.f - v), u * v };
+  const int16_t *cell[4] = {
+    wmm2020_grid[i][j], wmm2020_grid[i][j + 1], wmm2020_grid[i + 1][j], wmm2020_grid[i + 1][j + 1]
+  };
+
+  const float dt = date - GEO_EPOCH;
+  float b[3] = { 0.f, 0.f, 0.f };
+  for (int c = 0; c < 4; c++) {
+    for (int k = 0; k < 3; k++) {
+      b[k] += w[c] * (cell[c][k] * WMM2020_GRID_FIELD_UNIT + dt * cell[c][k + 3] * WMM2020_GRID_SV_UNIT);
+    }
+  }
+
+  /* dipole decrease with altitude */
+  const float ratio = 6371.2f / (6371.2f + alt);
+  const float scale = ratio * ratio * ratio;
+  *x = b[0] * scale;
+  *y = b[1] * scale;
+  *z = b[2] * scale;
+}
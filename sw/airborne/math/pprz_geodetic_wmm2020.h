@@ -38,6 +38,8 @@
 extern "C" {
 #endif
 
+#include "std.h"
+
 #define WMM2020_FRAC 2
 #define N_MAX_OF_GH  12
 
@@ -74,6 +76,78 @@ int16_t mag_calc(int16_t igdgc, double flat, double flon, double elev, int16_t n
                  double *gh, double *geo_mag_x, double *geo_mag_y, double *geo_mag_z,
                  int16_t iext, double ext1, double ext2, double ext3);
 
+/** @name Cached evaluation
+ *  The Legendre functions and radius powers only depend on the latitude
+ *  and altitude. They are summed per order m once, so that a query at a
+ *  close position only costs the longitude terms (about 50 flops).
+ *  The sums are computed again when the position moves out of the
+ *  latitude or altitude band of the last update. With the default bands
+ *  the direction error stays below 0.1 deg.
+ *  @{
+ */
+
+/// latitude band (deg) where the cached sums are reused
+#ifndef WMM2020_CACHE_LAT_BAND
+#define WMM2020_CACHE_LAT_BAND 0.05
+#endif
+
+/// altitude band (km) where the cached sums are reused
+#ifndef WMM2020_CACHE_ALT_BAND
+#define WMM2020_CACHE_ALT_BAND 0.5
+#endif
+
+struct Wmm2020Cache {
+  double gh[MAXCOEFF];          ///< coefficients extrapolated to the date
+  int16_t nmax;                 ///< max degree
+  bool valid;                   ///< sums computed for lat0 and alt0
+  double lat0;                  ///< latitude of the sums (deg)
+  double alt0;                  ///< altitude of the sums (km)
+  double cd, sd;                ///< geocentric to geodetic rotation
+  double xa[MAXDEG], xb[MAXDEG];  ///< north sums per order, cos and sin terms
+  double ya[MAXDEG], yb[MAXDEG];  ///< east sums per order, sin and cos terms
+  double za[MAXDEG], zb[MAXDEG];  ///< down sums per order, cos and sin terms
+};
+
+/** Init the cache for a date
+ * @param date decimal year, for example 2022.5
+ */
+extern void wmm2020_cache_init(struct Wmm2020Cache *cache, double date);
+
+/** Geodetic field at a position, same units as mag_calc
+ * @param lat geodetic latitude (deg)
+ * @param lon longitude (deg)
+ * @param alt altitude above the ellipsoid (km)
+ * @param[out] x, y, z north, east and down field (nT)
+ * @return true if the cached sums were computed again
+ */
+extern bool wmm2020_cache_field(struct Wmm2020Cache *cache, double lat, double lon, double alt,
+                                double *x, double *y, double *z);
+/** @}*/
+
+/** @name Grid evaluation
+ *  Field on a precomputed 10 deg grid at sea level, with its secular
+ *  variation, interpolated bilinearly. Much cheaper than the full model
+ *  and without any refresh, at the cost of a lower accuracy
+ *  (about 1 deg on the direction, more close to the poles).
+ *  The table is generated with sw/tools/gen_wmm2020_grid.
+ *  @{
+ */
+#define WMM2020_GRID_RES 10
+#define WMM2020_GRID_NLAT (180 / WMM2020_GRID_RES + 1)
+#define WMM2020_GRID_NLON (360 / WMM2020_GRID_RES + 1)
+#define WMM2020_GRID_FIELD_UNIT 4.f   ///< nT
+#define WMM2020_GRID_SV_UNIT 0.1f     ///< nT/year
+
+/** Geodetic field at a position from the grid
+ * @param date decimal year
+ * @param lat geodetic latitude (deg)
+ * @param lon longitude (deg)
+ * @param alt altitude above the ellipsoid (km), only scales the norm
+ * @param[out] x, y, z north, east and down field (nT)
+ */
+extern void wmm2020_grid_field(double date, float lat, float lon, float alt, float *x, float *y, float *z);
+/** @}*/
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
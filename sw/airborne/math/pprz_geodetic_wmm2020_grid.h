@@ -0,0 +1,760 @@
+/*
+ * Generated by sw/tools/gen_wmm2020_grid, do not edit
+ */
+
+/**
+ * @file pprz_geodetic_wmm2020_grid.h
+ * @brief WMM2020 field on a 10 deg grid.
+ *
+ * [lat][lon]: north, east, down field at 2020 (4 nT), then
+ * their secular variation (0.1 nT/year), from lat -90 and lon -180.
+ */
+
+#ifndef WMM2020_GRID_H
+#define WMM2020_GRID_H
+
+static const int16_t wmm2020_grid[WMM2020_GRID_NLAT][WMM2020_GRID_NLON][6] = {
+  { // lat -90
+    { -3606, 2145, -13006, 97, 434, 667 },
+    { -3179, 2738, -13006, 171, 411, 667 },
+    { -2655, 3249, -13006, 240, 375, 667 },
+    { -2051, 3660, -13006, 301, 327, 667 },
+    { -1384, 3961, -13006, 353, 270, 667 },
+    { -675, 4141, -13006, 395, 205, 667 },
+    { 54, 4196, -13006, 424, 133, 667 },
+    { 782, 4122, -13006, 441, 57, 667 },
+    { 1486, 3924, -13006, 444, -20, 667 },
+    { 2145, 3606, -13006, 434, -97, 667 },
+    { 2738, 3179, -13006, 411, -171, 667 },
+    { 3249, 2655, -13006, 375, -240, 667 },
+    { 3661, 2051, -13006, 327, -301, 667 },
+    { 3961, 1384, -13006, 270, -353, 667 },
+    { 4141, 675, -13006, 205, -395, 667 },
+    { 4196, -54, -13006, 133, -424, 667 },
+    { 4123, -782, -13006, 57, -441, 667 },
+    { 3924, -1486, -13006, -20, -444, 667 },
+    { 3607, -2145, -13006, -97, -434, 667 },
+    { 3179, -2738, -13006, -171, -411, 667 },
+    { 2656, -3249, -13006, -240, -375, 667 },
+    { 2051, -3660, -13006, -301, -327, 667 },
+    { 1384, -3961, -13006, -353, -270, 667 },
+    { 675, -4141, -13006, -395, -205, 667 },
+    { -54, -4196, -13006, -424, -133, 667 },
+    { -782, -4122, -13006, -441, -57, 667 },
+    { -1486, -3924, -13006, -444, 20, 667 },
+    { -2144, -3606, -13006, -434, 97, 667 },
+    { -2738, -3179, -13006, -411, 171, 667 },
+    { -3249, -2655, -13006, -375, 240, 667 },
+    { -3660, -2051, -13006, -327, 301, 667 },
+    { -3961, -1384, -13006, -270, 353, 667 },
+    { -4141, -675, -13006, -205, 395, 667 },
+    { -4195, 54, -13006, -133, 424, 667 },
+    { -4122, 782, -13006, -57, 441, 667 },
+    { -3924, 1486, -13006, 20, 444, 667 },
+    { -3606, 2145, -13006, 97, 434, 667 },
+  },
+  { // lat -80
+    { -1954, 2359, -14869, 41, 492, 665 },
+    { -1483, 2866, -14676, 127, 448, 729 },
+    { -954, 3282, -14433, 200, 384, 787 },
+    { -379, 3602, -14150, 257, 303, 836 },
+    { 228, 3821, -13831, 294, 211, 875 },
+    { 854, 3936, -13485, 310, 114, 902 },
+    { 1485, 3943, -13120, 304, 18, 917 },
+    { 2105, 3839, -12746, 278, -69, 920 },
+    { 2695, 3626, -12372, 237, -144, 913 },
+    { 3236, 3309, -12010, 184, -202, 898 },
+    { 3711, 2899, -11670, 127, -242, 877 },
+    { 4108, 2414, -11362, 71, -266, 853 },
+    { 4417, 1869, -11092, 23, -275, 828 },
+    { 4637, 1282, -10867, -16, -278, 802 },
+    { 4768, 667, -10690, -44, -279, 775 },
+    { 4811, 35, -10567, -65, -284, 748 },
+    { 4766, -606, -10500, -84, -297, 717 },
+    { 4633, -1249, -10494, -108, -318, 683 },
+    { 4405, -1882, -10553, -142, -342, 643 },
+    { 4078, -2491, -10681, -189, -362, 598 },
+    { 3648, -3056, -10879, -250, -373, 549 },
+    { 3117, -3552, -11145, -319, -366, 498 },
+    { 2494, -3951, -11474, -391, -338, 448 },
+    { 1795, -4226, -11858, -459, -289, 402 },
+    { 1046, -4355, -12281, -516, -219, 362 },
+    { 278, -4324, -12728, -556, -135, 331 },
+    { -472, -4126, -13180, -577, -40, 311 },
+    { -1168, -3767, -13617, -577, 57, 302 },
+    { -1776, -3265, -14020, -557, 154, 304 },
+    { -2270, -2643, -14373, -520, 244, 318 },
+    { -2630, -1934, -14663, -467, 326, 343 },
+    { -2845, -1172, -14882, -401, 396, 378 },
+    { -2915, -393, -15024, -324, 452, 423 },
+    { -2846, 374, -15091, -238, 492, 476 },
+    { -2652, 1101, -15083, -146, 513, 536 },
+    { -2349, 1767, -15007, -52, 514, 600 },
+    { -1954, 2359, -14869, 41, 492, 665 },
+  },
+  { // lat -70
+    { 187, 2477, -15596, -42, 490, 656 },
+    { 621, 2851, -15189, 23, 442, 780 },
+    { 1065, 3145, -14728, 79, 367, 891 },
+    { 1512, 3369, -14220, 118, 269, 980 },
+    { 1964, 3529, -13665, 138, 158, 1042 },
+    { 2426, 3620, -13064, 136, 41, 1076 },
+    { 2897, 3627, -12421, 113, -72, 1081 },
+    { 3369, 3529, -11750, 69, -176, 1060 },
+    { 3822, 3308, -11075, 4, -261, 1016 },
+    { 4222, 2962, -10429, -78, -319, 953 },
+    { 4539, 2508, -9843, -168, -340, 879 },
+    { 4751, 1982, -9342, -253, -322, 804 },
+    { 4853, 1429, -8936, -315, -268, 739 },
+    { 4862, 887, -8623, -342, -196, 693 },
+    { 4807, 375, -8389, -327, -127, 669 },
+    { 4718, -110, -8224, -278, -86, 660 },
+    { 4613, -587, -8125, -213, -90, 654 },
+    { 4494, -1082, -8101, -155, -139, 635 },
+    { 4344, -1612, -8170, -125, -222, 593 },
+    { 4140, -2176, -8357, -138, -316, 520 },
+    { 3853, -2756, -8681, -194, -394, 421 },
+    { 3465, -3313, -9154, -283, -434, 304 },
+    { 2970, -3797, -9773, -387, -425, 184 },
+    { 2381, -4157, -10522, -483, -367, 73 },
+    { 1726, -4347, -11370, -555, -269, -16 },
+    { 1047, -4339, -12273, -594, -150, -76 },
+    { 390, -4120, -13183, -599, -27, -107 },
+    { -198, -3700, -14047, -576, 89, -108 },
+    { -676, -3105, -14816, -534, 190, -84 },
+    { -1016, -2380, -15451, -481, 274, -39 },
+    { -1202, -1577, -15924, -423, 343, 24 },
+    { -1237, -750, -16226, -364, 398, 99 },
+    { -1132, 52, -16360, -305, 444, 188 },
+    { -912, 794, -16341, -244, 480, 289 },
+    { -601, 1451, -16192, -180, 504, 403 },
+    { -227, 2013, -15936, -112, 510, 527 },
+    { 187, 2477, -15596, -42, 490, 656 },
+  },
+  { // lat -60
+    { 2249, 2478, -15136, -154, 433, 586 },
+    { 2589, 2725, -14553, -124, 392, 733 },
+    { 2906, 2901, -13943, -98, 320, 863 },
+    { 3197, 3030, -13309, -83, 222, 964 },
+    { 3467, 3132, -12642, -81, 113, 1031 },
+    { 3728, 3207, -11919, -91, 0, 1067 },
+    { 3995, 3235, -11124, -113, -112, 1072 },
+    { 4275, 3172, -10261, -149, -223, 1045 },
+    { 4551, 2967, -9366, -207, -325, 980 },
+    { 4786, 2593, -8508, -288, -402, 876 },
+    { 4931, 2066, -7766, -389, -433, 739 },
+    { 4945, 1453, -7199, -494, -395, 591 },
+    { 4824, 843, -6824, -572, -285, 466 },
+    { 4601, 318, -6609, -594, -126, 395 },
+    { 4335, -90, -6495, -545, 34, 397 },
+    { 4086, -400, -6426, -433, 140, 458 },
+    { 3892, -671, -6375, -289, 158, 544 },
+    { 3764, -969, -6353, -148, 80, 608 },
+    { 3681, -1344, -6403, -49, -75, 611 },
+    { 3606, -1820, -6585, -19, -263, 534 },
+    { 3489, -2378, -6953, -68, -431, 378 },
+    { 3289, -2966, -7547, -179, -529, 167 },
+    { 2986, -3506, -8373, -316, -530, -61 },
+    { 2591, -3915, -9405, -434, -437, -263 },
+    { 2139, -4129, -10585, -500, -283, -409 },
+    { 1678, -4111, -11839, -508, -112, -485 },
+    { 1257, -3854, -13084, -471, 39, -498 },
+    { 918, -3375, -14236, -414, 155, -464 },
+    { 689, -2716, -15220, -357, 238, -394 },
+    { 585, -1936, -15974, -308, 294, -299 },
+    { 605, -1105, -16469, -271, 331, -190 },
+    { 733, -285, -16701, -246, 355, -75 },
+    { 948, 473, -16697, -231, 379, 40 },
+    { 1228, 1139, -16495, -218, 405, 160 },
+    { 1552, 1697, -16140, -202, 430, 292 },
+    { 1898, 2141, -15675, -181, 443, 436 },
+    { 2249, 2478, -15136, -154, 433, 586 },
+  },
+  { // lat -50
+    { 3953, 2381, -13892, -231, 362, 441 },
+    { 4174, 2539, -13196, -217, 337, 579 },
+    { 4368, 2631, -12499, -200, 272, 705 },
+    { 4531, 2682, -11808, -196, 176, 803 },
+    { 4658, 2718, -11113, -208, 70, 865 },
+    { 4750, 2754, -10382, -234, -33, 900 },
+    { 4820, 2778, -9571, -268, -136, 912 },
+    { 4883, 2739, -8662, -309, -242, 892 },
+    { 4946, 2561, -7686, -359, -351, 828 },
+    { 4987, 2184, -6734, -428, -451, 705 },
+    { 4956, 1604, -5938, -524, -506, 521 },
+    { 4801, 905, -5412, -637, -467, 304 },
+    { 4509, 233, -5190, -727, -310, 117 },
+    { 4121, -283, -5205, -747, -68, 34 },
+    { 3712, -594, -5331, -682, 176, 86 },
+    { 3350, -742, -5452, -551, 342, 248 },
+    { 3076, -816, -5510, -382, 388, 455 },
+    { 2910, -908, -5515, -199, 303, 635 },
+    { 2853, -1099, -5523, -36, 97, 724 },
+    { 2877, -1442, -5628, 56, -187, 667 },
+    { 2925, -1938, -5940, 40, -461, 448 },
+    { 2935, -2527, -6543, -71, -629, 106 },
+    { 2863, -3098, -7464, -219, -631, -269 },
+    { 2710, -3529, -8662, -334, -479, -580 },
+    { 2516, -3731, -10037, -368, -241, -760 },
+    { 2337, -3670, -11467, -317, -8, -798 },
+    { 2220, -3360, -12839, -217, 153, -736 },
+    { 2190, -2838, -14058, -121, 229, -633 },
+    { 2252, -2161, -15041, -66, 253, -522 },
+    { 2391, -1402, -15729, -56, 259, -404 },
+    { 2578, -634, -16107, -78, 259, -280 },
+    { 2786, 93, -16195, -119, 258, -161 },
+    { 3004, 748, -16038, -165, 271, -52 },
+    { 3231, 1314, -15682, -202, 301, 58 },
+    { 3469, 1778, -15175, -225, 334, 179 },
+    { 3714, 2133, -14563, -234, 357, 307 },
+    { 3953, 2381, -13892, -231, 362, 441 },
+  },
+  { // lat -40
+    { 5394, 2222, -12178, -254, 325, 282 },
+    { 5495, 2326, -11432, -217, 317, 420 },
+    { 5574, 2370, -10695, -187, 248, 557 },
+    { 5631, 2373, -9975, -186, 135, 653 },
+    { 5656, 2351, -9277, -216, 19, 699 },
+    { 5635, 2325, -8583, -266, -85, 715 },
+    { 5560, 2302, -7853, -327, -179, 708 },
+    { 5447, 2253, -7045, -387, -267, 677 },
+    { 5322, 2100, -6152, -435, -359, 619 },
+    { 5189, 1743, -5249, -484, -473, 508 },
+    { 5008, 1139, -4506, -574, -570, 301 },
+    { 4724, 383, -4100, -706, -551, 13 },
+    { 4325, -329, -4092, -825, -354, -242 },
+    { 3858, -823, -4376, -867, -35, -334 },
+    { 3395, -1051, -4761, -820, 271, -228 },
+    { 2981, -1085, -5095, -718, 468, 5 },
+    { 2638, -1025, -5317, -582, 549, 283 },
+    { 2391, -949, -5424, -396, 513, 563 },
+    { 2279, -943, -5444, -171, 315, 783 },
+    { 2319, -1099, -5469, 20, -42, 813 },
+    { 2481, -1467, -5651, 101, -432, 564 },
+    { 2694, -2002, -6142, 65, -683, 89 },
+    { 2885, -2575, -7018, -32, -695, -447 },
+    { 3019, -3017, -8240, -115, -489, -863 },
+    { 3115, -3201, -9659, -129, -170, -1047 },
+    { 3222, -3093, -11093, -61, 126, -994 },
+    { 3384, -2733, -12395, 65, 293, -791 },
+    { 3621, -2183, -13469, 184, 305, -571 },
+    { 3925, -1525, -14245, 235, 236, -419 },
+    { 4249, -856, -14703, 203, 167, -323 },
+    { 4529, -234, -14880, 113, 125, -244 },
+    { 4736, 336, -14827, -4, 109, -176 },
+    { 4887, 863, -14580, -119, 134, -114 },
+    { 5016, 1336, -14158, -203, 190, -36 },
+    { 5143, 1734, -13590, -252, 247, 62 },
+    { 5272, 2032, -12912, -269, 293, 165 },
+    { 5394, 2222, -12178, -254, 325, 282 },
+  },
+  { // lat -30
+    { 6701, 2032, -10001, -252, 347, 141 },
+    { 6687, 2092, -9262, -175, 344, 332 },
+    { 6646, 2109, -8539, -128, 243, 504 },
+    { 6590, 2091, -7828, -131, 94, 594 },
+    { 6517, 2034, -7144, -173, -41, 607 },
+    { 6411, 1953, -6501, -237, -152, 581 },
+    { 6255, 1869, -5890, -317, -246, 529 },
+    { 6055, 1790, -5257, -401, -309, 463 },
+    { 5838, 1650, -4542, -463, -367, 419 },
+    { 5610, 1310, -3783, -518, -492, 349 },
+    { 5331, 690, -3177, -618, -647, 124 },
+    { 4962, -105, -2959, -771, -664, -268 },
+    { 4505, -831, -3202, -917, -434, -639 },
+    { 4010, -1288, -3755, -989, -41, -780 },
+    { 3533, -1448, -4378, -966, 318, -656 },
+    { 3107, -1414, -4926, -885, 533, -404 },
+    { 2737, -1283, -5372, -773, 650, -123 },
+    { 2444, -1095, -5704, -607, 700, 227 },
+    { 2278, -906, -5881, -370, 569, 623 },
+    { 2296, -838, -5921, -107, 196, 845 },
+    { 2517, -998, -5969, 113, -273, 692 },
+    { 2897, -1395, -6232, 248, -609, 198 },
+    { 3350, -1918, -6868, 292, -675, -418 },
+    { 3787, -2368, -7898, 282, -479, -911 },
+    { 4178, -2563, -9168, 267, -135, -1127 },
+    { 4541, -2451, -10442, 284, 202, -1036 },
+    { 4903, -2080, -11542, 349, 393, -721 },
+    { 5294, -1523, -12347, 431, 368, -369 },
+    { 5718, -904, -12788, 461, 205, -154 },
+    { 6111, -368, -12914, 400, 47, -88 },
+    { 6384, 56, -12864, 257, -53, -92 },
+    { 6522, 452, -12714, 67, -88, -132 },
+    { 6584, 866, -12440, -118, -34, -171 },
+    { 6621, 1272, -12013, -246, 75, -157 },
+    { 6654, 1626, -11438, -306, 181, -93 },
+    { 6684, 1886, -10746, -306, 274, -1 },
+    { 6701, 2032, -10001, -252, 347, 141 },
+  },
+  { // lat -20
+    { 7796, 1827, -7262, -232, 413, 15 },
+    { 7687, 1841, -6583, -147, 395, 309 },
+    { 7537, 1829, -5946, -103, 247, 532 },
+    { 7368, 1802, -5321, -106, 61, 614 },
+    { 7195, 1737, -4716, -138, -91, 595 },
+    { 7018, 1632, -4163, -189, -214, 535 },
+    { 6828, 1518, -3677, -269, -325, 434 },
+    { 6626, 1423, -3203, -380, -386, 309 },
+    { 6416, 1283, -2646, -495, -421, 233 },
+    { 6174, 930, -2035, -601, -546, 154 },
+    { 5866, 276, -1610, -713, -734, -128 },
+    { 5482, -548, -1631, -835, -770, -640 },
+    { 5038, -1277, -2153, -943, -517, -1141 },
+    { 4563, -1708, -2994, -1006, -66, -1366 },
+    { 4100, -1812, -3890, -982, 362, -1252 },
+    { 3705, -1706, -4685, -871, 611, -962 },
+    { 3410, -1502, -5370, -731, 740, -651 },
+    { 3222, -1224, -5941, -598, 827, -255 },
+    { 3145, -899, -6314, -451, 764, 259 },
+    { 3208, -633, -6431, -243, 459, 671 },
+    { 3463, -558, -6369, 45, 21, 750 },
+    { 3922, -755, -6325, 349, -366, 464 },
+    { 4521, -1176, -6543, 561, -538, -52 },
+    { 5156, -1618, -7159, 658, -427, -551 },
+    { 5757, -1851, -8069, 686, -131, -818 },
+    { 6296, -1796, -9033, 676, 191, -781 },
+    { 6763, -1481, -9857, 649, 395, -473 },
+    { 7178, -961, -10377, 628, 368, -66 },
+    { 7564, -403, -10479, 592, 153, 195 },
+    { 7874, -17, -10286, 499, -84, 235 },
+    { 8032, 204, -10065, 325, -257, 125 },
+    { 8050, 452, -9891, 87, -322, -86 },
+    { 8008, 797, -9636, -141, -224, -292 },
+    { 7960, 1165, -9222, -285, -33, -372 },
+    { 7913, 1490, -8660, -336, 144, -335 },
+    { 7863, 1722, -7982, -311, 302, -215 },
+    { 7796, 1827, -7262, -232, 413, 15 },
+  },
+  { // lat -10
+    { 8417, 1625, -4044, -186, 468, -84 },
+    { 8252, 1591, -3452, -154, 425, 298 },
+    { 8046, 1545, -2956, -150, 244, 560 },
+    { 7821, 1512, -2494, -161, 42, 651 },
+    { 7606, 1459, -2042, -178, -118, 634 },
+    { 7412, 1367, -1625, -209, -258, 571 },
+    { 7238, 1262, -1261, -276, -407, 438 },
+    { 7079, 1174, -886, -393, -504, 221 },
+    { 6909, 1018, -410, -539, -536, 22 },
+    { 6686, 621, 88, -663, -632, -169 },
+    { 6404, -70, 338, -732, -787, -536 },
+    { 6089, -903, 100, -750, -801, -1105 },
+    { 5763, -1633, -661, -757, -550, -1661 },
+    { 5419, -2060, -1782, -766, -76, -1957 },
+    { 5083, -2120, -2987, -727, 428, -1852 },
+    { 4827, -1911, -4047, -599, 739, -1457 },
+    { 4717, -1575, -4888, -439, 850, -1015 },
+    { 4756, -1193, -5516, -340, 882, -576 },
+    { 4882, -792, -5911, -311, 824, -94 },
+    { 5058, -422, -6028, -245, 637, 351 },
+    { 5323, -176, -5862, -32, 339, 661 },
+    { 5736, -184, -5534, 285, -36, 717 },
+    { 6289, -482, -5319, 562, -315, 440 },
+    { 6913, -890, -5458, 748, -303, 34 },
+    { 7543, -1153, -5912, 870, -80, -204 },
+    { 8122, -1181, -6481, 911, 157, -197 },
+    { 8595, -982, -7006, 846, 306, 20 },
+    { 8940, -566, -7304, 722, 273, 345 },
+    { 9169, -108, -7202, 600, 57, 566 },
+    { 9279, 132, -6849, 479, -217, 565 },
+    { 9255, 191, -6593, 314, -459, 342 },
+    { 9128, 341, -6485, 98, -553, -69 },
+    { 8968, 658, -6297, -99, -398, -467 },
+    { 8815, 1018, -5917, -213, -115, -634 },
+    { 8677, 1333, -5380, -246, 133, -594 },
+    { 8549, 1553, -4725, -228, 340, -416 },
+    { 8417, 1625, -4044, -186, 468, -84 },
+  },
+  { // lat 0
+    { 8376, 1434, -764, -117, 456, -138 },
+    { 8187, 1377, -252, -183, 393, 257 },
+    { 7994, 1310, 114, -251, 210, 513 },
+    { 7807, 1284, 422, -299, 19, 610 },
+    { 7649, 1259, 737, -328, -137, 614 },
+    { 7527, 1196, 1049, -359, -294, 563 },
+    { 7432, 1114, 1342, -408, -480, 404 },
+    { 7336, 1023, 1682, -484, -615, 95 },
+    { 7196, 822, 2114, -569, -644, -244 },
+    { 6987, 367, 2505, -612, -679, -546 },
+    { 6746, -337, 2600, -575, -755, -933 },
+    { 6537, -1138, 2223, -472, -732, -1447 },
+    { 6390, -1837, 1346, -361, -500, -1961 },
+    { 6294, -2247, 83, -284, -47, -2273 },
+    { 6244, -2265, -1296, -229, 494, -2174 },
+    { 6260, -1949, -2488, -159, 858, -1685 },
+    { 6381, -1471, -3322, -72, 953, -1098 },
+    { 6610, -985, -3798, -24, 899, -605 },
+    { 6884, -562, -4006, -48, 791, -219 },
+    { 7136, -191, -4000, -83, 689, 124 },
+    { 7371, 118, -3742, -24, 543, 512 },
+    { 7655, 230, -3244, 146, 232, 803 },
+    { 8028, 38, -2751, 359, -84, 742 },
+    { 8479, -313, -2546, 566, -118, 486 },
+    { 8973, -573, -2633, 747, 47, 393 },
+    { 9455, -665, -2853, 844, 163, 478 },
+    { 9857, -596, -3114, 799, 185, 616 },
+    { 10109, -340, -3276, 644, 111, 772 },
+    { 10181, -34, -3155, 479, -77, 866 },
+    { 10097, 73, -2865, 352, -340, 800 },
+    { 9906, 27, -2733, 242, -608, 492 },
+    { 9650, 119, -2778, 135, -710, -56 },
+    { 9362, 424, -2729, 49, -510, -573 },
+    { 9073, 794, -2454, -5, -167, -781 },
+    { 8807, 1127, -1994, -38, 117, -725 },
+    { 8576, 1364, -1394, -69, 337, -508 },
+    { 8376, 1434, -764, -117, 456, -138 },
+  },
+  { // lat 10
+    { 7841, 1239, 2087, -47, 349, -134 },
+    { 7635, 1215, 2535, -214, 280, 177 },
+    { 7486, 1168, 2838, -358, 121, 363 },
+    { 7381, 1173, 3086, -457, -38, 427 },
+    { 7324, 1192, 3374, -519, -178, 423 },
+    { 7308, 1163, 3700, -559, -333, 363 },
+    { 7309, 1085, 4036, -579, -525, 180 },
+    { 7280, 953, 4408, -573, -661, -167 },
+    { 7175, 669, 4806, -544, -669, -549 },
+    { 6997, 151, 5074, -480, -642, -860 },
+    { 6807, -545, 5017, -354, -642, -1177 },
+    { 6688, -1274, 4546, -168, -577, -1564 },
+    { 6695, -1878, 3665, 42, -354, -1946 },
+    { 6845, -2205, 2476, 219, 52, -2169 },
+    { 7098, -2161, 1214, 299, 541, -2045 },
+    { 7390, -1790, 157, 282, 890, -1569 },
+    { 7684, -1244, -506, 235, 988, -968 },
+    { 7979, -707, -754, 198, 901, -456 },
+    { 8261, -292, -723, 153, 750, -120 },
+    { 8496, 31, -556, 92, 660, 116 },
+    { 8667, 319, -229, 43, 592, 431 },
+    { 8810, 471, 312, 62, 369, 745 },
+    { 8987, 353, 889, 175, 100, 792 },
+    { 9240, 67, 1239, 335, 69, 690 },
+    { 9556, -163, 1341, 476, 192, 762 },
+    { 9897, -277, 1334, 558, 205, 962 },
+    { 10206, -302, 1265, 546, 94, 1080 },
+    { 10402, -215, 1192, 437, -52, 1088 },
+    { 10413, -96, 1241, 297, -222, 1031 },
+    { 10253, -123, 1337, 195, -438, 883 },
+    { 9990, -245, 1245, 164, -670, 544 },
+    { 9664, -205, 975, 195, -746, -3 },
+    { 9278, 72, 786, 239, -536, -500 },
+    { 8865, 453, 830, 243, -200, -695 },
+    { 8469, 827, 1098, 196, 69, -641 },
+    { 8121, 1116, 1552, 100, 261, -445 },
+    { 7841, 1239, 2087, -47, 349, -134 },
+  },
+  { // lat 20
+    { 7211, 1015, 4387, -9, 152, -90 },
+    { 6977, 1089, 4760, -232, 92, 56 },
+    { 6851, 1118, 5058, -415, -23, 119 },
+    { 6803, 1181, 5344, -542, -137, 112 },
+    { 6804, 1247, 5706, -622, -246, 64 },
+    { 6834, 1247, 6146, -661, -374, -28 },
+    { 6869, 1155, 6613, -643, -525, -215 },
+    { 6867, 951, 7079, -559, -622, -520 },
+    { 6797, 570, 7475, -442, -609, -844 },
+    { 6680, -14, 7649, -313, -547, -1101 },
+    { 6574, -704, 7468, -150, -484, -1333 },
+    { 6545, -1350, 6916, 70, -361, -1572 },
+    { 6656, -1815, 6072, 325, -121, -1751 },
+    { 6931, -1998, 5083, 539, 220, -1774 },
+    { 7320, -1876, 4137, 621, 580, -1579 },
+    { 7722, -1504, 3396, 555, 840, -1191 },
+    { 8058, -983, 2974, 425, 937, -713 },
+    { 8313, -463, 2909, 313, 876, -264 },
+    { 8510, -69, 3097, 241, 726, 47 },
+    { 8658, 206, 3381, 182, 621, 231 },
+    { 8744, 439, 3742, 114, 565, 446 },
+    { 8775, 579, 4238, 73, 414, 686 },
+    { 8815, 514, 4766, 107, 219, 771 },
+    { 8936, 305, 5129, 178, 191, 766 },
+    { 9143, 124, 5308, 219, 276, 906 },
+    { 9393, 19, 5417, 232, 243, 1159 },
+    { 9640, -57, 5490, 231, 57, 1302 },
+    { 9817, -109, 5519, 192, -160, 1258 },
+    { 9850, -177, 5531, 122, -340, 1098 },
+    { 9731, -350, 5455, 77, -501, 877 },
+    { 9511, -558, 5141, 114, -649, 559 },
+    { 9216, -593, 4621, 233, -675, 130 },
+    { 8840, -371, 4128, 354, -496, -243 },
+    { 8407, 10, 3842, 391, -228, -398 },
+    { 7964, 429, 3810, 334, -19, -372 },
+    { 7551, 793, 4020, 196, 110, -256 },
+    { 7211, 1015, 4387, -9, 152, -90 },
+  },
+  { // lat 30
+    { 6725, 755, 6394, -3, -91, -52 },
+    { 6477, 970, 6656, -209, -137, -87 },
+    { 6341, 1121, 6964, -377, -199, -153 },
+    { 6287, 1260, 7336, -494, -263, -239 },
+    { 6269, 1364, 7813, -564, -331, -343 },
+    { 6254, 1373, 8379, -583, -407, -472 },
+    { 6227, 1252, 8970, -531, -484, -643 },
+    { 6172, 978, 9521, -407, -523, -861 },
+    { 6093, 518, 9933, -247, -493, -1082 },
+    { 6022, -111, 10071, -81, -415, -1268 },
+    { 6005, -795, 9837, 102, -300, -1418 },
+    { 6079, -1372, 9258, 313, -118, -1507 },
+    { 6267, -1711, 8472, 520, 130, -1479 },
+    { 6561, -1767, 7670, 664, 390, -1318 },
+    { 6912, -1582, 7003, 696, 614, -1065 },
+    { 7249, -1228, 6535, 619, 775, -761 },
+    { 7509, -772, 6301, 486, 856, -418 },
+    { 7671, -307, 6328, 355, 828, -67 },
+    { 7755, 58, 6560, 261, 712, 207 },
+    { 7795, 304, 6873, 201, 607, 383 },
+    { 7795, 490, 7219, 142, 539, 553 },
+    { 7757, 609, 7624, 87, 420, 730 },
+    { 7736, 601, 8050, 70, 272, 810 },
+    { 7803, 492, 8399, 71, 231, 821 },
+    { 7965, 380, 8657, 42, 280, 929 },
+    { 8174, 290, 8887, -8, 244, 1153 },
+    { 8380, 178, 9101, -39, 48, 1320 },
+    { 8538, 17, 9254, -54, -210, 1296 },
+    { 8601, -214, 9295, -66, -411, 1105 },
+    { 8564, -527, 9136, -56, -528, 849 },
+    { 8463, -832, 8681, 20, -584, 573 },
+    { 8309, -953, 7980, 163, -558, 288 },
+    { 8083, -805, 7236, 303, -424, 59 },
+    { 7781, -451, 6650, 362, -252, -46 },
+    { 7428, -7, 6316, 320, -133, -58 },
+    { 7060, 422, 6247, 189, -84, -48 },
+    { 6725, 755, 6394, -3, -91, -52 },
+  },
+  { // lat 40
+    { 6321, 498, 8441, 9, -335, -22 },
+    { 6103, 845, 8587, -136, -372, -196 },
+    { 5935, 1122, 8887, -260, -388, -369 },
+    { 5806, 1335, 9326, -344, -399, -526 },
+    { 5683, 1457, 9883, -378, -410, -675 },
+    { 5545, 1449, 10508, -354, -417, -821 },
+    { 5390, 1288, 11130, -268, -412, -957 },
+    { 5228, 960, 11675, -126, -386, -1080 },
+    { 5090, 462, 12052, 47, -330, -1187 },
+    { 5020, -167, 12159, 228, -237, -1272 },
+    { 5059, -815, 11929, 404, -95, -1314 },
+    { 5213, -1329, 11398, 559, 99, -1276 },
+    { 5457, -1596, 10709, 662, 312, -1133 },
+    { 5741, -1596, 10038, 693, 496, -913 },
+    { 6016, -1392, 9509, 657, 633, -670 },
+    { 6245, -1063, 9159, 570, 734, -424 },
+    { 6402, -664, 8993, 451, 793, -159 },
+    { 6472, -258, 9018, 322, 780, 116 },
+    { 6467, 79, 9198, 213, 699, 349 },
+    { 6425, 319, 9454, 133, 607, 521 },
+    { 6368, 494, 9736, 64, 525, 671 },
+    { 6308, 622, 10050, 5, 416, 801 },
+    { 6278, 687, 10399, -25, 294, 862 },
+    { 6317, 688, 10764, -39, 237, 874 },
+    { 6428, 650, 11136, -82, 239, 941 },
+    { 6574, 570, 11517, -165, 185, 1093 },
+    { 6714, 412, 11875, -248, -2, 1215 },
+    { 6822, 154, 12140, -293, -256, 1177 },
+    { 6887, -203, 12227, -288, -449, 973 },
+    { 6925, -621, 12050, -237, -522, 710 },
+    { 6963, -995, 11561, -135, -502, 482 },
+    { 7002, -1182, 10821, 10, -428, 324 },
+    { 7004, -1106, 9999, 151, -331, 237 },
+    { 6932, -805, 9277, 230, -256, 207 },
+    { 6779, -378, 8761, 223, -241, 185 },
+    { 6563, 79, 8487, 140, -280, 115 },
+    { 6321, 498, 8441, 9, -335, -22 },
+  },
+  { // lat 50
+    { 5685, 299, 10652, 14, -562, 31 },
+    { 5517, 708, 10722, -50, -603, -246 },
+    { 5309, 1052, 10974, -105, -585, -514 },
+    { 5070, 1298, 11380, -132, -530, -736 },
+    { 4801, 1416, 11891, -115, -460, -903 },
+    { 4514, 1382, 12440, -48, -381, -1017 },
+    { 4227, 1188, 12958, 62, -297, -1078 },
+    { 3971, 839, 13380, 202, -213, -1094 },
+    { 3783, 353, 13644, 356, -127, -1079 },
+    { 3708, -221, 13686, 507, -26, -1045 },
+    { 3773, -786, 13476, 633, 103, -983 },
+    { 3968, -1228, 13046, 711, 255, -879 },
+    { 4244, -1461, 12492, 728, 406, -729 },
+    { 4534, -1469, 11938, 689, 532, -550 },
+    { 4785, -1297, 11474, 610, 629, -364 },
+    { 4972, -1009, 11144, 504, 702, -172 },
+    { 5081, -659, 10960, 376, 741, 32 },
+    { 5111, -300, 10918, 239, 729, 235 },
+    { 5077, 19, 10996, 114, 671, 411 },
+    { 5011, 278, 11153, 12, 596, 552 },
+    { 4941, 486, 11361, -69, 517, 673 },
+    { 4879, 661, 11620, -130, 424, 775 },
+    { 4836, 800, 11947, -163, 325, 846 },
+    { 4822, 887, 12349, -185, 246, 894 },
+    { 4832, 902, 12812, -234, 178, 948 },
+    { 4854, 819, 13300, -320, 66, 1008 },
+    { 4879, 613, 13747, -408, -121, 1008 },
+    { 4908, 280, 14068, -446, -330, 886 },
+    { 4959, -150, 14183, -411, -464, 662 },
+    { 5055, -611, 14031, -320, -476, 429 },
+    { 5214, -1000, 13607, -199, -395, 282 },
+    { 5420, -1211, 12978, -73, -291, 252 },
+    { 5623, -1189, 12270, 33, -229, 304 },
+    { 5771, -957, 11615, 94, -243, 369 },
+    { 5830, -584, 11104, 103, -333, 368 },
+    { 5796, -146, 10779, 70, -458, 254 },
+    { 5685, 299, 10652, 14, -562, 31 },
+  },
+  { // lat 60
+    { 4480, 166, 12711, -6, -742, 48 },
+    { 4349, 539, 12734, 45, -787, -265 },
+    { 4125, 852, 12885, 102, -741, -571 },
+    { 3827, 1069, 13139, 164, -626, -815 },
+    { 3483, 1160, 13459, 232, -473, -969 },
+    { 3123, 1110, 13796, 309, -310, -1028 },
+    { 2787, 919, 14102, 394, -158, -1007 },
+    { 2510, 602, 14333, 482, -27, -927 },
+    { 2328, 186, 14451, 568, 82, -815 },
+    { 2272, -279, 14429, 643, 178, -693 },
+    { 2354, -725, 14255, 695, 273, -570 },
+    { 2556, -1078, 13949, 713, 369, -448 },
+    { 2834, -1282, 13561, 690, 461, -325 },
+    { 3134, -1319, 13152, 632, 543, -202 },
+    { 3404, -1207, 12780, 544, 611, -79 },
+    { 3614, -983, 12482, 432, 659, 48 },
+    { 3750, -691, 12280, 305, 680, 177 },
+    { 3813, -372, 12179, 173, 669, 301 },
+    { 3814, -60, 12173, 49, 630, 411 },
+    { 3774, 228, 12251, -58, 576, 508 },
+    { 3709, 486, 12406, -148, 512, 599 },
+    { 3629, 715, 12639, -224, 434, 685 },
+    { 3534, 902, 12956, -285, 341, 763 },
+    { 3424, 1024, 13354, -340, 231, 821 },
+    { 3302, 1052, 13811, -394, 100, 847 },
+    { 3181, 957, 14281, -443, -57, 824 },
+    { 3081, 728, 14700, -461, -226, 733 },
+    { 3031, 379, 14998, -427, -364, 575 },
+    { 3058, -45, 15120, -341, -422, 392 },
+    { 3183, -472, 15037, -234, -386, 250 },
+    { 3404, -821, 14764, -140, -293, 202 },
+    { 3689, -1020, 14352, -81, -210, 255 },
+    { 3990, -1035, 13883, -58, -198, 363 },
+    { 4251, -877, 13436, -57, -281, 448 },
+    { 4431, -589, 13071, -58, -437, 440 },
+    { 4509, -224, 12824, -43, -612, 302 },
+    { 4480, 166, 12711, -6, -742, 48 },
+  },
+  { // lat 70
+    { 2771, 60, 14044, 43, -805, -3 },
+    { 2680, 313, 14021, 189, -828, -228 },
+    { 2504, 525, 14053, 340, -767, -446 },
+    { 2262, 666, 14129, 475, -634, -620 },
+    { 1980, 715, 14231, 579, -455, -726 },
+    { 1692, 664, 14338, 649, -259, -757 },
+    { 1429, 513, 14430, 688, -72, -718 },
+    { 1225, 278, 14486, 702, 90, -628 },
+    { 1105, -18, 14491, 699, 221, -508 },
+    { 1086, -338, 14432, 683, 324, -376 },
+    { 1172, -642, 14309, 657, 405, -248 },
+    { 1350, -886, 14129, 618, 472, -129 },
+    { 1593, -1040, 13909, 565, 528, -23 },
+    { 1866, -1086, 13673, 496, 576, 72 },
+    { 2133, -1025, 13446, 411, 612, 158 },
+    { 2364, -870, 13250, 313, 635, 237 },
+    { 2542, -645, 13103, 206, 640, 311 },
+    { 2656, -376, 13016, 96, 627, 379 },
+    { 2706, -87, 12995, -13, 597, 443 },
+    { 2696, 202, 13043, -116, 550, 502 },
+    { 2632, 474, 13161, -212, 488, 558 },
+    { 2517, 712, 13347, -299, 407, 610 },
+    { 2358, 897, 13595, -375, 305, 650 },
+    { 2164, 1007, 13895, -432, 181, 671 },
+    { 1952, 1022, 14222, -465, 42, 662 },
+    { 1747, 929, 14547, -463, -98, 618 },
+    { 1579, 729, 14831, -425, -221, 543 },
+    { 1479, 445, 15041, -356, -303, 450 },
+    { 1472, 116, 15151, -274, -334, 365 },
+    { 1564, -208, 15152, -202, -320, 311 },
+    { 1745, -473, 15054, -161, -291, 301 },
+    { 1987, -638, 14881, -154, -282, 328 },
+    { 2249, -683, 14670, -167, -325, 364 },
+    { 2488, -609, 14455, -174, -427, 371 },
+    { 2669, -438, 14267, -148, -568, 318 },
+    { 2767, -203, 14126, -75, -709, 190 },
+    { 2771, 60, 14044, 43, -805, -3 },
+  },
+  { // lat 80
+    { 1013, -23, 14435, 200, -737, 33 },
+    { 984, 70, 14398, 348, -714, -49 },
+    { 913, 145, 14370, 494, -645, -124 },
+    { 810, 188, 14350, 621, -536, -185 },
+    { 689, 187, 14333, 720, -394, -223 },
+    { 567, 140, 14316, 784, -235, -237 },
+    { 463, 46, 14295, 811, -70, -224 },
+    { 392, -85, 14266, 803, 87, -190 },
+    { 368, -240, 14225, 767, 229, -138 },
+    { 399, -402, 14171, 709, 351, -74 },
+    { 484, -551, 14104, 635, 451, -5 },
+    { 618, -668, 14026, 550, 530, 65 },
+    { 789, -739, 13942, 457, 589, 133 },
+    { 980, -753, 13857, 358, 631, 196 },
+    { 1173, -705, 13779, 256, 655, 254 },
+    { 1350, -600, 13713, 151, 664, 306 },
+    { 1495, -444, 13667, 45, 655, 353 },
+    { 1595, -251, 13645, -60, 631, 394 },
+    { 1643, -37, 13652, -162, 590, 429 },
+    { 1633, 183, 13688, -257, 532, 459 },
+    { 1569, 390, 13754, -343, 459, 483 },
+    { 1453, 568, 13848, -416, 370, 500 },
+    { 1297, 701, 13965, -472, 269, 508 },
+    { 1114, 778, 14097, -509, 160, 508 },
+    { 921, 790, 14236, -523, 48, 498 },
+    { 738, 738, 14371, -515, -60, 479 },
+    { 584, 628, 14491, -488, -157, 454 },
+    { 477, 473, 14589, -448, -240, 425 },
+    { 426, 296, 14657, -402, -308, 396 },
+    { 434, 117, 14693, -355, -366, 368 },
+    { 495, -38, 14699, -311, -419, 342 },
+    { 595, -154, 14679, -266, -476, 315 },
+    { 714, -217, 14639, -214, -540, 282 },
+    { 833, -227, 14588, -145, -609, 239 },
+    { 931, -189, 14533, -54, -673, 183 },
+    { 994, -115, 14480, 62, -720, 113 },
+    { 1013, -23, 14435, 200, -737, 33 },
+  },
+  { // lat 90
+    { -456, -29, 14182, 279, -636, 244 },
+    { -444, -108, 14182, 385, -578, 244 },
+    { -418, -183, 14182, 480, -503, 244 },
+    { -380, -253, 14182, 560, -412, 244 },
+    { -331, -315, 14182, 623, -308, 244 },
+    { -271, -368, 14182, 667, -196, 244 },
+    { -203, -409, 14182, 690, -77, 244 },
+    { -129, -438, 14182, 693, 44, 244 },
+    { -50, -454, 14182, 675, 164, 244 },
+    { 29, -456, 14182, 636, 279, 244 },
+    { 108, -444, 14182, 578, 385, 244 },
+    { 183, -419, 14182, 503, 480, 244 },
+    { 253, -380, 14182, 412, 560, 244 },
+    { 316, -331, 14182, 308, 623, 244 },
+    { 368, -271, 14182, 196, 667, 244 },
+    { 410, -203, 14182, 77, 690, 244 },
+    { 439, -129, 14182, -44, 693, 244 },
+    { 454, -51, 14182, -164, 675, 244 },
+    { 456, 29, 14182, -279, 636, 244 },
+    { 444, 108, 14182, -385, 578, 244 },
+    { 419, 183, 14182, -480, 503, 244 },
+    { 380, 253, 14182, -560, 412, 244 },
+    { 331, 316, 14182, -623, 308, 244 },
+    { 271, 368, 14182, -667, 196, 244 },
+    { 203, 410, 14182, -690, 77, 244 },
+    { 129, 439, 14182, -693, -44, 244 },
+    { 51, 454, 14182, -675, -164, 244 },
+    { -29, 456, 14182, -636, -279, 244 },
+    { -108, 444, 14182, -578, -385, 244 },
+    { -183, 419, 14182, -503, -480, 244 },
+    { -253, 380, 14182, -412, -560, 244 },
+    { -315, 331, 14182, -308, -623, 244 },
+    { -368, 271, 14182, -196, -667, 244 },
+    { -409, 203, 14182, -77, -690, 244 },
+    { -438, 129, 14182, 44, -693, 244 },
+    { -454, 50, 14182, 164, -675, 244 },
+    { -456, -29, 14182, 279, -636, 244 },
+  },
+};
+
+#endif /* WMM2020_GRID_H */
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2023 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pprz_trig_float.h
+ * @brief Paparazzi floating point trig functions.
+ *
+ * By default these are the libm functions. With PPRZ_TRIG_FLOAT_APPROX,
+ * minimax polynomials are used instead (coefficients from Cephes),
+ * in constant time and without any table:
+ *  - pprz_sinf, pprz_cosf, pprz_sincosf: error below 2e-7 for |a| < 8192,
+ *    libm is used above
+ *  - pprz_atan2f: error below 4e-7 rad
+ */
+
+#ifndef PPRZ_TRIG_FLOAT_H
+#define PPRZ_TRIG_FLOAT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "std.h"
+
+#ifndef PPRZ_TRIG_FLOAT_APPROX
+#define PPRZ_TRIG_FLOAT_APPROX FALSE
+#endif
+
+#if PPRZ_TRIG_FLOAT_APPROX
+
+/** largest angle for the range reduction, quadrant times PIO2_1 stays exact */
+#define PPRZ_TRIG_FLOAT_MAX_ANGLE 8192.f
+
+/* pi/2 in three parts for the range reduction (Cody-Waite) */
+#define PPRZ_TRIG_FLOAT_PIO2_1 1.5703125f
+#define PPRZ_TRIG_FLOAT_PIO2_2 4.837512969970703125e-4f
+#define PPRZ_TRIG_FLOAT_PIO2_3 7.54978995489188216e-8f
+
+/** sine and cosine of an angle in [-pi/4, pi/4] */
+static inline void pprz_sincosf_reduced(float r, float *s, float *c)
+{
+  const float z = r * r;
+  *s = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * r + r;
+  *c = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z - 0.5f * z + 1.f;
+}
+
+/** Sine and cosine of the same angle */
+static inline void pprz_sincosf(float a, float *s, float *c)
+{
+  if (!(fabsf(a) <= PPRZ_TRIG_FLOAT_MAX_ANGLE)) {
+    *s = sinf(a);
+    *c = cosf(a);
+    return;
+  }
+  const float fq = a * (float)M_2_PI;
+  const int32_t q = (int32_t)(fq >= 0.f ? fq + 0.5f : fq - 0.5f);
+  const float r = ((a - q * PPRZ_TRIG_FLOAT_PIO2_1) - q * PPRZ_TRIG_FLOAT_PIO2_2) - q * PPRZ_TRIG_FLOAT_PIO2_3;
+  float sr, cr;
+  pprz_sincosf_reduced(r, &sr, &cr);
+  switch (q & 3) {
+    case 0: *s = sr; *c = cr; break;
+    case 1: *s = cr; *c = -sr; break;
+    case 2: *s = -sr; *c = -cr; break;
+    default: *s = -cr; *c = sr; break;
+  }
+}
+
+static inline float pprz_sinf(float a)
+{
+  float s, c;
+  pprz_sincosf(a, &s, &c);
+  return s;
+}
+
+static inline float pprz_cosf(float a)
+{
+  float s, c;
+  pprz_sincosf(a, &s, &c);
+  return c;
+}
+
+static inline float pprz_atan2f(float y, float x)
+{
+  const float ax = fabsf(x);
+  const float ay = fabsf(y);
+  if (!(ax < INFINITY && ay < INFINITY) || (ax == 0.f && ay == 0.f)) {
+    // special values, same conventions as libm
+    return atan2f(y, x);
+  }
+  // atan of the ratio in [0, 1], reduced to [-tan(pi/8), tan(pi/8)]
+  float t = ay > ax ? ax / ay : ay / ax;
+  float a = 0.f;
+  if (t > 0.4142135623730950f) {
+    a = (float)M_PI_4;
+    t = (t - 1.f) / (t + 1.f);
+  }
+  const float z = t * t;
+  a += (((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f) * z * t + t;
+  if (ay > ax) {
+    a = (float)M_PI_2 - a;
+  }
+  if (x < 0.f) {
+    a = (float)M_PI - a;
+  }
+  return signbit(y) ? -a : a;
+}
+
+#else /* libm */
+
+static inline void pprz_sincosf(float a, float *s, float *c)
+{
+  *s = sinf(a);
+  *c = cosf(a);
+}
+
+static inline float pprz_sinf(float a)
+{
+  return sinf(a);
+}
+
+static inline float pprz_cosf(float a)
+{
+  return cosf(a);
+}
+
+static inline float pprz_atan2f(float y, float x)
+{
+  return atan2f(y, x);
+}
+
+#endif /* PPRZ_TRIG_FLOAT_APPROX */
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* PPRZ_TRIG_FLOAT_H */
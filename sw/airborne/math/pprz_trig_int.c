@@ -27,7 +27,7 @@
 #include "pprz_trig_int.h"
 #include "pprz_algebra_int.h"
 #if !defined(PPRZ_TRIG_INT_USE_FLOAT)
-#if !defined(PPRZ_TRIG_INT_COMPR_FLASH) || defined(PPRZ_TRIG_INT_TEST)
+#if (!defined(PPRZ_TRIG_INT_COMPR_FLASH) && !defined(PPRZ_TRIG_INT_COMPR_INTERP)) || defined(PPRZ_TRIG_INT_TEST)
 PPRZ_TRIG_CONST int16_t pprz_trig_int[6434] = {    0,
                                                    3,     7,    11,    15,    19,    23,    27,    31,    35,    39,    43,    47,    51,    55,    59,    63,
                                                    67,    71,    75,    79,    83,    87,    91,    95,    99,   103,   107,   111,   115,   119,   123,   127,
@@ -583,6 +583,38 @@ const uint8_t pprz_trig_int_compr[TRIG_INT_COMPR_LEN] = {
 #endif
 #endif
 
+#if defined(PPRZ_TRIG_INT_COMPR_INTERP)
+/* sin(i * 32 / 4096) with INT32_TRIG_FRAC + 1 bits */
+static const uint16_t pprz_trig_int_interp_tab[TRIG_INT_INTERP_LEN] = {
+      0,   256,   512,   768,  1024,  1280,  1535,  1791,  2047,  2302,  2557,  2813,
+   3068,  3322,  3577,  3831,  4085,  4339,  4593,  4846,  5099,  5352,  5604,  5856,
+   6108,  6359,  6610,  6861,  7111,  7361,  7610,  7859,  8107,  8355,  8602,  8849,
+   9095,  9341,  9586,  9830, 10074, 10317, 10560, 10802, 11043, 11284, 11524, 11763,
+  12002, 12240, 12477, 12713, 12949, 13184, 13418, 13651, 13883, 14114, 14345, 14575,
+  14804, 15032, 15259, 15485, 15710, 15934, 16157, 16379, 16601, 16821, 17040, 17258,
+  17475, 17691, 17906, 18120, 18333, 18544, 18755, 18964, 19172, 19379, 19585, 19790,
+  19993, 20196, 20397, 20596, 20795, 20992, 21188, 21383, 21576, 21768, 21959, 22148,
+  22336, 22523, 22708, 22892, 23074, 23255, 23435, 23613, 23790, 23965, 24139, 24311,
+  24482, 24652, 24820, 24986, 25151, 25314, 25476, 25636, 25795, 25952, 26107, 26261,
+  26414, 26564, 26713, 26861, 27007, 27151, 27293, 27434, 27573, 27711, 27847, 27981,
+  28113, 28244, 28373, 28500, 28625, 28749, 28871, 28991, 29110, 29226, 29341, 29454,
+  29566, 29675, 29783, 29888, 29993, 30095, 30195, 30294, 30390, 30485, 30578, 30669,
+  30758, 30846, 30931, 31015, 31096, 31176, 31254, 31330, 31404, 31476, 31546, 31615,
+  31681, 31745, 31808, 31868, 31927, 31984, 32038, 32091, 32142, 32191, 32238, 32282,
+  32325, 32366, 32405, 32442, 32477, 32510, 32541, 32570, 32598, 32623, 32646, 32667,
+  32686, 32703, 32718, 32731, 32742, 32752, 32759, 32764, 32767, 32768, 32767,
+};
+
+int16_t pprz_trig_int_interp(int32_t val)
+{
+  const int32_t k = val >> TRIG_INT_INTERP_SHIFT;
+  const int32_t f = val & ((1 << TRIG_INT_INTERP_SHIFT) - 1);
+  const int32_t a = pprz_trig_int_interp_tab[k];
+  const int32_t b = pprz_trig_int_interp_tab[k + 1];
+  return (a + (((b - a) * f) >> TRIG_INT_INTERP_SHIFT)) >> 1;
+}
+#endif
+
 #if defined(PPRZ_TRIG_INT_COMPR_FLASH)
 
 #if defined(PPRZ_TRIG_INT_COMPR_HIGHEST)
@@ -878,7 +910,11 @@ int32_t pprz_itrig_sin(int32_t angle)
     angle = -INT32_ANGLE_PI - angle;
   }
   if (angle >= 0) {
-#if defined(PPRZ_TRIG_INT_COMPR_FLASH)
+#if defined(PPRZ_TRIG_INT_COMPR_INTERP) && !defined(PPRZ_TRIG_INT_TEST)
+    return pprz_trig_int_interp(angle);
+  } else {
+    return -pprz_trig_int_interp(-angle);
+#elif defined(PPRZ_TRIG_INT_COMPR_FLASH)
     return pprz_trig_int_f(angle);
   } else {
     return -pprz_trig_int_f(-angle);
@@ -46,6 +46,7 @@ extern "C" {
 #define PPRZ_TRIG_INT_COMPR_HIGH
 #define PPRZ_TRIG_INT_COMPR_LOW
 #define PPRZ_TRIG_INT_COMPR_NONE
+#define PPRZ_TRIG_INT_COMPR_INTERP
 #endif
 
 #if defined(PPRZ_TRIG_INT_COMPR_FLASH) && !defined(PPRZ_TRIG_INT_COMPR_HIGHEST) && !defined(PPRZ_TRIG_INT_COMPR_HIGH) && !defined(PPRZ_TRIG_INT_COMPR_LOW)
@@ -69,10 +70,21 @@ extern "C" {
 #define TREE_BUF_12_2 2145
 #define TREE_BUF_12_3 3474
 
-#if !defined(PPRZ_TRIG_INT_COMPR_FLASH) || defined(PPRZ_TRIG_INT_TEST)
+/* linear interpolation between the points of a coarse table */
+#define TRIG_INT_INTERP_SHIFT   5
+#define TRIG_INT_INTERP_LEN     ((TRIG_INT_SIZE >> TRIG_INT_INTERP_SHIFT) + 2)
+
+#if (!defined(PPRZ_TRIG_INT_COMPR_FLASH) && !defined(PPRZ_TRIG_INT_COMPR_INTERP)) || defined(PPRZ_TRIG_INT_TEST)
 extern PPRZ_TRIG_CONST int16_t pprz_trig_int[];
 #endif
 
+#if defined(PPRZ_TRIG_INT_COMPR_INTERP)
+/** Sine on [0, pi/2] from a 406 bytes table in flash, no init needed.
+ * Within 1 LSB of the full table.
+ */
+int16_t pprz_trig_int_interp(int32_t val);
+#endif
+
 extern int32_t pprz_itrig_sin(int32_t angle);
 extern int32_t pprz_itrig_cos(int32_t angle);
 extern int32_t int32_atan2(int32_t y, int32_t x);
@@ -263,6 +263,7 @@ int WEAK uart_check_free_space(struct uart_periph *p, long *fd __attribute__((un
 }
 
 // Weak implementation of put_buffer, byte by byte
+// fallback for byte oriented devices, arch should provide a block copy version
 void WEAK uart_put_buffer(struct uart_periph *p, long fd, const uint8_t *data, uint16_t len)
 {
   int i = 0;
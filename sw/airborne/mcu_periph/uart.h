@@ -31,6 +31,7 @@
 #include "mcu_periph/uart_arch.h"
 #include "pprzlink/pprzlink_device.h"
 #include "std.h"
+#include <string.h>
 
 #ifndef UART_RX_BUFFER_SIZE
 // Only for the STM32F1 less buffer
@@ -106,6 +107,28 @@ extern int uart_check_free_space(struct uart_periph *p, long *fd, uint16_t len);
 extern void uart_send_message(struct uart_periph *p, long fd);
 extern uint8_t uart_getch(struct uart_periph *p);
 
+/**
+ * Copy a block of data into the TX ring buffer.
+ * The caller is responsible for checking free space and for locking
+ * against the transmit interrupt or thread. The copy is done with at most
+ * two memcpy, splitting the data at the end of the ring buffer.
+ * @param p    pointer to UART peripheral
+ * @param data data to copy
+ * @param len  number of bytes to copy
+ */
+static inline void uart_tx_buffer_write(struct uart_periph *p, const uint8_t *data, uint16_t len)
+{
+  uint16_t head = UART_TX_BUFFER_SIZE - p->tx_insert_idx;
+  if (len < head) {
+    memcpy(&p->tx_buf[p->tx_insert_idx], data, len);
+    p->tx_insert_idx += len;
+  } else {
+    memcpy(&p->tx_buf[p->tx_insert_idx], data, head);
+    memcpy(p->tx_buf, &data[head], len - head);
+    p->tx_insert_idx = len - head;
+  }
+}
+
 /**
  * Check UART for available chars in receive buffer.
  * @return number of chars in the buffer
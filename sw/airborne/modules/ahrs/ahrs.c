@@ -42,22 +42,85 @@ PRINT_CONFIG_VAR(PRIMARY_AHRS)
 PRINT_CONFIG_VAR(SECONDARY_AHRS)
 #endif
 
+#ifdef TERTIARY_AHRS
+PRINT_CONFIG_VAR(TERTIARY_AHRS)
+#endif
+
 #define __RegisterAhrs(_x) _x ## _register()
 #define _RegisterAhrs(_x) __RegisterAhrs(_x)
 #define RegisterAhrs(_x) _RegisterAhrs(_x)
 
 /** maximum number of AHRS implementations that can register */
 #ifndef AHRS_NB_IMPL
+#ifdef TERTIARY_AHRS
+#define AHRS_NB_IMPL 3
+#else
 #define AHRS_NB_IMPL 2
 #endif
+#endif
+
+/** voting enabled at startup */
+#ifndef AHRS_VOTE_ENABLED
+#define AHRS_VOTE_ENABLED TRUE
+#endif
+
+/** low pass filter coefficient of the health scores, per vote */
+#ifndef AHRS_VOTE_FILTER
+#define AHRS_VOTE_FILTER 0.05f
+#endif
+
+/** score difference required to switch to another impl */
+#ifndef AHRS_VOTE_MARGIN
+#define AHRS_VOTE_MARGIN 0.05f
+#endif
+
+/** number of consecutive votes for the same impl before switching */
+#ifndef AHRS_VOTE_CONFIRM
+#define AHRS_VOTE_CONFIRM 20
+#endif
+
+/** CPU load in percent used to stop/resume impls, 0 to never stop them.
+ * Can be set to sys_mon.cpu_load or rtos_mon.cpu_load with AHRS_VOTE_CPU_LOAD_H
+ * to the corresponding sys_mon header.
+ */
+#ifdef AHRS_VOTE_CPU_LOAD_H
+#include AHRS_VOTE_CPU_LOAD_H
+#endif
+#ifndef AHRS_VOTE_CPU_LOAD
+#define AHRS_VOTE_CPU_LOAD 0
+#endif
+
+/** stop the lowest priority impl above this CPU load */
+#ifndef AHRS_VOTE_LOAD_HIGH
+#define AHRS_VOTE_LOAD_HIGH 90
+#endif
+
+/** resume the highest priority stopped impl below this CPU load */
+#ifndef AHRS_VOTE_LOAD_LOW
+#define AHRS_VOTE_LOAD_LOW 70
+#endif
+
+/** number of votes between two stop/resume actions, leaves time for the load to settle */
+#ifndef AHRS_VOTE_LOAD_HOLD
+#define AHRS_VOTE_LOAD_HOLD 50
+#endif
 
 /** references a registered AHRS implementation */
 struct AhrsImpl {
   AhrsEnableOutput enable;
+  AhrsHealth health;    ///< health score function, NULL if not voting
+  AhrsEnableRun run;    ///< start/stop function, NULL if it can't be stopped
+  float score;          ///< filtered health score, negative if not available
+  bool running;
 };
 
 struct AhrsImpl ahrs_impls[AHRS_NB_IMPL];
 uint8_t ahrs_output_idx;
+bool ahrs_vote_enabled;
+
+static uint8_t ahrs_vote_candidate;
+static uint8_t ahrs_vote_count;
+static uint8_t ahrs_vote_load_hold;
 
 void ahrs_register_impl(AhrsEnableOutput enable)
 {
@@ -70,17 +133,40 @@ void ahrs_register_impl(AhrsEnableOutput enable)
   }
 }
 
+void ahrs_register_vote(AhrsEnableOutput enable, AhrsHealth health, AhrsEnableRun run)
+{
+  int i;
+  for (i=0; i < AHRS_NB_IMPL; i++) {
+    if (ahrs_impls[i].enable == enable) {
+      ahrs_impls[i].health = health;
+      ahrs_impls[i].run = run;
+      break;
+    }
+  }
+}
+
 void ahrs_init(void)
 {
   int i;
   for (i=0; i < AHRS_NB_IMPL; i++) {
     ahrs_impls[i].enable = NULL;
+    ahrs_impls[i].health = NULL;
+    ahrs_impls[i].run = NULL;
+    ahrs_impls[i].score = -1.f;
+    ahrs_impls[i].running = true;
   }
+  ahrs_vote_enabled = AHRS_VOTE_ENABLED;
+  ahrs_vote_candidate = 0;
+  ahrs_vote_count = 0;
+  ahrs_vote_load_hold = 0;
 
   RegisterAhrs(PRIMARY_AHRS);
 #ifdef SECONDARY_AHRS
   RegisterAhrs(SECONDARY_AHRS);
 #endif
+#ifdef TERTIARY_AHRS
+  RegisterAhrs(TERTIARY_AHRS);
+#endif
 
   // enable primary AHRS by default
   ahrs_switch(0);
@@ -94,6 +180,8 @@ int ahrs_switch(uint8_t idx)
 {
   if (idx >= AHRS_NB_IMPL) { return -1; }
   if (ahrs_impls[idx].enable == NULL) { return -1; }
+  /* an impl stopped by the CPU budget has no up to date attitude */
+  if (!ahrs_impls[idx].running) { return -1; }
   /* first disable other AHRS output */
   int i;
   for (i=0; i < AHRS_NB_IMPL; i++) {
@@ -106,3 +194,110 @@ int ahrs_switch(uint8_t idx)
   ahrs_output_idx = idx;
   return ahrs_output_idx;
 }
+
+float ahrs_accel_innovation(struct FloatQuat *ltp_to_body_quat, struct FloatVect3 *accel)
+{
+  float norm = float_vect3_norm(accel);
+  if (norm < 1.f) {
+    // free fall or no data, no gravity direction
+    return -1.f;
+  }
+  // specific force at rest is opposite to gravity
+  struct FloatVect3 up_ltp = { 0.f, 0.f, -1.f };
+  struct FloatVect3 up_body;
+  float_quat_vmult(&up_body, ltp_to_body_quat, &up_ltp);
+  struct FloatVect3 diff;
+  VECT3_SMUL(diff, *accel, 1.f / norm);
+  VECT3_DIFF(diff, diff, up_body);
+  return float_vect3_norm(&diff);
+}
+
+/** Update the filtered health scores
+ * @return index of the healthiest running impl, AHRS_NB_IMPL if none
+ */
+static uint8_t ahrs_vote_scores(void)
+{
+  uint8_t best = AHRS_NB_IMPL;
+  int i;
+  for (i=0; i < AHRS_NB_IMPL; i++) {
+    struct AhrsImpl *impl = &ahrs_impls[i];
+    if (impl->health == NULL || !impl->running) {
+      impl->score = -1.f;
+      continue;
+    }
+    float h = impl->health();
+    if (h < 0.f) {
+      impl->score = -1.f;
+    } else if (impl->score < 0.f) {
+      impl->score = h;
+    } else {
+      impl->score += AHRS_VOTE_FILTER * (h - impl->score);
+    }
+    if (impl->score >= 0.f && (best == AHRS_NB_IMPL || impl->score < ahrs_impls[best].score)) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+/** Stop or resume impls according to the CPU load
+ * The output impl is never stopped, the lowest priority (last registered)
+ * impls are stopped first and resumed last.
+ */
+static void ahrs_vote_budget(void)
+{
+  uint8_t load = AHRS_VOTE_CPU_LOAD;
+  if (load == 0) { return; }
+  if (ahrs_vote_load_hold > 0) {
+    ahrs_vote_load_hold--;
+    return;
+  }
+  int i;
+  if (load > AHRS_VOTE_LOAD_HIGH) {
+    for (i=AHRS_NB_IMPL-1; i >= 0; i--) {
+      struct AhrsImpl *impl = &ahrs_impls[i];
+      if (impl->run != NULL && impl->running && i != ahrs_output_idx) {
+        impl->running = impl->run(false);
+        ahrs_vote_load_hold = AHRS_VOTE_LOAD_HOLD;
+        return;
+      }
+    }
+  } else if (load < AHRS_VOTE_LOAD_LOW) {
+    for (i=0; i < AHRS_NB_IMPL; i++) {
+      struct AhrsImpl *impl = &ahrs_impls[i];
+      if (impl->run != NULL && !impl->running) {
+        impl->running = impl->run(true);
+        ahrs_vote_load_hold = AHRS_VOTE_LOAD_HOLD;
+        return;
+      }
+    }
+  }
+}
+
+void ahrs_vote_periodic(void)
+{
+  uint8_t best = ahrs_vote_scores();
+  ahrs_vote_budget();
+
+  // impls without health score are never voted out
+  if (!ahrs_vote_enabled || best == AHRS_NB_IMPL || best == ahrs_output_idx ||
+      ahrs_impls[ahrs_output_idx].health == NULL) {
+    ahrs_vote_count = 0;
+    return;
+  }
+  float current = ahrs_impls[ahrs_output_idx].score;
+  if (current >= 0.f && ahrs_impls[best].score + AHRS_VOTE_MARGIN > current) {
+    // not significantly better than the current output
+    ahrs_vote_count = 0;
+    return;
+  }
+  if (best != ahrs_vote_candidate) {
+    ahrs_vote_candidate = best;
+    ahrs_vote_count = 0;
+  }
+  // switch immediately if the current output lost its score (not aligned)
+  if (current < 0.f || ++ahrs_vote_count >= AHRS_VOTE_CONFIRM) {
+    ahrs_switch(best);
+    ahrs_vote_count = 0;
+  }
+}
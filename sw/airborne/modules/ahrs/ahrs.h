@@ -28,6 +28,7 @@
 #define AHRS_H
 
 #include "std.h"
+#include "math/pprz_algebra_float.h"
 
 #define AHRS_COMP_ID_NONE       0
 #define AHRS_COMP_ID_GENERIC    1
@@ -55,8 +56,25 @@
 #include AHRS_SECONDARY_TYPE_H
 #endif
 
+/* include tertiary implementation header */
+#ifdef AHRS_TERTIARY_TYPE_H
+#include AHRS_TERTIARY_TYPE_H
+#endif
+
 typedef bool (*AhrsEnableOutput)(bool);
 
+/** Health of an AHRS impl for runtime voting
+ * @return innovation based score (lower is better), negative if not available (not aligned)
+ */
+typedef float (*AhrsHealth)(void);
+
+/** Start/stop the processing of an AHRS impl
+ * A stopped impl ignores its sensor callbacks and frees the CPU.
+ * @param run true to resume, false to stop
+ * @return new running state
+ */
+typedef bool (*AhrsEnableRun)(bool);
+
 /* for settings when using secondary AHRS */
 extern uint8_t ahrs_output_idx;
 
@@ -74,8 +92,37 @@ extern void ahrs_init(void);
 
 /**
  * Switch to the output of another AHRS impl.
- * @param idx index of the AHRS impl (0 = PRIMARY_AHRS, 1 = SECONDARY_AHRS).
+ * @param idx index of the AHRS impl (0 = PRIMARY_AHRS, 1 = SECONDARY_AHRS, 2 = TERTIARY_AHRS).
+ * @return index of the new output, -1 if the impl doesn't exist or is stopped by the CPU budget
  */
 extern int ahrs_switch(uint8_t idx);
 
+/* for settings when voting between AHRS impls */
+extern bool ahrs_vote_enabled;
+
+/**
+ * Register the voting callbacks of an already registered AHRS implementation.
+ * Implementations are prioritized in registration order.
+ * @param enable output enable function the implementation was registered with
+ * @param health pointer to function returning the health score, NULL if not available
+ * @param run pointer to function to start/stop processing, NULL if it can't be stopped
+ */
+extern void ahrs_register_vote(AhrsEnableOutput enable, AhrsHealth health, AhrsEnableRun run);
+
+/**
+ * Accelerometer innovation of an attitude estimate.
+ * Distance between the measured and predicted gravity directions in body frame,
+ * from 0 (consistent) to 2 (opposite), used as health score by AHRS impls.
+ * @param ltp_to_body_quat estimated attitude
+ * @param accel measured specific force in body frame
+ * @return innovation, negative if accel is too small to give a direction
+ */
+extern float ahrs_accel_innovation(struct FloatQuat *ltp_to_body_quat, struct FloatVect3 *accel);
+
+/** Periodic voting between registered AHRS impls.
+ * Switches the output to the healthiest running impl and, when the CPU load
+ * is too high, stops the lowest priority impls not used for output.
+ */
+extern void ahrs_vote_periodic(void);
+
 #endif /* AHRS_H */
@@ -36,6 +36,10 @@ PRINT_CONFIG_VAR(AHRS_FC_OUTPUT_ENABLED)
 
 /** if TRUE with push the estimation results to the state interface */
 static bool ahrs_fc_output_enabled;
+/** if FALSE sensor callbacks are ignored, see ahrs_register_vote */
+static bool ahrs_fc_running;
+/** last accel innovation, health score for voting */
+static float ahrs_fc_innovation;
 static uint32_t ahrs_fc_last_stamp;
 static uint8_t ahrs_fc_id = AHRS_COMP_ID_FC;
 
@@ -143,7 +147,7 @@ static void gyro_cb(uint8_t __attribute__((unused)) sender_id,
   /* timestamp in usec when last callback was received */
   static uint32_t last_stamp = 0;
 
-  if (last_stamp > 0 && ahrs_fc.is_aligned) {
+  if (last_stamp > 0 && ahrs_fc.is_aligned && ahrs_fc_running) {
     float dt = (float)(stamp - last_stamp) * 1e-6;
     ahrs_fc_propagate(&gyro_f, dt);
     compute_body_orientation_and_rates();
@@ -152,7 +156,7 @@ static void gyro_cb(uint8_t __attribute__((unused)) sender_id,
 #else
   PRINT_CONFIG_MSG("Using fixed AHRS_PROPAGATE_FREQUENCY for AHRS_FC propagation.")
   PRINT_CONFIG_VAR(AHRS_PROPAGATE_FREQUENCY)
-  if (ahrs_fc.status == AHRS_FC_RUNNING) {
+  if (ahrs_fc.status == AHRS_FC_RUNNING && ahrs_fc_running) {
     const float dt = 1. / (AHRS_PROPAGATE_FREQUENCY);
     ahrs_fc_propagate(&gyro_f, dt);
     compute_body_orientation_and_rates();
@@ -166,6 +170,8 @@ static void accel_cb(uint8_t __attribute__((unused)) sender_id,
 {
   struct FloatVect3 accel_f;
   ACCELS_FLOAT_OF_BFP(accel_f, *accel);
+  if (!ahrs_fc_running) { return; }
+  ahrs_fc_innovation = ahrs_accel_innovation(&ahrs_fc.ltp_to_body_quat, &accel_f);
 
 #if USE_AUTO_AHRS_FREQ || !defined(AHRS_CORRECT_FREQUENCY)
   PRINT_CONFIG_MSG("Calculating dt for AHRS float_cmpl accel update.")
@@ -191,6 +197,7 @@ static void mag_cb(uint8_t __attribute__((unused)) sender_id,
 {
   struct FloatVect3 mag_f;
   MAGS_FLOAT_OF_BFP(mag_f, *mag);
+  if (!ahrs_fc_running) { return; }
 
 #if USE_AUTO_AHRS_FREQ || !defined(AHRS_MAG_CORRECT_FREQUENCY)
   PRINT_CONFIG_MSG("Calculating dt for AHRS float_cmpl mag update.")
@@ -249,6 +256,21 @@ static bool ahrs_fc_enable_output(bool enable)
   return ahrs_fc_output_enabled;
 }
 
+static float ahrs_fc_health(void)
+{
+  return ahrs_fc.is_aligned ? ahrs_fc_innovation : -1.f;
+}
+
+static bool ahrs_fc_enable_run(bool run)
+{
+  if (run && !ahrs_fc_running) {
+    // the innovation of the stale attitude is not a score, wait for the next update
+    ahrs_fc_innovation = -1.f;
+  }
+  ahrs_fc_running = run;
+  return ahrs_fc_running;
+}
+
 /**
  * Compute body orientation and rates from imu orientation and rates
  */
@@ -264,8 +286,11 @@ static void compute_body_orientation_and_rates(void)
 void ahrs_fc_register(void)
 {
   ahrs_fc_output_enabled = AHRS_FC_OUTPUT_ENABLED;
+  ahrs_fc_running = true;
+  ahrs_fc_innovation = -1.f;
   ahrs_fc_init();
   ahrs_register_impl(ahrs_fc_enable_output);
+  ahrs_register_vote(ahrs_fc_enable_output, ahrs_fc_health, ahrs_fc_enable_run);
 
   /*
    * Subscribe to scaled IMU measurements and attach callbacks
@@ -39,6 +39,10 @@ PRINT_CONFIG_VAR(AHRS_FINV_OUTPUT_ENABLED)
 
 /** if TRUE with push the estimation results to the state interface */
 static bool ahrs_finv_output_enabled;
+/** if FALSE sensor callbacks are ignored, see ahrs_register_vote */
+static bool ahrs_finv_running;
+/** last accel innovation, health score for voting */
+static float ahrs_finv_innovation;
 /** last gyro msg timestamp */
 static uint32_t ahrs_finv_last_stamp = 0;
 static uint8_t ahrs_finv_id = AHRS_COMP_ID_FINV;
@@ -124,7 +128,7 @@ static void gyro_cb(uint8_t sender_id __attribute__((unused)),
   /* timestamp in usec when last callback was received */
   static uint32_t last_stamp = 0;
 
-  if (last_stamp > 0 && ahrs_float_inv.is_aligned) {
+  if (last_stamp > 0 && ahrs_float_inv.is_aligned && ahrs_finv_running) {
     float dt = (float)(stamp - last_stamp) * 1e-6;
     ahrs_float_invariant_propagate(&gyro_f, dt);
     compute_body_orientation_and_rates();
@@ -134,7 +138,7 @@ static void gyro_cb(uint8_t sender_id __attribute__((unused)),
   PRINT_CONFIG_MSG("Using fixed AHRS_PROPAGATE_FREQUENCY for AHRS float_invariant propagation.")
   PRINT_CONFIG_VAR(AHRS_PROPAGATE_FREQUENCY)
   const float dt = 1. / (AHRS_PROPAGATE_FREQUENCY);
-  if (ahrs_float_inv.is_aligned) {
+  if (ahrs_float_inv.is_aligned && ahrs_finv_running) {
     ahrs_float_invariant_propagate(&gyro_f, dt);
     compute_body_orientation_and_rates();
   }
@@ -147,9 +151,10 @@ static void accel_cb(uint8_t sender_id __attribute__((unused)),
                      uint32_t stamp __attribute__((unused)),
                      struct Int32Vect3 *accel)
 {
-  if (ahrs_float_inv.is_aligned) {
+  if (ahrs_float_inv.is_aligned && ahrs_finv_running) {
     struct FloatVect3 accel_f;
     ACCELS_FLOAT_OF_BFP(accel_f, *accel);
+    ahrs_finv_innovation = ahrs_accel_innovation(&ahrs_float_inv.state.quat, &accel_f);
     ahrs_float_invariant_update_accel(&accel_f);
   }
 }
@@ -158,7 +163,7 @@ static void mag_cb(uint8_t sender_id __attribute__((unused)),
                    uint32_t stamp __attribute__((unused)),
                    struct Int32Vect3 *mag)
 {
-  if (ahrs_float_inv.is_aligned) {
+  if (ahrs_float_inv.is_aligned && ahrs_finv_running) {
     struct FloatVect3 mag_f;
     MAGS_FLOAT_OF_BFP(mag_f, *mag);
     ahrs_float_invariant_update_mag(&mag_f);
@@ -194,6 +199,21 @@ static bool ahrs_float_invariant_enable_output(bool enable)
   return ahrs_finv_output_enabled;
 }
 
+static float ahrs_float_invariant_health(void)
+{
+  return ahrs_float_inv.is_aligned ? ahrs_finv_innovation : -1.f;
+}
+
+static bool ahrs_float_invariant_enable_run(bool run)
+{
+  if (run && !ahrs_finv_running) {
+    // the innovation of the stale attitude is not a score, wait for the next update
+    ahrs_finv_innovation = -1.f;
+  }
+  ahrs_finv_running = run;
+  return ahrs_finv_running;
+}
+
 /**
  * Compute body orientation and rates from imu orientation and rates
  */
@@ -214,8 +234,12 @@ static void compute_body_orientation_and_rates(void)
 void ahrs_float_invariant_register(void)
 {
   ahrs_finv_output_enabled = AHRS_FINV_OUTPUT_ENABLED;
+  ahrs_finv_running = true;
+  ahrs_finv_innovation = -1.f;
   ahrs_float_invariant_init();
   ahrs_register_impl(ahrs_float_invariant_enable_output);
+  ahrs_register_vote(ahrs_float_invariant_enable_output, ahrs_float_invariant_health,
+                     ahrs_float_invariant_enable_run);
 
   /*
    * Subscribe to scaled IMU measurements and attach callbacks
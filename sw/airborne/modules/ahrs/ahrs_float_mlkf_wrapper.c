@@ -37,6 +37,10 @@ PRINT_CONFIG_VAR(AHRS_MLKF_OUTPUT_ENABLED)
 
 /** if TRUE with push the estimation results to the state interface */
 static bool ahrs_mlkf_output_enabled;
+/** if FALSE sensor callbacks are ignored, see ahrs_register_vote */
+static bool ahrs_mlkf_running;
+/** last accel innovation, health score for voting */
+static float ahrs_mlkf_innovation;
 static uint32_t ahrs_mlkf_last_stamp;
 static uint8_t ahrs_mlkf_id = AHRS_COMP_ID_MLKF;
 
@@ -117,7 +121,7 @@ static void gyro_cb(uint8_t __attribute__((unused)) sender_id,
   /* timestamp in usec when last callback was received */
   static uint32_t last_stamp = 0;
 
-  if (last_stamp > 0 && ahrs_mlkf.is_aligned) {
+  if (last_stamp > 0 && ahrs_mlkf.is_aligned && ahrs_mlkf_running) {
     float dt = (float)(stamp - last_stamp) * 1e-6;
     ahrs_mlkf_propagate(&gyro_f, dt);
     set_body_state_from_quat();
@@ -126,7 +130,7 @@ static void gyro_cb(uint8_t __attribute__((unused)) sender_id,
 #else
   PRINT_CONFIG_MSG("Using fixed AHRS_PROPAGATE_FREQUENCY for AHRS_MLKF propagation.")
   PRINT_CONFIG_VAR(AHRS_PROPAGATE_FREQUENCY)
-  if (ahrs_mlkf.status == AHRS_MLKF_RUNNING) {
+  if (ahrs_mlkf.status == AHRS_MLKF_RUNNING && ahrs_mlkf_running) {
     const float dt = 1. / (AHRS_PROPAGATE_FREQUENCY);
     ahrs_mlkf_propagate(&gyro_f, dt);
     set_body_state_from_quat();
@@ -138,9 +142,10 @@ static void accel_cb(uint8_t sender_id __attribute__((unused)),
                      uint32_t stamp __attribute__((unused)),
                      struct Int32Vect3 *accel)
 {
-  if (ahrs_mlkf.is_aligned) {
+  if (ahrs_mlkf.is_aligned && ahrs_mlkf_running) {
     struct FloatVect3 accel_f;
     ACCELS_FLOAT_OF_BFP(accel_f, *accel);
+    ahrs_mlkf_innovation = ahrs_accel_innovation(&ahrs_mlkf.ltp_to_body_quat, &accel_f);
     ahrs_mlkf_update_accel(&accel_f);
     set_body_state_from_quat();
   }
@@ -150,7 +155,7 @@ static void mag_cb(uint8_t sender_id __attribute__((unused)),
                    uint32_t stamp __attribute__((unused)),
                    struct Int32Vect3 *mag)
 {
-  if (ahrs_mlkf.is_aligned) {
+  if (ahrs_mlkf.is_aligned && ahrs_mlkf_running) {
     struct FloatVect3 mag_f;
     MAGS_FLOAT_OF_BFP(mag_f, *mag);
     ahrs_mlkf_update_mag(&mag_f);
@@ -189,6 +194,21 @@ static bool ahrs_mlkf_enable_output(bool enable)
   return ahrs_mlkf_output_enabled;
 }
 
+static float ahrs_mlkf_health(void)
+{
+  return ahrs_mlkf.is_aligned ? ahrs_mlkf_innovation : -1.f;
+}
+
+static bool ahrs_mlkf_enable_run(bool run)
+{
+  if (run && !ahrs_mlkf_running) {
+    // the innovation of the stale attitude is not a score, wait for the next update
+    ahrs_mlkf_innovation = -1.f;
+  }
+  ahrs_mlkf_running = run;
+  return ahrs_mlkf_running;
+}
+
 /**
  * Compute body orientation and rates from imu orientation and rates
  */
@@ -204,8 +224,11 @@ static void set_body_state_from_quat(void)
 void ahrs_mlkf_register(void)
 {
   ahrs_mlkf_output_enabled = AHRS_MLKF_OUTPUT_ENABLED;
+  ahrs_mlkf_running = true;
+  ahrs_mlkf_innovation = -1.f;
   ahrs_mlkf_init();
   ahrs_register_impl(ahrs_mlkf_enable_output);
+  ahrs_register_vote(ahrs_mlkf_enable_output, ahrs_mlkf_health, ahrs_mlkf_enable_run);
 
   /*
    * Subscribe to scaled IMU measurements and attach callbacks
@@ -30,6 +30,84 @@
 #include "blob_finder.h"
 #include <stdio.h>
 
+/** Label of the pixels which don't belong to a blob */
+#define BLOB_NO_LABEL 0xFFFF
+
+/** Horizontal run of pixels passing the same filter */
+struct image_run_t {
+  uint16_t x_start;         ///< First pixel of the run
+  uint16_t x_end;           ///< Last pixel of the run
+  uint16_t lid;             ///< Label of the run
+  uint8_t filter;           ///< Filter of the run
+};
+
+/**
+ * Find the filter of an UYVY pixel pair
+ * @return The filter index, filters_cnt if no filter matches
+ */
+static inline uint8_t pixel_filter(uint8_t *p, struct image_filter_t *filters, uint8_t filters_cnt)
+{
+  uint8_t p_y = (p[1] + p[3]) / 2;
+  uint8_t p_u = p[0];
+  uint8_t p_v = p[2];
+
+  uint8_t f = 0;
+  for (; f < filters_cnt; f++) {
+    if (p_y > filters[f].y_min && p_y < filters[f].y_max &&
+        p_u > filters[f].u_min && p_u < filters[f].u_max &&
+        p_v > filters[f].v_min && p_v < filters[f].v_max) {
+      break;
+    }
+  }
+  return f;
+}
+
+/**
+ * Find the root label of a group, with path compression
+ */
+static uint16_t label_find(struct image_label_t *labels, uint16_t lid)
+{
+  uint16_t root = lid;
+  while (labels[root].id != root) {
+    root = labels[root].id;
+  }
+  while (labels[lid].id != root) {
+    uint16_t next = labels[lid].id;
+    labels[lid].id = root;
+    lid = next;
+  }
+  return root;
+}
+
+/**
+ * Merge two groups, the lowest label becomes the root
+ * @return The root label of the merged group
+ */
+static uint16_t label_union(struct image_label_t *labels, uint16_t a, uint16_t b)
+{
+  a = label_find(labels, a);
+  b = label_find(labels, b);
+  if (a < b) {
+    labels[b].id = a;
+    return a;
+  }
+  labels[a].id = b;
+  return b;
+}
+
+/**
+ * Label the connected pixels of the filters, 8-connectivity.
+ * The first pass labels horizontal runs of pixels and merges the labels of touching runs with a union-find,
+ * the second pass gives all pixels of a blob the label of its root.
+ * The output has one label per UYVY pixel pair, BLOB_NO_LABEL if none.
+ * On return the labels of merged groups have an id different from their index and an empty pixel count.
+ * @param[in] input The input UYVY image
+ * @param[out] output The label image (IMAGE_GRADIENT)
+ * @param[in] filters The color filters
+ * @param[in] filters_cnt The number of filters
+ * @param[out] labels The blobs
+ * @param[in,out] labels_count The size of the labels array, the number of labels used on return
+ */
 void image_labeling(struct image_t *input, struct image_t *output, struct image_filter_t *filters, uint8_t filters_cnt,
                     struct image_label_t *labels, uint16_t *labels_count)
 {
@@ -39,144 +117,107 @@ void image_labeling(struct image_t *input, struct image_t *output, struct image_
   // Initialize labels
   uint16_t labels_size = *labels_count;
   uint16_t labels_cnt = 0;
-  uint16_t i, x, y;
-
-  // Initialize first line with empty groups
-  uint16_t *p = output_buf;
-  for (i = 0; i < output->w; i++) {
-    *p++ = 0xffff;
-  }
+  uint16_t i, x, y, r;
 
-  // Do steps of 2 for YUV image
-  // Skip first line as we need previous groups for connectivity
-  for (y = 1; y < input->h; y++) {
-    for (x = 0; x < input->w / 2; x++) {
-      uint16_t lid = 0;
-      uint8_t p_y = (input_buf[y * input->w * 2 + x * 4 + 1] + input_buf[y * input->w * 2 + x * 4 + 3]) / 2;
-      uint8_t p_u = input_buf[y * input->w * 2 + x * 4];
-      uint8_t p_v = input_buf[y * input->w * 2 + x * 4 + 2];
-
-      // Go trough the filters
-      uint8_t f = 0;
-      for (; f < filters_cnt; f++) {
-        if (p_y > filters[f].y_min && p_y < filters[f].y_max &&
-            p_u > filters[f].u_min && p_u < filters[f].u_max &&
-            p_v > filters[f].v_min && p_v < filters[f].v_max) {
-          break;
-        }
-      }
+  // One label per UYVY pixel pair, runs of the current and previous line
+  uint16_t w = input->w / 2;
+  struct image_run_t runs[2][w];
+  struct image_run_t *prev = runs[0];
+  struct image_run_t *cur = runs[1];
+  uint16_t prev_cnt = 0;
 
-      // Check if this pixel belongs to a filter else goto next
+  for (y = 0; y < input->h; y++) {
+    uint8_t *p = input_buf + y * input->w * 2;
+    uint16_t *out = output_buf + y * output->w;
+    uint16_t cur_cnt = 0;
+    uint16_t j = 0; // first run of the previous line which can touch the current run
+
+    x = 0;
+    while (x < w) {
+      uint8_t f = pixel_filter(p + x * 4, filters, filters_cnt);
       if (f >= filters_cnt) {
-        output_buf[y * output->w + x] = 0xFFFF;
+        out[x] = BLOB_NO_LABEL;
+        x++;
         continue;
       }
 
-      // Check pixel above (if the same filter then take same group)
-      lid = output_buf[(y - 1) * output->w + x];
-      if (y > 0 && lid < labels_size && labels[lid].filter == f) {
-        output_buf[y * output->w + x] = lid;
-        labels[lid].pixel_cnt++;
-        labels[lid].x_sum += x;
-        labels[lid].y_sum += y;
-        continue;
+      // Extend the run as long as the pixels pass the same filter
+      uint16_t x_start = x;
+      do {
+        x++;
+      } while (x < w && pixel_filter(p + x * 4, filters, filters_cnt) == f);
+      uint16_t x_end = x - 1;
+
+      // Merge with the touching runs of the previous line
+      uint16_t lid = BLOB_NO_LABEL;
+      while (j < prev_cnt && prev[j].x_end + 1 < x_start) {
+        j++;
       }
-
-      // Check pixel top right (check for merging)
-      lid = output_buf[(y - 1) * output->w + x + 1];
-      if (y > 0 && x < output->w - 1 && lid < labels_size && labels[lid].filter == f) {
-
-        // Merging labels if needed
-        uint16_t lid_tl = output_buf[(y - 1) * output->w + x - 1]; // Top left
-        uint16_t lid_l = output_buf[y * output->w + x - 1]; // Left
-        uint16_t m = labels[lid].id, n = labels[lid].id;
-        if (x > 0 && lid_tl < labels_size && labels[lid_tl].filter == f) {
-          // Merge with top left
-          m = labels[lid].id;
-          n = labels[lid_tl].id;
-        } else if (x > 0 && lid_l < labels_size && labels[lid_l].filter == f) {
-          // Merge with left
-          m = labels[lid].id;
-          n = labels[lid_l].id;
-        }
-
-        // Change the id of the highest id label
-        if (m != n) {
-          if (m > n) {
-            m = n;
-            n = labels[lid].id;
-          }
-
-          for (i = 0; i < labels_cnt; i++) {
-            if (labels[i].id == n) {
-              labels[i].id = m;
-            }
+      for (r = j; r < prev_cnt && prev[r].x_start <= x_end + 1; r++) {
+        if (prev[r].filter == f && prev[r].lid != BLOB_NO_LABEL) {
+          if (lid == BLOB_NO_LABEL) {
+            lid = label_find(labels, prev[r].lid);
+          } else {
+            lid = label_union(labels, lid, prev[r].lid);
           }
         }
-
-        // Update the label
-        output_buf[y * output->w + x] = lid;
-        labels[lid].pixel_cnt++;
-        labels[lid].x_sum += x;
-        labels[lid].y_sum += y;
-        continue;
       }
 
-      // Take top left
-      lid = output_buf[(y - 1) * output->w + x - 1];
-      if (y > 0 && x > 0 && lid < labels_size && labels[lid].filter == f) {
-        output_buf[y * output->w + x] = lid;
-        labels[lid].pixel_cnt++;
-        labels[lid].x_sum += x;
-        labels[lid].y_sum += y;
-        continue;
+      // Create new group if there is enough space
+      if (lid == BLOB_NO_LABEL && labels_cnt < labels_size) {
+        lid = labels_cnt++;
+        labels[lid].id = lid;
+        labels[lid].filter = f;
+        labels[lid].pixel_cnt = 0;
+        labels[lid].x_min = x_start;
+        labels[lid].y_min = y;
+        labels[lid].x_sum = 0;
+        labels[lid].y_sum = 0;
       }
 
-      // Take left
-      lid = output_buf[y * output->w + x - 1];
-      if (x > 0 && lid < labels_size && labels[lid].filter == f) {
-        output_buf[y * output->w + x] = lid;
-        labels[lid].pixel_cnt++;
-        labels[lid].x_sum += x;
-        labels[lid].y_sum += y;
-        continue;
+      // Update the label
+      if (lid != BLOB_NO_LABEL) {
+        uint16_t len = x_end - x_start + 1;
+        labels[lid].pixel_cnt += len;
+        labels[lid].x_sum += (uint32_t)(x_start + x_end) * len / 2;
+        labels[lid].y_sum += (uint32_t)y * len;
+        if (x_start < labels[lid].x_min) { labels[lid].x_min = x_start; }
       }
-
-      // Check if there is enough space
-      if (labels_cnt >= labels_size - 1) {
-        break;
+      for (i = x_start; i <= x_end; i++) {
+        out[i] = lid;
       }
 
-      // Create new group
-      lid = labels_cnt;
-      output_buf[y * output->w + x] = lid;
-      labels[lid].id = lid;
-      labels[lid].filter = f;
-      labels[lid].pixel_cnt = 1;
-      labels[lid].x_min = x;
-      labels[lid].y_min = y;
-      labels[lid].x_sum = x;
-      labels[lid].y_sum = y;
-      labels_cnt++;
+      cur[cur_cnt].x_start = x_start;
+      cur[cur_cnt].x_end = x_end;
+      cur[cur_cnt].lid = lid;
+      cur[cur_cnt].filter = f;
+      cur_cnt++;
     }
+
+    struct image_run_t *tmp = prev;
+    prev = cur;
+    cur = tmp;
+    prev_cnt = cur_cnt;
   }
 
-  if (labels_cnt >= labels_size - 1) {
-    printf("Break did not work: we have %d labels\n", labels_cnt);
+  if (labels_cnt >= labels_size) {
+    printf("Out of labels: we have %d labels\n", labels_cnt);
   }
 
-  // Merge connected labels
+  // Merge connected labels into their root, roots always have the lowest id
   for (i = 0; i < labels_cnt; i++) {
-    if (labels[i].id != i) {
-      uint16_t new_id = labels[i].id;
+    uint16_t new_id = label_find(labels, i);
+    if (new_id != i) {
       labels[new_id].pixel_cnt += labels[i].pixel_cnt;
       labels[new_id].x_sum += labels[i].x_sum;
       labels[new_id].y_sum += labels[i].y_sum;
 
-      //printf("%d == %d,  ",new_id, i);
-
       if (labels[i].x_min < labels[new_id].x_min) { labels[new_id].x_min = labels[i].x_min; }
       if (labels[i].y_min < labels[new_id].y_min) { labels[new_id].y_min = labels[i].y_min; }
+
+      labels[i].pixel_cnt = 0;
+      labels[i].x_sum = 0;
+      labels[i].y_sum = 0;
     }
   }
 
@@ -184,10 +225,10 @@ void image_labeling(struct image_t *input, struct image_t *output, struct image_
 
   // Replace ID's
   for (y = 0; y < input->h; y++) {
-    for (x = 0; x < input->w / 2; x++) {
-      uint16_t lid = output_buf[y * output->w + x];
-      if (lid < labels_cnt) {
-        output_buf[y * output->w + x] = labels[lid].id;
+    uint16_t *out = output_buf + y * output->w;
+    for (x = 0; x < w; x++) {
+      if (out[x] < labels_cnt) {
+        out[x] = labels[out[x]].id;
       }
     }
   }
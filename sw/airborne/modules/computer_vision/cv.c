@@ -30,10 +30,48 @@
 
 #include "cv.h"
 #include "rt_priority.h"
+#include "mcu_periph/sys_time.h"
 
+/** Lower the resolution of a listener when it uses more than this fraction of its frame period */
+#ifndef CV_ADAPTIVE_LOAD_HIGH
+#define CV_ADAPTIVE_LOAD_HIGH 0.8f
+#endif
+
+/** Raise the resolution of a listener when it would use less than this fraction of its frame period */
+#ifndef CV_ADAPTIVE_LOAD_LOW
+#define CV_ADAPTIVE_LOAD_LOW 0.5f
+#endif
+
+/** Gain of the low pass filter on the processing time */
+#ifndef CV_ADAPTIVE_FILTER
+#define CV_ADAPTIVE_FILTER 0.2f
+#endif
+
+/** Number of frames processed at a resolution before it can be changed again */
+#ifndef CV_ADAPTIVE_HOLD_FRAMES
+#define CV_ADAPTIVE_HOLD_FRAMES 10
+#endif
+
+/** Number of video devices with downsampled frames */
+#ifndef CV_RESOLUTION_CACHE_DEVICES
+#define CV_RESOLUTION_CACHE_DEVICES 4
+#endif
+
+/** Downsampled versions of the current frame of a device, shared by its listeners */
+struct cv_resolution_cache {
+  struct video_config_t *device;                      ///< The device of the frames
+  struct image_t *source;                             ///< The full resolution frame
+  void *source_buf;                                   ///< Buffer of the full resolution frame
+  struct timeval source_ts;                           ///< Timestamp of the full resolution frame
+  struct image_t levels[CV_MAX_DOWNSAMPLE_LEVEL];     ///< The frame downsampled by 2^(i+1)
+  uint8_t nb_levels;                                  ///< Number of levels computed for the current frame
+};
+
+static struct cv_resolution_cache cv_caches[CV_RESOLUTION_CACHE_DEVICES];
+static pthread_mutex_t cv_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 void cv_attach_listener(struct video_config_t *device, struct video_listener *new_listener);
-int8_t cv_async_function(struct cv_async *async, struct image_t *img);
+int8_t cv_async_function(struct video_config_t *device, struct video_listener *listener, struct image_t *img);
 void *cv_async_thread(void *args);
 
 
@@ -55,6 +93,10 @@ struct video_listener *cv_add_to_device(struct video_config_t *device, cv_functi
   new_listener->async = NULL;
   new_listener->maximum_fps = fps;
   new_listener->id = id;
+  new_listener->max_downsample_level = 0;
+  new_listener->downsample_level = 0;
+  new_listener->proc_time_us = 0.f;
+  new_listener->proc_count = 0;
 
   // Initialise the device that we want our function to use
   add_video_device(device);
@@ -109,13 +151,144 @@ struct video_listener *cv_add_to_device_async(struct video_config_t *device, cv_
 }
 
 
-int8_t cv_async_function(struct cv_async *async, struct image_t *img)
+/**
+ * Get the cache of the downsampled frames of a device
+ * @return The cache, or NULL if all caches are used by other devices
+ */
+static struct cv_resolution_cache *cv_get_cache(struct video_config_t *device)
+{
+  struct cv_resolution_cache *cache = NULL;
+  pthread_mutex_lock(&cv_cache_mutex);
+  for (uint8_t i = 0; i < CV_RESOLUTION_CACHE_DEVICES; i++) {
+    if (cv_caches[i].device == device) {
+      cache = &cv_caches[i];
+      break;
+    }
+    if (cache == NULL && cv_caches[i].device == NULL) {
+      cache = &cv_caches[i];
+    }
+  }
+  if (cache != NULL) {
+    cache->device = device;
+  }
+  pthread_mutex_unlock(&cv_cache_mutex);
+  return cache;
+}
+
+/**
+ * Get a frame downsampled by 2^level, each level is computed once per frame from the level above
+ * @param[in] cache The cache of the device
+ * @param[in] img The full resolution frame
+ * @param[in,out] level The requested level, lowered when the image can not be downsampled that much
+ * @return The downsampled frame
+ */
+static struct image_t *cv_get_downsampled(struct cv_resolution_cache *cache, struct image_t *img, uint8_t *level)
 {
+  if (*level == 0 || cache == NULL || img->type != IMAGE_YUV422) {
+    *level = 0;
+    return img;
+  }
+  if (cache->source != img || cache->source_buf != img->buf || cache->source_ts.tv_sec != img->ts.tv_sec ||
+      cache->source_ts.tv_usec != img->ts.tv_usec) {
+    cache->source = img;
+    cache->source_buf = img->buf;
+    cache->source_ts = img->ts;
+    cache->nb_levels = 0;
+  }
+
+  struct image_t *prev = (cache->nb_levels > 0) ? &cache->levels[cache->nb_levels - 1] : img;
+  while (cache->nb_levels < *level && prev->w % 4 == 0 && prev->h >= 2) {
+    struct image_t *next = &cache->levels[cache->nb_levels];
+    if (next->buf == NULL || next->w != prev->w / 2 || next->h != prev->h / 2) {
+      image_free(next);
+      image_create(next, prev->w / 2, prev->h / 2, IMAGE_YUV422);
+    }
+    image_yuv422_downsample(prev, next, 2);
+    next->eulers = img->eulers;
+    next->pprz_ts = img->pprz_ts;
+    cache->nb_levels++;
+    prev = next;
+  }
+
+  if (*level > cache->nb_levels) {
+    *level = cache->nb_levels;
+  }
+  return (*level > 0) ? &cache->levels[*level - 1] : img;
+}
+
+/**
+ * Choose the resolution of a listener from its processing time and its frame period
+ * (the fps of the listener, or else of the device)
+ */
+static void cv_adapt_resolution(struct video_config_t *device, struct video_listener *listener)
+{
+  uint8_t max_level = Min(listener->max_downsample_level, CV_MAX_DOWNSAMPLE_LEVEL);
+  if (listener->downsample_level > max_level) {
+    listener->downsample_level = max_level;
+    listener->proc_count = 0;
+  }
+
+  int fps = (listener->maximum_fps > 0) ? listener->maximum_fps : device->fps;
+  if (fps <= 0 || listener->proc_count < CV_ADAPTIVE_HOLD_FRAMES) {
+    return;
+  }
+
+  float period_us = 1000000.f / fps;
+  if (listener->proc_time_us > CV_ADAPTIVE_LOAD_HIGH * period_us && listener->downsample_level < max_level) {
+    listener->downsample_level++;
+    listener->proc_count = 0;
+  } else if (listener->downsample_level > 0 && 4.f * listener->proc_time_us < CV_ADAPTIVE_LOAD_LOW * period_us) {
+    // a level up has four times as many pixels
+    listener->downsample_level--;
+    listener->proc_count = 0;
+  }
+}
+
+/** Update the filtered processing time of a listener */
+static void cv_update_proc_time(struct video_listener *listener, uint32_t dt_us)
+{
+  if (listener->proc_count == 0) {
+    listener->proc_time_us = dt_us;
+  } else {
+    listener->proc_time_us += CV_ADAPTIVE_FILTER * (dt_us - listener->proc_time_us);
+  }
+  if (listener->proc_count < UINT16_MAX) {
+    listener->proc_count++;
+  }
+}
+
+/**
+ * Get the image for a listener at its resolution
+ * @param[in,out] cache The cache of the device, looked up at the first listener that needs it
+ */
+static struct image_t *cv_listener_image(struct video_config_t *device, struct video_listener *listener,
+    struct cv_resolution_cache **cache, struct image_t *img)
+{
+  if (listener->max_downsample_level == 0) {
+    listener->downsample_level = 0;
+    return img;
+  }
+  cv_adapt_resolution(device, listener);
+  if (*cache == NULL) {
+    *cache = cv_get_cache(device);
+  }
+  return cv_get_downsampled(*cache, img, &listener->downsample_level);
+}
+
+
+int8_t cv_async_function(struct video_config_t *device, struct video_listener *listener, struct image_t *img)
+{
+  struct cv_async *async = listener->async;
+  struct cv_resolution_cache *cache = NULL;
+
   // If the previous image is not yet processed, return
   if (!async->img_processed || pthread_mutex_trylock(&async->img_mutex) != 0) {
     return -1;
   }
 
+  // The thread is waiting, the resolution can be changed
+  img = cv_listener_image(device, listener, &cache, img);
+
   // update image copy if input image size changed or not yet initialised
   if (async->img_copy.buf_size != img->buf_size) {
     if (async->img_copy.buf !=  NULL) {
@@ -164,7 +337,9 @@ void *cv_async_thread(void *args)
     }
 
     // Execute vision function from this thread
+    uint32_t start_us = get_sys_time_usec();
     listener->func(&async->img_copy, listener->id);
+    cv_update_proc_time(listener, get_sys_time_usec() - start_us);
 
     // Mark image as processed
     async->img_processed = true;
@@ -178,6 +353,7 @@ void *cv_async_thread(void *args)
 void cv_run_device(struct video_config_t *device, struct image_t *img)
 {
   struct image_t *result;
+  struct cv_resolution_cache *cache = NULL;
 
   // Loop through computer vision pipeline
   for (struct video_listener *listener = device->cv_listener; listener != NULL; listener = listener->next) {
@@ -193,16 +369,19 @@ void cv_run_device(struct video_config_t *device, struct image_t *img)
 
     if (listener->async != NULL) {
       // Send image to asynchronous thread, only update listener if successful
-      if (!cv_async_function(listener->async, img)) {
+      if (!cv_async_function(device, listener, img)) {
         // Store timestamp
         listener->ts = img->ts;
       }
     } else {
       // Execute the cvFunction and catch result
-      result = listener->func(img, listener->id);
+      struct image_t *listener_img = cv_listener_image(device, listener, &cache, img);
+      uint32_t start_us = get_sys_time_usec();
+      result = listener->func(listener_img, listener->id);
+      cv_update_proc_time(listener, get_sys_time_usec() - start_us);
 
-      // If result gives an image pointer, use it in the next stage
-      if (result != NULL) {
+      // If result gives an image pointer, use it in the next stage (not for downsampled images)
+      if (result != NULL && listener_img == img && result != img) {
         img = result;
       }
       // Store timestamp
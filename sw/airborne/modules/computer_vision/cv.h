@@ -58,8 +58,19 @@ struct video_listener {
   // Can be set by user
   uint16_t maximum_fps;
   volatile bool active;
+  uint8_t max_downsample_level;   ///< Lowest resolution the framework may give when the listener is too slow (image size divided by 2^level), 0 for full resolution only
+
+  // Set by the framework when max_downsample_level is not zero
+  uint8_t downsample_level;       ///< Resolution of the image given to the listener (image size divided by 2^level)
+  float proc_time_us;             ///< Filtered processing time of the listener [us]
+  uint16_t proc_count;            ///< Number of frames processed since the last change of resolution
 };
 
+/** Maximum downsample level of the listeners */
+#ifndef CV_MAX_DOWNSAMPLE_LEVEL
+#define CV_MAX_DOWNSAMPLE_LEVEL 3
+#endif
+
 extern bool add_video_device(struct video_config_t *device);
 
 extern struct video_listener *cv_add_to_device(struct video_config_t *device, cv_function func, uint16_t fps, uint8_t id);
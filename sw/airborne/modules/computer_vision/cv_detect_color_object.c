@@ -28,6 +28,7 @@
 // Own header
 #include "modules/computer_vision/cv_detect_color_object.h"
 #include "modules/computer_vision/cv.h"
+#include "modules/computer_vision/lib/vision/color_mask.h"
 #include "modules/core/abi.h"
 #include "std.h"
 
@@ -51,6 +52,14 @@ static pthread_mutex_t mutex;
 #ifndef COLOR_OBJECT_DETECTOR_FPS2
 #define COLOR_OBJECT_DETECTOR_FPS2 0 ///< Default FPS (zero means run at camera fps)
 #endif
+#ifndef COLOR_OBJECT_DETECTOR_MAX_DOWNSAMPLE_LEVEL1
+#define COLOR_OBJECT_DETECTOR_MAX_DOWNSAMPLE_LEVEL1 0 ///< Lowest resolution when the detector is too slow (image size divided by 2^level)
+#endif
+#ifndef COLOR_OBJECT_DETECTOR_MAX_DOWNSAMPLE_LEVEL2
+#define COLOR_OBJECT_DETECTOR_MAX_DOWNSAMPLE_LEVEL2 0 ///< Lowest resolution when the detector is too slow (image size divided by 2^level)
+#endif
+
+static struct video_listener *listeners[2] = {NULL, NULL};
 
 // Filter Settings
 uint8_t cod_lum_min1 = 0;
@@ -125,6 +134,14 @@ static struct image_t *object_detector(struct image_t *img, uint8_t filter)
 
   // Filter and find centroid
   uint32_t count = find_object_centroid(img, &x_c, &y_c, draw, lum_min, lum_max, cb_min, cb_max, cr_min, cr_max);
+
+  // Results in pixels of the full resolution image when the image is downsampled
+  if (listeners[filter - 1] != NULL && listeners[filter - 1]->downsample_level > 0) {
+    uint8_t level = listeners[filter - 1]->downsample_level;
+    x_c *= 1 << level;
+    y_c *= 1 << level;
+    count <<= 2 * level;
+  }
   VERBOSE_PRINT("Color count %d: %u, threshold %u, x_c %d, y_c %d\n", camera, object_count, count_threshold, x_c, y_c);
   VERBOSE_PRINT("centroid %d: (%d, %d) r: %4.2f a: %4.2f\n", camera, x_c, y_c,
         hypotf(x_c, y_c) / hypotf(img->w * 0.5, img->h * 0.5), RadOfDeg(atan2f(y_c, x_c)));
@@ -168,7 +185,8 @@ void color_object_detector_init(void)
   cod_draw1 = COLOR_OBJECT_DETECTOR_DRAW1;
 #endif
 
-  cv_add_to_device(&COLOR_OBJECT_DETECTOR_CAMERA1, object_detector1, COLOR_OBJECT_DETECTOR_FPS1, 0);
+  listeners[0] = cv_add_to_device(&COLOR_OBJECT_DETECTOR_CAMERA1, object_detector1, COLOR_OBJECT_DETECTOR_FPS1, 0);
+  listeners[0]->max_downsample_level = COLOR_OBJECT_DETECTOR_MAX_DOWNSAMPLE_LEVEL1;
 #endif
 
 #ifdef COLOR_OBJECT_DETECTOR_CAMERA2
@@ -184,7 +202,8 @@ void color_object_detector_init(void)
   cod_draw2 = COLOR_OBJECT_DETECTOR_DRAW2;
 #endif
 
-  cv_add_to_device(&COLOR_OBJECT_DETECTOR_CAMERA2, object_detector2, COLOR_OBJECT_DETECTOR_FPS2, 1);
+  listeners[1] = cv_add_to_device(&COLOR_OBJECT_DETECTOR_CAMERA2, object_detector2, COLOR_OBJECT_DETECTOR_FPS2, 1);
+  listeners[1]->max_downsample_level = COLOR_OBJECT_DETECTOR_MAX_DOWNSAMPLE_LEVEL2;
 #endif
 }
 
@@ -216,32 +235,49 @@ uint32_t find_object_centroid(struct image_t *img, int32_t* p_xc, int32_t* p_yc,
   uint32_t tot_y = 0;
   uint8_t *buffer = img->buf;
 
-  // Go through all the pixels
-  for (uint16_t y = 0; y < img->h; y++) {
-    for (uint16_t x = 0; x < img->w; x ++) {
-      // Check if the color is inside the specified values
-      uint8_t *yp, *up, *vp;
-      if (x % 2 == 0) {
-        // Even x
-        up = &buffer[y * 2 * img->w + 2 * x];      // U
-        yp = &buffer[y * 2 * img->w + 2 * x + 1];  // Y1
-        vp = &buffer[y * 2 * img->w + 2 * x + 2];  // V
-        //yp = &buffer[y * 2 * img->w + 2 * x + 3]; // Y2
-      } else {
-        // Uneven x
-        up = &buffer[y * 2 * img->w + 2 * x - 2];  // U
-        //yp = &buffer[y * 2 * img->w + 2 * x - 1]; // Y1
-        vp = &buffer[y * 2 * img->w + 2 * x];      // V
-        yp = &buffer[y * 2 * img->w + 2 * x + 1];  // Y2
+  // The count and the coordinate sums come with the color mask, which may be shared with other detectors
+  struct color_range_t range = { lum_min, lum_max, cb_min, cb_max, cr_min, cr_max };
+  struct color_mask_t *mask = color_mask_acquire(img, &range);
+  if (mask != NULL) {
+    cnt = mask->count;
+    tot_x = mask->sum_x;
+    tot_y = mask->sum_y;
+    if (draw) {
+      for (uint32_t i = 0; i < (uint32_t)img->w * img->h; i++) {
+        if (mask->mask[i]) {
+          buffer[2 * i + 1] = 255;  // make pixel brighter in image
+        }
       }
-      if ( (*yp >= lum_min) && (*yp <= lum_max) &&
-           (*up >= cb_min ) && (*up <= cb_max ) &&
-           (*vp >= cr_min ) && (*vp <= cr_max )) {
-        cnt ++;
-        tot_x += x;
-        tot_y += y;
-        if (draw){
-          *yp = 255;  // make pixel brighter in image
+    }
+    color_mask_release(mask);
+  } else {
+    // Go through all the pixels
+    for (uint16_t y = 0; y < img->h; y++) {
+      for (uint16_t x = 0; x < img->w; x ++) {
+        // Check if the color is inside the specified values
+        uint8_t *yp, *up, *vp;
+        if (x % 2 == 0) {
+          // Even x
+          up = &buffer[y * 2 * img->w + 2 * x];      // U
+          yp = &buffer[y * 2 * img->w + 2 * x + 1];  // Y1
+          vp = &buffer[y * 2 * img->w + 2 * x + 2];  // V
+          //yp = &buffer[y * 2 * img->w + 2 * x + 3]; // Y2
+        } else {
+          // Uneven x
+          up = &buffer[y * 2 * img->w + 2 * x - 2];  // U
+          //yp = &buffer[y * 2 * img->w + 2 * x - 1]; // Y1
+          vp = &buffer[y * 2 * img->w + 2 * x];      // V
+          yp = &buffer[y * 2 * img->w + 2 * x + 1];  // Y2
+        }
+        if ( (*yp >= lum_min) && (*yp <= lum_max) &&
+             (*up >= cb_min ) && (*up <= cb_max ) &&
+             (*vp >= cr_min ) && (*vp <= cr_max )) {
+          cnt ++;
+          tot_x += x;
+          tot_y += y;
+          if (draw){
+            *yp = 255;  // make pixel brighter in image
+          }
         }
       }
     }
@@ -29,56 +29,83 @@
 
 #include "lib/vision/image.h"
 
+/* Fixed point YUV coefficients, scaled by 2^15 */
+#define BAYER_Y_R 8414    ///< 0.256788
+#define BAYER_Y_G 16519   ///< 0.504129
+#define BAYER_Y_B 3208    ///< 0.097906
+#define BAYER_U_R -4857   ///< -0.148223
+#define BAYER_U_G -9535   ///< -0.290993
+#define BAYER_U_B 14392   ///< 0.439216
+#define BAYER_V_R 14392   ///< 0.439216
+#define BAYER_V_G -12052  ///< -0.367788
+#define BAYER_V_B -2341   ///< -0.071427
+
 /**
- * @brief Decode Bayer Pattern
+ * @brief Decode part of a Bayer Pattern
+ * Demosaics, converts and downscales the rows [row_start, row_end[ of the output image in one pass,
+ * so that the rows can be split over several threads.
  * @param RedX, RedY the coordinates of the upper-rightmost green pixel
  *        which has a red pixel next to it and a blue underneath
- *
+ * @param row_start, row_end the output rows to decode
  */
-
-inline void BayerToYUV(struct image_t *in, struct image_t *out,
-                 int RedX, int RedY)
+static inline void BayerToYUVRows(struct image_t *in, struct image_t *out,
+                                  int RedX, int RedY, uint16_t row_start, uint16_t row_end)
 {
-  uint16_t *ii = (uint16_t *) in->buf;
+  const uint16_t *ii = (const uint16_t *) in->buf;
   uint8_t *oi = (uint8_t *) out->buf;
   int x, y;
 
-  for (y = 0; y < out->h; y++) {
+  for (y = row_start; y < row_end; y++) {
+    uint8_t *row = &oi[y * out->w * 2];
+    /* RGB Bayer:
+     * RBRBRBRBRBRBRBRB
+     * GRGRGRGRGRGRGRGR
+     */
+    int i = 2 * (out->h - y) + RedX;
     for (x = 0; x < out->w; x += 2) {
-      /* RGB Bayer:
-       * RBRBRBRBRBRBRBRB
-       * GRGRGRGRGRGRGRGR
-       */
-      int i = 2 * (out->h - y) + RedX;
       int j = 2 * x + RedY;
-      if ((i < in->w) && (j < in->h)) {
-        uint16_t G1 = ii[i + j * in->w] / 2;
-        uint16_t R1 = ii[i + j * in->w + 1] / 2;
-        uint16_t B1 = ii[i + (j + 1) * in->w] / 2;
-        j += 2;
-        uint16_t G2 = ii[i + j * in->w] / 2;
-        uint16_t R2 = ii[i + j * in->w + 1] / 2;
-        uint16_t B2 = ii[i + (j + 1) * in->w] / 2;
+      if ((i + 1 < in->w) && (j + 3 < in->h)) {
+        const uint16_t *p = &ii[i + j * in->w];
+        int32_t G1 = p[0] / 2;
+        int32_t R1 = p[1] / 2;
+        int32_t B1 = p[in->w] / 2;
+        p += 2 * in->w;
+        int32_t G2 = p[0] / 2;
+        int32_t R2 = p[1] / 2;
+        int32_t B2 = p[in->w] / 2;
 
-        uint32_t u, my1, v, my2;
+        int32_t u, my1, v, my2;
 
-        my1 = (0.256788 * R1 + 0.504129 * G1 + 0.097906 * B1) / 128 +  16;
-        my2 = (0.256788 * R2 + 0.504129 * G2 + 0.097906 * B2) / 128 +  16;
-        u = (-0.148223 * (R1 + R2) - 0.290993 * (G1 + G2) + 0.439216 * (B1 + B2)) / 256 + 128;
-        v = (0.439216 * (R1 + R2) - 0.367788 * (G1 + G2) - 0.071427 * (B1 + B2)) / 256 + 128;
+        // the offset of U and V is added before the division to round down like the floating point version
+        my1 = (BAYER_Y_R * R1 + BAYER_Y_G * G1 + BAYER_Y_B * B1) / (128 << 15) +  16;
+        my2 = (BAYER_Y_R * R2 + BAYER_Y_G * G2 + BAYER_Y_B * B2) / (128 << 15) +  16;
+        u = (BAYER_U_R * (R1 + R2) + BAYER_U_G * (G1 + G2) + BAYER_U_B * (B1 + B2) + (128 << 23)) / (256 << 15);
+        v = (BAYER_V_R * (R1 + R2) + BAYER_V_G * (G1 + G2) + BAYER_V_B * (B1 + B2) + (128 << 23)) / (256 << 15);
 
-        oi[(x + y * out->w) * 2] = Clip(u, 0, 255);
-        oi[(x + y * out->w) * 2 + 1] = Clip(my1, 0, 255);
-        oi[(x + y * out->w) * 2 + 2] = Clip(v, 0, 255);
-        oi[(x + y * out->w) * 2 + 3] = Clip(my2, 0, 255);
+        row[x * 2] = Clip(u, 0, 255);
+        row[x * 2 + 1] = Clip(my1, 0, 255);
+        row[x * 2 + 2] = Clip(v, 0, 255);
+        row[x * 2 + 3] = Clip(my2, 0, 255);
       } else {
-        oi[(x + y * out->w) * 2] = 0;
-        oi[(x + y * out->w) * 2 + 1] = 0;
-        oi[(x + y * out->w) * 2 + 2] = 0;
-        oi[(x + y * out->w) * 2 + 3] = 0;
+        row[x * 2] = 0;
+        row[x * 2 + 1] = 0;
+        row[x * 2 + 2] = 0;
+        row[x * 2 + 3] = 0;
       }
     }
   }
 }
 
+/**
+ * @brief Decode Bayer Pattern
+ * @param RedX, RedY the coordinates of the upper-rightmost green pixel
+ *        which has a red pixel next to it and a blue underneath
+ *
+ */
+static inline void BayerToYUV(struct image_t *in, struct image_t *out,
+                              int RedX, int RedY)
+{
+  BayerToYUVRows(in, out, RedX, RedY, 0, out->h);
+}
+
 #endif /* Bayer_H */
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2023 The Paparazzi Team
+ *
+ * This file is part of Paparazzi.
+ *
+ * Paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * Paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * @file modules/computer_vision/lib/vision/color_mask.c
+ * Color mask of a YUV422 image, shared by the color detectors working on the same frame.
+ */
+
+#include "modules/computer_vision/lib/vision/color_mask.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/** Number of masks kept, at least the number of detectors working at the same time */
+#ifndef COLOR_MASK_CACHE_SIZE
+#define COLOR_MASK_CACHE_SIZE 4
+#endif
+
+static struct color_mask_t color_masks[COLOR_MASK_CACHE_SIZE];
+static uint32_t color_mask_requests = 0;
+/** Lock of the cache lookup and of the users count */
+static pthread_mutex_t color_mask_mutex = PTHREAD_MUTEX_INITIALIZER;
+/** Lock of the content of each mask, held while the mask or its summed area table is computed */
+static pthread_mutex_t color_mask_locks[COLOR_MASK_CACHE_SIZE];
+static bool color_mask_locks_init = false;
+
+/** Whether a value is in [min, max] */
+#define InRange(_v, _min, _max) ((_v) >= (_min) && (_v) <= (_max))
+
+static bool color_mask_matches(struct color_mask_t *cm, struct image_t *img, struct color_range_t *range)
+{
+  return cm->frame_buf == img->buf && cm->w == img->w && cm->h == img->h &&
+         cm->frame_ts.tv_sec == img->ts.tv_sec && cm->frame_ts.tv_usec == img->ts.tv_usec &&
+         cm->frame_pprz_ts == img->pprz_ts && memcmp(&cm->range, range, sizeof(struct color_range_t)) == 0;
+}
+
+/**
+ * Compute the mask of a frame, the pixels of a pair share U and V but have their own Y.
+ * Called with the lock of the mask held, the frame and the range are already set.
+ * @return false if the mask could not be allocated
+ */
+static bool color_mask_compute(struct color_mask_t *cm, struct image_t *img, struct color_range_t *range)
+{
+  if (cm->mask == NULL || cm->mask_size != img->w * img->h) {
+    free(cm->mask);
+    free(cm->sat);
+    cm->sat = NULL;
+    cm->mask = malloc(img->w * img->h);
+    cm->mask_size = (cm->mask != NULL) ? img->w * img->h : 0;
+    if (cm->mask == NULL) {
+      return false;
+    }
+  }
+
+  cm->sat_valid = false;
+  cm->count = 0;
+  cm->sum_x = 0;
+  cm->sum_y = 0;
+
+  const uint8_t *buf = img->buf;
+  uint8_t *mask = cm->mask;
+  for (uint16_t y = 0; y < img->h; y++) {
+    uint32_t row_count = 0, row_sum_x = 0;
+    for (uint16_t x = 0; x < img->w; x += 2) {
+      // UYVY
+      uint8_t uv = InRange(buf[0], range->u_min, range->u_max) & InRange(buf[2], range->v_min, range->v_max);
+      mask[0] = uv & InRange(buf[1], range->y_min, range->y_max);
+      mask[1] = uv & InRange(buf[3], range->y_min, range->y_max);
+      row_count += mask[0] + mask[1];
+      row_sum_x += mask[0] * x + mask[1] * (x + 1);
+      buf += 4;
+      mask += 2;
+    }
+    cm->count += row_count;
+    cm->sum_x += row_sum_x;
+    cm->sum_y += row_count * y;
+  }
+  return true;
+}
+
+/**
+ * Get the color mask of a frame, computed at the first request for this frame and color range.
+ * The other requests for the same mask wait until it is computed, the requests for other masks don't.
+ * The mask has to be released after use.
+ * @param[in] img The YUV422 image
+ * @param[in] range The color range
+ * @return The color mask, or NULL if no mask is available (then the pixels have to be checked directly)
+ */
+struct color_mask_t *color_mask_acquire(struct image_t *img, struct color_range_t *range)
+{
+  struct color_mask_t *cm = NULL;
+
+  if (img->type != IMAGE_YUV422 || img->w % 2 != 0) {
+    return NULL;
+  }
+
+  pthread_mutex_lock(&color_mask_mutex);
+  if (!color_mask_locks_init) {
+    for (uint8_t i = 0; i < COLOR_MASK_CACHE_SIZE; i++) {
+      pthread_mutex_init(&color_mask_locks[i], NULL);
+    }
+    color_mask_locks_init = true;
+  }
+  color_mask_requests++;
+
+  // mask already computed (or being computed) for this frame
+  for (uint8_t i = 0; i < COLOR_MASK_CACHE_SIZE; i++) {
+    if (color_mask_matches(&color_masks[i], img, range)) {
+      cm = &color_masks[i];
+      break;
+    }
+  }
+
+  if (cm != NULL) {
+    cm->users++;
+    cm->last_used = color_mask_requests;
+    pthread_mutex_unlock(&color_mask_mutex);
+
+    // wait for the request computing it
+    pthread_mutex_lock(&color_mask_locks[cm - color_masks]);
+    bool valid = cm->valid;
+    pthread_mutex_unlock(&color_mask_locks[cm - color_masks]);
+    if (!valid) {
+      color_mask_release(cm);
+      return NULL;
+    }
+    return cm;
+  }
+
+  // else replace the mask that was not used for the longest time
+  for (uint8_t i = 0; i < COLOR_MASK_CACHE_SIZE; i++) {
+    if (color_masks[i].users == 0 && (cm == NULL || color_masks[i].last_used < cm->last_used)) {
+      cm = &color_masks[i];
+    }
+  }
+  if (cm == NULL) {
+    pthread_mutex_unlock(&color_mask_mutex);
+    return NULL;
+  }
+
+  // the mask is unused, it is locked before it can be found by the other requests for this frame
+  pthread_mutex_t *lock = &color_mask_locks[cm - color_masks];
+  pthread_mutex_lock(lock);
+  cm->range = *range;
+  cm->w = img->w;
+  cm->h = img->h;
+  cm->frame_buf = img->buf;
+  cm->frame_ts = img->ts;
+  cm->frame_pprz_ts = img->pprz_ts;
+  cm->users++;
+  cm->last_used = color_mask_requests;
+  pthread_mutex_unlock(&color_mask_mutex);
+
+  bool valid = color_mask_compute(cm, img, range);
+  cm->valid = valid;
+  pthread_mutex_unlock(lock);
+
+  if (!valid) {
+    // not found anymore by the next requests
+    pthread_mutex_lock(&color_mask_mutex);
+    cm->frame_buf = NULL;
+    cm->users--;
+    pthread_mutex_unlock(&color_mask_mutex);
+    return NULL;
+  }
+  return cm;
+}
+
+/**
+ * Release a color mask after use
+ * @param[in] cm The color mask
+ */
+void color_mask_release(struct color_mask_t *cm)
+{
+  if (cm == NULL) {
+    return;
+  }
+  pthread_mutex_lock(&color_mask_mutex);
+  cm->users--;
+  pthread_mutex_unlock(&color_mask_mutex);
+}
+
+/**
+ * Compute the summed area table: sat[y][x] is the number of pixels in range above and left of (x, y)
+ * Called with the lock of the mask held, as the detectors sharing the mask may ask for it at the same time.
+ */
+static bool color_mask_compute_sat(struct color_mask_t *cm)
+{
+  const uint32_t stride = cm->w + 1;
+
+  if (cm->sat == NULL) {
+    cm->sat = malloc(stride * (cm->h + 1) * sizeof(uint32_t));
+    if (cm->sat == NULL) {
+      return false;
+    }
+  }
+
+  memset(cm->sat, 0, stride * sizeof(uint32_t));
+  for (uint16_t y = 0; y < cm->h; y++) {
+    const uint8_t *mask = &cm->mask[y * cm->w];
+    const uint32_t *above = &cm->sat[y * stride];
+    uint32_t *row = &cm->sat[(y + 1) * stride];
+    uint32_t row_sum = 0;
+    row[0] = 0;
+    for (uint16_t x = 0; x < cm->w; x++) {
+      row_sum += mask[x];
+      row[x + 1] = above[x + 1] + row_sum;
+    }
+  }
+  __atomic_store_n(&cm->sat_valid, true, __ATOMIC_RELEASE);
+  return true;
+}
+
+/**
+ * Number of pixels in range in a rectangle, the parts outside of the image are ignored
+ * @param[in] cm The color mask
+ * @param[in] x_min, y_min The first pixel of the rectangle
+ * @param[in] x_max, y_max The last pixel of the rectangle (included)
+ * @param[out] n_pixels The number of pixels of the rectangle inside the image (can be NULL)
+ * @return The number of pixels in range
+ */
+uint32_t color_mask_count_rect(struct color_mask_t *cm, int x_min, int y_min, int x_max, int y_max,
+                               uint32_t *n_pixels)
+{
+  Bound(x_min, 0, cm->w);
+  Bound(y_min, 0, cm->h);
+  Bound(x_max, -1, cm->w - 1);
+  Bound(y_max, -1, cm->h - 1);
+  if (x_max < x_min || y_max < y_min) {
+    if (n_pixels != NULL) {
+      *n_pixels = 0;
+    }
+    return 0;
+  }
+  if (n_pixels != NULL) {
+    *n_pixels = (x_max - x_min + 1) * (y_max - y_min + 1);
+  }
+  bool sat_valid = __atomic_load_n(&cm->sat_valid, __ATOMIC_ACQUIRE);
+  if (!sat_valid) {
+    pthread_mutex_lock(&color_mask_locks[cm - color_masks]);
+    sat_valid = cm->sat_valid || color_mask_compute_sat(cm);
+    pthread_mutex_unlock(&color_mask_locks[cm - color_masks]);
+  }
+  if (!sat_valid) {
+    // count the pixels directly
+    uint32_t count = 0;
+    for (int y = y_min; y <= y_max; y++) {
+      for (int x = x_min; x <= x_max; x++) {
+        count += cm->mask[y * cm->w + x];
+      }
+    }
+    return count;
+  }
+
+  const uint32_t stride = cm->w + 1;
+  return cm->sat[(y_max + 1) * stride + x_max + 1] - cm->sat[y_min * stride + x_max + 1]
+         - cm->sat[(y_max + 1) * stride + x_min] + cm->sat[y_min * stride + x_min];
+}
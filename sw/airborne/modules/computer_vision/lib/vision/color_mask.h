@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2023 The Paparazzi Team
+ *
+ * This file is part of Paparazzi.
+ *
+ * Paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * Paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * @file modules/computer_vision/lib/vision/color_mask.h
+ * Color mask of a YUV422 image, shared by the color detectors working on the same frame.
+ *
+ * The mask is computed in one pass over the image, the first time a frame is requested with a color range.
+ * Other requests for the same frame and range get the same mask. Besides single pixel lookups, it gives
+ * the number of pixels in range in a rectangle in constant time, with a summed area table computed at
+ * the first rectangle query.
+ *
+ * Note that the mask is computed from the frame as it is at the first request: later changes to the
+ * image (drawing, filtering) are not seen by the other detectors.
+ */
+
+#ifndef COLOR_MASK_H
+#define COLOR_MASK_H
+
+#include "std.h"
+#include "modules/computer_vision/lib/vision/image.h"
+
+/** Color range in YUV */
+struct color_range_t {
+  uint8_t y_min;
+  uint8_t y_max;
+  uint8_t u_min;
+  uint8_t u_max;
+  uint8_t v_min;
+  uint8_t v_max;
+};
+
+/** Color mask of a frame */
+struct color_mask_t {
+  struct color_range_t range;   ///< The color range of the mask
+  uint16_t w;                   ///< Image width
+  uint16_t h;                   ///< Image height
+  void *frame_buf;              ///< Buffer of the frame the mask was computed from
+  struct timeval frame_ts;      ///< Timestamp of the frame the mask was computed from
+  uint32_t frame_pprz_ts;       ///< Paparazzi timestamp of the frame the mask was computed from
+
+  bool valid;                   ///< Whether the mask is computed for this frame
+  uint8_t *mask;                ///< 1 for the pixels in range, 0 for the others (w x h)
+  uint32_t mask_size;           ///< Allocated size of the mask
+  uint32_t *sat;                ///< Summed area table of the mask ((w + 1) x (h + 1))
+  bool sat_valid;               ///< Whether the summed area table is computed for this frame
+  uint32_t count;               ///< Number of pixels in range
+  uint32_t sum_x;               ///< Sum of the x coordinates of the pixels in range
+  uint32_t sum_y;               ///< Sum of the y coordinates of the pixels in range
+
+  uint32_t last_used;           ///< Request counter at the last use, for the replacement of masks
+  uint8_t users;                ///< Number of detectors using the mask
+};
+
+extern struct color_mask_t *color_mask_acquire(struct image_t *img, struct color_range_t *range);
+extern void color_mask_release(struct color_mask_t *cm);
+extern uint32_t color_mask_count_rect(struct color_mask_t *cm, int x_min, int y_min, int x_max, int y_max,
+                                      uint32_t *n_pixels);
+
+/**
+ * Whether a pixel is in range
+ * @param[in] cm The color mask
+ * @param[in] x The x-coordinate of the pixel
+ * @param[in] y The y-coordinate of the pixel
+ * @return 1 if the pixel is in range, 0 if not or if it is outside the image
+ */
+static inline uint8_t color_mask_pixel(struct color_mask_t *cm, int x, int y)
+{
+  if (x < 0 || x >= cm->w || y < 0 || y >= cm->h) {
+    return 0;
+  }
+  return cm->mask[y * cm->w + x];
+}
+
+#endif /* COLOR_MASK_H */
@@ -78,79 +78,172 @@ void  calc_previous_frame_nr(struct opticflow_result_t *result, struct opticflow
                          MAX_HORIZON;
 }
 
+/** Use NEON for the edge histograms, only on ARM processors */
+#ifndef EDGE_FLOW_USE_NEON
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define EDGE_FLOW_USE_NEON TRUE
+#else
+#define EDGE_FLOW_USE_NEON FALSE
+#endif
+#endif
+
+#if EDGE_FLOW_USE_NEON
+#include <arm_neon.h>
+#endif
+
+/** Rows accumulated in 16 bit before adding them to the 32 bit histogram (255 * 256 fits in 16 bit) */
+#define EDGE_HIST_BLOCK_ROWS 256
+
 /**
- * Calculate a edge/gradient histogram for each dimension of the image
- * @param[in] *img  The image frame to calculate the edge histogram from
- * @param[out] *edge_histogram  The edge histogram from the current frame_step
- * @param[in] direction  Indicating if the histogram is made in either x or y direction
- * @param[in] edge_threshold  A threshold if a gradient is considered a edge or not
+ * Add the horizontal gradients of a row to the column sums
+ * @param[in] *row Gray values of the row, pixel_step bytes apart
+ * @param[in] pixel_step Distance between the gray values (1 for grayscale, 2 for YUV422)
+ * @param[in] w Width of the row
+ * @param[in] edge_threshold A gradient is added if it is above the threshold
+ * @param[in,out] *col_sum Sums of the columns 1 to w - 2 (col_sum[0] is column 1)
  */
-void calculate_edge_histogram(struct image_t *img, int32_t edge_histogram[],
-                              char direction, uint16_t edge_threshold)
+static void edge_hist_add_row_x(const uint8_t *row, uint8_t pixel_step, uint16_t w, uint8_t edge_threshold,
+                                uint16_t *col_sum)
 {
-  uint8_t *img_buf = (uint8_t *)img->buf;
-
-  // TODO use arm_conv_q31()
-  int32_t sobel_sum = 0;
-  int32_t Sobel[3] = { -1, 0, 1};
-
-  int32_t y = 0, x = 0;
-  int32_t c = 0;
+  uint16_t x = 1;
+#if EDGE_FLOW_USE_NEON
+  const uint8x16_t thr = vdupq_n_u8(edge_threshold);
+  // the deinterleaving loads of YUV422 read one byte further
+  const uint16_t w_neon = w - (pixel_step - 1);
+  for (; x + 16 < w_neon; x += 16) {
+    uint8x16_t left, right;
+    if (pixel_step == 2) {
+      left = vld2q_u8(&row[2 * (x - 1)]).val[0];
+      right = vld2q_u8(&row[2 * (x + 1)]).val[0];
+    } else {
+      left = vld1q_u8(&row[x - 1]);
+      right = vld1q_u8(&row[x + 1]);
+    }
+    uint8x16_t grad = vabdq_u8(right, left);
+    grad = vandq_u8(grad, vcgtq_u8(grad, thr));
+    uint16_t *sum = &col_sum[x - 1];
+    vst1q_u16(sum, vaddw_u8(vld1q_u16(sum), vget_low_u8(grad)));
+    vst1q_u16(sum + 8, vaddw_u8(vld1q_u16(sum + 8), vget_high_u8(grad)));
+  }
+#endif
+  for (; x < w - 1; x++) {
+    uint8_t grad = abs(row[pixel_step * (x + 1)] - row[pixel_step * (x - 1)]);
+    if (grad > edge_threshold) {
+      col_sum[x - 1] += grad;
+    }
+  }
+}
 
-  uint32_t idx = 0;
+/**
+ * Sum of the vertical gradients of a row
+ * @param[in] *above Gray values of the row above
+ * @param[in] *below Gray values of the row below
+ * @param[in] pixel_step Distance between the gray values (1 for grayscale, 2 for YUV422)
+ * @param[in] w Width of the rows
+ * @param[in] edge_threshold A gradient is added if it is above the threshold
+ * @return The sum of the gradients
+ */
+static int32_t edge_hist_row_y(const uint8_t *above, const uint8_t *below, uint8_t pixel_step, uint16_t w,
+                               uint8_t edge_threshold)
+{
+  int32_t row_sum = 0;
+  uint16_t x = 0;
+#if EDGE_FLOW_USE_NEON
+  const uint8x16_t thr = vdupq_n_u8(edge_threshold);
+  uint32x4_t sum = vdupq_n_u32(0);
+  const uint16_t w_neon = w - (pixel_step - 1);
+  for (; x + 16 <= w_neon; x += 16) {
+    uint8x16_t a, b;
+    if (pixel_step == 2) {
+      a = vld2q_u8(&above[2 * x]).val[0];
+      b = vld2q_u8(&below[2 * x]).val[0];
+    } else {
+      a = vld1q_u8(&above[x]);
+      b = vld1q_u8(&below[x]);
+    }
+    uint8x16_t grad = vabdq_u8(b, a);
+    grad = vandq_u8(grad, vcgtq_u8(grad, thr));
+    sum = vpadalq_u16(sum, vpaddlq_u8(grad));
+  }
+  row_sum = vgetq_lane_u32(sum, 0) + vgetq_lane_u32(sum, 1) + vgetq_lane_u32(sum, 2) + vgetq_lane_u32(sum, 3);
+#endif
+  for (; x < w; x++) {
+    uint8_t grad = abs(below[pixel_step * x] - above[pixel_step * x]);
+    if (grad > edge_threshold) {
+      row_sum += grad;
+    }
+  }
+  return row_sum;
+}
 
-  int16_t image_width = (int16_t)img->w;
-  int16_t image_height = (int16_t)img->h;
-  uint32_t interlace;
+/**
+ * Calculate the edge/gradient histograms of both dimensions of the image in a single pass over the rows
+ * @param[in] *img  The image frame to calculate the edge histogram from (grayscale or YUV422, then Y is used)
+ * @param[out] *edge_histogram_x  The horizontal edge histogram (img->w values), can be NULL
+ * @param[out] *edge_histogram_y  The vertical edge histogram (img->h values), can be NULL
+ * @param[in] edge_threshold  A threshold if a gradient is considered a edge or not
+ */
+void calculate_edge_histograms(struct image_t *img, int32_t *edge_histogram_x, int32_t *edge_histogram_y,
+                               uint16_t edge_threshold)
+{
+  const uint8_t *img_buf = (const uint8_t *)img->buf;
+  uint8_t pixel_step;
   if (img->type == IMAGE_GRAYSCALE) {
-    interlace = 1;
+    pixel_step = 1;
+  } else if (img->type == IMAGE_YUV422) {
+    // Y values of UYVY
+    pixel_step = 2;
+    img_buf++;
   } else {
-    if (img->type == IMAGE_YUV422) {
-      interlace = 2;
-    } else
-      while (1);   // hang to show user something isn't right
+    while (1);   // hang to show user something isn't right
   }
 
+  uint16_t w = img->w;
+  uint16_t h = img->h;
+  uint32_t row_size = pixel_step * w;
+  // gradients are at most 255, larger thresholds keep no edge at all
+  uint8_t threshold = (edge_threshold > 255) ? 255 : edge_threshold;
 
-  // compute edge histogram
-  if (direction == 'x') {
-    // set values that are not visited
-    edge_histogram[0] = edge_histogram[image_width - 1] = 0;
-    for (x = 1; x < image_width - 1; x++) {
-      edge_histogram[x] = 0;
-      for (y = 0; y < image_height; y++) {
-        sobel_sum = 0;
-
-        for (c = -1; c <= 1; c += 2) {
-          idx = interlace * (image_width * y + (x + c));
+  uint16_t col_sum[w];
+  if (edge_histogram_x != NULL) {
+    memset(edge_histogram_x, 0, w * sizeof(int32_t));
+    memset(col_sum, 0, sizeof(col_sum));
+  }
+  if (edge_histogram_y != NULL) {
+    edge_histogram_y[0] = edge_histogram_y[h - 1] = 0;
+  }
 
-          sobel_sum += Sobel[c + 1] * (int32_t)img_buf[idx];
-        }
-        sobel_sum = abs(sobel_sum);
-        if (sobel_sum > edge_threshold) {
-          edge_histogram[x] += sobel_sum;
+  for (uint16_t y = 0; y < h; y++) {
+    const uint8_t *row = &img_buf[y * row_size];
+    if (edge_histogram_x != NULL && w > 2) {
+      edge_hist_add_row_x(row, pixel_step, w, threshold, col_sum);
+      if ((y + 1) % EDGE_HIST_BLOCK_ROWS == 0 || y == h - 1) {
+        for (uint16_t x = 1; x < w - 1; x++) {
+          edge_histogram_x[x] += col_sum[x - 1];
+          col_sum[x - 1] = 0;
         }
       }
     }
-  } else if (direction == 'y') {
-    // set values that are not visited
-    edge_histogram[0] = edge_histogram[image_height - 1] = 0;
-    for (y = 1; y < image_height - 1; y++) {
-      edge_histogram[y] = 0;
-      for (x = 0; x < image_width; x++) {
-        sobel_sum = 0;
-
-        for (c = -1; c <= 1; c += 2) {
-          idx = interlace * (image_width * (y + c) + x);
-
-          sobel_sum += Sobel[c + 1] * (int32_t)img_buf[idx];
-        }
-        sobel_sum = abs(sobel_sum);
-        if (sobel_sum > edge_threshold) {
-          edge_histogram[y] += sobel_sum;
-        }
-      }
+    if (edge_histogram_y != NULL && y > 0 && y < h - 1) {
+      edge_histogram_y[y] = edge_hist_row_y(row - row_size, row + row_size, pixel_step, w, threshold);
     }
+  }
+}
+
+/**
+ * Calculate a edge/gradient histogram for each dimension of the image
+ * @param[in] *img  The image frame to calculate the edge histogram from
+ * @param[out] *edge_histogram  The edge histogram from the current frame_step
+ * @param[in] direction  Indicating if the histogram is made in either x or y direction
+ * @param[in] edge_threshold  A threshold if a gradient is considered a edge or not
+ */
+void calculate_edge_histogram(struct image_t *img, int32_t edge_histogram[],
+                              char direction, uint16_t edge_threshold)
+{
+  if (direction == 'x') {
+    calculate_edge_histograms(img, edge_histogram, NULL, edge_threshold);
+  } else if (direction == 'y') {
+    calculate_edge_histograms(img, NULL, edge_histogram, edge_threshold);
   } else
     while (1);  // hang to show user something isn't right
 }
@@ -169,48 +262,107 @@ void calculate_edge_displacement(int32_t *edge_histogram, int32_t *edge_histogra
                                  uint16_t size,
                                  uint8_t window, uint8_t disp_range, int32_t der_shift)
 {
-  int32_t c = 0, r = 0;
-  int32_t x = 0;
-  uint32_t SAD_temp[2 * DISP_RANGE_MAX + 1]; // size must be at least 2*D + 1
+  calculate_edge_displacement_range(edge_histogram, edge_histogram_prev, displacement, size, window, disp_range,
+                                    der_shift, -disp_range, disp_range);
+}
 
+/**
+ * Calculate the displacement between two histograms, searching only the shifts from shift_min to shift_max.
+ * The SAD of the windows is updated incrementally along the histogram for each shift, the result
+ * is the same as calculate_edge_displacement when the range is [-disp_range, disp_range].
+ * @param[in] *edge_histogram  The edge histogram from the current frame_step
+ * @param[in] *edge_histogram_prev  The edge histogram from the previous frame_step
+ * @param[out] *displacement array with pixel displacement of the sequential edge histograms
+ * @param[in] size  Indicating the size of the displacement array
+ * @param[in] window Indicating the search window size
+ * @param[in] disp_range  Indicating the maximum disparity range for the block matching
+ * @param[in] der_shift  The pixel shift estimated by the angle rate of the IMU
+ * @param[in] shift_min, shift_max  The shifts searched, bounded by disp_range
+ */
+void calculate_edge_displacement_range(int32_t *edge_histogram, int32_t *edge_histogram_prev, int32_t *displacement,
+                                       uint16_t size, uint8_t window, uint8_t disp_range, int32_t der_shift,
+                                       int32_t shift_min, int32_t shift_max)
+{
   int32_t W = window;
   int32_t D = disp_range;
 
-
-  uint8_t SHIFT_TOO_FAR = 0;
   memset(displacement, 0, sizeof(int32_t)*size);
 
+  // the windows of all the shifts have to stay inside the histograms
   int32_t border[2];
-
-  if (der_shift < 0) {
-    border[0] =  W + D + der_shift;
-    border[1] = size - W - D;
-  } else if (der_shift > 0) {
-    border[0] =  W + D;
-    border[1] = size - W - D - der_shift;
-  } else {
-    border[0] =  W + D;
-    border[1] = size - W - D;
-  }
+  border[0] = W + D - Min(der_shift, 0);
+  border[1] = size - W - D - Max(der_shift, 0);
 
   if (border[0] >= border[1] || abs(der_shift) >= 10) {
-    SHIFT_TOO_FAR = 1;
+    // shift too far
+    return;
   }
-  // TODO: replace with arm offset subtract
-  for (x = border[0]; x < border[1]; x++) {
-    if (!SHIFT_TOO_FAR) {
-      for (c = -D; c <= D; c++) {
-        SAD_temp[c + D] = 0;
-        for (r = -W; r <= W; r++) {
-          SAD_temp[c + D] += abs(edge_histogram[x + r] - edge_histogram_prev[x + r + c + der_shift]);
-        }
+
+  Bound(shift_min, -D, D);
+  Bound(shift_max, shift_min, D);
+
+  // at most the image width
+  uint32_t best_sad[border[1] - border[0]];
+
+  for (int32_t c = shift_min; c <= shift_max; c++) {
+    const int32_t *prev = &edge_histogram_prev[c + der_shift];
+    int32_t x = border[0];
+
+    uint32_t sad = 0;
+    for (int32_t r = -W; r <= W; r++) {
+      sad += abs(edge_histogram[x + r] - prev[x + r]);
+    }
+
+    for (; x < border[1]; x++) {
+      // the last shift with the lowest SAD is kept, as getMinimum does
+      if (c == shift_min || sad <= best_sad[x - border[0]]) {
+        best_sad[x - border[0]] = sad;
+        displacement[x] = c;
+      }
+      if (x + 1 < border[1]) {
+        sad += abs(edge_histogram[x + W + 1] - prev[x + W + 1]);
+        sad -= abs(edge_histogram[x - W] - prev[x - W]);
       }
-      displacement[x] = (int32_t)getMinimum(SAD_temp, 2 * D + 1) - D;
-    } else {
     }
   }
 }
 
+/**
+ * Update the range of shifts searched for the next frame, around the displacements found in this one.
+ * The range is widened more when the displacements reach its limits, as the flow may be outside of it.
+ * @param[in] *displacement Pixel wise displacement array
+ * @param[in] size  Size of the displacement array
+ * @param[in] border  A border offset of the array that is not considered
+ * @param[in] disp_range  The maximum disparity range
+ * @param[in,out] shift_min, shift_max  The range of shifts searched
+ */
+void edge_displacement_search_range(int32_t *displacement, uint16_t size, uint32_t border, uint8_t disp_range,
+                                    int32_t *shift_min, int32_t *shift_max)
+{
+  if (size <= 2 * border) {
+    *shift_min = -disp_range;
+    *shift_max = disp_range;
+    return;
+  }
+
+  int32_t disp_min = displacement[border];
+  int32_t disp_max = displacement[border];
+  for (uint32_t x = border + 1; x < size - border; x++) {
+    if (displacement[x] < disp_min) {
+      disp_min = displacement[x];
+    } else if (displacement[x] > disp_max) {
+      disp_max = displacement[x];
+    }
+  }
+
+  int32_t new_min = disp_min - ((disp_min <= *shift_min) ? 2 * EDGE_FLOW_SEARCH_MARGIN : EDGE_FLOW_SEARCH_MARGIN);
+  int32_t new_max = disp_max + ((disp_max >= *shift_max) ? 2 * EDGE_FLOW_SEARCH_MARGIN : EDGE_FLOW_SEARCH_MARGIN);
+  Bound(new_min, -disp_range, disp_range);
+  Bound(new_max, -disp_range, disp_range);
+  *shift_min = new_min;
+  *shift_max = new_max;
+}
+
 /**
  * Calculate minimum of an array
  * @param[in] *a Array containing values
@@ -55,6 +55,13 @@
 #ifndef MAX_WINDOW_SIZE
 #define MAX_WINDOW_SIZE 20
 #endif
+/** Search the displacements around the ones of the previous frame, with this margin in pixels */
+#ifndef EDGE_FLOW_SEARCH_PRIOR
+#define EDGE_FLOW_SEARCH_PRIOR TRUE
+#endif
+#ifndef EDGE_FLOW_SEARCH_MARGIN
+#define EDGE_FLOW_SEARCH_MARGIN 3
+#endif
 #ifndef OPTICFLOW_FOV_W
 #define OPTICFLOW_FOV_W 0.89360857702
 #endif
@@ -89,9 +96,16 @@ void calc_previous_frame_nr(struct opticflow_result_t *result, struct opticflow_
                             uint8_t *previous_frame_offset, uint8_t *previous_frame_nr);
 void calculate_edge_histogram(struct image_t *img, int32_t edge_histogram[],
                               char direction, uint16_t edge_threshold);
+void calculate_edge_histograms(struct image_t *img, int32_t *edge_histogram_x, int32_t *edge_histogram_y,
+                               uint16_t edge_threshold);
 void calculate_edge_displacement(int32_t *edge_histogram, int32_t *edge_histogram_prev, int32_t *displacement,
                                  uint16_t size,
                                  uint8_t window, uint8_t disp_range, int32_t der_shift);
+void calculate_edge_displacement_range(int32_t *edge_histogram, int32_t *edge_histogram_prev, int32_t *displacement,
+                                       uint16_t size, uint8_t window, uint8_t disp_range, int32_t der_shift,
+                                       int32_t shift_min, int32_t shift_max);
+void edge_displacement_search_range(int32_t *displacement, uint16_t size, uint32_t border, uint8_t disp_range,
+                                    int32_t *shift_min, int32_t *shift_max);
 
 // Local assisting functions (only used here)
 // TODO: find a way to incorperate/find these functions in paparazzi
@@ -437,14 +437,16 @@ void pyramid_next_level(struct image_t *input, struct image_t *output, uint8_t b
   }
   // Vertical convolution
   w = output->w;
-  for (uint16_t i = 0; i != output->h - border_size; i++) {
-    for (uint16_t j = 0; j != output->w - border_size; j++) {
+  for (int32_t i = 0; i < output->h - border_size; i++) {
+    for (int32_t j = 0; j < output->w - border_size; j++) {
       // Wrong to add border_size again, but offset of a few px acceptable inaccuracy
       row = border_size + i;
       col = border_size + j;
+      // the last row has no row below it
+      uint16_t below = (row + 1 < output->h) ? row + 1 : row;
 
       sum = (output_buf[row * w + col]) >> 1;
-      sum += (output_buf[(row + 1) * w + col] + output_buf[(row - 1) * w + col]) >> 2;
+      sum += (output_buf[below * w + col] + output_buf[(row - 1) * w + col]) >> 2;
 
       output_buf[i * output->w + j] = sum;
     }
@@ -476,6 +478,137 @@ void pyramid_build(struct image_t *input, struct image_t *output_array, uint8_t
   }
 }
 
+/**
+ * Allocate the levels of an image pyramid, to be filled by pyramid_update.
+ * @param[out] *pyramid - array of `pyr_level` + 1 image_t structs
+ * @param[in]  w, h  - size of the image without padding
+ * @param[in]  pyr_level  - number of pyramid levels
+ * @param[in]  border_size  - amount of padding around each level
+ */
+void pyramid_create(struct image_t *pyramid, uint16_t w, uint16_t h, uint8_t pyr_level, uint16_t border_size)
+{
+  for (uint8_t i = 0; i != pyr_level + 1; i++) {
+    image_create(&pyramid[i], w + 2 * border_size, h + 2 * border_size, IMAGE_GRAYSCALE);
+    // same size as pyramid_next_level
+    w = (w + 1) / 2;
+    h = (h + 1) / 2;
+  }
+}
+
+/**
+ * Free the levels of an image pyramid
+ * @param[in] *pyramid - array of `pyr_level` + 1 image_t structs
+ * @param[in] pyr_level  - number of pyramid levels
+ */
+void pyramid_free(struct image_t *pyramid, uint8_t pyr_level)
+{
+  for (uint8_t i = 0; i != pyr_level + 1; i++) {
+    image_free(&pyramid[i]);
+  }
+}
+
+/**
+ * Mirror the border of a padded image, the inner part being filled
+ * (same padding as image_add_border)
+ */
+static void image_mirror_border(struct image_t *img, uint16_t border_size)
+{
+  uint8_t *buf = (uint8_t *)img->buf;
+  uint16_t w = img->w;
+
+  for (uint16_t i = border_size; i != img->h - border_size; i++) {
+    uint8_t *row = &buf[i * w];
+    for (uint16_t j = 0; j != border_size; j++) {
+      row[border_size - 1 - j] = row[border_size + j];
+    }
+    for (uint16_t j = 0; j != border_size; j++) {
+      row[w - border_size + j] = row[w - border_size - 1 - j];
+    }
+  }
+  for (uint16_t i = 0; i != border_size; i++) {
+    memcpy(&buf[(border_size - 1 - i) * w], &buf[(border_size + i) * w], w);
+    memcpy(&buf[(img->h - border_size + i) * w], &buf[(img->h - border_size - 1 - i) * w], w);
+  }
+}
+
+/**
+ * Fill an image pyramid allocated with pyramid_create, with the same result as pyramid_build.
+ * The levels are written in place: the gray values are extracted straight into the padded first level
+ * (and optionally into a gray image at the same time), and each level is filtered straight into the
+ * padded next level, without temporary images.
+ * @param[in]  *input  - input image (YUV422 or grayscale)
+ * @param[out] *gray  - gray version of the input image, can be NULL
+ * @param[out] *pyramid - array of image_t structs, allocated with pyramid_create for the size of input
+ * @param[in]  pyr_level  - number of pyramid levels, as allocated
+ * @param[in]  border_size  - amount of padding around each level, as allocated
+ */
+void pyramid_update(struct image_t *input, struct image_t *gray, struct image_t *pyramid, uint8_t pyr_level,
+                    uint16_t border_size)
+{
+  uint8_t *source = (uint8_t *)input->buf;
+  uint8_t pixel_step = 1;
+  if (input->type == IMAGE_YUV422) {
+    // Y values of UYVY
+    source++;
+    pixel_step = 2;
+  }
+
+  if (gray != NULL) {
+    gray->ts = input->ts;
+    gray->eulers = input->eulers;
+    gray->pprz_ts = input->pprz_ts;
+  }
+  pyramid[0].ts = input->ts;
+
+  // First level: gray values with padding
+  uint8_t *level_buf = (uint8_t *)pyramid[0].buf;
+  for (uint16_t i = 0; i != input->h; i++) {
+    uint8_t *row = &level_buf[(i + border_size) * pyramid[0].w + border_size];
+    uint8_t *gray_row = (gray != NULL) ? &((uint8_t *)gray->buf)[i * input->w] : NULL;
+    for (uint16_t j = 0; j != input->w; j++) {
+      row[j] = *source;
+      source += pixel_step;
+    }
+    if (gray_row != NULL) {
+      memcpy(gray_row, row, input->w);
+    }
+  }
+  image_mirror_border(&pyramid[0], border_size);
+
+  // Next levels, same filter as pyramid_next_level
+  for (uint8_t l = 1; l != pyr_level + 1; l++) {
+    uint8_t *in_buf = (uint8_t *)pyramid[l - 1].buf;
+    uint16_t in_w = pyramid[l - 1].w;
+    uint16_t out_stride = pyramid[l].w;
+    uint16_t out_w = pyramid[l].w - 2 * border_size;
+    uint16_t out_h = pyramid[l].h - 2 * border_size;
+    uint8_t *out_buf = &((uint8_t *)pyramid[l].buf)[border_size * out_stride + border_size];
+
+    // Horizontal convolution
+    for (uint16_t i = 0; i != out_h; i++) {
+      uint8_t *in_row = &in_buf[(border_size + 2 * i) * in_w + border_size];
+      uint8_t *out_row = &out_buf[i * out_stride];
+      for (uint16_t j = 0; j != out_w; j++) {
+        out_row[j] = (in_row[2 * j] >> 1) + ((in_row[2 * j + 1] + in_row[2 * j - 1]) >> 2);
+      }
+    }
+    // Vertical convolution, in place with the same offset as pyramid_next_level
+    // the last row is repeated below it
+    if (border_size > 0 && out_h > 0) {
+      memcpy(&out_buf[out_h * out_stride], &out_buf[(out_h - 1) * out_stride], out_w);
+    }
+    for (int32_t i = 0; i < out_h - border_size; i++) {
+      uint8_t *out_row = &out_buf[i * out_stride];
+      uint8_t *center = &out_buf[(border_size + i) * out_stride + border_size];
+      for (int32_t j = 0; j < out_w - border_size; j++) {
+        out_row[j] = (center[j] >> 1) + ((center[j + out_stride] + center[j - out_stride]) >> 2);
+      }
+    }
+    image_mirror_border(&pyramid[l], border_size);
+    pyramid[l].ts = input->ts;
+  }
+}
+
 /**
  * This outputs a subpixel window image in grayscale
  * Currently only works with Grayscale images as input but could be upgraded to
@@ -126,6 +126,10 @@ void image_draw_line(struct image_t *img, struct point_t *from, struct point_t *
 void image_draw_line_color(struct image_t *img, struct point_t *from, struct point_t *to, const uint8_t *color);
 void pyramid_next_level(struct image_t *input, struct image_t *output, uint8_t border_size);
 void pyramid_build(struct image_t *input, struct image_t *output_array, uint8_t pyr_level, uint16_t border_size);
+void pyramid_create(struct image_t *pyramid, uint16_t w, uint16_t h, uint8_t pyr_level, uint16_t border_size);
+void pyramid_free(struct image_t *pyramid, uint8_t pyr_level);
+void pyramid_update(struct image_t *input, struct image_t *gray, struct image_t *pyramid, uint8_t pyr_level,
+                    uint16_t border_size);
 void image_gradient_pixel(struct image_t *img, struct point_t *loc, int method, int *dx, int *dy);
 
 #endif
@@ -76,6 +76,25 @@ struct flow_t *opticFlowLK(struct image_t *new_img, struct image_t *old_img, str
                            uint16_t subpixel_factor, uint8_t max_iterations, uint8_t step_threshold, uint8_t max_points, uint8_t pyramid_level,
                            uint8_t keep_bad_points)
 {
+  return opticFlowLK_pyramids(new_img, old_img, NULL, NULL, points, points_cnt, half_window_size, subpixel_factor,
+                              max_iterations, step_threshold, max_points, pyramid_level, keep_bad_points);
+}
+
+/**
+ * Pyramidal Lucas-Kanade with pyramids that can be built beforehand, for instance with pyramid_update
+ * when the gray image is extracted, and kept for the next frame.
+ * @param[in] *new_img The newest grayscale image
+ * @param[in] *old_img The old grayscale image
+ * @param[in] *pyramid_new Pyramid of the newest image with LK_PYRAMID_BORDER_SIZE(half_window_size) padding,
+ *                         or NULL to build it from new_img
+ * @param[in] *pyramid_old Pyramid of the old image, or NULL to build it from old_img
+ * The other parameters and the return value are the same as for opticFlowLK.
+ */
+struct flow_t *opticFlowLK_pyramids(struct image_t *new_img, struct image_t *old_img, struct image_t *pyramid_new,
+                                    struct image_t *pyramid_old, struct point_t *points, uint16_t *points_cnt,
+                                    uint16_t half_window_size, uint16_t subpixel_factor, uint8_t max_iterations,
+                                    uint8_t step_threshold, uint8_t max_points, uint8_t pyramid_level, uint8_t keep_bad_points)
+{
 
   // if no pyramids, use the old code:
   if (pyramid_level == 0) {
@@ -92,15 +111,19 @@ struct flow_t *opticFlowLK(struct image_t *new_img, struct image_t *old_img, str
   // TODO: Feature management shows that this threshold rejects corners maybe too often, maybe another formula could be chosen
   uint32_t error_threshold = (25 * 25) * (patch_size * patch_size);
   uint16_t padded_patch_size = patch_size + 2;
-  uint16_t border_size = padded_patch_size / 2 + 2; // amount of padding added to images
-
-  // Allocate memory for image pyramids
-  struct image_t *pyramid_old = malloc(sizeof(struct image_t) * (pyramid_level + 1));
-  struct image_t *pyramid_new = malloc(sizeof(struct image_t) * (pyramid_level + 1));
-
-  // Build pyramid levels
-  pyramid_build(old_img, pyramid_old, pyramid_level, border_size);
-  pyramid_build(new_img, pyramid_new, pyramid_level, border_size);
+  uint16_t border_size = LK_PYRAMID_BORDER_SIZE(half_window_size); // amount of padding added to images
+
+  // Build the pyramid levels which are not given
+  bool build_old = (pyramid_old == NULL);
+  bool build_new = (pyramid_new == NULL);
+  if (build_old) {
+    pyramid_old = malloc(sizeof(struct image_t) * (pyramid_level + 1));
+    pyramid_build(old_img, pyramid_old, pyramid_level, border_size);
+  }
+  if (build_new) {
+    pyramid_new = malloc(sizeof(struct image_t) * (pyramid_level + 1));
+    pyramid_build(new_img, pyramid_new, pyramid_level, border_size);
+  }
 
   // Create the window images
   struct image_t window_I, window_J, window_DX, window_DY, window_diff;
@@ -246,12 +269,14 @@ struct flow_t *opticFlowLK(struct image_t *new_img, struct image_t *old_img, str
   image_free(&window_DY);
   image_free(&window_diff);
 
-  for (int8_t i = pyramid_level; i != -1; i--) {
-    image_free(&pyramid_old[i]);
-    image_free(&pyramid_new[i]);
+  if (build_old) {
+    pyramid_free(pyramid_old, pyramid_level);
+    free(pyramid_old);
+  }
+  if (build_new) {
+    pyramid_free(pyramid_new, pyramid_level);
+    free(pyramid_new);
   }
-  pyramid_old = NULL;
-  pyramid_new = NULL;
 
   // Return the vectors
   return vectors;
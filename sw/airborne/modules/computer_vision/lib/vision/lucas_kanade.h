@@ -37,11 +37,19 @@
 #define LARGE_FLOW_ERROR 1E5
 #define MEDIUM_FLOW_ERROR 1E3
 
+/** Padding of the pyramid levels used by the pyramidal Lucas-Kanade for a half window size */
+#define LK_PYRAMID_BORDER_SIZE(_hws) ((2 * (_hws) + 3) / 2 + 2)
+
 struct flow_t *opticFlowLK(struct image_t *new_img, struct image_t *old_img, struct point_t *points,
                            uint16_t *points_cnt, uint16_t half_window_size,
                            uint16_t subpixel_factor, uint8_t max_iterations, uint8_t step_threshold, uint8_t max_points, uint8_t pyramid_level,
                            uint8_t keep_bad_points);
 
+struct flow_t *opticFlowLK_pyramids(struct image_t *new_img, struct image_t *old_img, struct image_t *pyramid_new,
+                                    struct image_t *pyramid_old, struct point_t *points, uint16_t *points_cnt,
+                                    uint16_t half_window_size, uint16_t subpixel_factor, uint8_t max_iterations,
+                                    uint8_t step_threshold, uint8_t max_points, uint8_t pyramid_level, uint8_t keep_bad_points);
+
 // used when pyramid level is 0:
 struct flow_t *opticFlowLK_flat(struct image_t *new_img, struct image_t *old_img, struct point_t *points,
                                 uint16_t *points_cnt,
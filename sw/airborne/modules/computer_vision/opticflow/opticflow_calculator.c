@@ -483,6 +483,58 @@ void opticflow_calc_init(struct opticflow_t opticflow[])
   float_rmat_of_eulers(&body_to_cam[1], &euler_cam2);
 #endif
 }
+/**
+ * Allocate the pyramids of the current and previous gray images, they are kept between frames
+ * and reallocated when the pyramid level, window size or image size changes.
+ * @param[in] *opticflow The opticalflow structure
+ * @param[in] *img The image frame
+ * @return Whether the pyramids are available
+ */
+static bool opticflow_pyramid_alloc(struct opticflow_t *opticflow, struct image_t *img)
+{
+  uint8_t pyramid_level = opticflow->pyramid_level;
+  uint16_t border_size = LK_PYRAMID_BORDER_SIZE(opticflow->window_size / 2);
+  if (pyramid_level > OPTICFLOW_MAX_PYRAMID_LEVEL) {
+    pyramid_level = 0;
+  }
+
+  if (opticflow->pyramid_alloc_level == pyramid_level && opticflow->pyramid_border_size == border_size
+      && (pyramid_level == 0 || (opticflow->pyramid[0].w == img->w + 2 * border_size
+                                 && opticflow->pyramid[0].h == img->h + 2 * border_size))) {
+    return pyramid_level > 0;
+  }
+
+  if (opticflow->pyramid_alloc_level > 0) {
+    pyramid_free(opticflow->pyramid, opticflow->pyramid_alloc_level);
+    pyramid_free(opticflow->prev_pyramid, opticflow->pyramid_alloc_level);
+  }
+  if (pyramid_level > 0) {
+    pyramid_create(opticflow->pyramid, img->w, img->h, pyramid_level, border_size);
+    pyramid_create(opticflow->prev_pyramid, img->w, img->h, pyramid_level, border_size);
+  }
+  opticflow->pyramid_alloc_level = pyramid_level;
+  opticflow->pyramid_border_size = border_size;
+  opticflow->pyramid_valid = false;
+  opticflow->prev_pyramid_valid = false;
+  return pyramid_level > 0;
+}
+
+/**
+ * The current gray image (and its pyramid) becomes the previous one
+ * @param[in] *opticflow The opticalflow structure
+ */
+static void opticflow_switch_frames(struct opticflow_t *opticflow)
+{
+  image_switch(&opticflow->img_gray, &opticflow->prev_img_gray);
+  if (opticflow->pyramid_alloc_level > 0) {
+    for (uint8_t i = 0; i != opticflow->pyramid_alloc_level + 1; i++) {
+      image_switch(&opticflow->pyramid[i], &opticflow->prev_pyramid[i]);
+    }
+  }
+  opticflow->prev_pyramid_valid = opticflow->pyramid_valid;
+  opticflow->pyramid_valid = false;
+}
+
 /**
  * Run the optical flow with fast9 and lukaskanade on a new image frame
  * @param[in] *opticflow The opticalflow structure that keeps track of previous images
@@ -506,11 +558,19 @@ bool calc_fast9_lukas_kanade(struct opticflow_t *opticflow, struct image_t *img,
     InitMedianFilterVect3Float(vel_filt, MEDIAN_DEFAULT_SIZE);
   }
 
-  // Convert image to grayscale
-  image_to_grayscale(img, &opticflow->img_gray);
+  // Convert image to grayscale, and build its pyramid in the same pass when pyramids are used
+  bool use_pyramids = opticflow_pyramid_alloc(opticflow, img);
+  if (use_pyramids) {
+    pyramid_update(img, &opticflow->img_gray, opticflow->pyramid, opticflow->pyramid_alloc_level,
+                   opticflow->pyramid_border_size);
+  } else {
+    image_to_grayscale(img, &opticflow->img_gray);
+  }
+  opticflow->pyramid_valid = use_pyramids;
 
   if (!opticflow->got_first_img) {
     image_copy(&opticflow->img_gray, &opticflow->prev_img_gray);
+    opticflow->prev_pyramid_valid = false;
     opticflow->got_first_img = true;
     return false;
   }
@@ -596,7 +656,7 @@ bool calc_fast9_lukas_kanade(struct opticflow_t *opticflow, struct image_t *img,
     result->divergence = 0;
     result->noise_measurement = 5.0;
 
-    image_switch(&opticflow->img_gray, &opticflow->prev_img_gray);
+    opticflow_switch_frames(opticflow);
     return false;
   }
 
@@ -607,10 +667,21 @@ bool calc_fast9_lukas_kanade(struct opticflow_t *opticflow, struct image_t *img,
   // Execute a Lucas Kanade optical flow
   result->tracked_cnt = result->corner_cnt;
   uint8_t keep_bad_points = 0;
-  struct flow_t *vectors = opticFlowLK(&opticflow->img_gray, &opticflow->prev_img_gray, opticflow->fast9_ret_corners,
-                                       &result->tracked_cnt,
-                                       opticflow->window_size / 2, opticflow->subpixel_factor, opticflow->max_iterations,
-                                       opticflow->threshold_vec, opticflow->max_track_corners, opticflow->pyramid_level, keep_bad_points);
+  struct image_t *pyramid = NULL, *prev_pyramid = NULL;
+  if (use_pyramids) {
+    // the previous pyramid is missing after a reallocation or the first image
+    if (!opticflow->prev_pyramid_valid) {
+      pyramid_update(&opticflow->prev_img_gray, NULL, opticflow->prev_pyramid, opticflow->pyramid_alloc_level,
+                     opticflow->pyramid_border_size);
+      opticflow->prev_pyramid_valid = true;
+    }
+    pyramid = opticflow->pyramid;
+    prev_pyramid = opticflow->prev_pyramid;
+  }
+  struct flow_t *vectors = opticFlowLK_pyramids(&opticflow->img_gray, &opticflow->prev_img_gray, pyramid, prev_pyramid,
+                           opticflow->fast9_ret_corners, &result->tracked_cnt,
+                           opticflow->window_size / 2, opticflow->subpixel_factor, opticflow->max_iterations,
+                           opticflow->threshold_vec, opticflow->max_track_corners, opticflow->pyramid_level, keep_bad_points);
 
 
   if (opticflow->track_back) {
@@ -627,8 +698,8 @@ bool calc_fast9_lukas_kanade(struct opticflow_t *opticflow, struct image_t *img,
     // present the images in the opposite order:
     keep_bad_points = 1;
     uint16_t back_track_cnt = result->tracked_cnt;
-    struct flow_t *back_vectors = opticFlowLK(&opticflow->prev_img_gray, &opticflow->img_gray, opticflow->fast9_ret_corners,
-                                  &back_track_cnt,
+    struct flow_t *back_vectors = opticFlowLK_pyramids(&opticflow->prev_img_gray, &opticflow->img_gray, prev_pyramid,
+                                  pyramid, opticflow->fast9_ret_corners, &back_track_cnt,
                                   opticflow->window_size / 2, opticflow->subpixel_factor, opticflow->max_iterations,
                                   opticflow->threshold_vec, opticflow->max_track_corners, opticflow->pyramid_level, keep_bad_points);
 
@@ -705,7 +776,7 @@ bool calc_fast9_lukas_kanade(struct opticflow_t *opticflow, struct image_t *img,
     result->flow_y = 0;
 
     free(vectors);
-    image_switch(&opticflow->img_gray, &opticflow->prev_img_gray);
+    opticflow_switch_frames(opticflow);
     return false;
   } else if (result->tracked_cnt % 2) {
     // Take the median point
@@ -822,7 +893,7 @@ bool calc_fast9_lukas_kanade(struct opticflow_t *opticflow, struct image_t *img,
     }
   }
   free(vectors);
-  image_switch(&opticflow->img_gray, &opticflow->prev_img_gray);
+  opticflow_switch_frames(opticflow);
   return true;
 }
 
@@ -1022,6 +1093,10 @@ bool calc_edgeflow_tot(struct opticflow_t *opticflow, struct image_t *img,
   static uint8_t current_frame_nr = 0;
   struct edge_flow_t edgeflow;
   static uint8_t previous_frame_offset[2] = {1, 1};
+  // range of the displacements searched, from the previous displacements
+  static int32_t search_min[2] = {-DISP_RANGE_MAX, -DISP_RANGE_MAX};
+  static int32_t search_max[2] = {DISP_RANGE_MAX, DISP_RANGE_MAX};
+  static uint8_t search_frame_offset[2] = {0, 0};
 
   // Define Normal variables
   struct edgeflow_displacement_t displacement;
@@ -1059,8 +1134,7 @@ bool calc_edgeflow_tot(struct opticflow_t *opticflow, struct image_t *img,
   // Calculate current frame's edge histogram
   int32_t *edge_hist_x = edge_hist[current_frame_nr].x;
   int32_t *edge_hist_y = edge_hist[current_frame_nr].y;
-  calculate_edge_histogram(img, edge_hist_x, 'x', 0);
-  calculate_edge_histogram(img, edge_hist_y, 'y', 0);
+  calculate_edge_histograms(img, edge_hist_x, edge_hist_y, 0);
 
 
   // Copy frame time and angles of image to calculated edge histogram
@@ -1085,13 +1159,26 @@ bool calc_edgeflow_tot(struct opticflow_t *opticflow, struct image_t *img,
                             opticflow->camera->camera_intrinsics.focal_y * opticflow->derotation_correction_factor_y);
   }
 
+  // The displacements of the previous frame are only a prior for the same time horizon
+  for (uint8_t i = 0; i < 2; i++) {
+    if (!EDGE_FLOW_SEARCH_PRIOR || opticflow->just_switched_method || search_frame_offset[i] != previous_frame_offset[i]) {
+      search_min[i] = -disp_range;
+      search_max[i] = disp_range;
+      search_frame_offset[i] = previous_frame_offset[i];
+    }
+  }
+
   // Estimate pixel wise displacement of the edge histograms for x and y direction
-  calculate_edge_displacement(edge_hist_x, prev_edge_histogram_x,
-                              displacement.x, img->w,
-                              window_size, disp_range,  der_shift_x);
-  calculate_edge_displacement(edge_hist_y, prev_edge_histogram_y,
-                              displacement.y, img->h,
-                              window_size, disp_range, der_shift_y);
+  calculate_edge_displacement_range(edge_hist_x, prev_edge_histogram_x,
+                                    displacement.x, img->w,
+                                    window_size, disp_range, der_shift_x, search_min[0], search_max[0]);
+  calculate_edge_displacement_range(edge_hist_y, prev_edge_histogram_y,
+                                    displacement.y, img->h,
+                                    window_size, disp_range, der_shift_y, search_min[1], search_max[1]);
+  edge_displacement_search_range(displacement.x, img->w, window_size + disp_range, disp_range,
+                                 &search_min[0], &search_max[0]);
+  edge_displacement_search_range(displacement.y, img->h, window_size + disp_range, disp_range,
+                                 &search_min[1], &search_max[1]);
 
   // Fit a line on the pixel displacement to estimate
   // the global pixel flow and divergence (RES is resolution)
@@ -37,6 +37,9 @@
 #include "lib/vision/image.h"
 #include "lib/v4l/v4l2.h"
 
+/** Maximum number of pyramid levels kept between frames (same as the maximum of the setting) */
+#define OPTICFLOW_MAX_PYRAMID_LEVEL 10
+
 struct opticflow_t {
   bool got_first_img;                 ///< If we got a image to work with
   bool just_switched_method;        ///< Boolean to check if methods has been switched (for reinitialization)
@@ -61,6 +64,12 @@ struct opticflow_t {
   uint8_t max_iterations;               ///< The maximum amount of iterations the Lucas Kanade algorithm should do
   uint8_t threshold_vec;                ///< The threshold in x, y subpixels which the algorithm should stop
   uint8_t pyramid_level;              ///< Number of pyramid levels used in Lucas Kanade algorithm (0 == no pyramids used)
+  struct image_t pyramid[OPTICFLOW_MAX_PYRAMID_LEVEL + 1];      ///< Pyramid of the current gray image
+  struct image_t prev_pyramid[OPTICFLOW_MAX_PYRAMID_LEVEL + 1]; ///< Pyramid of the previous gray image
+  uint8_t pyramid_alloc_level;        ///< Number of allocated pyramid levels (0 == no pyramids allocated)
+  uint16_t pyramid_border_size;       ///< Padding of the allocated pyramid levels
+  bool pyramid_valid;                 ///< Whether the pyramid is built from the current gray image
+  bool prev_pyramid_valid;            ///< Whether the previous pyramid is built from the previous gray image
 
   uint16_t max_track_corners;            ///< Maximum amount of corners Lucas Kanade should track
   bool fast9_adaptive;                  ///< Whether the FAST9 threshold should be adaptive
@@ -21,13 +21,23 @@
 
 /**
  * @file modules/computer_vision/qrcode/qr_code.c
+ *
+ * The codes are decoded by a pool of worker threads, each with its own zbar scanner.
+ * The video thread only copies the gray values of the region to scan to an idle worker,
+ * frames arriving while all the workers are busy are skipped.
+ * Once a code is found, the next frames are scanned only around it, and the full frame
+ * is scanned again every QRCODE_FULL_FRAME_PERIOD scans and when the code is lost.
+ * The results are sent from the periodic function as soon as they are available.
  */
 
 #include "qr_code.h"
 #include "cv.h"
+#include "modules/core/abi.h"
 
 #include "zbar.h"
 #include <stdio.h>
+#include <string.h>
+#include <pthread.h>
 
 #ifndef QRCODE_DRAW_RECTANGLE
 #define QRCODE_DRAW_RECTANGLE FALSE
@@ -39,8 +49,102 @@ bool drawRectangleAroundQRCode = QRCODE_DRAW_RECTANGLE;
 #endif
 PRINT_CONFIG_VAR(QRCODE_FPS)
 
+#ifndef QRCODE_NB_WORKERS
+#define QRCODE_NB_WORKERS 2       ///< Number of decoding threads
+#endif
+PRINT_CONFIG_VAR(QRCODE_NB_WORKERS)
+
+#ifndef QRCODE_ROI_MARGIN
+#define QRCODE_ROI_MARGIN 40      ///< Margin in pixels around the last code that is scanned
+#endif
+PRINT_CONFIG_VAR(QRCODE_ROI_MARGIN)
+
+#ifndef QRCODE_FULL_FRAME_PERIOD
+#define QRCODE_FULL_FRAME_PERIOD 10   ///< Number of scans between full frame scans when a code is tracked
+#endif
+PRINT_CONFIG_VAR(QRCODE_FULL_FRAME_PERIOD)
+
+#ifndef QRCODE_ROI_TIMEOUT
+#define QRCODE_ROI_TIMEOUT 5      ///< Number of scans without code before scanning the full frame again
+#endif
+PRINT_CONFIG_VAR(QRCODE_ROI_TIMEOUT)
+
+/** Maximum number of codes kept from a frame */
+#define QRCODE_MAX_SYMBOLS 4
+/** Maximum length of the content of a code */
+#define QRCODE_MAX_DATA_LEN 64
+/** Maximum number of corners of a code */
+#define QRCODE_MAX_CORNERS 4
+
+/** Decoded code */
+struct qrcode_symbol_t {
+  char data[QRCODE_MAX_DATA_LEN + 1];         ///< Content of the code
+  struct point_t corners[QRCODE_MAX_CORNERS]; ///< Corners in the frame
+  uint8_t nb_corners;                         ///< Number of corners
+  int quality;                                ///< Quality given by zbar
+};
+
+/** Decoding results of a frame */
+struct qrcode_result_t {
+  struct qrcode_symbol_t symbols[QRCODE_MAX_SYMBOLS];
+  uint8_t nb_symbols;
+  uint16_t frame_w;             ///< Size of the frame
+  uint16_t frame_h;
+  uint32_t frame_nr;            ///< Number of the scan of the frame
+  bool updated;                 ///< New results, not sent yet
+};
+
+/** Region of a frame to decode */
+struct qrcode_roi_t {
+  uint16_t x;
+  uint16_t y;
+  uint16_t w;
+  uint16_t h;
+};
+
+/** Decoding thread */
+struct qrcode_worker_t {
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t job_available;
+  bool busy;                    ///< A job is waiting or being decoded
+  struct image_t gray;          ///< Gray values of the region to decode
+  struct qrcode_roi_t roi;      ///< Region of the frame in gray
+  uint16_t frame_w;             ///< Size of the frame
+  uint16_t frame_h;
+  uint32_t frame_nr;            ///< Number of the scan of the frame
+  zbar_image_scanner_t *scanner;
+};
+
+static struct qrcode_worker_t qrcode_workers[QRCODE_NB_WORKERS];
+
+// tracking and results, shared by the video, decoding and autopilot threads
+static pthread_mutex_t qrcode_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct qrcode_result_t qrcode_result;
+static struct qrcode_roi_t qrcode_roi;    ///< Region around the last codes
+static bool qrcode_roi_valid = false;
+static uint8_t qrcode_roi_misses = 0;
+static uint32_t qrcode_frame_nr = 0;     ///< Number of frames scanned (frames skipped while the workers are busy are not counted)
+static uint32_t qrcode_last_full_frame = 0;
+
+static void *qrcode_worker_thread(void *arg);
+
 void qrcode_init(void)
 {
+  for (uint8_t i = 0; i < QRCODE_NB_WORKERS; i++) {
+    struct qrcode_worker_t *worker = &qrcode_workers[i];
+    worker->busy = false;
+    worker->gray.buf = NULL;
+    worker->gray.buf_size = 0;
+    worker->scanner = zbar_image_scanner_create();
+    pthread_mutex_init(&worker->mutex, NULL);
+    pthread_cond_init(&worker->job_available, NULL);
+    pthread_create(&worker->thread, NULL, qrcode_worker_thread, worker);
+#ifndef __APPLE__
+    pthread_setname_np(worker->thread, "qrcode");
+#endif
+  }
+
   // Add qrscan to the list of image processing tasks in video_thread
   cv_add_to_device(&QRCODE_CAMERA, qrscan, QRCODE_FPS, 0);
 }
@@ -48,86 +152,218 @@ void qrcode_init(void)
 // Telemetry
 #include "modules/datalink/telemetry.h"
 
-
-zbar_image_scanner_t *scanner = 0;
-
-struct image_t *qrscan(struct image_t *img, uint8_t camera_id)
+void qrcode_periodic(void)
 {
-  int i, j;
-
-  // Create the JPEG encoded image
-  struct image_t gray;
-  image_create(&gray, img->w, img->h, IMAGE_GRAYSCALE);
-
-  uint8_t *ii = (uint8_t *) img->buf;
-  uint8_t *oi = (uint8_t *) gray.buf;
+  static struct qrcode_result_t result;
+  pthread_mutex_lock(&qrcode_mutex);
+  if (!qrcode_result.updated) {
+    pthread_mutex_unlock(&qrcode_mutex);
+    return;
+  }
+  result = qrcode_result;
+  qrcode_result.updated = false;
+  pthread_mutex_unlock(&qrcode_mutex);
 
-  for (j = 0; j < img->h; j++) {
-    for (i = 0; i < img->w; i++) {
-      oi[j * img->w + i] = ii[(j * img->w + i) * 2 + 1];
+  for (uint8_t i = 0; i < result.nb_symbols; i++) {
+    struct qrcode_symbol_t *symbol = &result.symbols[i];
+    int16_t x_min = result.frame_w, x_max = 0, y_min = result.frame_h, y_max = 0;
+    for (uint8_t c = 0; c < symbol->nb_corners; c++) {
+      x_min = Min(x_min, (int16_t)symbol->corners[c].x);
+      x_max = Max(x_max, (int16_t)symbol->corners[c].x);
+      y_min = Min(y_min, (int16_t)symbol->corners[c].y);
+      y_max = Max(y_max, (int16_t)symbol->corners[c].y);
     }
+    // center relative to the image center, as the other visual detections
+    AbiSendMsgVISUAL_DETECTION(QRCODE_DETECTION_ID, (x_min + x_max) / 2 - result.frame_w / 2,
+                               (y_min + y_max) / 2 - result.frame_h / 2, x_max - x_min, y_max - y_min, symbol->quality, 0);
+#if DOWNLINK
+    DOWNLINK_SEND_INFO_MSG(DefaultChannel, DefaultDevice, strlen(symbol->data), symbol->data);
+#endif
   }
+}
 
-  if (scanner == 0) {
-    // create a reader
-    scanner = zbar_image_scanner_create();
-
-    // configure the reader
-    //zbar_image_scanner_set_config(scanner, 0, ZBAR_CFG_POSITION, 1);
-    //zbar_increase_verbosity();
-  }
+/**
+ * Decode the region of a frame and update the results and the region to scan
+ */
+static void qrcode_decode(struct qrcode_worker_t *worker)
+{
+  struct qrcode_symbol_t symbols[QRCODE_MAX_SYMBOLS];
+  uint8_t nb_symbols = 0;
 
   // wrap image data
   zbar_image_t *image = zbar_image_create();
   zbar_image_set_format(image, *(int *)"Y800");
-  zbar_image_set_size(image, gray.w, gray.h);
-  zbar_image_set_data(image, gray.buf, gray.buf_size, zbar_image_free_data);
+  zbar_image_set_size(image, worker->roi.w, worker->roi.h);
+  zbar_image_set_data(image, worker->gray.buf, worker->roi.w * worker->roi.h, NULL);
 
   // scan the image for barcodes
-  int n = zbar_scan_image(scanner, image);
+  int n = zbar_scan_image(worker->scanner, image);
 
   if (n < 0) {
     printf("zbar_scan_image returned %d\n", n);
   }
 
-  // extract results
+  // extract results, in frame coordinates
   const zbar_symbol_t *symbol = zbar_image_first_symbol(image);
-  for (; symbol; symbol = zbar_symbol_next(symbol)) {
-    // do something useful with results
-    zbar_symbol_type_t typ = zbar_symbol_get_type(symbol);
-    char *data = (char *)zbar_symbol_get_data(symbol);
+  for (; symbol && nb_symbols < QRCODE_MAX_SYMBOLS; symbol = zbar_symbol_next(symbol)) {
+    struct qrcode_symbol_t *s = &symbols[nb_symbols++];
+    strncpy(s->data, zbar_symbol_get_data(symbol), QRCODE_MAX_DATA_LEN);
+    s->data[QRCODE_MAX_DATA_LEN] = '\0';
+    s->quality = zbar_symbol_get_quality(symbol);
+    s->nb_corners = Min(zbar_symbol_get_loc_size(symbol), QRCODE_MAX_CORNERS);
+    for (uint8_t c = 0; c < s->nb_corners; c++) {
+      s->corners[c].x = worker->roi.x + zbar_symbol_get_loc_x(symbol, c);
+      s->corners[c].y = worker->roi.y + zbar_symbol_get_loc_y(symbol, c);
+    }
     printf("decoded %s symbol \"%s\" at %d %d\n",
-           zbar_get_symbol_name(typ), data, zbar_symbol_get_loc_x(symbol, 0), zbar_symbol_get_loc_y(symbol, 0));
+           zbar_get_symbol_name(zbar_symbol_get_type(symbol)), s->data, s->corners[0].x, s->corners[0].y);
+  }
 
-    if (drawRectangleAroundQRCode) {
-      uint8_t cornerIndex;
-      struct point_t from;
-      struct point_t to;
+  // clean up
+  zbar_image_destroy(image);
 
-      for (cornerIndex = 0; cornerIndex < zbar_symbol_get_loc_size(symbol); cornerIndex++) {
-        // Determine where to draw from and to
-        uint8_t nextCorner = (cornerIndex + 1) % zbar_symbol_get_loc_size(symbol);
+  pthread_mutex_lock(&qrcode_mutex);
+  // results of an older frame than the last ones (from another worker) are dropped
+  if (worker->frame_nr > qrcode_result.frame_nr) {
+    bool full_frame = (worker->roi.w == worker->frame_w && worker->roi.h == worker->frame_h);
+    if (nb_symbols > 0) {
+      memcpy(qrcode_result.symbols, symbols, nb_symbols * sizeof(struct qrcode_symbol_t));
+      qrcode_result.nb_symbols = nb_symbols;
+      qrcode_result.frame_w = worker->frame_w;
+      qrcode_result.frame_h = worker->frame_h;
+      qrcode_result.frame_nr = worker->frame_nr;
+      qrcode_result.updated = true;
 
-        from.x = zbar_symbol_get_loc_x(symbol, cornerIndex);
-        from.y = zbar_symbol_get_loc_y(symbol, cornerIndex);
+      // next region: around the codes found
+      int32_t x_min = worker->frame_w, x_max = 0, y_min = worker->frame_h, y_max = 0;
+      for (uint8_t i = 0; i < nb_symbols; i++) {
+        for (uint8_t c = 0; c < symbols[i].nb_corners; c++) {
+          x_min = Min(x_min, (int32_t)symbols[i].corners[c].x);
+          x_max = Max(x_max, (int32_t)symbols[i].corners[c].x);
+          y_min = Min(y_min, (int32_t)symbols[i].corners[c].y);
+          y_max = Max(y_max, (int32_t)symbols[i].corners[c].y);
+        }
+      }
+      x_min -= QRCODE_ROI_MARGIN;
+      y_min -= QRCODE_ROI_MARGIN;
+      x_max += QRCODE_ROI_MARGIN;
+      y_max += QRCODE_ROI_MARGIN;
+      Bound(x_min, 0, worker->frame_w - 1);
+      Bound(y_min, 0, worker->frame_h - 1);
+      Bound(x_max, x_min, worker->frame_w - 1);
+      Bound(y_max, y_min, worker->frame_h - 1);
+      qrcode_roi.x = x_min;
+      qrcode_roi.y = y_min;
+      qrcode_roi.w = x_max - x_min + 1;
+      qrcode_roi.h = y_max - y_min + 1;
+      qrcode_roi_valid = true;
+      qrcode_roi_misses = 0;
+    } else if (full_frame || ++qrcode_roi_misses >= QRCODE_ROI_TIMEOUT) {
+      // lost the code
+      qrcode_roi_valid = false;
+      qrcode_result.nb_symbols = 0;
+    }
+  }
+  pthread_mutex_unlock(&qrcode_mutex);
+}
 
-        to.x = zbar_symbol_get_loc_x(symbol, nextCorner);
-        to.y = zbar_symbol_get_loc_y(symbol, nextCorner);
+static void *qrcode_worker_thread(void *arg)
+{
+  struct qrcode_worker_t *worker = arg;
 
-        // Draw a line between these two corners
-        image_draw_line(img, &to, &from);
+  pthread_mutex_lock(&worker->mutex);
+  while (true) {
+    // Wait for a new region to decode
+    while (!worker->busy) {
+      pthread_cond_wait(&worker->job_available, &worker->mutex);
+    }
+    // The video thread does not touch the job while busy
+    pthread_mutex_unlock(&worker->mutex);
+    qrcode_decode(worker);
+    pthread_mutex_lock(&worker->mutex);
+    worker->busy = false;
+  }
+  return NULL;
+}
+
+/**
+ * Copy the Y values of a region of an UYVY image
+ */
+static void qrcode_extract_gray(struct image_t *img, struct image_t *gray, struct qrcode_roi_t *roi)
+{
+  if (gray->buf_size < (uint32_t)img->w * img->h) {
+    if (gray->buf != NULL) {
+      image_free(gray);
+    }
+    image_create(gray, img->w, img->h, IMAGE_GRAYSCALE);
+  }
+
+  uint8_t *ii = (uint8_t *) img->buf;
+  uint8_t *oi = (uint8_t *) gray->buf;
+
+  for (uint16_t j = 0; j < roi->h; j++) {
+    const uint8_t *row = &ii[((roi->y + j) * img->w + roi->x) * 2 + 1];
+    for (uint16_t i = 0; i < roi->w; i++) {
+      oi[j * roi->w + i] = row[2 * i];
+    }
+  }
+}
+
+struct image_t *qrscan(struct image_t *img, uint8_t camera_id)
+{
+  // Find an idle worker, else skip the frame
+  struct qrcode_worker_t *worker = NULL;
+  for (uint8_t i = 0; i < QRCODE_NB_WORKERS && worker == NULL; i++) {
+    if (pthread_mutex_trylock(&qrcode_workers[i].mutex) == 0) {
+      if (!qrcode_workers[i].busy) {
+        worker = &qrcode_workers[i];
+      } else {
+        pthread_mutex_unlock(&qrcode_workers[i].mutex);
       }
+    }
+  }
+
+  if (worker != NULL) {
+    qrcode_frame_nr++;
 
+    // Scan around the last codes, or the full frame from time to time
+    struct qrcode_roi_t roi = { 0, 0, img->w, img->h };
+    pthread_mutex_lock(&qrcode_mutex);
+    if (qrcode_roi_valid && qrcode_frame_nr - qrcode_last_full_frame < QRCODE_FULL_FRAME_PERIOD
+        && qrcode_roi.x + qrcode_roi.w <= img->w && qrcode_roi.y + qrcode_roi.h <= img->h) {
+      roi = qrcode_roi;
+    } else {
+      qrcode_last_full_frame = qrcode_frame_nr;
     }
-    // TODO: not allowed to access telemetry from vision thread
-#if DOWNLINK
-    DOWNLINK_SEND_INFO_MSG(DefaultChannel, DefaultDevice, strlen(data), data);
-#endif
+    pthread_mutex_unlock(&qrcode_mutex);
+
+    qrcode_extract_gray(img, &worker->gray, &roi);
+    worker->roi = roi;
+    worker->frame_w = img->w;
+    worker->frame_h = img->h;
+    worker->frame_nr = qrcode_frame_nr;
+    worker->busy = true;
+    pthread_cond_signal(&worker->job_available);
+    pthread_mutex_unlock(&worker->mutex);
   }
 
-// clean up
-  zbar_image_destroy(image);
-  //zbar_image_scanner_destroy(scanner);
+  if (drawRectangleAroundQRCode) {
+    // Draw the last codes found
+    pthread_mutex_lock(&qrcode_mutex);
+    for (uint8_t i = 0; i < qrcode_result.nb_symbols; i++) {
+      struct qrcode_symbol_t *symbol = &qrcode_result.symbols[i];
+      for (uint8_t cornerIndex = 0; cornerIndex < symbol->nb_corners; cornerIndex++) {
+        // Determine where to draw from and to
+        uint8_t nextCorner = (cornerIndex + 1) % symbol->nb_corners;
+        struct point_t from = symbol->corners[cornerIndex];
+        struct point_t to = symbol->corners[nextCorner];
+
+        // Draw a line between these two corners
+        image_draw_line(img, &to, &from);
+      }
+    }
+    pthread_mutex_unlock(&qrcode_mutex);
+  }
 
   return img;
 }
@@ -35,6 +35,7 @@
 
 extern bool drawRectangleAroundQRCode;
 extern void qrcode_init(void);
+extern void qrcode_periodic(void);
 extern struct image_t *qrscan(struct image_t *img, uint8_t camera_id);
 
 
@@ -43,6 +43,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "modules/computer_vision/lib/vision/image.h"
+#include "modules/computer_vision/lib/vision/color_mask.h"
 #include "paparazzi.h"
 
 // to debug the algorithm, uncomment the define:
@@ -69,6 +70,9 @@ uint8_t color_U_max;
 uint8_t color_V_min;
 uint8_t color_V_max;
 
+// Color mask of the current image, NULL if the pixels are checked directly
+static struct color_mask_t *color_mask;
+
 // Other settings:
 int min_pixel_size;
 
@@ -160,6 +164,10 @@ int snake_gate_detection(struct image_t *img, int n_samples, int min_px_size, fl
   color_V_max  = color_VM;
   min_pixel_size = min_px_size;
 
+  // All the color checks of this image are mask lookups, the mask may be shared with other detectors
+  struct color_range_t range = { color_Y_min, color_Y_max, color_U_min, color_U_max, color_V_min, color_V_max };
+  color_mask = color_mask_acquire(img, &range);
+
   int x, y;
   best_quality = 0;
   best_gate->quality = 0;
@@ -420,6 +428,10 @@ int snake_gate_detection(struct image_t *img, int n_samples, int min_px_size, fl
   memcpy(previous_best_gate.x_corners, best_gate->x_corners, sizeof(best_gate->x_corners));
   memcpy(previous_best_gate.y_corners, best_gate->y_corners, sizeof(best_gate->y_corners));
 
+  // the image is changed from here on
+  color_mask_release(color_mask);
+  color_mask = NULL;
+
   //color filtered version of image for overlay and debugging
   if (FILTER_IMAGE) { //filter) {
     image_yuv422_colorfilt(img, img, color_Y_min, color_Y_max, color_U_min, color_U_max, color_V_min, color_V_max);
@@ -767,6 +779,17 @@ float check_inside(struct image_t *im, int x, int y, int sz, int n_samples_in)
     return 1.0f;
   }
 
+  if (color_mask != NULL) {
+    // exact ratio over the box, counted as the samples it replaces
+    // (note the switch of x and y, see check_color_snake_gate_detection)
+    uint32_t n_pixels;
+    int half_sz = abs(sz) / 2;
+    num_color_center = color_mask_count_rect(color_mask, y - half_sz, x - half_sz, y - half_sz + abs(sz) - 1,
+                       x - half_sz + abs(sz) - 1, &n_pixels);
+    n_total_samples += n_samples_in;
+    return (n_pixels == 0) ? 1.0f : num_color_center / (float)n_pixels;
+  }
+
   for (int i = 0; i < n_samples_in; i++) {
     // get a random coordinate:
     int x_in = x + (rand() % sz) - (0.5 * sz);
@@ -1102,10 +1125,15 @@ void refine_single_corner(struct image_t *im, int *corner_x, int *corner_y, int
 int check_color_snake_gate_detection(struct image_t *im, int x, int y)
 {
 
-  // Call the function in image.c with the color thresholds:
   // Please note that we have to switch x and y around here, due to the strange sensor mounting in the Bebop:
-  int success = check_color_yuv422(im, y, x, color_Y_min, color_Y_max, color_U_min, color_U_max, color_V_min,
-                                   color_V_max);
+  int success;
+  if (color_mask != NULL) {
+    success = color_mask_pixel(color_mask, y, x);
+  } else {
+    // Call the function in image.c with the color thresholds:
+    success = check_color_yuv422(im, y, x, color_Y_min, color_Y_max, color_U_min, color_U_max, color_V_min,
+                                 color_V_max);
+  }
   n_total_samples++;
   /*
   #ifdef DEBUG_SNAKE_GATE
@@ -31,12 +31,14 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "modules/computer_vision/cv.h"
 #include "modules/computer_vision/textons.h"
 #include "mcu_periph/sys_time.h"
 #include "generated/airframe.h"
 
-float ** **dictionary;
+float *dictionary = NULL;
+uint32_t dictionary_stride = 0;
 uint32_t learned_samples = 0;
 uint8_t dictionary_initialized = 0;
 float *texton_distribution;
@@ -113,6 +115,24 @@ PRINT_CONFIG_VAR(TEXTONS_DICTIONARY_NUMBER)
 #define TEXTONS_DICTIONARY_PATH /data/ftp/internal_000
 #endif
 
+/** Number of patches extracted from the image before looking up their textons */
+#ifndef TEXTONS_BATCH_SIZE
+#define TEXTONS_BATCH_SIZE 64
+#endif
+
+/** Use NEON for the texton distances, only on ARM processors */
+#ifndef TEXTONS_USE_NEON
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define TEXTONS_USE_NEON TRUE
+#else
+#define TEXTONS_USE_NEON FALSE
+#endif
+#endif
+
+#if TEXTONS_USE_NEON
+#include <arm_neon.h>
+#endif
+
 struct video_listener *listener = NULL;
 
 uint8_t running = TEXTONS_RUN;
@@ -135,6 +155,98 @@ float alpha = 0.0;
 // File pointer for saving the dictionary
 static FILE *dictionary_logger = NULL;
 
+// patch size the dictionary is allocated for
+static uint8_t dictionary_patch_size = 0;
+// batch of patches extracted from the image, dictionary_stride floats each
+static float *patches = NULL;
+
+/**
+ * Allocate the dictionary and the patch batch for the current patch size.
+ * A texton is stored as rows of U/Y/V/Y values, padded with zeros to a multiple of 4 floats.
+ * @return false if the allocation failed, textons are then stopped
+ */
+static bool textons_alloc(void)
+{
+  free(dictionary);
+  free(patches);
+  dictionary = NULL;
+  patches = NULL;
+  dictionary_patch_size = patch_size;
+  dictionary_stride = ((uint32_t)patch_size * patch_size * 2 + 3) & ~3u;
+
+  const size_t dictionary_size = MAX_N_TEXTONS * dictionary_stride * sizeof(float);
+  const size_t patches_size = TEXTONS_BATCH_SIZE * dictionary_stride * sizeof(float);
+  if (posix_memalign((void **)&dictionary, 16, dictionary_size) != 0 ||
+      posix_memalign((void **)&patches, 16, patches_size) != 0) {
+    perror("Textons: unable to allocate the dictionary");
+    running = 0;
+    return false;
+  }
+  memset(dictionary, 0, dictionary_size);
+  memset(patches, 0, patches_size);
+  return true;
+}
+
+/**
+ * Copy an image patch to a flat float array.
+ * @param[in] frame The YUV image data
+ * @param[in] width The width of the image
+ * @param[in] x, y The top left corner of the patch
+ * @param[out] patch The patch values
+ */
+static inline void extract_patch(uint8_t *frame, uint16_t width, int x, int y, float *patch)
+{
+  for (int i = 0; i < patch_size; i++) {
+    uint8_t *buf = frame + (width * 2 * (i + y)) + 2 * x;
+    for (int j = 0; j < 2 * patch_size; j++) {
+      *patch++ = (float) buf[j];
+    }
+  }
+}
+
+/**
+ * Squared euclidean distance between a patch and a texton.
+ */
+static inline float texton_distance(const float *patch, const float *texton)
+{
+#if TEXTONS_USE_NEON
+  float32x4_t acc = vdupq_n_f32(0.f);
+  for (uint32_t k = 0; k < dictionary_stride; k += 4) {
+    float32x4_t d = vsubq_f32(vld1q_f32(patch + k), vld1q_f32(texton + k));
+    acc = vmlaq_f32(acc, d, d);
+  }
+  float32x2_t sum = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+  return vget_lane_f32(vpadd_f32(sum, sum), 0);
+#else
+  // four partial sums, like the NEON lanes
+  float acc[4] = {0.f, 0.f, 0.f, 0.f};
+  for (uint32_t k = 0; k < dictionary_stride; k += 4) {
+    for (uint8_t l = 0; l < 4; l++) {
+      const float d = patch[k + l] - texton[k + l];
+      acc[l] += d * d;
+    }
+  }
+  return (acc[0] + acc[2]) + (acc[1] + acc[3]);
+#endif
+}
+
+/**
+ * Find the closest texton of a patch in the dictionary.
+ */
+static uint8_t nearest_texton(const float *patch)
+{
+  uint8_t assignment = 0;
+  float min_dist = texton_distance(patch, dictionary);
+  for (uint8_t texton = 1; texton < n_textons; texton++) {
+    const float dist = texton_distance(patch, &dictionary[texton * dictionary_stride]);
+    if (dist < min_dist) {
+      min_dist = dist;
+      assignment = texton;
+    }
+  }
+  return assignment;
+}
+
 /**
  * Main texton processing function that first either loads or learns a dictionary and then extracts the texton histogram.
  * @param[out] *img The output image
@@ -154,6 +266,13 @@ struct image_t *texton_func(struct image_t *img, UNUSED uint8_t p)
   // if patch size odd, correct:
   if (patch_size % 2 == 1) { patch_size++; }
 
+  // the patch size changed, the dictionary has to be loaded or learned again:
+  if (patch_size != dictionary_patch_size) {
+    if (!textons_alloc()) { return img; }
+    dictionary_ready = 0;
+    dictionary_initialized = 0;
+  }
+
   // check whether we have to reinitialize the dictionary:
   if (reinitialize_dictionary) {
     // set all vars to trigger a reinitialization and learning phase of the dictionary:
@@ -226,11 +345,8 @@ struct image_t *texton_func(struct image_t *img, UNUSED uint8_t p)
  */
 void DictionaryTrainingYUV(uint8_t *frame, uint16_t width, uint16_t height)
 {
-  int i, j, w, s, texton, c; // iterators
+  int w, s, b, k; // iterators
   int x, y; // image coordinates
-  float error_texton; // distance between an image patch and a texton
-
-  uint8_t *buf;
 
   // ***********************
   //   DICTIONARY LEARNING
@@ -248,119 +364,43 @@ void DictionaryTrainingYUV(uint8_t *frame, uint16_t width, uint16_t height)
       // select a coordinate
       x = rand() % (width - patch_size);
       y = rand() % (height - patch_size);
-
-      //printf("(x,y) = (%d,%d), (w,h) = (%d,%d), ps = %d\n", x, y, width, height, patch_size);
-      // take the sample
-      for (i = 0; i < patch_size; i++) {
-        buf = frame + (width * 2 * (i + y)) + 2 * x;
-        for (j = 0; j < patch_size; j++) {
-          // put it in a texton
-          printf("Setting dictionary:\n");
-          // U/V component
-
-          dictionary[w][i][j][0] = (float) * buf;
-          buf += 1;
-          // Y1/Y2 component
-          dictionary[w][i][j][1] = (float) * buf;
-          buf += 1;
-          printf("Done!\n");
-        }
-      }
+      // take the sample and put it in a texton
+      extract_patch(frame, width, x, y, &dictionary[w * dictionary_stride]);
     }
     dictionary_initialized = 1;
   } else {
     // ********
     // LEARNING
     // ********
-    printf("Learning!");
     alpha = ((float) alpha_uint) / 255.0;
 
-    float *texton_distances, * **patch;
-    texton_distances = (float *)calloc(n_textons, sizeof(float));
-    patch = (float ** *)calloc(patch_size, sizeof(float **));
+    // Extract and learn from n_samples_image per image, in batches
+    for (s = 0; s < (int) n_samples_image; s += TEXTONS_BATCH_SIZE) {
+      const int n_batch = Min(TEXTONS_BATCH_SIZE, (int) n_samples_image - s);
 
-    for (i = 0; i < patch_size; i++) {
-      patch[i] = (float **)calloc(patch_size, sizeof(float *));
-      for (j = 0; j < patch_size; j++) {
-        patch[i][j] = (float *)calloc(2, sizeof(float));
-      }
-    }
-
-    // Extract and learn from n_samples_image per image
-    for (s = 0; s < (int) n_samples_image; s++) {
-      // select a random sample from the image
-      x = rand() % (width - patch_size);
-      y = rand() % (height - patch_size);
-
-      // reset texton_distances
-      for (texton = 0; texton < n_textons; texton++) {
-        texton_distances[texton] = 0;
+      // extract random samples from the image
+      for (b = 0; b < n_batch; b++) {
+        x = rand() % (width - patch_size);
+        y = rand() % (height - patch_size);
+        extract_patch(frame, width, x, y, &patches[b * dictionary_stride]);
       }
 
-      // extract sample
-      for (i = 0; i < patch_size; i++) {
-        buf = frame + (width * 2 * (i + y)) + 2 * x;
-        for (j = 0; j < patch_size; j++) {
-          // U/V component
-          patch[i][j][0] = (float) * buf;
-          buf += 1;
-          // Y1/Y2 component
-          patch[i][j][1] = (float) * buf;
-          buf += 1;
-        }
-      }
-
-      // determine distances to the textons:
-      for (i = 0; i < patch_size; i++) {
-        for (j = 0; j < patch_size; j++) {
-          for (c = 0; c < 2; c++) {
-            // determine the distance to textons
-            for (texton = 0; texton < n_textons; texton++) {
-              texton_distances[texton] += (patch[i][j][c] - dictionary[texton][i][j][c])
-                                          * (patch[i][j][c] - dictionary[texton][i][j][c]);
-            }
-          }
-        }
-      }
+      for (b = 0; b < n_batch; b++) {
+        float *patch = &patches[b * dictionary_stride];
 
-      // search the closest texton
-      int assignment = 0;
-      float min_dist = texton_distances[0];
-      for (texton = 1; texton < n_textons; texton++) {
-        if (texton_distances[texton] < min_dist) {
-          min_dist = texton_distances[texton];
-          assignment = texton;
-        }
-      }
+        // search the closest texton
+        float *texton = &dictionary[nearest_texton(patch) * dictionary_stride];
 
-      // move the neighbour closer to the input
-      for (i = 0; i < patch_size; i++) {
-        for (j = 0; j < patch_size; j++) {
-          for (c = 0; c < 2; c++) {
-            error_texton = patch[i][j][c] - dictionary[assignment][i][j][c];
-            dictionary[assignment][i][j][c] += (alpha * error_texton);
-          }
+        // move the neighbour closer to the input
+        for (k = 0; k < (int) dictionary_stride; k++) {
+          texton[k] += alpha * (patch[k] - texton[k]);
         }
-      }
-
-      // Augment the number of learned samples:
-      learned_samples++;
-    }
 
-    // Free the allocated memory:
-    for (i = 0; i < patch_size; i++) {
-      for (j = 0; j < patch_size; j++) {
-        free(patch[i][j]);
+        // Augment the number of learned samples:
+        learned_samples++;
       }
-      free(patch[i]);
     }
-    free(patch);
-    free(texton_distances);
   }
-
-  // Free the buffer
-  buf = NULL;
-  free(buf);
 }
 
 /**
@@ -371,27 +411,15 @@ void DictionaryTrainingYUV(uint8_t *frame, uint16_t width, uint16_t height)
  */
 void DistributionExtraction(uint8_t *frame, uint16_t width, uint16_t height)
 {
-  int i, j, texton, c; // iterators
+  int i, b; // iterators
   int x, y; // coordinates
   int n_extracted_textons = 0;
-
-  uint8_t *buf;
+  int n_batch = 0;
 
   // ************************
   //       EXECUTION
   // ************************
 
-  // Allocate memory for texton distances and image patch:
-  float *texton_distances, * **patch;
-  texton_distances = (float *)calloc(n_textons, sizeof(float));
-  patch = (float ** *)calloc(patch_size, sizeof(float **));
-  for (i = 0; i < patch_size; i++) {
-    patch[i] = (float **)calloc(patch_size, sizeof(float *));
-    for (j = 0; j < patch_size; j++) {
-      patch[i][j] = (float *)calloc(2, sizeof(float));
-    }
-  }
-
   int finished = 0;
   x = 0;
   y = 0;
@@ -401,50 +429,9 @@ void DistributionExtraction(uint8_t *frame, uint16_t width, uint16_t height)
       y = border_height + rand() % (height - patch_size - 2 * border_height);
     }
 
-    // reset texton_distances
-    for (texton = 0; texton < n_textons; texton++) {
-      texton_distances[texton] = 0;
-    }
-
     // extract sample
-    for (i = 0; i < patch_size; i++) {
-      buf = frame + (width * 2 * (i + y)) + 2 * x;
-      for (j = 0; j < patch_size; j++) {
-        // U/V component
-        patch[i][j][0] = (float) * buf;
-        buf += 1;
-        // Y1/Y2 component
-        patch[i][j][1] = (float) * buf;
-        buf += 1;
-      }
-    }
-
-    // determine distances:
-    for (i = 0; i < patch_size; i++) {
-      for (j = 0; j < patch_size; j++) {
-        for (c = 0; c < 2; c++) {
-          // determine the distance to words
-          for (texton = 0; texton < n_textons; texton++) {
-            texton_distances[texton] += (patch[i][j][c] - dictionary[texton][i][j][c])
-                                        * (patch[i][j][c] - dictionary[texton][i][j][c]);
-          }
-        }
-      }
-    }
-
-    // determine the nearest neighbour
-    // search the closest centroid
-    int assignment = 0;
-    float min_dist = texton_distances[0];
-    for (texton = 1; texton < n_textons; texton++) {
-      if (texton_distances[texton] < min_dist) {
-        min_dist = texton_distances[texton];
-        assignment = texton;
-      }
-    }
-
-    // put the assignment in the histogram
-    texton_distribution[assignment]++;
+    extract_patch(frame, width, x, y, &patches[n_batch * dictionary_stride]);
+    n_batch++;
     n_extracted_textons++;
 
     if (!FULL_SAMPLING && n_extracted_textons == (int) n_samples_image) {
@@ -467,6 +454,14 @@ void DistributionExtraction(uint8_t *frame, uint16_t width, uint16_t height)
         finished = 1;
       }
     }
+
+    // put the nearest textons of the batch in the histogram
+    if (n_batch == TEXTONS_BATCH_SIZE || finished) {
+      for (b = 0; b < n_batch; b++) {
+        texton_distribution[nearest_texton(&patches[b * dictionary_stride])]++;
+      }
+      n_batch = 0;
+    }
   }
 
   // Normalize distribution:
@@ -475,22 +470,6 @@ void DistributionExtraction(uint8_t *frame, uint16_t width, uint16_t height)
       texton_distribution[i] = texton_distribution[i] / (float) n_extracted_textons;
     }
   }
-  // printf("\n");
-
-
-  // free memory:
-  for (i = 0; i < patch_size; i++) {
-    for (j = 0; j < patch_size; j++) {
-      free(patch[i][j]);
-    }
-    free(patch[i]);
-  }
-  free(patch);
-  free(texton_distances);
-
-  buf = NULL;
-  free(buf);
-
 } // EXECUTION
 
 
@@ -514,11 +493,9 @@ void save_texton_dictionary(void)
   } else {
     // (over-)write dictionary
     for (uint8_t i = 0; i < n_textons; i++) {
-      for (uint8_t j = 0; j < patch_size; j++) {
-        for (uint8_t k = 0; k < patch_size; k++) {
-          fprintf(dictionary_logger, "%f\n", dictionary[i][j][k][0]);
-          fprintf(dictionary_logger, "%f\n", dictionary[i][j][k][1]);
-        }
+      float *texton = &dictionary[i * dictionary_stride];
+      for (int k = 0; k < 2 * patch_size * patch_size; k++) {
+        fprintf(dictionary_logger, "%f\n", texton[k]);
       }
     }
     fclose(dictionary_logger);
@@ -537,11 +514,9 @@ void load_texton_dictionary(void)
   if ((dictionary_logger = fopen(filename, "r"))) {
     // Load the dictionary:
     for (int i = 0; i < n_textons; i++) {
-      for (int j = 0; j < patch_size; j++) {
-        for (int k = 0; k < patch_size; k++) {
-          if (fscanf(dictionary_logger, "%f\n", &dictionary[i][j][k][0]) == EOF) { break; }
-          if (fscanf(dictionary_logger, "%f\n", &dictionary[i][j][k][1]) == EOF) { break; }
-        }
+      float *texton = &dictionary[i * dictionary_stride];
+      for (int k = 0; k < 2 * patch_size * patch_size; k++) {
+        if (fscanf(dictionary_logger, "%f\n", &texton[k]) == EOF) { break; }
       }
     }
 
@@ -566,16 +541,7 @@ void textons_init(void)
   dictionary_initialized = 0;
   learned_samples = 0;
   dictionary_ready = 0;
-  dictionary = (float ** **)calloc(MAX_N_TEXTONS, sizeof(float ** *));
-  for (int w = 0; w < MAX_N_TEXTONS; w++) {
-    dictionary[w] = (float ** *) calloc(patch_size, sizeof(float **));
-    for (int i = 0; i < patch_size; i++) {
-      dictionary[w][i] = (float **) calloc(patch_size, sizeof(float *));
-      for (int j = 0; j < patch_size; j++) {
-        dictionary[w][i][j] = (float *) calloc(2, sizeof(float));
-      }
-    }
-  }
+  textons_alloc();
 
   listener = cv_add_to_device(&TEXTONS_CAMERA, texton_func, TEXTONS_FPS, 0);
 }
@@ -584,6 +550,9 @@ void textons_stop(void)
 {
   free(texton_distribution);
   free(dictionary);
+  free(patches);
+  dictionary = NULL;
+  patches = NULL;
 }
 
 /**
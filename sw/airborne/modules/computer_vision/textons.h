@@ -55,7 +55,8 @@ extern uint8_t dictionary_number;
 // status variables
 extern uint8_t dictionary_ready;
 extern float alpha;
-extern float ** **dictionary;
+extern float *dictionary; // n_textons textons of dictionary_stride floats
+extern uint32_t dictionary_stride;
 extern uint32_t learned_samples;
 extern uint8_t dictionary_initialized;
 
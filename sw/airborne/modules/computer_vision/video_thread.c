@@ -70,6 +70,35 @@ PRINT_CONFIG_VAR(VIDEO_THREAD_MAX_CAMERAS)
 
 #define printf_debug    if(VIDEO_THREAD_VERBOSE > 0) printf
 
+// Number of threads decoding the Bayer pattern of a frame (including the video thread itself)
+#ifndef VIDEO_THREAD_DEBAYER_THREADS
+#define VIDEO_THREAD_DEBAYER_THREADS 2
+#endif
+PRINT_CONFIG_VAR(VIDEO_THREAD_DEBAYER_THREADS)
+
+struct debayer_pool_t;
+
+/** Debayer worker thread */
+struct debayer_worker_t {
+  struct debayer_pool_t *pool;      ///< The pool of the worker
+  pthread_t tid;                    ///< The thread
+  uint8_t idx;                      ///< The strip decoded by the worker
+};
+
+/** Threads decoding the Bayer pattern of a frame, each thread decodes a strip of output rows */
+struct debayer_pool_t {
+  pthread_mutex_t mutex;
+  pthread_cond_t start_cond;        ///< Signaled when a new frame has to be decoded
+  pthread_cond_t done_cond;         ///< Signaled when all workers finished their strip
+  struct image_t *in;               ///< The raw image
+  struct image_t *out;              ///< The decoded image
+  uint32_t frame;                   ///< Frame counter, incremented for every frame to decode
+  uint8_t pending;                  ///< Number of workers still decoding the current frame
+  bool stop;                        ///< Stop the workers
+  uint8_t nb_workers;               ///< Number of workers started
+  struct debayer_worker_t workers[VIDEO_THREAD_DEBAYER_THREADS];
+};
+
 static struct video_config_t *cameras[VIDEO_THREAD_MAX_CAMERAS] = {NULL};
 
 // Main thread
@@ -83,6 +112,109 @@ void video_thread_periodic(void)
   /* currently no direct periodic functionality */
 }
 
+/** Decode strip number idx of the output rows */
+static void debayer_strip(struct image_t *in, struct image_t *out, uint8_t idx)
+{
+  uint16_t row_start = out->h * idx / VIDEO_THREAD_DEBAYER_THREADS;
+  uint16_t row_end = out->h * (idx + 1) / VIDEO_THREAD_DEBAYER_THREADS;
+  BayerToYUVRows(in, out, 0, 0, row_start, row_end);
+}
+
+/** Debayer worker, waits for frames and decodes its strip */
+static void *debayer_worker_function(void *data)
+{
+  struct debayer_worker_t *worker = (struct debayer_worker_t *)data;
+  struct debayer_pool_t *pool = worker->pool;
+  uint32_t frame = 0;
+
+  pthread_mutex_lock(&pool->mutex);
+  while (true) {
+    while (pool->frame == frame && !pool->stop) {
+      pthread_cond_wait(&pool->start_cond, &pool->mutex);
+    }
+    if (pool->stop) {
+      break;
+    }
+    frame = pool->frame;
+    struct image_t *in = pool->in;
+    struct image_t *out = pool->out;
+    pthread_mutex_unlock(&pool->mutex);
+
+    debayer_strip(in, out, worker->idx);
+
+    pthread_mutex_lock(&pool->mutex);
+    if (--pool->pending == 0) {
+      pthread_cond_signal(&pool->done_cond);
+    }
+  }
+  pthread_mutex_unlock(&pool->mutex);
+  return NULL;
+}
+
+/** Start the debayer workers, the video thread decodes the first strip itself */
+static void debayer_pool_start(struct debayer_pool_t *pool)
+{
+  pthread_mutex_init(&pool->mutex, NULL);
+  pthread_cond_init(&pool->start_cond, NULL);
+  pthread_cond_init(&pool->done_cond, NULL);
+  pool->frame = 0;
+  pool->pending = 0;
+  pool->stop = false;
+  pool->nb_workers = 0;
+  for (uint8_t i = 0; i + 1 < VIDEO_THREAD_DEBAYER_THREADS; i++) {
+    struct debayer_worker_t *worker = &pool->workers[i];
+    worker->pool = pool;
+    worker->idx = i + 1;
+    if (pthread_create(&worker->tid, NULL, debayer_worker_function, worker) != 0) {
+      fprintf(stderr, "[video_thread] Could not create debayer thread: Reason: %d.\n", errno);
+      break;
+    }
+#ifndef __APPLE__
+    pthread_setname_np(worker->tid, "debayer");
+#endif
+    pool->nb_workers++;
+  }
+}
+
+/** Decode a frame with the video thread and the workers */
+static void debayer_pool_run(struct debayer_pool_t *pool, struct image_t *in, struct image_t *out)
+{
+  pthread_mutex_lock(&pool->mutex);
+  pool->in = in;
+  pool->out = out;
+  pool->pending = pool->nb_workers;
+  pool->frame++;
+  pthread_cond_broadcast(&pool->start_cond);
+  pthread_mutex_unlock(&pool->mutex);
+
+  debayer_strip(in, out, 0);
+  // strips of the workers that could not be started
+  for (uint8_t i = pool->nb_workers + 1; i < VIDEO_THREAD_DEBAYER_THREADS; i++) {
+    debayer_strip(in, out, i);
+  }
+
+  pthread_mutex_lock(&pool->mutex);
+  while (pool->pending > 0) {
+    pthread_cond_wait(&pool->done_cond, &pool->mutex);
+  }
+  pthread_mutex_unlock(&pool->mutex);
+}
+
+/** Stop and join the debayer workers */
+static void debayer_pool_stop(struct debayer_pool_t *pool)
+{
+  pthread_mutex_lock(&pool->mutex);
+  pool->stop = true;
+  pthread_cond_broadcast(&pool->start_cond);
+  pthread_mutex_unlock(&pool->mutex);
+  for (uint8_t i = 0; i < pool->nb_workers; i++) {
+    pthread_join(pool->workers[i].tid, NULL);
+  }
+  pthread_mutex_destroy(&pool->mutex);
+  pthread_cond_destroy(&pool->start_cond);
+  pthread_cond_destroy(&pool->done_cond);
+}
+
 /**
  * Handles all the video streaming and saving of the image shots
  * This is a separate thread, so it needs to be thread safe!
@@ -95,17 +227,23 @@ static void *video_thread_function(void *data)
   snprintf(print_tag, 80, "video_thread-%s", vid->dev_name);
 
   struct image_t img_color;
+  struct debayer_pool_t debayer_pool;
 
   // create the images
   if (vid->filters & VIDEO_FILTER_DEBAYER) {
     // fixme: don't hardcode size, works for Bebop front camera for now
 #define IMG_FLT_SIZE 272
     image_create(&img_color, IMG_FLT_SIZE, IMG_FLT_SIZE, IMAGE_YUV422);
+    debayer_pool_start(&debayer_pool);
   }
 
   // Start the streaming of the V4L2 device
   if (!v4l2_start_capture(vid->thread.dev)) {
     fprintf(stderr, "[%s] Could not start capture.\n", print_tag);
+    if (vid->filters & VIDEO_FILTER_DEBAYER) {
+      debayer_pool_stop(&debayer_pool);
+      image_free(&img_color);
+    }
     return 0;
   }
 
@@ -140,7 +278,7 @@ static void *video_thread_function(void *data)
 
     // Run selected filters
     if (vid->filters & VIDEO_FILTER_DEBAYER) {
-      BayerToYUV(&img, &img_color, 0, 0);
+      debayer_pool_run(&debayer_pool, &img, &img_color);
       // use color image for further processing
       img_final = &img_color;
     }
@@ -164,7 +302,10 @@ static void *video_thread_function(void *data)
     }
   }
 
-  image_free(&img_color);
+  if (vid->filters & VIDEO_FILTER_DEBAYER) {
+    debayer_pool_stop(&debayer_pool);
+    image_free(&img_color);
+  }
 
   return 0;
 }
@@ -75,5 +75,65 @@ typedef struct abi_struct abi_event;
 #define ABI_FOREACH(head,el) for(el=head; el; el=el->next)
 #define ABI_PREPEND(head,add) { (add)->next = head; head = add; }
 
+#if ABI_TRACE
+/** Optional tracing of all ABI messages
+ * The last ABI_TRACE_SIZE messages are stored in a ring buffer with
+ * a timestamp and the first bytes of their arguments (pointed values for
+ * pointer arguments). The buffer can be dumped by the flight recorder.
+ */
+#include "mcu_periph/sys_time.h"
+#include <string.h>
+
+/** Number of events in the trace ring buffer, power of two */
+#ifndef ABI_TRACE_SIZE
+#define ABI_TRACE_SIZE 256
+#endif
+
+#if (ABI_TRACE_SIZE & (ABI_TRACE_SIZE - 1)) != 0
+#error "ABI_TRACE_SIZE must be a power of two"
+#endif
+
+/** Number of payload bytes stored per event */
+#define ABI_TRACE_PAYLOAD_SIZE 8
+
+struct abi_trace_event {
+  uint32_t timestamp;                       ///< time of the message in usec
+  uint8_t msg_id;                           ///< ABI message id
+  uint8_t sender_id;                        ///< ABI sender id
+  uint8_t len;                              ///< number of payload bytes
+  uint8_t pad;
+  uint8_t payload[ABI_TRACE_PAYLOAD_SIZE];  ///< first bytes of the arguments
+};
+
+ABI_EXTERN struct abi_trace_event abi_trace_events[ABI_TRACE_SIZE];
+ABI_EXTERN uint32_t abi_trace_idx;      ///< total number of recorded events
+ABI_EXTERN volatile bool abi_trace_paused; ///< stop recording, for instance while dumping
+
+/** Get next trace event
+ * @return pointer to event or NULL if tracing is paused
+ */
+static inline struct abi_trace_event *abi_trace_new(uint8_t msg_id, uint8_t sender_id)
+{
+  if (abi_trace_paused) {
+    return NULL;
+  }
+  struct abi_trace_event *ev = &abi_trace_events[abi_trace_idx & (ABI_TRACE_SIZE - 1)];
+  abi_trace_idx++;
+  ev->timestamp = get_sys_time_usec();
+  ev->msg_id = msg_id;
+  ev->sender_id = sender_id;
+  ev->len = 0;
+  return ev;
+}
+
+/** Add data to a trace event payload, truncated to the remaining space */
+static inline void abi_trace_add(struct abi_trace_event *ev, const void *data, uint8_t size)
+{
+  uint8_t n = Min(size, ABI_TRACE_PAYLOAD_SIZE - ev->len);
+  memcpy(&ev->payload[ev->len], data, n);
+  ev->len += n;
+}
+#endif
+
 #endif /* ABI_COMMON_H */
 
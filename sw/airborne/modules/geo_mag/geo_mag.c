@@ -40,12 +40,27 @@
 #define GEO_MAG_SENDER_ID 1
 #endif
 
+/** Use the precomputed grid instead of the spherical harmonics,
+ *  less accurate but without any stall
+ */
+#ifndef GEO_MAG_USE_GRID
+#define GEO_MAG_USE_GRID FALSE
+#endif
+
 struct GeoMag geo_mag;
 
+#if !GEO_MAG_USE_GRID
+static struct Wmm2020Cache geo_mag_cache;
+static double geo_mag_date;
+#endif
+
 void geo_mag_init(void)
 {
   geo_mag.calc_once = false;
   geo_mag.ready = false;
+#if !GEO_MAG_USE_GRID
+  geo_mag_date = 0.;
+#endif
 }
 
 void geo_mag_periodic(void)
@@ -59,9 +74,6 @@ void geo_mag_periodic(void)
 void geo_mag_event(void)
 {
   if (geo_mag.calc_once) {
-    double gha[MAXCOEFF]; // Geomag global variables
-    int32_t nmax;
-
     /* Current date in decimal year, for example 2015.68 */
     double sdate = GPS_EPOCH_BEGIN +
                    (double)gps.week / WEEKS_IN_YEAR +
@@ -72,12 +84,20 @@ void geo_mag_event(void)
     double longitude = (double)gps.lla_pos.lon / 1e7;
     double alt = (double)gps.lla_pos.alt / 1e6;
 
-    // Calculates additional coeffs
-    nmax = extrapsh(sdate, GEO_EPOCH, NMAX_1, NMAX_2, gha);
-    // Calculates absolute magnet fields
-    mag_calc(1, latitude, longitude, alt, nmax, gha,
-             &geo_mag.vect.x, &geo_mag.vect.y, &geo_mag.vect.z,
-             IEXT, EXT_COEFF1, EXT_COEFF2, EXT_COEFF3);
+#if GEO_MAG_USE_GRID
+    float x, y, z;
+    wmm2020_grid_field(sdate, latitude, longitude, alt, &x, &y, &z);
+    VECT3_ASSIGN(geo_mag.vect, x, y, z);
+#else
+    // coefficients only extrapolated again when the date changes by more than a day
+    if (fabs(sdate - geo_mag_date) > 1. / 365.) {
+      wmm2020_cache_init(&geo_mag_cache, sdate);
+      geo_mag_date = sdate;
+    }
+    // Calculates absolute magnet fields, Legendre sums reused close to the last position
+    wmm2020_cache_field(&geo_mag_cache, latitude, longitude, alt,
+                        &geo_mag.vect.x, &geo_mag.vect.y, &geo_mag.vect.z);
+#endif
 
     // send as normalized float vector via ABI
     struct FloatVect3 h = { .x = geo_mag.vect.x,
@@ -39,6 +39,14 @@
 #define IMU_INTEGRATION false
 #endif
 
+/** Output frequency of the coning and sculling compensated IMU_DELTA message,
+ * usually the estimator propagation frequency
+ */
+#ifndef IMU_INTEGRATION_FREQ
+#define IMU_INTEGRATION_FREQ PERIODIC_FREQUENCY
+#endif
+#define IMU_INTEGRATION_DT (1.f / IMU_INTEGRATION_FREQ)
+
 /** By default gyro signs are positive for single IMU with old format or defaults */
 #if defined(IMU_GYRO_CALIB) && (defined(IMU_GYRO_P_SIGN) || defined(IMU_GYRO_Q_SIGN) || defined(IMU_GYRO_R_SIGN))
 #warning "The IMU_GYRO_?_SIGN's aren't compatible with the IMU_GYRO_CALIB define in the airframe"
@@ -570,6 +578,82 @@ void imu_set_defaults_mag(uint8_t abi_id, const struct Int32RMat *imu_to_sensor,
   }
 }
 
+#if IMU_INTEGRATION
+/**
+ * Add a gyro sample to the delta angle with coning compensation
+ * beta += 1/2 (alpha + 1/6 last) x dtheta
+ */
+static inline void imu_delta_angle_add(struct imu_delta_angle_t *d, struct FloatVect3 *rate, float dt)
+{
+  struct FloatVect3 dtheta, alpha, cross;
+  VECT3_SMUL(dtheta, *rate, dt);
+  VECT3_SUM_SCALED(alpha, d->alpha, d->last, 1.f / 6.f);
+  VECT3_CROSS_PRODUCT(cross, alpha, dtheta);
+  VECT3_ADD_SCALED(d->beta, cross, 0.5f);
+  VECT3_ADD(d->alpha, dtheta);
+  VECT3_COPY(d->last, dtheta);
+  d->dt += dt;
+}
+
+/**
+ * Add an accel sample to the delta velocity with sculling compensation
+ * scul += 1/2 (alpha + 1/6 last_angle) x dv + 1/2 (nu + 1/6 last) x dtheta
+ */
+static inline void imu_delta_vel_add(struct imu_delta_vel_t *d, struct FloatVect3 *accel, struct FloatVect3 *rate, float dt)
+{
+  struct FloatVect3 dv, dtheta, tmp, cross;
+  VECT3_SMUL(dv, *accel, dt);
+  VECT3_SMUL(dtheta, *rate, dt);
+  VECT3_SUM_SCALED(tmp, d->alpha, d->last_angle, 1.f / 6.f);
+  VECT3_CROSS_PRODUCT(cross, tmp, dv);
+  VECT3_ADD_SCALED(d->scul, cross, 0.5f);
+  VECT3_SUM_SCALED(tmp, d->nu, d->last, 1.f / 6.f);
+  VECT3_CROSS_PRODUCT(cross, tmp, dtheta);
+  VECT3_ADD_SCALED(d->scul, cross, 0.5f);
+  VECT3_ADD(d->alpha, dtheta);
+  VECT3_ADD(d->nu, dv);
+  VECT3_COPY(d->last, dv);
+  VECT3_COPY(d->last_angle, dtheta);
+  d->dt += dt;
+}
+
+/**
+ * Send the compensated delta angle and velocity in body frame and restart the integration
+ */
+static void imu_delta_send(uint8_t sender_id, uint32_t stamp, struct imu_gyro_t *gyro, struct imu_accel_t *accel)
+{
+  struct FloatRMat body_to_sensor;
+  struct FloatVect3 delta_s, delta_b, rot;
+
+  // delta angle = alpha + beta
+  VECT3_SUM(delta_s, gyro->delta.alpha, gyro->delta.beta);
+  RMAT_FLOAT_OF_BFP(body_to_sensor, gyro->body_to_sensor);
+  float_rmat_transp_vmult(&delta_b, &body_to_sensor, &delta_s);
+  struct FloatRates delta_angle = { delta_b.x, delta_b.y, delta_b.z };
+  uint16_t angle_dt = gyro->delta.dt * 1e6f;
+
+  // delta velocity = nu + 1/2 alpha x nu + sculling
+  VECT3_CROSS_PRODUCT(rot, accel->delta.alpha, accel->delta.nu);
+  VECT3_SUM(delta_s, accel->delta.nu, accel->delta.scul);
+  VECT3_ADD_SCALED(delta_s, rot, 0.5f);
+  RMAT_FLOAT_OF_BFP(body_to_sensor, accel->body_to_sensor);
+  struct FloatVect3 delta_vel;
+  float_rmat_transp_vmult(&delta_vel, &body_to_sensor, &delta_s);
+  uint16_t vel_dt = accel->delta.dt * 1e6f;
+
+  AbiSendMsgIMU_DELTA(sender_id, stamp, &delta_angle, angle_dt, &delta_vel, vel_dt);
+
+  // last sample deltas are kept for the next interval
+  FLOAT_VECT3_ZERO(gyro->delta.alpha);
+  FLOAT_VECT3_ZERO(gyro->delta.beta);
+  gyro->delta.dt = 0.f;
+  FLOAT_VECT3_ZERO(accel->delta.nu);
+  FLOAT_VECT3_ZERO(accel->delta.scul);
+  FLOAT_VECT3_ZERO(accel->delta.alpha);
+  accel->delta.dt = 0.f;
+}
+#endif
+
 static void imu_gyro_raw_cb(uint8_t sender_id, uint32_t stamp, struct Int32Rates *data, uint8_t samples, float rate, float temp)
 {
   // Find the correct gyro
@@ -577,19 +661,59 @@ static void imu_gyro_raw_cb(uint8_t sender_id, uint32_t stamp, struct Int32Rates
   if(gyro == NULL || samples < 1)
     return;
 
-  // Filter the gyro
-  struct Int32Rates data_filtered[samples];
-  if(gyro->calibrated.filter) {
-    for(uint8_t i = 0; i < samples; i++) {
-      data_filtered[i].p = update_butterworth_2_low_pass(&gyro->filter[0], data[i].p);
-      data_filtered[i].q = update_butterworth_2_low_pass(&gyro->filter[1], data[i].q);
-      data_filtered[i].r = update_butterworth_2_low_pass(&gyro->filter[2], data[i].r);
+#if IMU_INTEGRATION
+  // Only integrate if we have gotten a previous measurement and didn't overflow the timer
+  bool integrate = !isnan(rate) && gyro->last_stamp > 0 && stamp > gyro->last_stamp;
+  float sample_dt = 1.f / rate;
+  struct FloatRates sum_sensor = { 0.f, 0.f, 0.f };
+#else
+  (void)rate; // Surpress compile warning not used
+#endif
+
+#if IMU_INTEGRATION || IMU_LOG_HIGHSPEED
+  // Scale factors of the whole batch, from unscaled to float in sensor frame
+  struct FloatRates f_scale;
+  f_scale.p = RATE_FLOAT_OF_BFP((float)gyro->scale[0].p / gyro->scale[1].p);
+  f_scale.q = RATE_FLOAT_OF_BFP((float)gyro->scale[0].q / gyro->scale[1].q);
+  f_scale.r = RATE_FLOAT_OF_BFP((float)gyro->scale[0].r / gyro->scale[1].r);
+#endif
+
+  // Filter, scale and integrate all the samples in a single pass
+  struct Int32Rates sample;
+  for(uint8_t i = 0; i < samples; i++) {
+    if(gyro->calibrated.filter) {
+      sample.p = update_butterworth_2_low_pass(&gyro->filter[0], data[i].p);
+      sample.q = update_butterworth_2_low_pass(&gyro->filter[1], data[i].q);
+      sample.r = update_butterworth_2_low_pass(&gyro->filter[2], data[i].r);
+    } else {
+      RATES_COPY(sample, data[i]);
+    }
+
+#if IMU_INTEGRATION || IMU_LOG_HIGHSPEED
+    struct FloatRates f_sample;
+    f_sample.p = (sample.p - gyro->neutral.p) * f_scale.p;
+    f_sample.q = (sample.q - gyro->neutral.q) * f_scale.q;
+    f_sample.r = (sample.r - gyro->neutral.r) * f_scale.r;
+#endif
+
+#if IMU_LOG_HIGHSPEED
+    // Every sample is logged in sensor frame
+    pprz_msg_send_IMU_GYRO(&pprzlog_tp.trans_tx, &(IMU_LOG_HIGHSPEED_DEVICE).device, AC_ID, &sender_id, &f_sample.p, &f_sample.q, &f_sample.r);
+#endif
+
+#if IMU_INTEGRATION
+    if(integrate) {
+      if(i < samples - 1) {
+        RATES_ADD(sum_sensor, f_sample);
+      }
+      struct FloatVect3 w = { f_sample.p, f_sample.q, f_sample.r };
+      imu_delta_angle_add(&gyro->delta, &w, sample_dt);
     }
-    data = data_filtered;
+#endif
   }
 
   // Copy last sample as unscaled
-  RATES_COPY(gyro->unscaled, data[samples-1]);
+  RATES_COPY(gyro->unscaled, sample);
 
   // Scale the gyro
   struct Int32Rates scaled, scaled_rot;
@@ -601,11 +725,10 @@ static void imu_gyro_raw_cb(uint8_t sender_id, uint32_t stamp, struct Int32Rates
   int32_rmat_transp_ratemult(&scaled_rot, &gyro->body_to_sensor, &scaled);
 
 #if IMU_INTEGRATION
-  // Only integrate if we have gotten a previous measurement and didn't overflow the timer
-  if(!isnan(rate) && gyro->last_stamp > 0 && stamp > gyro->last_stamp) {
+  if(integrate) {
     struct FloatRates integrated;
 
-    // Trapezoidal integration (TODO: coning correction)
+    // Trapezoidal integration of the last sample
     integrated.p = RATE_FLOAT_OF_BFP(gyro->scaled.p + scaled_rot.p) * 0.5f;
     integrated.q = RATE_FLOAT_OF_BFP(gyro->scaled.q + scaled_rot.q) * 0.5f;
     integrated.r = RATE_FLOAT_OF_BFP(gyro->scaled.r + scaled_rot.r) * 0.5f;
@@ -614,47 +737,31 @@ static void imu_gyro_raw_cb(uint8_t sender_id, uint32_t stamp, struct Int32Rates
     if(samples > 1) {
       struct FloatRates integrated_sensor;
       struct FloatRMat body_to_sensor;
-      // Rotate back to sensor frame
+      // Rotate back to sensor frame and add all the other samples
       RMAT_FLOAT_OF_BFP(body_to_sensor, gyro->body_to_sensor);
       float_rmat_ratemult(&integrated_sensor, &body_to_sensor, &integrated);
-
-      // Add all the other samples
-      for(uint8_t i = 0; i < samples-1; i++) {
-        struct FloatRates f_sample;
-        f_sample.p = RATE_FLOAT_OF_BFP((data[i].p - gyro->neutral.p) * gyro->scale[0].p / gyro->scale[1].p);
-        f_sample.q = RATE_FLOAT_OF_BFP((data[i].q - gyro->neutral.q) * gyro->scale[0].q / gyro->scale[1].q);
-        f_sample.r = RATE_FLOAT_OF_BFP((data[i].r - gyro->neutral.r) * gyro->scale[0].r / gyro->scale[1].r);
-
-#if IMU_LOG_HIGHSPEED
-        pprz_msg_send_IMU_GYRO(&pprzlog_tp.trans_tx, &(IMU_LOG_HIGHSPEED_DEVICE).device, AC_ID, &sender_id, &f_sample.p, &f_sample.q, &f_sample.r);
-#endif
-
-        integrated_sensor.p += f_sample.p;
-        integrated_sensor.q += f_sample.q;
-        integrated_sensor.r += f_sample.r;
-      }
+      RATES_ADD(integrated_sensor, sum_sensor);
 
       // Rotate to body frame
       float_rmat_transp_ratemult(&integrated, &body_to_sensor, &integrated_sensor);
     }
 
     // Divide by the time of the collected samples
-    integrated.p = integrated.p * (1.f / rate);
-    integrated.q = integrated.q * (1.f / rate);
-    integrated.r = integrated.r * (1.f / rate);
+    integrated.p = integrated.p * sample_dt;
+    integrated.q = integrated.q * sample_dt;
+    integrated.r = integrated.r * sample_dt;
 
     // Send the integrated values
     uint16_t dt = (1e6 / rate) * samples;
     AbiSendMsgIMU_GYRO_INT(sender_id, stamp, &integrated, dt);
-  }
-#else
-  (void)rate; // Surpress compile warning not used
-#endif
 
-#if IMU_LOG_HIGHSPEED
-  struct FloatRates f_sample;
-  RATES_FLOAT_OF_BFP(f_sample, scaled);
-  pprz_msg_send_IMU_GYRO(&pprzlog_tp.trans_tx, &(IMU_LOG_HIGHSPEED_DEVICE).device, AC_ID, &sender_id, &f_sample.p, &f_sample.q, &f_sample.r);
+    // Drop the delta angle when no accelerometer consumes it
+    if(gyro->delta.dt > 4.f * IMU_INTEGRATION_DT) {
+      FLOAT_VECT3_ZERO(gyro->delta.alpha);
+      FLOAT_VECT3_ZERO(gyro->delta.beta);
+      gyro->delta.dt = 0.f;
+    }
+  }
 #endif
 
   // Copy and send
@@ -671,19 +778,78 @@ static void imu_accel_raw_cb(uint8_t sender_id, uint32_t stamp, struct Int32Vect
   if(accel == NULL || samples < 1)
     return;
 
-  // Filter the accel
-  struct Int32Vect3 data_filtered[samples];
-  if(accel->calibrated.filter) {
-    for(uint8_t i = 0; i < samples; i++) {
-      data_filtered[i].x = update_butterworth_2_low_pass(&accel->filter[0], data[i].x);
-      data_filtered[i].y = update_butterworth_2_low_pass(&accel->filter[1], data[i].y);
-      data_filtered[i].z = update_butterworth_2_low_pass(&accel->filter[2], data[i].z);
+#if IMU_INTEGRATION
+  // Only integrate if we have gotten a previous measurement and didn't overflow the timer
+  bool integrate = !isnan(rate) && accel->last_stamp > 0 && stamp > accel->last_stamp;
+  float sample_dt = 1.f / rate;
+  struct FloatVect3 sum_sensor = { 0.f, 0.f, 0.f };
+
+  // Latest angular rate of the gyro with the same ID in accel sensor frame, for sculling
+  struct FloatVect3 rate_sensor = { 0.f, 0.f, 0.f };
+  struct imu_gyro_t *gyro = imu_get_gyro(sender_id, false);
+  if(gyro != NULL) {
+    struct FloatVect3 rate_body;
+    struct FloatRMat body_to_sensor;
+    VECT3_ASSIGN(rate_body, RATE_FLOAT_OF_BFP(gyro->scaled.p), RATE_FLOAT_OF_BFP(gyro->scaled.q),
+                 RATE_FLOAT_OF_BFP(gyro->scaled.r));
+    RMAT_FLOAT_OF_BFP(body_to_sensor, accel->body_to_sensor);
+    float_rmat_vmult(&rate_sensor, &body_to_sensor, &rate_body);
+  }
+
+  // Rate change over the batch, the rate of each sample is interpolated from the previous batch
+  struct FloatVect3 rate_step, rate_sample;
+  VECT3_DIFF(rate_step, rate_sensor, accel->delta.last_rate);
+  VECT3_SDIV(rate_step, rate_step, (float)samples);
+  VECT3_COPY(rate_sample, accel->delta.last_rate);
+  VECT3_COPY(accel->delta.last_rate, rate_sensor);
+#else
+  (void)rate; // Surpress compile warning not used
+#endif
+
+#if IMU_INTEGRATION || IMU_LOG_HIGHSPEED
+  // Scale factors of the whole batch, from unscaled to float in sensor frame
+  struct FloatVect3 f_scale;
+  f_scale.x = ACCEL_FLOAT_OF_BFP((float)accel->scale[0].x / accel->scale[1].x);
+  f_scale.y = ACCEL_FLOAT_OF_BFP((float)accel->scale[0].y / accel->scale[1].y);
+  f_scale.z = ACCEL_FLOAT_OF_BFP((float)accel->scale[0].z / accel->scale[1].z);
+#endif
+
+  // Filter, scale and integrate all the samples in a single pass
+  struct Int32Vect3 sample;
+  for(uint8_t i = 0; i < samples; i++) {
+    if(accel->calibrated.filter) {
+      sample.x = update_butterworth_2_low_pass(&accel->filter[0], data[i].x);
+      sample.y = update_butterworth_2_low_pass(&accel->filter[1], data[i].y);
+      sample.z = update_butterworth_2_low_pass(&accel->filter[2], data[i].z);
+    } else {
+      VECT3_COPY(sample, data[i]);
+    }
+
+#if IMU_INTEGRATION || IMU_LOG_HIGHSPEED
+    struct FloatVect3 f_sample;
+    f_sample.x = (sample.x - accel->neutral.x) * f_scale.x;
+    f_sample.y = (sample.y - accel->neutral.y) * f_scale.y;
+    f_sample.z = (sample.z - accel->neutral.z) * f_scale.z;
+#endif
+
+#if IMU_LOG_HIGHSPEED
+    // Every sample is logged in sensor frame
+    pprz_msg_send_IMU_ACCEL(&pprzlog_tp.trans_tx, &(IMU_LOG_HIGHSPEED_DEVICE).device, AC_ID, &sender_id, &f_sample.x, &f_sample.y, &f_sample.z);
+#endif
+
+#if IMU_INTEGRATION
+    if(integrate) {
+      if(i < samples - 1) {
+        VECT3_ADD(sum_sensor, f_sample);
+      }
+      VECT3_ADD(rate_sample, rate_step);
+      imu_delta_vel_add(&accel->delta, &f_sample, &rate_sample, sample_dt);
     }
-    data = data_filtered;
+#endif
   }
 
   // Copy last sample as unscaled
-  VECT3_COPY(accel->unscaled, data[samples-1]);
+  VECT3_COPY(accel->unscaled, sample);
 
   // Scale the accel
   struct Int32Vect3 scaled, scaled_rot;
@@ -695,11 +861,10 @@ static void imu_accel_raw_cb(uint8_t sender_id, uint32_t stamp, struct Int32Vect
   int32_rmat_transp_vmult(&scaled_rot, &accel->body_to_sensor, &scaled);
 
 #if IMU_INTEGRATION
-  // Only integrate if we have gotten a previous measurement and didn't overflow the timer
-  if(!isnan(rate) && accel->last_stamp > 0 && stamp > accel->last_stamp) {
+  if(integrate) {
     struct FloatVect3 integrated;
 
-    // Trapezoidal integration
+    // Trapezoidal integration of the last sample
     integrated.x = ACCEL_FLOAT_OF_BFP(accel->scaled.x + scaled_rot.x) * 0.5f;
     integrated.y = ACCEL_FLOAT_OF_BFP(accel->scaled.y + scaled_rot.y) * 0.5f;
     integrated.z = ACCEL_FLOAT_OF_BFP(accel->scaled.z + scaled_rot.z) * 0.5f;
@@ -708,47 +873,29 @@ static void imu_accel_raw_cb(uint8_t sender_id, uint32_t stamp, struct Int32Vect
     if(samples > 1) {
       struct FloatVect3 integrated_sensor;
       struct FloatRMat body_to_sensor;
-      // Rotate back to sensor frame
+      // Rotate back to sensor frame and add all the other samples
       RMAT_FLOAT_OF_BFP(body_to_sensor, accel->body_to_sensor);
       float_rmat_vmult(&integrated_sensor, &body_to_sensor, &integrated);
-
-      // Add all the other samples
-      for(uint8_t i = 0; i < samples-1; i++) {
-        struct FloatVect3 f_sample;
-        f_sample.x = ACCEL_FLOAT_OF_BFP((data[i].x - accel->neutral.x) * accel->scale[0].x / accel->scale[1].x);
-        f_sample.y = ACCEL_FLOAT_OF_BFP((data[i].y - accel->neutral.y) * accel->scale[0].y / accel->scale[1].y);
-        f_sample.z = ACCEL_FLOAT_OF_BFP((data[i].z - accel->neutral.z) * accel->scale[0].z / accel->scale[1].z);
-
-#if IMU_LOG_HIGHSPEED
-        pprz_msg_send_IMU_ACCEL(&pprzlog_tp.trans_tx, &(IMU_LOG_HIGHSPEED_DEVICE).device, AC_ID, &sender_id, &f_sample.x, &f_sample.y, &f_sample.z);
-#endif
-
-        integrated_sensor.x += f_sample.x;
-        integrated_sensor.y += f_sample.y;
-        integrated_sensor.z += f_sample.z;
-      }
+      VECT3_ADD(integrated_sensor, sum_sensor);
 
       // Rotate to body frame
       float_rmat_transp_vmult(&integrated, &body_to_sensor, &integrated_sensor);
     }
 
     // Divide by the time of the collected samples
-    integrated.x = integrated.x * (1.f / rate);
-    integrated.y = integrated.y * (1.f / rate);
-    integrated.z = integrated.z * (1.f / rate);
+    integrated.x = integrated.x * sample_dt;
+    integrated.y = integrated.y * sample_dt;
+    integrated.z = integrated.z * sample_dt;
 
     // Send the integrated values
     uint16_t dt = (1e6 / rate) * samples;
     AbiSendMsgIMU_ACCEL_INT(sender_id, stamp, &integrated, dt);
-  }
-#else
-  (void)rate; // Surpress compile warning not used
-#endif
 
-#if IMU_LOG_HIGHSPEED
-  struct FloatVect3 f_sample;
-  ACCELS_FLOAT_OF_BFP(f_sample, scaled);
-  pprz_msg_send_IMU_ACCEL(&pprzlog_tp.trans_tx, &(IMU_LOG_HIGHSPEED_DEVICE).device, AC_ID, &sender_id, &f_sample.x, &f_sample.y, &f_sample.z);
+    // Send the compensated deltas at the estimator rate
+    if(gyro != NULL && gyro->delta.dt > 0.f && accel->delta.dt + 0.5f * sample_dt >= IMU_INTEGRATION_DT) {
+      imu_delta_send(sender_id, stamp, gyro, accel);
+    }
+  }
 #endif
 
   // Copy and send
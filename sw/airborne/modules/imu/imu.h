@@ -46,6 +46,25 @@ struct imu_calib_t {
   bool filter: 1;     ///< Enable the lowpass filter
 };
 
+/** Coning compensated delta angle accumulator, in sensor frame */
+struct imu_delta_angle_t {
+  struct FloatVect3 alpha;            ///< Sum of the sample delta angles over the interval (rad)
+  struct FloatVect3 beta;             ///< Coning correction over the interval (rad)
+  struct FloatVect3 last;             ///< Delta angle of the previous sample (rad)
+  float dt;                           ///< Integrated time (s)
+};
+
+/** Sculling compensated delta velocity accumulator, in sensor frame */
+struct imu_delta_vel_t {
+  struct FloatVect3 nu;               ///< Sum of the sample delta velocities over the interval (m/s)
+  struct FloatVect3 scul;             ///< Sculling correction over the interval (m/s)
+  struct FloatVect3 last;             ///< Delta velocity of the previous sample (m/s)
+  struct FloatVect3 alpha;            ///< Rotation over the interval (rad)
+  struct FloatVect3 last_angle;       ///< Delta angle of the previous sample (rad)
+  struct FloatVect3 last_rate;        ///< Gyro rate at the end of the previous batch (rad/s)
+  float dt;                           ///< Integrated time (s)
+};
+
 struct imu_gyro_t {
   uint8_t abi_id;                     ///< ABI sensor ID
   uint32_t last_stamp;                ///< Last measurement timestamp for integration
@@ -59,6 +78,7 @@ struct imu_gyro_t {
   float filter_freq;                  ///< Filter frequency
   float filter_sample_freq;           ///< Lowpass filter sample frequency (Hz)
   Butterworth2LowPass filter[3];      ///< Lowpass filter optional
+  struct imu_delta_angle_t delta;     ///< Delta angle accumulated for IMU_DELTA
 };
 
 struct imu_accel_t {
@@ -74,6 +94,7 @@ struct imu_accel_t {
   float filter_freq;                  ///< Lowpass filter frequency (Hz)
   float filter_sample_freq;           ///< Lowpass filter sample frequency (Hz)
   Butterworth2LowPass filter[3];      ///< Lowpass filter optional
+  struct imu_delta_vel_t delta;       ///< Delta velocity accumulated for IMU_DELTA
 };
 
 struct imu_mag_t {
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2023 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/ins/ins_delay_buffer.c
+ *
+ * State and input history for fusing delayed measurements in INS filters.
+ */
+
+#include "modules/ins/ins_delay_buffer.h"
+#include <string.h>
+
+#define STATE_AT(_b, _i) ((_b)->states + (size_t)(_i) * (_b)->state_size)
+#define INPUT_AT(_b, _i) ((_b)->inputs + (size_t)(_i) * (_b)->input_size)
+
+void ins_delay_buffer_init(struct InsDelayBuffer *b, void *states, uint16_t state_size,
+                           void *inputs, uint16_t input_size, float *stamps, float *dts,
+                           uint16_t size, void *replay_state, ins_delay_propagate_t propagate,
+                           uint16_t budget)
+{
+  b->states = (uint8_t *)states;
+  b->state_size = state_size;
+  b->inputs = (uint8_t *)inputs;
+  b->input_size = input_size;
+  b->stamps = stamps;
+  b->dts = dts;
+  b->size = size;
+  b->replay_state = replay_state;
+  b->propagate = propagate;
+  b->budget = budget;
+  b->nb_replays = 0;
+  b->nb_aborts = 0;
+  ins_delay_buffer_reset(b);
+}
+
+void ins_delay_buffer_reset(struct InsDelayBuffer *b)
+{
+  b->head = 0;
+  b->count = 0;
+  b->replay_idx = 0;
+  b->replay_n = 0;
+  b->replaying = false;
+}
+
+void *ins_delay_buffer_push(struct InsDelayBuffer *b, float stamp, float dt, const void *input)
+{
+  if (b->count == b->size) {
+    // the oldest entry is overwritten, a replay starting from it can't complete
+    if (b->replaying && b->replay_idx == b->head) {
+      b->replaying = false;
+      b->nb_aborts++;
+    }
+  } else {
+    b->count++;
+  }
+  if (b->replaying) {
+    b->replay_n++;
+  }
+
+  uint16_t i = b->head;
+  b->stamps[i] = stamp;
+  b->dts[i] = dt;
+  memcpy(INPUT_AT(b, i), input, b->input_size);
+  b->head = (i + 1) % b->size;
+  return STATE_AT(b, i);
+}
+
+void *ins_delay_buffer_rewind(struct InsDelayBuffer *b, float stamp)
+{
+  if (b->replaying || b->count == 0) {
+    return NULL;
+  }
+  // search from the newest entry for the last snapshot before stamp
+  uint16_t i = b->head;
+  for (uint16_t n = 1; n <= b->count; n++) {
+    i = (i == 0) ? b->size - 1 : i - 1;
+    if (b->stamps[i] <= stamp) {
+      memcpy(b->replay_state, STATE_AT(b, i), b->state_size);
+      b->replay_idx = i;
+      b->replay_n = n;
+      b->replaying = true;
+      return b->replay_state;
+    }
+  }
+  // older than the whole history
+  return NULL;
+}
+
+bool ins_delay_buffer_replay(struct InsDelayBuffer *b, void *state)
+{
+  if (!b->replaying) {
+    return false;
+  }
+  for (uint16_t n = 0; n < b->budget && b->replay_n > 0; n++) {
+    uint16_t i = b->replay_idx;
+    // store corrected snapshot, then propagate to the next one
+    memcpy(STATE_AT(b, i), b->replay_state, b->state_size);
+    b->propagate(b->replay_state, INPUT_AT(b, i), b->dts[i]);
+    b->replay_idx = (i + 1) % b->size;
+    b->replay_n--;
+  }
+  if (b->replay_n == 0) {
+    memcpy(state, b->replay_state, b->state_size);
+    b->replaying = false;
+    b->nb_replays++;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2023 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/ins/ins_delay_buffer.h
+ *
+ * State and input history for fusing delayed measurements in INS filters.
+ *
+ * Each propagation step of the filter stores the state before propagation,
+ * the input and the time step. When a delayed measurement arrives, the
+ * filter rewinds to the snapshot closest before the measurement time,
+ * applies its correction on the replay state, and the buffer re-propagates
+ * the stored inputs up to the present, at most a given number of steps per
+ * call, before handing the corrected state back to the filter.
+ *
+ * All memory is provided by the caller:
+ * @code
+ * static struct MyState hist_states[N];
+ * static struct MyInput hist_inputs[N];
+ * static float hist_stamps[N], hist_dts[N];
+ * static struct MyState replay_state;
+ * ins_delay_buffer_init(&hist, hist_states, sizeof(struct MyState), hist_inputs,
+ *                       sizeof(struct MyInput), hist_stamps, hist_dts, N, &replay_state,
+ *                       my_propagate, budget);
+ * @endcode
+ *
+ * At each step:
+ * @code
+ * memcpy(ins_delay_buffer_push(&hist, now, dt, &input), &state, sizeof(state));
+ * my_propagate(&state, &input, dt);
+ * ins_delay_buffer_replay(&hist, &state);
+ * @endcode
+ * and on a delayed measurement:
+ * @code
+ * struct MyState *past = ins_delay_buffer_rewind(&hist, meas_stamp);
+ * if (past) { my_update(past, &meas); }
+ * @endcode
+ */
+
+#ifndef INS_DELAY_BUFFER_H
+#define INS_DELAY_BUFFER_H
+
+#include "std.h"
+
+/** Filter propagation function
+ * @param state state to propagate in place
+ * @param input input of the propagation step
+ * @param dt time step
+ */
+typedef void (*ins_delay_propagate_t)(void *state, const void *input, float dt);
+
+struct InsDelayBuffer {
+  uint8_t *states;                  ///< state snapshots before each propagation step
+  uint8_t *inputs;                  ///< inputs of each propagation step
+  float *stamps;                    ///< time of each snapshot (s)
+  float *dts;                       ///< time step of each propagation step (s)
+  void *replay_state;               ///< state being re-propagated
+  ins_delay_propagate_t propagate;  ///< filter propagation function
+  uint16_t state_size;              ///< size of a state in bytes
+  uint16_t input_size;              ///< size of an input in bytes
+  uint16_t size;                    ///< number of entries
+  uint16_t head;                    ///< next entry to write
+  uint16_t count;                   ///< number of valid entries
+  uint16_t replay_idx;              ///< next entry to re-propagate
+  uint16_t replay_n;                ///< number of entries left to re-propagate
+  uint16_t budget;                  ///< max number of steps re-propagated per call
+  bool replaying;                   ///< a replay is in progress
+  uint32_t nb_replays;              ///< number of completed replays
+  uint32_t nb_aborts;               ///< number of replays aborted by a buffer overrun
+};
+
+/** Init the buffer
+ * @param b delay buffer
+ * @param states storage for size states
+ * @param state_size size of a state in bytes
+ * @param inputs storage for size inputs
+ * @param input_size size of an input in bytes
+ * @param stamps storage for size time stamps
+ * @param dts storage for size time steps
+ * @param size number of entries, sets the maximum measurement delay
+ * @param replay_state storage for one state
+ * @param propagate filter propagation function
+ * @param budget maximum number of steps re-propagated per call to ins_delay_buffer_replay,
+ *               must be larger than 1 for the replay to catch up with the present
+ */
+extern void ins_delay_buffer_init(struct InsDelayBuffer *b, void *states, uint16_t state_size,
+                                  void *inputs, uint16_t input_size, float *stamps, float *dts,
+                                  uint16_t size, void *replay_state, ins_delay_propagate_t propagate,
+                                  uint16_t budget);
+
+/** Drop history and any replay in progress */
+extern void ins_delay_buffer_reset(struct InsDelayBuffer *b);
+
+/** Store a propagation step
+ * The oldest entry is overwritten when the buffer is full.
+ * @param b delay buffer
+ * @param stamp time of the state before propagation
+ * @param dt time step of the propagation
+ * @param input input of the propagation, copied
+ * @return pointer to the state slot the caller must fill with the state before propagation
+ */
+extern void *ins_delay_buffer_push(struct InsDelayBuffer *b, float stamp, float dt, const void *input);
+
+/** Rewind to a past state
+ * The returned state is the last snapshot taken at or before stamp,
+ * the caller applies the delayed correction on it before the next call
+ * to ins_delay_buffer_replay.
+ * @param b delay buffer
+ * @param stamp time of the delayed measurement
+ * @return past state to correct, NULL if stamp is out of the history or a replay is already in progress
+ */
+extern void *ins_delay_buffer_rewind(struct InsDelayBuffer *b, float stamp);
+
+/** Re-propagate the corrected past state
+ * Corrected states are written back to the history so later rewinds use them.
+ * @param b delay buffer
+ * @param state current filter state, overwritten when the replay reaches the present
+ * @return true if state was replaced by the re-propagated one
+ */
+extern bool ins_delay_buffer_replay(struct InsDelayBuffer *b, void *state);
+
+#endif /* INS_DELAY_BUFFER_H */
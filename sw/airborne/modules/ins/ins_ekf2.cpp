@@ -129,6 +129,11 @@ PRINT_CONFIG_VAR(INS_EKF2_GYRO_ID)
 #endif
 PRINT_CONFIG_VAR(INS_EKF2_ACCEL_ID)
 
+/* Use the combined coning and sculling compensated IMU message */
+#ifndef INS_EKF2_IMU_DELTA
+#define INS_EKF2_IMU_DELTA FALSE
+#endif
+
 /* default Magnetometer to use in INS */
 #ifndef INS_EKF2_MAG_ID
 #define INS_EKF2_MAG_ID ABI_BROADCAST
@@ -277,8 +282,12 @@ PRINT_CONFIG_VAR(INS_EKF2_BARO_NOISE)
 static abi_event baro_ev;
 static abi_event temperature_ev;
 static abi_event agl_ev;
+#if INS_EKF2_IMU_DELTA
+static abi_event imu_delta_ev;
+#else
 static abi_event gyro_int_ev;
 static abi_event accel_int_ev;
+#endif
 static abi_event mag_ev;
 static abi_event gps_ev;
 static abi_event optical_flow_ev;
@@ -287,8 +296,13 @@ static abi_event optical_flow_ev;
 static void baro_cb(uint8_t sender_id, uint32_t stamp, float pressure);
 static void temperature_cb(uint8_t sender_id, float temp);
 static void agl_cb(uint8_t sender_id, uint32_t stamp, float distance);
+#if INS_EKF2_IMU_DELTA
+static void imu_delta_cb(uint8_t sender_id, uint32_t stamp, struct FloatRates *delta_angle, uint16_t angle_dt,
+                         struct FloatVect3 *delta_velocity, uint16_t velocity_dt);
+#else
 static void gyro_int_cb(uint8_t sender_id, uint32_t stamp, struct FloatRates *delta_gyro, uint16_t dt);
 static void accel_int_cb(uint8_t sender_id, uint32_t stamp, struct FloatVect3 *delta_accel, uint16_t dt);
+#endif
 static void mag_cb(uint8_t sender_id, uint32_t stamp, struct Int32Vect3 *mag);
 static void gps_cb(uint8_t sender_id, uint32_t stamp, struct GpsState *gps_s);
 static void optical_flow_cb(uint8_t sender_id, uint32_t stamp, int32_t flow_x, int32_t flow_y, int32_t flow_der_x,
@@ -584,8 +598,12 @@ void ins_ekf2_init(void)
   AbiBindMsgBARO_ABS(INS_EKF2_BARO_ID, &baro_ev, baro_cb);
   AbiBindMsgTEMPERATURE(INS_EKF2_TEMPERATURE_ID, &temperature_ev, temperature_cb);
   AbiBindMsgAGL(INS_EKF2_AGL_ID, &agl_ev, agl_cb);
+#if INS_EKF2_IMU_DELTA
+  AbiBindMsgIMU_DELTA(INS_EKF2_GYRO_ID, &imu_delta_ev, imu_delta_cb);
+#else
   AbiBindMsgIMU_GYRO_INT(INS_EKF2_GYRO_ID, &gyro_int_ev, gyro_int_cb);
   AbiBindMsgIMU_ACCEL_INT(INS_EKF2_ACCEL_ID, &accel_int_ev, accel_int_cb);
+#endif
   AbiBindMsgIMU_MAG(INS_EKF2_MAG_ID, &mag_ev, mag_cb);
   AbiBindMsgGPS(INS_EKF2_GPS_ID, &gps_ev, gps_cb);
   AbiBindMsgOPTICAL_FLOW(INS_EKF2_OF_ID, &optical_flow_ev, optical_flow_cb);
@@ -830,6 +848,22 @@ static void agl_cb(uint8_t __attribute__((unused)) sender_id, uint32_t stamp, fl
   ekf.setRangeData(sample);
 }
 
+#if INS_EKF2_IMU_DELTA
+/* Update INS based on combined delta angle and velocity */
+static void imu_delta_cb(uint8_t sender_id __attribute__((unused)),
+                         uint32_t stamp, struct FloatRates *delta_angle, uint16_t angle_dt,
+                         struct FloatVect3 *delta_velocity, uint16_t velocity_dt)
+{
+  RATES_COPY(ekf2.delta_gyro, *delta_angle);
+  ekf2.gyro_dt = angle_dt;
+  VECT3_COPY(ekf2.delta_accel, *delta_velocity);
+  ekf2.accel_dt = velocity_dt;
+  ekf2.gyro_valid = true;
+  ekf2.accel_valid = true;
+
+  ins_ekf2_publish_attitude(stamp);
+}
+#else
 /* Update INS based on Gyro information */
 static void gyro_int_cb(uint8_t __attribute__((unused)) sender_id,
                     uint32_t stamp, struct FloatRates *delta_gyro, uint16_t dt)
@@ -860,6 +894,8 @@ static void accel_int_cb(uint8_t sender_id __attribute__((unused)),
   }
 }
 
+#endif
+
 /* Update INS based on Magnetometer information */
 static void mag_cb(uint8_t __attribute__((unused)) sender_id,
                    uint32_t stamp,
@@ -36,6 +36,8 @@
 
 #include "modules/core/abi.h"
 
+#include <string.h>
+
 #if 0
 #include <stdio.h>
 #define DEBUG_PRINT(...) printf(__VA_ARGS__)
@@ -44,6 +46,32 @@
 #endif
 
 
+/** Latency of the external pose measurements (s)
+ * When defined, measurements are fused at their time of validity by
+ * rewinding the filter to a stored past state and re-propagating it.
+ */
+#ifdef INS_EXT_POSE_DELAY
+#define INS_EXT_POSE_USE_DELAY TRUE
+#include "modules/ins/ins_delay_buffer.h"
+PRINT_CONFIG_VAR(INS_EXT_POSE_DELAY)
+#else
+#define INS_EXT_POSE_USE_DELAY FALSE
+#define INS_EXT_POSE_DELAY 0.f
+#endif
+
+/** Number of propagation steps stored for delayed fusion,
+ * must cover INS_EXT_POSE_DELAY at the module frequency (32 steps are 62 ms at 512 Hz).
+ * Each step stores the state and its covariance, about 1 KB of RAM.
+ */
+#ifndef INS_EXT_POSE_DELAY_BUFFER_SIZE
+#define INS_EXT_POSE_DELAY_BUFFER_SIZE 32
+#endif
+
+/** Maximum number of propagation steps replayed per run after a delayed measurement */
+#ifndef INS_EXT_POSE_DELAY_REPLAY_BUDGET
+#define INS_EXT_POSE_DELAY_REPLAY_BUDGET 8
+#endif
+
 /** Data for telemetry and LTP origin.
  */
 
@@ -57,6 +85,7 @@ struct InsExtPose {
 
   struct FloatVect3 ev_pos;
   struct FloatEulers ev_att;
+  float ev_stamp;
   bool has_new_ext_pose;
 
   /* Origin */
@@ -193,6 +222,7 @@ void ins_ext_pose_msg_update(uint8_t *buf)
   ins_ext_pos.ev_att.theta = orient_eulers.theta;
   ins_ext_pos.ev_att.psi = orient_eulers.psi;
 
+  ins_ext_pos.ev_stamp = get_sys_time_float() - INS_EXT_POSE_DELAY;
   ins_ext_pos.has_new_ext_pose = true;
 
   DEBUG_PRINT("Att = %f %f %f \n", ins_ext_pos.ev_att.phi, ins_ext_pos.ev_att.theta, ins_ext_pos.ev_att.psi);
@@ -271,8 +301,10 @@ static inline void ekf_f_rk4(const float X[EKF_NUM_STATES], const float U[EKF_NU
                              float out[EKF_NUM_STATES]);
 
 static inline void ekf_step(const float U[EKF_NUM_INPUTS], const float Z[EKF_NUM_OUTPUTS], const float dt);
-static inline void ekf_prediction_step(const float U[EKF_NUM_INPUTS], const float dt);
-static inline void ekf_measurement_step(const float Z[EKF_NUM_OUTPUTS]);
+static inline void ekf_prediction_step(float X[EKF_NUM_STATES], float P[EKF_NUM_STATES][EKF_NUM_STATES],
+                                       const float U[EKF_NUM_INPUTS], const float dt);
+static inline void ekf_measurement_step(float X[EKF_NUM_STATES], float P[EKF_NUM_STATES][EKF_NUM_STATES],
+                                        const float Z[EKF_NUM_OUTPUTS]);
 
 
 
@@ -289,6 +321,28 @@ float ekf_H[EKF_NUM_OUTPUTS][EKF_NUM_STATES] = {{1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
 float t0;
 float t1;
 
+#if INS_EXT_POSE_USE_DELAY
+/** Filter state saved in the delay buffer */
+struct InsExtPoseEkfState {
+  float X[EKF_NUM_STATES];
+  float P[EKF_NUM_STATES][EKF_NUM_STATES];
+};
+
+static struct InsDelayBuffer ekf_hist;
+static struct InsExtPoseEkfState ekf_hist_states[INS_EXT_POSE_DELAY_BUFFER_SIZE];
+static float ekf_hist_inputs[INS_EXT_POSE_DELAY_BUFFER_SIZE][EKF_NUM_INPUTS];
+static float ekf_hist_stamps[INS_EXT_POSE_DELAY_BUFFER_SIZE];
+static float ekf_hist_dts[INS_EXT_POSE_DELAY_BUFFER_SIZE];
+static struct InsExtPoseEkfState ekf_hist_replay;
+static struct InsExtPoseEkfState ekf_hist_now;
+
+static void ekf_hist_propagate(void *state, const void *input, float dt)
+{
+  struct InsExtPoseEkfState *s = (struct InsExtPoseEkfState *)state;
+  ekf_prediction_step(s->X, s->P, (const float *)input, dt);
+}
+#endif
+
 void ekf_set_diag(float **a, float *b, int n);
 void ekf_set_diag(float **a, float *b, int n)
 {
@@ -329,6 +383,13 @@ static inline void ekf_init(void)
   float_vect_copy(ekf_X, X0, EKF_NUM_STATES);
   float_vect_copy(ekf_U, U0, EKF_NUM_INPUTS);
   float_vect_copy(ekf_Z, Z0, EKF_NUM_OUTPUTS);
+
+#if INS_EXT_POSE_USE_DELAY
+  ins_delay_buffer_init(&ekf_hist, ekf_hist_states, sizeof(struct InsExtPoseEkfState),
+                        ekf_hist_inputs, sizeof(ekf_hist_inputs[0]), ekf_hist_stamps, ekf_hist_dts,
+                        INS_EXT_POSE_DELAY_BUFFER_SIZE, &ekf_hist_replay, ekf_hist_propagate,
+                        INS_EXT_POSE_DELAY_REPLAY_BUDGET);
+#endif
 }
 
 static inline void ekf_f(const float X[EKF_NUM_STATES], const float U[EKF_NUM_INPUTS], float out[EKF_NUM_STATES])
@@ -949,23 +1010,24 @@ static inline void ekf_step(const float U[EKF_NUM_INPUTS], const float Z[EKF_NUM
   float_mat_mul(ekf_P_, tmp_, Pkk_1_, EKF_NUM_STATES, EKF_NUM_STATES, EKF_NUM_STATES);
 }
 
-static inline void ekf_prediction_step(const float U[EKF_NUM_INPUTS], const float dt)
+static inline void ekf_prediction_step(float X[EKF_NUM_STATES], float P[EKF_NUM_STATES][EKF_NUM_STATES],
+                                       const float U[EKF_NUM_INPUTS], const float dt)
 {
   // [1] Predicted (a priori) state estimate:
   float Xkk_1[EKF_NUM_STATES];
   // Xkk_1 = f(X,U)
-  ekf_f(ekf_X, U, Xkk_1);
+  ekf_f(X, U, Xkk_1);
   // Xkk_1 *= dt
   float_vect_scale(Xkk_1, dt, EKF_NUM_STATES);
   // Xkk_1 += X
-  float_vect_add(Xkk_1, ekf_X, EKF_NUM_STATES);
+  float_vect_add(Xkk_1, X, EKF_NUM_STATES);
 
 
   // [2] Get matrices
   float F[EKF_NUM_STATES][EKF_NUM_STATES];
   float Ld[EKF_NUM_STATES][EKF_NUM_INPUTS];
-  ekf_F(ekf_X, U, F);
-  ekf_L(ekf_X, U, Ld);
+  ekf_F(X, U, F);
+  ekf_L(X, U, Ld);
 
 
   // [3] Continuous to discrete
@@ -993,7 +1055,7 @@ static inline void ekf_prediction_step(const float U[EKF_NUM_INPUTS], const floa
   float tmp[EKF_NUM_STATES][EKF_NUM_STATES];
 
   MAKE_MATRIX_PTR(Pkk_1_, Pkk_1, EKF_NUM_STATES);
-  MAKE_MATRIX_PTR(ekf_P_, ekf_P, EKF_NUM_STATES);
+  MAKE_MATRIX_PTR(ekf_P_, P, EKF_NUM_STATES);
   MAKE_MATRIX_PTR(ekf_Q_, ekf_Q, EKF_NUM_STATES);
   MAKE_MATRIX_PTR(LdT_, LdT, EKF_NUM_INPUTS);
   MAKE_MATRIX_PTR(QLdT_, QLdT, EKF_NUM_INPUTS);
@@ -1024,22 +1086,23 @@ static inline void ekf_prediction_step(const float U[EKF_NUM_INPUTS], const floa
   float_mat_sum_scaled(Pkk_1_, tmp_, 1, EKF_NUM_STATES, EKF_NUM_STATES);
 
   // X = Xkk_1
-  float_vect_copy(ekf_X, Xkk_1, EKF_NUM_STATES);
+  float_vect_copy(X, Xkk_1, EKF_NUM_STATES);
 
   // P = Pkk_1
   float_mat_copy(ekf_P_, Pkk_1_, EKF_NUM_STATES, EKF_NUM_STATES);
 }
 
-static inline void ekf_measurement_step(const float Z[EKF_NUM_OUTPUTS])
+static inline void ekf_measurement_step(float X[EKF_NUM_STATES], float P[EKF_NUM_STATES][EKF_NUM_STATES],
+                                        const float Z[EKF_NUM_OUTPUTS])
 {
   // Xkk_1 = X
   float Xkk_1[EKF_NUM_STATES];
-  float_vect_copy(Xkk_1, ekf_X, EKF_NUM_STATES);
+  float_vect_copy(Xkk_1, X, EKF_NUM_STATES);
 
   // Pkk_1 = P
   float Pkk_1[EKF_NUM_STATES][EKF_NUM_STATES];
   MAKE_MATRIX_PTR(Pkk_1_, Pkk_1, EKF_NUM_STATES);
-  MAKE_MATRIX_PTR(ekf_P_, ekf_P, EKF_NUM_STATES);
+  MAKE_MATRIX_PTR(ekf_P_, P, EKF_NUM_STATES);
   float_mat_copy(Pkk_1_, ekf_P_, EKF_NUM_STATES, EKF_NUM_STATES);
 
   // [5] Measurement residual:
@@ -1090,8 +1153,8 @@ static inline void ekf_measurement_step(const float Z[EKF_NUM_OUTPUTS])
 
   // [8] Updated state estimate
   // Xkk = Xkk_1 + K*yk
-  float_mat_vect_mul(ekf_X, K_, yk, EKF_NUM_STATES, EKF_NUM_OUTPUTS);
-  float_vect_add(ekf_X, Xkk_1, EKF_NUM_STATES);
+  float_mat_vect_mul(X, K_, yk, EKF_NUM_STATES, EKF_NUM_OUTPUTS);
+  float_vect_add(X, Xkk_1, EKF_NUM_STATES);
 
 
   // [9] Updated covariance estimate:
@@ -1167,10 +1230,21 @@ static inline void ekf_run(void)
     // prediction step
     DEBUG_PRINT("ekf prediction step U = %f, %f, %f, %f, %f, %f dt = %f \n", ekf_U[0], ekf_U[1], ekf_U[2], ekf_U[3],
                 ekf_U[4], ekf_U[5], dt);
-    ekf_prediction_step(ekf_U, dt);
+#if INS_EXT_POSE_USE_DELAY
+    // save state before propagation
+    struct InsExtPoseEkfState *hist = ins_delay_buffer_push(&ekf_hist, t1 - dt, dt, ekf_U);
+    float_vect_copy(hist->X, ekf_X, EKF_NUM_STATES);
+    memcpy(hist->P, ekf_P, sizeof(ekf_P));
+#endif
+    ekf_prediction_step(ekf_X, ekf_P, ekf_U, dt);
 
     // measurement step
+    // with delayed fusion, wait for the end of the previous replay
+#if INS_EXT_POSE_USE_DELAY
+    if (ins_ext_pos.has_new_ext_pose && !ekf_hist.replaying) {
+#else
     if (ins_ext_pos.has_new_ext_pose) {
+#endif
 
       //fix psi
       static float last_psi = 0;
@@ -1193,8 +1267,32 @@ static inline void ekf_run(void)
       ins_ext_pos.has_new_ext_pose = false;
 
       DEBUG_PRINT("ekf measurement step Z = %f, %f, %f, %f \n", ekf_Z[0], ekf_Z[1], ekf_Z[2], ekf_Z[3]);
-      ekf_measurement_step(ekf_Z);
+#if INS_EXT_POSE_USE_DELAY
+      // correct the past state, dropped if older than the history
+      struct InsExtPoseEkfState *past = ins_delay_buffer_rewind(&ekf_hist, ins_ext_pos.ev_stamp);
+      if (past != NULL) {
+        // unwrap psi around the heading of the past state it corrects
+        ekf_Z[5] = ins_ext_pos.ev_att.psi;
+        while (ekf_Z[5] - past->X[8] > M_PI) {
+          ekf_Z[5] -= 2 * M_PI;
+        }
+        while (ekf_Z[5] - past->X[8] < -M_PI) {
+          ekf_Z[5] += 2 * M_PI;
+        }
+        ekf_measurement_step(past->X, past->P, ekf_Z);
+      }
+#else
+      ekf_measurement_step(ekf_X, ekf_P, ekf_Z);
+#endif
+    }
+
+#if INS_EXT_POSE_USE_DELAY
+    // re-propagate corrected past state, within the replay budget
+    if (ins_delay_buffer_replay(&ekf_hist, &ekf_hist_now)) {
+      float_vect_copy(ekf_X, ekf_hist_now.X, EKF_NUM_STATES);
+      memcpy(ekf_P, ekf_hist_now.P, sizeof(ekf_P));
     }
+#endif
   }
 
   // Export Results
@@ -44,36 +44,9 @@
 #include <Eigen/Dense>
 #pragma GCC diagnostic pop
 
-using namespace Eigen;
-
-/** Covariance matrix elements and size
- */
-enum MekfWindCovVar {
-  MEKF_WIND_qx, MEKF_WIND_qy, MEKF_WIND_qz,
-  MEKF_WIND_vx, MEKF_WIND_vy, MEKF_WIND_vz,
-  MEKF_WIND_px, MEKF_WIND_py, MEKF_WIND_pz,
-  MEKF_WIND_rbp, MEKF_WIND_rbq, MEKF_WIND_rbr,
-  MEKF_WIND_abx, MEKF_WIND_aby, MEKF_WIND_abz,
-  MEKF_WIND_bb,
-  MEKF_WIND_wx, MEKF_WIND_wy, MEKF_WIND_wz,
-  MEKF_WIND_COV_SIZE
-};
+#include "modules/ins/ins_mekf_wind_cov.h"
 
-typedef Matrix<float, MEKF_WIND_COV_SIZE, MEKF_WIND_COV_SIZE> MEKFWCov;
-
-/** Process noise elements and size
- */
-enum MekfWindPNoiseVar {
-  MEKF_WIND_qgp, MEKF_WIND_qgq, MEKF_WIND_qgr,
-  MEKF_WIND_qax, MEKF_WIND_qay, MEKF_WIND_qaz,
-  MEKF_WIND_qrbp, MEKF_WIND_qrbq, MEKF_WIND_qrbr,
-  MEKF_WIND_qabx, MEKF_WIND_qaby, MEKF_WIND_qabz,
-  MEKF_WIND_qbb,
-  MEKF_WIND_qwx, MEKF_WIND_qwy, MEKF_WIND_qwz,
-  MEKF_WIND_PROC_NOISE_SIZE
-};
-
-typedef Matrix<float, MEKF_WIND_PROC_NOISE_SIZE, MEKF_WIND_PROC_NOISE_SIZE> MEKFWPNoise;
+using namespace Eigen;
 
 /** Measurement noise elements and size
  */
@@ -213,6 +186,11 @@ struct InsMekfWindPrivate {
 #define INS_MEKF_WIND_DISABLE_WIND true
 #endif
 
+/** Use the dense covariance propagation instead of the block sparse one */
+#ifndef INS_MEKF_WIND_DENSE_PROPAGATION
+#define INS_MEKF_WIND_DENSE_PROPAGATION FALSE
+#endif
+
 // paramters
 struct ins_mekf_wind_parameters ins_mekf_wind_params;
 
@@ -376,36 +354,12 @@ void ins_mekf_wind_propagate(struct FloatRates *gyro, struct FloatVect3 *acc, fl
 
   // propagate covariance
   const Matrix3f Rq = mwp.state.quat.toRotationMatrix();
-  const Matrix3f Rqdt = Rq * dt;
   const Matrix3f RqA = skew_sym(Rq * accel_unbiased);
-  const Matrix3f RqAdt = RqA * dt;
-  const Matrix3f RqAdt2 = RqAdt * dt;
-
-  MEKFWCov A = MEKFWCov::Identity();
-  A.block<3,3>(MEKF_WIND_qx,MEKF_WIND_rbp) = -Rqdt;
-  A.block<3,3>(MEKF_WIND_vx,MEKF_WIND_qx) = -RqAdt;
-  A.block<3,3>(MEKF_WIND_vx,MEKF_WIND_rbp) = RqAdt2;
-  A.block<3,3>(MEKF_WIND_vx,MEKF_WIND_abx) = -Rqdt;
-  A.block<3,3>(MEKF_WIND_px,MEKF_WIND_qx) = -RqAdt2;
-  A.block<3,3>(MEKF_WIND_px,MEKF_WIND_vx) = Matrix3f::Identity() * dt;
-  A.block<3,3>(MEKF_WIND_px,MEKF_WIND_rbp) = RqAdt2 * dt;
-  A.block<3,3>(MEKF_WIND_px,MEKF_WIND_abx) = -Rqdt * dt;
-
-  Matrix<float, MEKF_WIND_COV_SIZE, MEKF_WIND_PROC_NOISE_SIZE> An;
-  An.setZero();
-  An.block<3,3>(MEKF_WIND_qx,MEKF_WIND_qgp) = Rq;
-  An.block<3,3>(MEKF_WIND_vx,MEKF_WIND_qax) = Rq;
-  An.block<3,3>(MEKF_WIND_rbp,MEKF_WIND_qrbp) = Matrix3f::Identity();
-  An.block<3,3>(MEKF_WIND_abx,MEKF_WIND_qabx) = Matrix3f::Identity();
-  An(MEKF_WIND_bb,MEKF_WIND_qbb) = 1.0f;
-  An.block<3,3>(MEKF_WIND_wx,MEKF_WIND_qwx) = Matrix3f::Identity();
-
-  MEKFWCov At(A);
-  At.transposeInPlace();
-  Matrix<float, MEKF_WIND_PROC_NOISE_SIZE, MEKF_WIND_COV_SIZE> Ant;
-  Ant = An.transpose();
-
-  mwp.P = A * mwp.P * At + An * mwp.Q * Ant * dt;
+#if INS_MEKF_WIND_DENSE_PROPAGATION
+  ins_mekf_wind_cov_propagate_dense(mwp.P, mwp.Q, Rq, RqA, dt);
+#else
+  ins_mekf_wind_cov_propagate(mwp.P, mwp.Q, Rq, RqA, dt);
+#endif
 
   if (ins_mekf_wind_params.disable_wind) {
     mwp.P.block<3,MEKF_WIND_COV_SIZE>(MEKF_WIND_wx,0) = Matrix<float,3,MEKF_WIND_COV_SIZE>::Zero();
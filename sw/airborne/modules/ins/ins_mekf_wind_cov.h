@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2017 Marton Brossard <martin.brossard@mines-paristech.fr>
+ *                    Gautier Hattenberger <gautier.hattenberger@enac.fr>
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/ins/ins_mekf_wind_cov.h
+ *
+ * Covariance propagation of the MEKF wind filter.
+ *
+ * The state transition matrix A is the identity plus a few 3x3 blocks
+ * and the process noise Q is diagonal. The block sparse version only
+ * computes the non trivial blocks of P = A * P * At + An * Q * Ant * dt
+ * and uses the symmetry of P. The dense version is kept as a reference.
+ *
+ * Eigen must be included before this file.
+ */
+
+#ifndef INS_MEKF_WIND_COV_H
+#define INS_MEKF_WIND_COV_H
+
+/** Covariance matrix elements and size
+ */
+enum MekfWindCovVar {
+  MEKF_WIND_qx, MEKF_WIND_qy, MEKF_WIND_qz,
+  MEKF_WIND_vx, MEKF_WIND_vy, MEKF_WIND_vz,
+  MEKF_WIND_px, MEKF_WIND_py, MEKF_WIND_pz,
+  MEKF_WIND_rbp, MEKF_WIND_rbq, MEKF_WIND_rbr,
+  MEKF_WIND_abx, MEKF_WIND_aby, MEKF_WIND_abz,
+  MEKF_WIND_bb,
+  MEKF_WIND_wx, MEKF_WIND_wy, MEKF_WIND_wz,
+  MEKF_WIND_COV_SIZE
+};
+
+typedef Eigen::Matrix<float, MEKF_WIND_COV_SIZE, MEKF_WIND_COV_SIZE> MEKFWCov;
+
+/** Process noise elements and size
+ */
+enum MekfWindPNoiseVar {
+  MEKF_WIND_qgp, MEKF_WIND_qgq, MEKF_WIND_qgr,
+  MEKF_WIND_qax, MEKF_WIND_qay, MEKF_WIND_qaz,
+  MEKF_WIND_qrbp, MEKF_WIND_qrbq, MEKF_WIND_qrbr,
+  MEKF_WIND_qabx, MEKF_WIND_qaby, MEKF_WIND_qabz,
+  MEKF_WIND_qbb,
+  MEKF_WIND_qwx, MEKF_WIND_qwy, MEKF_WIND_qwz,
+  MEKF_WIND_PROC_NOISE_SIZE
+};
+
+typedef Eigen::Matrix<float, MEKF_WIND_PROC_NOISE_SIZE, MEKF_WIND_PROC_NOISE_SIZE> MEKFWPNoise;
+
+/** Dense covariance propagation (reference)
+ * @param P covariance matrix, updated in place
+ * @param Q process noise matrix
+ * @param Rq rotation matrix of the current attitude
+ * @param RqA skew symmetric matrix of the unbiased accel rotated to NED
+ * @param dt time step
+ */
+static inline void ins_mekf_wind_cov_propagate_dense(MEKFWCov &P, const MEKFWPNoise &Q,
+    const Eigen::Matrix3f &Rq, const Eigen::Matrix3f &RqA, float dt)
+{
+  const Eigen::Matrix3f Rqdt = Rq * dt;
+  const Eigen::Matrix3f RqAdt = RqA * dt;
+  const Eigen::Matrix3f RqAdt2 = RqAdt * dt;
+
+  MEKFWCov A = MEKFWCov::Identity();
+  A.block<3,3>(MEKF_WIND_qx,MEKF_WIND_rbp) = -Rqdt;
+  A.block<3,3>(MEKF_WIND_vx,MEKF_WIND_qx) = -RqAdt;
+  A.block<3,3>(MEKF_WIND_vx,MEKF_WIND_rbp) = RqAdt2;
+  A.block<3,3>(MEKF_WIND_vx,MEKF_WIND_abx) = -Rqdt;
+  A.block<3,3>(MEKF_WIND_px,MEKF_WIND_qx) = -RqAdt2;
+  A.block<3,3>(MEKF_WIND_px,MEKF_WIND_vx) = Eigen::Matrix3f::Identity() * dt;
+  A.block<3,3>(MEKF_WIND_px,MEKF_WIND_rbp) = RqAdt2 * dt;
+  A.block<3,3>(MEKF_WIND_px,MEKF_WIND_abx) = -Rqdt * dt;
+
+  Eigen::Matrix<float, MEKF_WIND_COV_SIZE, MEKF_WIND_PROC_NOISE_SIZE> An;
+  An.setZero();
+  An.block<3,3>(MEKF_WIND_qx,MEKF_WIND_qgp) = Rq;
+  An.block<3,3>(MEKF_WIND_vx,MEKF_WIND_qax) = Rq;
+  An.block<3,3>(MEKF_WIND_rbp,MEKF_WIND_qrbp) = Eigen::Matrix3f::Identity();
+  An.block<3,3>(MEKF_WIND_abx,MEKF_WIND_qabx) = Eigen::Matrix3f::Identity();
+  An(MEKF_WIND_bb,MEKF_WIND_qbb) = 1.0f;
+  An.block<3,3>(MEKF_WIND_wx,MEKF_WIND_qwx) = Eigen::Matrix3f::Identity();
+
+  MEKFWCov At(A);
+  At.transposeInPlace();
+  Eigen::Matrix<float, MEKF_WIND_PROC_NOISE_SIZE, MEKF_WIND_COV_SIZE> Ant;
+  Ant = An.transpose();
+
+  P = A * P * At + An * Q * Ant * dt;
+}
+
+/** Block sparse covariance propagation
+ * Same result as ins_mekf_wind_cov_propagate_dense, Q must be diagonal
+ * and P symmetric.
+ * @param P covariance matrix, updated in place
+ * @param Q process noise matrix (diagonal)
+ * @param Rq rotation matrix of the current attitude
+ * @param RqA skew symmetric matrix of the unbiased accel rotated to NED
+ * @param dt time step
+ */
+static inline void ins_mekf_wind_cov_propagate(MEKFWCov &P, const MEKFWPNoise &Q,
+    const Eigen::Matrix3f &Rq, const Eigen::Matrix3f &RqA, float dt)
+{
+  const int N = MEKF_WIND_COV_SIZE;
+  const int NQVP = MEKF_WIND_rbp; // size of the quat, speed, pos block
+  const Eigen::Matrix3f Rqdt = Rq * dt;
+  const Eigen::Matrix3f RqAdt = RqA * dt;
+  const Eigen::Matrix3f RqAdt2 = RqAdt * dt;
+
+  // non identity blocks of A, named by (row, column) blocks, A_p_v = I * dt
+  const Eigen::Matrix3f A_q_rb = -Rqdt;
+  const Eigen::Matrix3f A_v_q = -RqAdt;
+  const Eigen::Matrix3f A_v_rb = RqAdt2;
+  const Eigen::Matrix3f A_v_ab = -Rqdt;
+  const Eigen::Matrix3f A_p_q = -RqAdt2;
+  const Eigen::Matrix3f A_p_rb = RqAdt2 * dt;
+  const Eigen::Matrix3f A_p_ab = -Rqdt * dt;
+
+  // P <- A * P, only quat, speed and pos rows are modified
+  // pos rows first as they depend on the quat and speed rows
+  P.block<3,N>(MEKF_WIND_px,0) += A_p_q * P.block<3,N>(MEKF_WIND_qx,0)
+                                  + dt * P.block<3,N>(MEKF_WIND_vx,0)
+                                  + A_p_rb * P.block<3,N>(MEKF_WIND_rbp,0)
+                                  + A_p_ab * P.block<3,N>(MEKF_WIND_abx,0);
+  P.block<3,N>(MEKF_WIND_vx,0) += A_v_q * P.block<3,N>(MEKF_WIND_qx,0)
+                                  + A_v_rb * P.block<3,N>(MEKF_WIND_rbp,0)
+                                  + A_v_ab * P.block<3,N>(MEKF_WIND_abx,0);
+  P.block<3,N>(MEKF_WIND_qx,0) += A_q_rb * P.block<3,N>(MEKF_WIND_rbp,0);
+
+  // P <- P * At, only quat, speed and pos columns are modified
+  // and by symmetry only their upper part needs to be computed
+  P.block<NQVP,3>(0,MEKF_WIND_px) += P.block<NQVP,3>(0,MEKF_WIND_qx) * A_p_q.transpose()
+                                     + dt * P.block<NQVP,3>(0,MEKF_WIND_vx)
+                                     + P.block<NQVP,3>(0,MEKF_WIND_rbp) * A_p_rb.transpose()
+                                     + P.block<NQVP,3>(0,MEKF_WIND_abx) * A_p_ab.transpose();
+  P.block<NQVP,3>(0,MEKF_WIND_vx) += P.block<NQVP,3>(0,MEKF_WIND_qx) * A_v_q.transpose()
+                                     + P.block<NQVP,3>(0,MEKF_WIND_rbp) * A_v_rb.transpose()
+                                     + P.block<NQVP,3>(0,MEKF_WIND_abx) * A_v_ab.transpose();
+  P.block<NQVP,3>(0,MEKF_WIND_qx) += P.block<NQVP,3>(0,MEKF_WIND_rbp) * A_q_rb.transpose();
+  P.block<N-NQVP,NQVP>(NQVP,0) = P.block<NQVP,N-NQVP>(0,NQVP).transpose();
+
+  // P <- P + An * Q * Ant * dt, with Q diagonal
+  const Eigen::Matrix3f Qg = Q.diagonal().segment<3>(MEKF_WIND_qgp).asDiagonal();
+  const Eigen::Matrix3f Qa = Q.diagonal().segment<3>(MEKF_WIND_qax).asDiagonal();
+  P.block<3,3>(MEKF_WIND_qx,MEKF_WIND_qx) += Rq * Qg * Rq.transpose() * dt;
+  P.block<3,3>(MEKF_WIND_vx,MEKF_WIND_vx) += Rq * Qa * Rq.transpose() * dt;
+  P.diagonal().segment<3>(MEKF_WIND_rbp) += Q.diagonal().segment<3>(MEKF_WIND_qrbp) * dt;
+  P.diagonal().segment<3>(MEKF_WIND_abx) += Q.diagonal().segment<3>(MEKF_WIND_qabx) * dt;
+  P(MEKF_WIND_bb,MEKF_WIND_bb) += Q(MEKF_WIND_qbb,MEKF_WIND_qbb) * dt;
+  P.diagonal().segment<3>(MEKF_WIND_wx) += Q.diagonal().segment<3>(MEKF_WIND_qwx) * dt;
+}
+
+#endif /* INS_MEKF_WIND_COV_H */
@@ -49,11 +49,70 @@ struct chibios_sdlog flightrecorder_sdlog;
 #error "You need to use a telemetry xml file with FlightRecorder process!"
 #endif
 
+#if ABI_TRACE
+#include "modules/core/abi.h"
+#include "autopilot.h"
+
+/** Number of ABI trace events sent per periodic call during a dump */
+#ifndef FLIGHTRECORDER_ABI_TRACE_RATE
+#define FLIGHTRECORDER_ABI_TRACE_RATE 4
+#endif
+
+/** Dump the ABI trace on autopilot mode change (including failsafe) */
+#ifndef FLIGHTRECORDER_ABI_TRACE_ON_MODE
+#define FLIGHTRECORDER_ABI_TRACE_ON_MODE TRUE
+#endif
+
+static uint32_t abi_trace_dump_idx;
+static uint32_t abi_trace_dump_end;
+static uint8_t abi_trace_last_mode;
+
+void flight_recorder_dump_abi_trace(void)
+{
+  if (abi_trace_paused) {
+    return; // dump already in progress
+  }
+  // stop recording until the whole buffer has been sent
+  abi_trace_paused = true;
+  abi_trace_dump_end = abi_trace_idx;
+  abi_trace_dump_idx = abi_trace_idx > ABI_TRACE_SIZE ? abi_trace_idx - ABI_TRACE_SIZE : 0;
+}
+
+/** Send a few events of the frozen trace buffer as PAYLOAD messages */
+static void flight_recorder_send_abi_trace(void)
+{
+#if FLIGHTRECORDER_ABI_TRACE_ON_MODE
+  uint8_t mode = autopilot_get_mode();
+  if (mode != abi_trace_last_mode) {
+    abi_trace_last_mode = mode;
+    flight_recorder_dump_abi_trace();
+  }
+#endif
+  if (!abi_trace_paused) {
+    return;
+  }
+  for (uint8_t i = 0; i < FLIGHTRECORDER_ABI_TRACE_RATE && abi_trace_dump_idx < abi_trace_dump_end; i++) {
+    struct abi_trace_event *ev = &abi_trace_events[abi_trace_dump_idx & (ABI_TRACE_SIZE - 1)];
+    pprz_msg_send_PAYLOAD(&pprzlog_tp.trans_tx, &(FLIGHTRECORDER_DEVICE).device, AC_ID,
+                          sizeof(struct abi_trace_event), (uint8_t *)ev);
+    abi_trace_dump_idx++;
+  }
+  if (abi_trace_dump_idx >= abi_trace_dump_end) {
+    abi_trace_paused = false;
+  }
+}
+#endif
+
 void flight_recorder_init()
 {
 #if FLIGHTRECORDER_SDLOG
   chibios_sdlog_init(&flightrecorder_sdlog, &flightRecorderLogFile);
 #endif
+#if ABI_TRACE
+  abi_trace_dump_idx = 0;
+  abi_trace_dump_end = 0;
+  abi_trace_last_mode = autopilot_get_mode();
+#endif
 }
 
 void flight_recorder_periodic()
@@ -66,6 +125,9 @@ void flight_recorder_periodic()
 #if PERIODIC_TELEMETRY
   periodic_telemetry_send_FlightRecorder(DefaultPeriodic, &pprzlog_tp.trans_tx, &(FLIGHTRECORDER_DEVICE).device);
 #endif
+#if ABI_TRACE
+  flight_recorder_send_abi_trace();
+#endif
 }
 
 void flight_recorder_log_msg_up(uint8_t *buf) {
@@ -43,5 +43,12 @@ extern void flight_recorder_periodic(void);
 
 extern void flight_recorder_log_msg_up(uint8_t *buf);
 
+#if ABI_TRACE
+/** Dump the ABI trace buffer to the flight recorder
+ * Recording is paused until all events are sent.
+ */
+extern void flight_recorder_dump_abi_trace(void);
+#endif
+
 #endif
 
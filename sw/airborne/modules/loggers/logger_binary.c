@@ -0,0 +1,470 @@
+/*
+ * Copyright (C) 2022 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+/** @file modules/loggers/logger_binary.c
+ *  @brief Binary file logger for Linux based autopilots
+ *
+ * File layout (little endian):
+ *  - char[8]  magic "PPRZBLOG"
+ *  - uint16   version
+ *  - uint16   number of fields
+ *  - uint16   record size in bytes
+ *  - uint16   reserved
+ *  - uint32   offset of the first record
+ *  - for each field: uint8 type ('f', 'i', 'I', 'h'), uint8 name length, name
+ *  - zero padding up to the first record, then the records back to back
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // for O_DIRECT
+#endif
+
+#include "logger_binary.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "std.h"
+
+#include "mcu_periph/sys_time.h"
+#include "state.h"
+#include "generated/airframe.h"
+#include "generated/modules.h"
+#include "rt_priority.h"
+
+/** Set the default binary logger path to the USB drive */
+#ifndef LOGGER_BINARY_PATH
+#define LOGGER_BINARY_PATH /data/video/usb
+#endif
+
+/** Size of the blocks written to the file, multiple of LOGGER_BINARY_ALIGN */
+#ifndef LOGGER_BINARY_BLOCK_SIZE
+#define LOGGER_BINARY_BLOCK_SIZE (64 * 1024)
+#endif
+
+/** Number of blocks in the staging ring, power of two */
+#ifndef LOGGER_BINARY_RING_BLOCKS
+#define LOGGER_BINARY_RING_BLOCKS 16
+#endif
+
+/** Use O_DIRECT to bypass the page cache */
+#ifndef LOGGER_BINARY_DIRECT_IO
+#define LOGGER_BINARY_DIRECT_IO FALSE
+#endif
+
+/** Nice level of the writer thread */
+#ifndef LOGGER_BINARY_NICE_LEVEL
+#define LOGGER_BINARY_NICE_LEVEL 10
+#endif
+
+/** Period of the writer thread in microseconds */
+#ifndef LOGGER_BINARY_WRITER_PERIOD
+#define LOGGER_BINARY_WRITER_PERIOD 20000
+#endif
+
+// define parameters logged by default
+
+#ifndef LOGGER_BINARY_COMMANDS
+#define LOGGER_BINARY_COMMANDS TRUE
+#endif
+
+#ifndef LOGGER_BINARY_ACTUATORS
+#define LOGGER_BINARY_ACTUATORS FALSE
+#endif
+
+#ifndef LOGGER_BINARY_INDI
+#define LOGGER_BINARY_INDI FALSE
+#endif
+
+#define LOGGER_BINARY_ALIGN 4096
+#define LOGGER_BINARY_RING_SIZE (LOGGER_BINARY_BLOCK_SIZE * LOGGER_BINARY_RING_BLOCKS)
+#define LOGGER_BINARY_MAX_RECORD 1024
+#define LOGGER_BINARY_VERSION 1
+
+#if (LOGGER_BINARY_BLOCK_SIZE % LOGGER_BINARY_ALIGN) != 0
+#error "LOGGER_BINARY_BLOCK_SIZE must be a multiple of 4096"
+#endif
+
+#if (LOGGER_BINARY_RING_SIZE & (LOGGER_BINARY_RING_SIZE - 1)) != 0
+#error "LOGGER_BINARY_BLOCK_SIZE * LOGGER_BINARY_RING_BLOCKS must be a power of two"
+#endif
+
+// extra includes
+
+#if LOGGER_BINARY_COMMANDS
+#include "modules/core/commands.h"
+#endif
+
+#if LOGGER_BINARY_ACTUATORS
+#include "modules/actuators/actuators.h"
+#endif
+
+#if LOGGER_BINARY_INDI
+#include "firmwares/rotorcraft/stabilization/stabilization_indi.h"
+extern float indi_u[INDI_NUM_ACT];
+extern float indi_du[INDI_NUM_ACT];
+extern float actuator_state[INDI_NUM_ACT];
+extern float angular_acceleration[3];
+extern struct FloatRates angular_accel_ref;
+#endif
+
+uint32_t logger_binary_dropped = 0;
+
+/** Record being built, or schema being built when buf is NULL */
+struct logger_binary_record {
+  uint8_t *buf;         ///< record buffer, NULL to only build the schema
+  uint16_t size;        ///< record size
+  uint8_t *schema;      ///< schema buffer
+  uint16_t schema_len;  ///< schema length
+  uint16_t nb_fields;   ///< number of fields in schema
+  uint16_t schema_max;  ///< schema buffer size
+  bool overflow;        ///< a field did not fit in the record or in the schema
+};
+
+/** Staging ring, written by the autopilot thread and read by the writer thread.
+ * Indexes are free running byte counters, only the producer writes ring_head
+ * and only the consumer writes ring_tail.
+ */
+static uint8_t *ring = NULL;
+static uint32_t ring_head = 0;
+static uint32_t ring_tail = 0;
+
+static int logger_fd = -1;
+static off_t logger_data_offset = 0;
+static uint64_t logger_written = 0;
+static volatile bool writer_running = false;
+static pthread_t writer_thread;
+
+static uint8_t record_buf[LOGGER_BINARY_MAX_RECORD];
+
+
+/** Field helpers */
+
+static void log_field(struct logger_binary_record *rec, const char *name, char type, const void *value, uint8_t size)
+{
+  if (rec->size + size > LOGGER_BINARY_MAX_RECORD) {
+    rec->overflow = true;
+    return;
+  }
+  if (rec->buf != NULL) {
+    memcpy(&rec->buf[rec->size], value, size);
+  } else {
+    uint8_t len = strlen(name);
+    if (rec->schema_len + 2 + len > rec->schema_max) {
+      // the header would not describe the records
+      rec->overflow = true;
+      return;
+    }
+    rec->schema[rec->schema_len++] = type;
+    rec->schema[rec->schema_len++] = len;
+    memcpy(&rec->schema[rec->schema_len], name, len);
+    rec->schema_len += len;
+    rec->nb_fields++;
+  }
+  rec->size += size;
+}
+
+static inline void log_uint32(struct logger_binary_record *rec, const char *name, uint32_t value)
+{
+  log_field(rec, name, 'I', &value, sizeof(uint32_t));
+}
+
+/** Log an array of values of the same type
+ * In data mode the array is copied at once, names are only built for the schema.
+ * @param suffix list of name suffixes, or NULL to use the index
+ */
+static void log_array(struct logger_binary_record *rec, const char *prefix, const char *const *suffix,
+                      char type, const void *values, uint8_t elem_size, uint8_t nb)
+{
+  if (rec->buf != NULL) {
+    if (rec->size + nb * elem_size <= LOGGER_BINARY_MAX_RECORD) {
+      memcpy(&rec->buf[rec->size], values, nb * elem_size);
+      rec->size += nb * elem_size;
+    } else {
+      rec->overflow = true;
+    }
+  } else {
+    char name[64];
+    for (uint8_t i = 0; i < nb; i++) {
+      if (suffix != NULL) {
+        snprintf(name, sizeof(name), "%s_%s", prefix, suffix[i]);
+      } else {
+        snprintf(name, sizeof(name), "%s_%d", prefix, i);
+      }
+      log_field(rec, name, type, (const uint8_t *)values + i * elem_size, elem_size);
+    }
+  }
+}
+
+static const char *const xyz[] = { "x", "y", "z" };
+static const char *const pqr[] = { "p", "q", "r" };
+static const char *const euler[] = { "phi", "theta", "psi" };
+
+/** Fill record or schema
+ * This is the only place where logged fields are listed,
+ * so the schema always matches the records.
+ */
+static void logger_binary_fill(struct logger_binary_record *rec)
+{
+  log_uint32(rec, "time_us", get_sys_time_usec());
+  log_array(rec, "pos", xyz, 'f', stateGetPositionNed_f(), sizeof(float), 3);
+  log_array(rec, "vel", xyz, 'f', stateGetSpeedNed_f(), sizeof(float), 3);
+  log_array(rec, "accel", xyz, 'f', stateGetAccelNed_f(), sizeof(float), 3);
+  log_array(rec, "att", euler, 'f', stateGetNedToBodyEulers_f(), sizeof(float), 3);
+  log_array(rec, "rate", pqr, 'f', stateGetBodyRates_f(), sizeof(float), 3);
+#if LOGGER_BINARY_COMMANDS
+  log_array(rec, "cmd", NULL, 'h', commands, sizeof(commands[0]), COMMANDS_NB);
+#endif
+#if LOGGER_BINARY_ACTUATORS
+  log_array(rec, "act", NULL, 'h', actuators_pprz, sizeof(actuators_pprz[0]), ACTUATORS_NB);
+#endif
+#if LOGGER_BINARY_INDI
+  log_array(rec, "indi_u", NULL, 'f', indi_u, sizeof(float), INDI_NUM_ACT);
+  log_array(rec, "indi_du", NULL, 'f', indi_du, sizeof(float), INDI_NUM_ACT);
+  log_array(rec, "act_state", NULL, 'f', actuator_state, sizeof(float), INDI_NUM_ACT);
+  log_array(rec, "act_state_filt", NULL, 'f', actuator_state_filt_vect, sizeof(float), INDI_NUM_ACT);
+  log_array(rec, "ang_accel", pqr, 'f', angular_acceleration, sizeof(float), 3);
+  log_array(rec, "ang_accel_ref", pqr, 'f', &angular_accel_ref, sizeof(float), 3);
+#endif
+}
+
+
+/** Staging ring */
+
+/** Push a record in the ring, never blocks
+ * @return false if the ring is full and the record is dropped
+ */
+static bool ring_push(const uint8_t *data, uint16_t len)
+{
+  uint32_t tail = __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE);
+  if (LOGGER_BINARY_RING_SIZE - (ring_head - tail) < len) {
+    return false;
+  }
+  uint32_t idx = ring_head & (LOGGER_BINARY_RING_SIZE - 1);
+  uint32_t head = LOGGER_BINARY_RING_SIZE - idx;
+  if (len <= head) {
+    memcpy(&ring[idx], data, len);
+  } else {
+    memcpy(&ring[idx], data, head);
+    memcpy(ring, &data[head], len - head);
+  }
+  __atomic_store_n(&ring_head, ring_head + len, __ATOMIC_RELEASE);
+  return true;
+}
+
+/** Write all complete blocks available in the ring */
+static void ring_write_blocks(void)
+{
+  uint32_t head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+  while (head - ring_tail >= LOGGER_BINARY_BLOCK_SIZE) {
+    // tail is always on a block boundary, so the block is contiguous and aligned
+    uint8_t *block = &ring[ring_tail & (LOGGER_BINARY_RING_SIZE - 1)];
+    if (write(logger_fd, block, LOGGER_BINARY_BLOCK_SIZE) != LOGGER_BINARY_BLOCK_SIZE) {
+      perror("[logger_binary] block write failed");
+    }
+    logger_written += LOGGER_BINARY_BLOCK_SIZE;
+    __atomic_store_n(&ring_tail, ring_tail + LOGGER_BINARY_BLOCK_SIZE, __ATOMIC_RELEASE);
+  }
+}
+
+/** Write the last incomplete block, padded to the alignment, and cut the file to its real size */
+static void ring_flush(void)
+{
+  ring_write_blocks();
+  uint32_t len = ring_head - ring_tail;
+  if (len > 0) {
+    uint32_t padded = ((len + LOGGER_BINARY_ALIGN - 1) / LOGGER_BINARY_ALIGN) * LOGGER_BINARY_ALIGN;
+    uint8_t *block = &ring[ring_tail & (LOGGER_BINARY_RING_SIZE - 1)];
+    memset(&block[len], 0, padded - len);
+    if (write(logger_fd, block, padded) != (ssize_t)padded) {
+      perror("[logger_binary] last block write failed");
+    }
+    logger_written += len;
+    ring_tail += len;
+  }
+  if (ftruncate(logger_fd, logger_data_offset + logger_written) != 0) {
+    perror("[logger_binary] truncate failed");
+  }
+}
+
+static void *logger_binary_writer(void *arg __attribute__((unused)))
+{
+  set_nice_level(LOGGER_BINARY_NICE_LEVEL);
+  while (writer_running) {
+    ring_write_blocks();
+    usleep(LOGGER_BINARY_WRITER_PERIOD);
+  }
+  return NULL;
+}
+
+/** Write the file header with the record schema
+ * @return true on success
+ */
+static bool logger_binary_write_header(void)
+{
+  uint8_t *header;
+  if (posix_memalign((void **)&header, LOGGER_BINARY_ALIGN, LOGGER_BINARY_ALIGN) != 0) {
+    return false;
+  }
+  memset(header, 0, LOGGER_BINARY_ALIGN);
+
+  // build schema after the fixed part of the header
+  struct logger_binary_record rec = {
+    .buf = NULL, .size = 0,
+    .schema = &header[20], .schema_len = 0, .nb_fields = 0,
+    .schema_max = LOGGER_BINARY_ALIGN - 20, .overflow = false
+  };
+  logger_binary_fill(&rec);
+  if (rec.overflow) {
+    // the logged fields don't fit in a record or in the header
+    free(header);
+    return false;
+  }
+
+  uint16_t version = LOGGER_BINARY_VERSION;
+  uint32_t offset = LOGGER_BINARY_ALIGN;
+  memcpy(&header[0], "PPRZBLOG", 8);
+  memcpy(&header[8], &version, 2);
+  memcpy(&header[10], &rec.nb_fields, 2);
+  memcpy(&header[12], &rec.size, 2);
+  memcpy(&header[16], &offset, 4);
+
+  bool ok = (write(logger_fd, header, LOGGER_BINARY_ALIGN) == LOGGER_BINARY_ALIGN);
+  free(header);
+  logger_data_offset = LOGGER_BINARY_ALIGN;
+  return ok;
+}
+
+
+/** Start the binary logger and open a new file */
+void logger_binary_start(void)
+{
+  // Ensure that the module is running when started with this function
+  logger_binary_logger_binary_periodic_status = MODULES_RUN;
+
+  if (logger_fd >= 0) {
+    return; // already started
+  }
+
+  // Create output folder if necessary
+  if (access(STRINGIFY(LOGGER_BINARY_PATH), F_OK)) {
+    char save_dir_cmd[256];
+    sprintf(save_dir_cmd, "mkdir -p %s", STRINGIFY(LOGGER_BINARY_PATH));
+    if (system(save_dir_cmd) != 0) {
+      printf("[logger_binary] Could not create log file directory %s.\n", STRINGIFY(LOGGER_BINARY_PATH));
+      return;
+    }
+  }
+
+  // Allocate aligned staging ring
+  if (ring == NULL && posix_memalign((void **)&ring, LOGGER_BINARY_ALIGN, LOGGER_BINARY_RING_SIZE) != 0) {
+    ring = NULL;
+    printf("[logger_binary] Could not allocate staging buffer\n");
+    return;
+  }
+  ring_head = 0;
+  ring_tail = 0;
+  logger_written = 0;
+  logger_binary_dropped = 0;
+
+  // Get current date/time for filename
+  char date_time[80];
+  time_t now = time(0);
+  struct tm  tstruct;
+  tstruct = *localtime(&now);
+  strftime(date_time, sizeof(date_time), "%Y%m%d-%H%M%S", &tstruct);
+
+  uint32_t counter = 0;
+  char filename[512];
+
+  // Check for available files
+  sprintf(filename, "%s/%s.bin", STRINGIFY(LOGGER_BINARY_PATH), date_time);
+  while (access(filename, F_OK) == 0) {
+    sprintf(filename, "%s/%s_%05d.bin", STRINGIFY(LOGGER_BINARY_PATH), date_time, counter);
+    counter++;
+  }
+
+  int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#if LOGGER_BINARY_DIRECT_IO
+  flags |= O_DIRECT;
+#endif
+  logger_fd = open(filename, flags, 0644);
+  if (logger_fd < 0) {
+    printf("[logger_binary] ERROR opening log file %s!\n", filename);
+    return;
+  }
+
+  if (!logger_binary_write_header()) {
+    printf("[logger_binary] ERROR writing header to %s!\n", filename);
+    close(logger_fd);
+    logger_fd = -1;
+    return;
+  }
+
+  writer_running = true;
+  if (pthread_create(&writer_thread, NULL, logger_binary_writer, NULL) != 0) {
+    printf("[logger_binary] Could not create writer thread\n");
+    writer_running = false;
+    close(logger_fd);
+    logger_fd = -1;
+    return;
+  }
+#ifndef __APPLE__
+  pthread_setname_np(writer_thread, "logger_binary");
+#endif
+
+  printf("[logger_binary] Start logging to %s...\n", filename);
+}
+
+/** Stop the logger, flush the ring and nicely close the file */
+void logger_binary_stop(void)
+{
+  if (logger_fd < 0) {
+    return;
+  }
+  writer_running = false;
+  pthread_join(writer_thread, NULL);
+  ring_flush();
+  close(logger_fd);
+  logger_fd = -1;
+  if (logger_binary_dropped > 0) {
+    printf("[logger_binary] %u records dropped\n", logger_binary_dropped);
+  }
+}
+
+/** Log the values to the staging ring */
+void logger_binary_periodic(void)
+{
+  if (logger_fd < 0) {
+    return;
+  }
+  struct logger_binary_record rec = { .buf = record_buf, .size = 0, .overflow = false };
+  logger_binary_fill(&rec);
+  if (!ring_push(rec.buf, rec.size)) {
+    logger_binary_dropped++;
+  }
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2022 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+/** @file modules/loggers/logger_binary.h
+ *  @brief Binary file logger for Linux based autopilots
+ *
+ * Records are written by the autopilot thread into a lock-free single
+ * producer / single consumer staging ring, and a low priority writer thread
+ * flushes complete blocks of the ring to the file.
+ * The file starts with a schema describing the record fields, it can be
+ * converted to CSV with logger_binary_parse.py.
+ */
+
+#ifndef LOGGER_BINARY_H_
+#define LOGGER_BINARY_H_
+
+#include "std.h"
+
+/** Number of records dropped because the staging ring was full */
+extern uint32_t logger_binary_dropped;
+
+extern void logger_binary_start(void);
+extern void logger_binary_stop(void);
+extern void logger_binary_periodic(void);
+
+#endif /* LOGGER_BINARY_H_ */
@@ -0,0 +1,75 @@
+#! /usr/bin/env python3
+#
+# Convert a binary log file written by the logger_binary module
+# to CSV (or Parquet if pandas and pyarrow are available)
+#
+# usage: logger_binary_parse.py log.bin [-o out.csv] [--parquet]
+
+import argparse
+import struct
+import sys
+
+MAGIC = b'PPRZBLOG'
+TYPES = {'f': 'f', 'i': 'i', 'I': 'I', 'h': 'h'}
+
+
+def read_schema(data):
+    header = data.read(20)
+    if len(header) < 20 or header[0:8] != MAGIC:
+        raise ValueError("not a logger_binary file")
+    version, nb_fields, record_size, _, offset = struct.unpack('<HHHHI', header[8:20])
+    if version != 1:
+        raise ValueError("unsupported version %d" % version)
+    names = []
+    fmt = '<'
+    for _ in range(nb_fields):
+        t, l = struct.unpack('<BB', data.read(2))
+        names.append(data.read(l).decode('ascii'))
+        fmt += TYPES[chr(t)]
+    if struct.calcsize(fmt) != record_size:
+        raise ValueError("schema does not match record size")
+    data.seek(offset)
+    return names, fmt, record_size
+
+
+def records(data, fmt, record_size):
+    s = struct.Struct(fmt)
+    while True:
+        buf = data.read(record_size * 1024)
+        if not buf:
+            break
+        nb = len(buf) // record_size
+        for r in s.iter_unpack(buf[:nb * record_size]):
+            yield r
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert logger_binary files")
+    parser.add_argument('file', help="binary log file")
+    parser.add_argument('-o', '--output', help="output file (default: input file with new extension)")
+    parser.add_argument('--parquet', action='store_true', help="write Parquet instead of CSV")
+    args = parser.parse_args()
+
+    ext = '.parquet' if args.parquet else '.csv'
+    out_name = args.output or (args.file.rsplit('.', 1)[0] + ext)
+
+    with open(args.file, 'rb') as data:
+        names, fmt, record_size = read_schema(data)
+        if args.parquet:
+            try:
+                import pandas as pd
+            except ImportError:
+                print("pandas (and pyarrow) are needed for Parquet output")
+                sys.exit(1)
+            df = pd.DataFrame(list(records(data, fmt, record_size)), columns=names)
+            df.to_parquet(out_name)
+        else:
+            with open(out_name, 'w') as out:
+                out.write(','.join(names) + '\n')
+                for r in records(data, fmt, record_size):
+                    out.write(','.join(str(v) for v in r) + '\n')
+    print("Converted %s to %s" % (args.file, out_name))
+
+
+if __name__ == '__main__':
+    main()
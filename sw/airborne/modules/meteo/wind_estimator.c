@@ -25,7 +25,7 @@
  */
 
 #include "modules/meteo/wind_estimator.h"
-#include "modules/meteo/lib_ukf_wind_estimator/UKF_Wind_Estimator.h"
+#include "modules/meteo/wind_estimator_ukf.h"
 #include "mcu_periph/sys_time.h"
 #include "math/pprz_algebra_float.h"
 #include "math/pprz_geodetic_float.h"
@@ -118,20 +118,29 @@ static FILE* pprzLogFile = NULL;
 static bool log_we_started;
 #endif
 
-// matrix element
-#define MAT_EL(_m, _l, _c, _n) _m[_l + _c * _n]
-
 // wind estimator public structure
 struct WindEstimator wind_estimator;
 
+// filter, inputs and parameters
+static struct WeUkf we_ukf;
+static struct {
+  float rates[3];       ///< body rates (rad/s)
+  float accel[3];       ///< body accelerations without gravity (m/s^2)
+  float q[4];           ///< NED to body quaternion
+  float z[WE_UKF_M];    ///< ground speed (m/s), airspeed (m/s), aoa (rad), sideslip (rad)
+  float dt;             ///< time step (s)
+} we_in;
+static float we_Q[WE_UKF_N];
+static float we_R[WE_UKF_M];
+
 // local variables
 static uint32_t time_step_before;     // last periodic time
 
 /* Thread declaration
- * MATLAB UKF is using at least 6.6KB of stack
+ * UKF is using about 3KB of stack, leave room for logging
  */
 #ifndef SITL
-static THD_WORKING_AREA(wa_thd_windestimation, 8 * 1024);
+static THD_WORKING_AREA(wa_thd_windestimation, 6 * 1024);
 static __attribute__((noreturn)) void thd_windestimate(void *arg);
 
 static MUTEX_DECL(we_ukf_mtx);        // mutex for data acces protection
@@ -144,49 +153,31 @@ static SEMAPHORE_DECL(we_ukf_sem, 0); // semaaphore for sending signal
 /*----------------------------------------------------*/
 void init_calculator(void)
 {
-  UKF_Wind_Estimator_initialize();
-
-  // FIXME would be better to force Matlab to do this in initialize function
-  // zero input vector
-  memset(&ukf_U, 0, sizeof(ExtU));
-  // zero output vector
-  memset(&ukf_Y, 0, sizeof(ExtY));
-  // zero internal structure
-  memset(&ukf_DW, 0, sizeof(DW));
-  // zero init structure
-  memset(&ukf_init, 0, sizeof(ukf_init_type));
-  // zero params structure
-  memset(&ukf_params, 0, sizeof(ukf_params_type));
-
-  ukf_init.x0[6] = 1.0f; // initial airspeed scale factor
-
-  MAT_EL(ukf_init.P0, 0, 0, 7) = WE_UKF_P0;
-  MAT_EL(ukf_init.P0, 1, 1, 7) = WE_UKF_P0;
-  MAT_EL(ukf_init.P0, 2, 2, 7) = WE_UKF_P0;
-  MAT_EL(ukf_init.P0, 3, 3, 7) = WE_UKF_P0;
-  MAT_EL(ukf_init.P0, 4, 4, 7) = WE_UKF_P0;
-  MAT_EL(ukf_init.P0, 5, 5, 7) = WE_UKF_P0;
-  MAT_EL(ukf_init.P0, 6, 6, 7) = WE_UKF_P0;
-
-  MAT_EL(ukf_params.R, 0, 0, 6) = powf(WE_UKF_R_GS, 2);
-  MAT_EL(ukf_params.R, 1, 1, 6) = powf(WE_UKF_R_GS, 2);
-  MAT_EL(ukf_params.R, 2, 2, 6) = powf(WE_UKF_R_GS, 2);
-  MAT_EL(ukf_params.R, 3, 3, 6) = powf(WE_UKF_R_VA, 2);
-  MAT_EL(ukf_params.R, 4, 4, 6) = powf(WE_UKF_R_AOA, 2);
-  MAT_EL(ukf_params.R, 5, 5, 6) = powf(WE_UKF_R_SSA, 2);
-
-  MAT_EL(ukf_params.Q, 0, 0, 7) = powf(WE_UKF_Q_VA, 2);
-  MAT_EL(ukf_params.Q, 1, 1, 7) = powf(WE_UKF_Q_VA, 2);
-  MAT_EL(ukf_params.Q, 2, 2, 7) = powf(WE_UKF_Q_VA, 2);
-  MAT_EL(ukf_params.Q, 3, 3, 7) = powf(WE_UKF_Q_WIND, 2);
-  MAT_EL(ukf_params.Q, 4, 4, 7) = powf(WE_UKF_Q_WIND, 2);
-  MAT_EL(ukf_params.Q, 5, 5, 7) = powf(WE_UKF_Q_WIND, 2);
-  MAT_EL(ukf_params.Q, 6, 6, 7) = powf(WE_UKF_Q_VA_SCALE, 2);
-
-  ukf_init.ki = WE_UKF_KI;
-  ukf_init.alpha = WE_UKF_ALPHA;
-  ukf_init.beta = WE_UKF_BETA;
-  ukf_params.dt = WIND_ESTIMATOR_PERIODIC_PERIOD; // actually measured later
+  memset(&we_in, 0, sizeof(we_in));
+
+  const float x0[WE_UKF_N] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f }; // initial airspeed scale factor is 1
+  const float P0[WE_UKF_N] = { WE_UKF_P0, WE_UKF_P0, WE_UKF_P0, WE_UKF_P0, WE_UKF_P0, WE_UKF_P0, WE_UKF_P0 };
+
+  we_R[WE_UKF_VN] = powf(WE_UKF_R_GS, 2);
+  we_R[WE_UKF_VE] = powf(WE_UKF_R_GS, 2);
+  we_R[WE_UKF_VD] = powf(WE_UKF_R_GS, 2);
+  we_R[WE_UKF_VA] = powf(WE_UKF_R_VA, 2);
+  we_R[WE_UKF_AOA] = powf(WE_UKF_R_AOA, 2);
+  we_R[WE_UKF_SSA] = powf(WE_UKF_R_SSA, 2);
+
+  we_Q[WE_UKF_U] = powf(WE_UKF_Q_VA, 2);
+  we_Q[WE_UKF_V] = powf(WE_UKF_Q_VA, 2);
+  we_Q[WE_UKF_W] = powf(WE_UKF_Q_VA, 2);
+  we_Q[WE_UKF_WN] = powf(WE_UKF_Q_WIND, 2);
+  we_Q[WE_UKF_WE] = powf(WE_UKF_Q_WIND, 2);
+  we_Q[WE_UKF_WD] = powf(WE_UKF_Q_WIND, 2);
+  we_Q[WE_UKF_SCALE] = powf(WE_UKF_Q_VA_SCALE, 2);
+
+  we_ukf_init(&we_ukf, x0, P0);
+  we_ukf_set_weights(&we_ukf, WE_UKF_ALPHA, WE_UKF_BETA, WE_UKF_KI);
+  we_ukf_set_Q(&we_ukf, we_Q);
+  we_ukf_set_R(&we_ukf, we_R);
+  we_in.dt = WIND_ESTIMATOR_PERIODIC_PERIOD; // actually measured later
 
   wind_estimator.data_available = false;
   wind_estimator.reset = false;
@@ -212,52 +203,52 @@ static inline void wind_estimator_step(void)
       int i;
       PrintLog(pprzLogFile, "# Wind Estimator\n#\n");
       PrintLog(pprzLogFile, "# Q = diag( ");
-      for (i = 0; i < 7; i++)
-        PrintLog(pprzLogFile, "%.8f ", MAT_EL(ukf_params.Q, i, i, 7));
+      for (i = 0; i < WE_UKF_N; i++)
+        PrintLog(pprzLogFile, "%.8f ", we_Q[i]);
       PrintLog(pprzLogFile, ")\n");
       PrintLog(pprzLogFile, "# R = diag( ");
-      for (i = 0; i < 5; i++)
-        PrintLog(pprzLogFile, "%.8f ", MAT_EL(ukf_params.R, i, i, 5));
+      for (i = 0; i < WE_UKF_M; i++)
+        PrintLog(pprzLogFile, "%.8f ", we_R[i]);
       PrintLog(pprzLogFile, ")\n");
-      PrintLog(pprzLogFile, "# ki = %.5f\n", ukf_init.ki);
-      PrintLog(pprzLogFile, "# alpha = %.5f\n", ukf_init.alpha);
-      PrintLog(pprzLogFile, "# beta = %.5f\n", ukf_init.beta);
+      PrintLog(pprzLogFile, "# ki = %.5f\n", WE_UKF_KI);
+      PrintLog(pprzLogFile, "# alpha = %.5f\n", WE_UKF_ALPHA);
+      PrintLog(pprzLogFile, "# beta = %.5f\n", WE_UKF_BETA);
       PrintLog(pprzLogFile, "#\n");
       PrintLog(pprzLogFile, "p q r ax ay az q1 q2 q3 q4 vkx vky vkz va aoa ssa u v w wx wy wz vas t\n");
       log_we_started = true;
     }
     PrintLog(pprzLogFile, "%.5f %.5f %.5f %.3f %.3f %.3f %.4f %.4f %.4f %.4f %.5f %.5f %.5f %.5f %.5f %.5f ",
-        ukf_U.rates[0],
-        ukf_U.rates[1],
-        ukf_U.rates[2],
-        ukf_U.accel[0],
-        ukf_U.accel[1],
-        ukf_U.accel[2],
-        ukf_U.q[0],
-        ukf_U.q[1],
-        ukf_U.q[2],
-        ukf_U.q[3],
-        ukf_U.vk[0],
-        ukf_U.vk[1],
-        ukf_U.vk[2],
-        ukf_U.va,
-        ukf_U.aoa,
-        ukf_U.sideslip
+        we_in.rates[0],
+        we_in.rates[1],
+        we_in.rates[2],
+        we_in.accel[0],
+        we_in.accel[1],
+        we_in.accel[2],
+        we_in.q[0],
+        we_in.q[1],
+        we_in.q[2],
+        we_in.q[3],
+        we_in.z[WE_UKF_VN],
+        we_in.z[WE_UKF_VE],
+        we_in.z[WE_UKF_VD],
+        we_in.z[WE_UKF_VA],
+        we_in.z[WE_UKF_AOA],
+        we_in.z[WE_UKF_SSA]
         );
   }
 #endif
 
   // estimate wind if airspeed is high enough
-  if (ukf_U.va > 5.0f) {
+  if (we_in.z[WE_UKF_VA] > 5.0f) {
     // run estimation
-    UKF_Wind_Estimator_step();
+    we_ukf_step(&we_ukf, we_in.rates, we_in.accel, we_in.q, we_in.z, we_in.dt);
     // update output structure
-    wind_estimator.airspeed.x = ukf_Y.xout[0];
-    wind_estimator.airspeed.y = ukf_Y.xout[1];
-    wind_estimator.airspeed.z = ukf_Y.xout[2];
-    wind_estimator.wind.x = ukf_Y.xout[3];
-    wind_estimator.wind.y = ukf_Y.xout[4];
-    wind_estimator.wind.z = ukf_Y.xout[5];
+    wind_estimator.airspeed.x = we_ukf.x[WE_UKF_U];
+    wind_estimator.airspeed.y = we_ukf.x[WE_UKF_V];
+    wind_estimator.airspeed.z = we_ukf.x[WE_UKF_W];
+    wind_estimator.wind.x = we_ukf.x[WE_UKF_WN];
+    wind_estimator.wind.y = we_ukf.x[WE_UKF_WE];
+    wind_estimator.wind.z = we_ukf.x[WE_UKF_WD];
     // set ready flag
     wind_estimator.data_available = true;
   } else {
@@ -278,7 +269,7 @@ static inline void wind_estimator_step(void)
         wind_estimator.wind.x,
         wind_estimator.wind.y,
         wind_estimator.wind.z,
-        ukf_Y.xout[6],
+        we_ukf.x[WE_UKF_SCALE],
         time_step_before
         );
   }
@@ -300,9 +291,9 @@ void wind_estimator_periodic(void)
       init_calculator();
     }
     // update input vector from state interface
-    ukf_U.rates[0] = stateGetBodyRates_f()->p;  // rad/s
-    ukf_U.rates[1] = stateGetBodyRates_f()->q;  // rad/s
-    ukf_U.rates[2] = stateGetBodyRates_f()->r;  // rad/s
+    we_in.rates[0] = stateGetBodyRates_f()->p;  // rad/s
+    we_in.rates[1] = stateGetBodyRates_f()->q;  // rad/s
+    we_in.rates[2] = stateGetBodyRates_f()->r;  // rad/s
     // transform data in body frame
     struct FloatVect3 accel_ned = {
       stateGetAccelNed_f()->x,
@@ -336,40 +327,19 @@ void wind_estimator_periodic(void)
 #endif
     ///// End test
 
-    ukf_U.accel[0] = accel_body.x;   // m/s^2
-    ukf_U.accel[1] = accel_body.y;   // m/s^2
-    ukf_U.accel[2] = accel_body.z;   // m/s^2
-    ukf_U.q[0] = stateGetNedToBodyQuat_f()->qi;
-    ukf_U.q[1] = stateGetNedToBodyQuat_f()->qx;
-    ukf_U.q[2] = stateGetNedToBodyQuat_f()->qy;
-    ukf_U.q[3] = stateGetNedToBodyQuat_f()->qz;
-    ukf_U.vk[0] = stateGetSpeedNed_f()->x;      // m/s
-    ukf_U.vk[1] = stateGetSpeedNed_f()->y;      // m/s
-    ukf_U.vk[2] = stateGetSpeedNed_f()->z;      // m/s
-    ukf_U.va = stateGetAirspeed_f();            // m/s
-    ukf_U.aoa = stateGetAngleOfAttack_f();      // rad.
-    ukf_U.sideslip = stateGetSideslip_f();      // rad.
-
-    ///// TEST
-    // update input vector from state interface
-    //ukf_U.rates[0] = 0.;
-    //ukf_U.rates[1] = 0.;
-    //ukf_U.rates[2] = 0.;
-    //ukf_U.accel[0] = 0.;
-    //ukf_U.accel[1] = 0.;
-    //ukf_U.accel[2] = 0.;
-    //ukf_U.q[0] = 1.0;
-    //ukf_U.q[1] = 0.;
-    //ukf_U.q[2] = 0.;
-    //ukf_U.q[3] = 0.;
-    //ukf_U.vk[0] = 15.;
-    //ukf_U.vk[1] = 0.;
-    //ukf_U.vk[2] = 0.;
-    //ukf_U.va = 15.;
-    //ukf_U.aoa = 0.;
-    //ukf_U.sideslip = 0.;
-
-    //DOWNLINK_SEND_PAYLOAD_FLOAT(DefaultChannel, DefaultDevice, 16, (float *)(&ukf_U));
+    we_in.accel[0] = accel_body.x;   // m/s^2
+    we_in.accel[1] = accel_body.y;   // m/s^2
+    we_in.accel[2] = accel_body.z;   // m/s^2
+    we_in.q[0] = stateGetNedToBodyQuat_f()->qi;
+    we_in.q[1] = stateGetNedToBodyQuat_f()->qx;
+    we_in.q[2] = stateGetNedToBodyQuat_f()->qy;
+    we_in.q[3] = stateGetNedToBodyQuat_f()->qz;
+    we_in.z[WE_UKF_VN] = stateGetSpeedNed_f()->x;       // m/s
+    we_in.z[WE_UKF_VE] = stateGetSpeedNed_f()->y;       // m/s
+    we_in.z[WE_UKF_VD] = stateGetSpeedNed_f()->z;       // m/s
+    we_in.z[WE_UKF_VA] = stateGetAirspeed_f();          // m/s
+    we_in.z[WE_UKF_AOA] = stateGetAngleOfAttack_f();    // rad.
+    we_in.z[WE_UKF_SSA] = stateGetSideslip_f();         // rad.
 
     float msg[] = {
       tmp.x,
@@ -389,10 +359,10 @@ void wind_estimator_periodic(void)
 
     // compute DT and set input vector
     if (time_step_before == 0) {
-      ukf_params.dt = WIND_ESTIMATOR_PERIODIC_PERIOD;
+      we_in.dt = WIND_ESTIMATOR_PERIODIC_PERIOD;
       time_step_before = get_sys_time_msec();
     } else {
-      ukf_params.dt = (get_sys_time_msec() - time_step_before) / 1000.f;
+      we_in.dt = (get_sys_time_msec() - time_step_before) / 1000.f;
       time_step_before = get_sys_time_msec();
     }
 #ifndef SITL
@@ -499,51 +469,86 @@ void wind_estimator_init(void)
 #endif
 }
 
+/** Lock the filter while a setting changes the noise matrices used by the estimation thread */
+static void wind_estimator_settings_lock(void)
+{
+#ifndef SITL
+  chMtxLock(&we_ukf_mtx);
+#endif
+}
+
+static void wind_estimator_settings_unlock(void)
+{
+#ifndef SITL
+  chMtxUnlock(&we_ukf_mtx);
+#endif
+}
+
 void wind_estimator_Set_R_GS(float _v)
 {
+  wind_estimator_settings_lock();
   wind_estimator.r_gs = _v;
-  MAT_EL(ukf_params.R, 0, 0, 6) = powf(_v, 2);
-  MAT_EL(ukf_params.R, 1, 1, 6) = powf(_v, 2);
-  MAT_EL(ukf_params.R, 2, 2, 6) = powf(_v, 2);
+  we_R[WE_UKF_VN] = powf(_v, 2);
+  we_R[WE_UKF_VE] = powf(_v, 2);
+  we_R[WE_UKF_VD] = powf(_v, 2);
+  we_ukf_set_R(&we_ukf, we_R);
+  wind_estimator_settings_unlock();
 }
 
 void wind_estimator_Set_R_VA(float _v)
 {
+  wind_estimator_settings_lock();
   wind_estimator.r_va = _v;
-  MAT_EL(ukf_params.R, 3, 3, 6) = powf(_v, 2);
+  we_R[WE_UKF_VA] = powf(_v, 2);
+  we_ukf_set_R(&we_ukf, we_R);
+  wind_estimator_settings_unlock();
 }
 
 void wind_estimator_Set_R_AOA(float _v)
 {
+  wind_estimator_settings_lock();
   wind_estimator.r_aoa = _v;
-  MAT_EL(ukf_params.R, 4, 4, 6) = powf(_v, 2);
+  we_R[WE_UKF_AOA] = powf(_v, 2);
+  we_ukf_set_R(&we_ukf, we_R);
+  wind_estimator_settings_unlock();
 }
 
 void wind_estimator_Set_R_SSA(float _v)
 {
+  wind_estimator_settings_lock();
   wind_estimator.r_ssa = _v;
-  MAT_EL(ukf_params.R, 5, 5, 6) = powf(_v, 2);
+  we_R[WE_UKF_SSA] = powf(_v, 2);
+  we_ukf_set_R(&we_ukf, we_R);
+  wind_estimator_settings_unlock();
 }
 
 void wind_estimator_Set_Q_VA(float _v)
 {
+  wind_estimator_settings_lock();
   wind_estimator.q_va = _v;
-  MAT_EL(ukf_params.Q, 0, 0, 7) = powf(_v, 2);
-  MAT_EL(ukf_params.Q, 1, 1, 7) = powf(_v, 2);
-  MAT_EL(ukf_params.Q, 2, 2, 7) = powf(_v, 2);
+  we_Q[WE_UKF_U] = powf(_v, 2);
+  we_Q[WE_UKF_V] = powf(_v, 2);
+  we_Q[WE_UKF_W] = powf(_v, 2);
+  we_ukf_set_Q(&we_ukf, we_Q);
+  wind_estimator_settings_unlock();
 }
 
 void wind_estimator_Set_Q_WIND(float _v)
 {
+  wind_estimator_settings_lock();
   wind_estimator.q_wind = _v;
-  MAT_EL(ukf_params.Q, 3, 3, 7) = powf(_v, 2);
-  MAT_EL(ukf_params.Q, 4, 4, 7) = powf(_v, 2);
-  MAT_EL(ukf_params.Q, 5, 5, 7) = powf(_v, 2);
+  we_Q[WE_UKF_WN] = powf(_v, 2);
+  we_Q[WE_UKF_WE] = powf(_v, 2);
+  we_Q[WE_UKF_WD] = powf(_v, 2);
+  we_ukf_set_Q(&we_ukf, we_Q);
+  wind_estimator_settings_unlock();
 }
 
 void wind_estimator_Set_Q_VA_SCALE(float _v)
 {
+  wind_estimator_settings_lock();
   wind_estimator.q_va_scale = _v;
-  MAT_EL(ukf_params.Q, 6, 6, 7) = powf(_v, 2);
+  we_Q[WE_UKF_SCALE] = powf(_v, 2);
+  we_ukf_set_Q(&we_ukf, we_Q);
+  wind_estimator_settings_unlock();
 }
-
@@ -21,7 +21,7 @@
 /**
  * @file "modules/meteo/wind_estimator.h"
  *
- * Wind Estimator based on generated library from Matlab
+ * Wind Estimator based on a square root UKF
  *
  * Original Simulink files available at https://github.com/enacuavlab/UKF_Wind_Estimation
  */
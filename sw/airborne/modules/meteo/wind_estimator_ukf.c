@@ -0,0 +1,383 @@
+/*
+ * Copyright (C) 2016 Johan Maurin, Gautier Hattenberger
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/meteo/wind_estimator_ukf.c
+ *
+ * Square root UKF for the wind estimator.
+ */
+
+#include "modules/meteo/wind_estimator_ukf.h"
+#include <math.h>
+#include <string.h>
+
+#define N WE_UKF_N
+#define M WE_UKF_M
+#define L WE_UKF_L
+
+/** maximum number of columns of a matrix to triangularize */
+#define TRIA_MAX_COLS (2 * N + N)
+
+void we_ukf_init(struct WeUkf *ukf, const float x0[N], const float P0[N])
+{
+  memcpy(ukf->x, x0, sizeof(ukf->x));
+  memset(ukf->S, 0, sizeof(ukf->S));
+  for (int i = 0; i < N; i++) {
+    ukf->S[i][i] = sqrtf(P0[i]);
+  }
+}
+
+void we_ukf_set_weights(struct WeUkf *ukf, float alpha, float beta, float ki)
+{
+  const float lambda = alpha * alpha * ((float)N + ki) - (float)N;
+  ukf->gamma = sqrtf((float)N + lambda);
+  ukf->wm0 = lambda / ((float)N + lambda);
+  ukf->wi = 0.5f / ((float)N + lambda);
+  ukf->wc0 = ukf->wm0 + 1.f - alpha * alpha + beta;
+  ukf->sqrt_wi = sqrtf(ukf->wi);
+  // the original model updates with sqrt(|wc0|) * p * pt instead of wc0 * p * pt,
+  // kept for compatibility of the tuning
+  ukf->wc0_update = powf(fabsf(ukf->wc0), 0.25f);
+}
+
+void we_ukf_set_Q(struct WeUkf *ukf, const float Q[N])
+{
+  for (int i = 0; i < N; i++) {
+    ukf->sqrt_Q[i] = sqrtf(Q[i]);
+  }
+}
+
+void we_ukf_set_R(struct WeUkf *ukf, const float R[M])
+{
+  for (int i = 0; i < M; i++) {
+    ukf->sqrt_R[i] = sqrtf(R[i]);
+  }
+}
+
+/** Triangularization
+ * Computes the lower triangular T such that T * Tt = A * At
+ * with Householder reflections applied on the rows of A.
+ * Always called with constant sizes so that it is specialized by the compiler.
+ * @param T output lower triangular matrix [r x r] (row major)
+ * @param A input matrix [r x c] (row major), destroyed
+ * @param r number of rows
+ * @param c number of columns, c >= r
+ */
+static inline void tria(float *T, float *A, const int r, const int c)
+{
+  float v[TRIA_MAX_COLS];
+  for (int k = 0; k < r; k++) {
+    float *ak = A + k * c;
+    float norm2 = 0.f;
+    for (int j = k; j < c; j++) {
+      norm2 += ak[j] * ak[j];
+    }
+    if (norm2 == 0.f) {
+      continue;
+    }
+    // reflect row k on (alpha, 0, ..., 0)
+    const float alpha = ak[k] > 0.f ? -sqrtf(norm2) : sqrtf(norm2);
+    float vnorm2 = 0.f;
+    for (int j = k; j < c; j++) {
+      v[j] = ak[j];
+    }
+    v[k] -= alpha;
+    for (int j = k; j < c; j++) {
+      vnorm2 += v[j] * v[j];
+    }
+    if (vnorm2 == 0.f) {
+      continue;
+    }
+    for (int i = k; i < r; i++) {
+      float *ai = A + i * c;
+      float s = 0.f;
+      for (int j = k; j < c; j++) {
+        s += ai[j] * v[j];
+      }
+      const float f = 2.f * s / vnorm2;
+      for (int j = k; j < c; j++) {
+        ai[j] -= f * v[j];
+      }
+    }
+  }
+  // copy lower part, with positive diagonal
+  for (int i = 0; i < r; i++) {
+    for (int j = 0; j < r; j++) {
+      T[i * r + j] = (j <= i) ? A[i * c + j] : 0.f;
+    }
+  }
+  for (int j = 0; j < r; j++) {
+    if (T[j * r + j] < 0.f) {
+      for (int i = j; i < r; i++) {
+        T[i * r + j] = -T[i * r + j];
+      }
+    }
+  }
+}
+
+/** Rank one update of a Cholesky factor
+ * Computes the lower triangular S' such that S' * S't = S * St + sign * x * xt.
+ * S is left unchanged if the result is not positive definite.
+ * @param S lower triangular matrix [n x n] (row major), updated in place
+ * @param x update vector [n], destroyed
+ * @param n matrix size
+ * @param sign 1 for an update, -1 for a downdate
+ * @return false if the update failed
+ */
+static inline bool cholupdate(float *S, float *x, const int n, const float sign)
+{
+  float T[N * N];
+  memcpy(T, S, n * n * sizeof(float));
+  for (int k = 0; k < n; k++) {
+    const float tkk = T[k * n + k];
+    const float r2 = tkk * tkk + sign * x[k] * x[k];
+    if (tkk <= 0.f || r2 <= 0.f) {
+      return false;
+    }
+    const float r = sqrtf(r2);
+    const float c = r / tkk;
+    const float s = x[k] / tkk;
+    T[k * n + k] = r;
+    for (int i = k + 1; i < n; i++) {
+      T[i * n + k] = (T[i * n + k] + sign * s * x[i]) / c;
+      x[i] = c * x[i] - s * T[i * n + k];
+    }
+  }
+  memcpy(S, T, n * n * sizeof(float));
+  return true;
+}
+
+/** Airspeed dynamics in body frame, on all sigma points
+ * du = r.v - q.w + ax, dv = p.w - r.u + ay, dw = q.u - p.v + az
+ */
+static inline void airspeed_dot(float dx[3][L], float x[3][L], const float *rates, const float *accel)
+{
+  for (int i = 0; i < L; i++) {
+    dx[0][i] = (rates[2] * x[1][i] + accel[0]) - rates[1] * x[2][i];
+    dx[1][i] = (rates[0] * x[2][i] + accel[1]) - rates[2] * x[0][i];
+    dx[2][i] = (rates[1] * x[0][i] + accel[2]) - rates[0] * x[1][i];
+  }
+}
+
+/** Propagate all sigma points with a Runge-Kutta 4 integration
+ * Wind and scale factor are constant.
+ */
+static void propagate(float X[N][L], const float *rates, const float *accel, float dt)
+{
+  float k1[3][L], k2[3][L], k3[3][L], k4[3][L], xt[3][L];
+  const float dt2 = dt / 2.f;
+
+  airspeed_dot(k1, X, rates, accel);
+  for (int j = 0; j < 3; j++) {
+    for (int i = 0; i < L; i++) {
+      xt[j][i] = k1[j][i] * dt2 + X[j][i];
+    }
+  }
+  airspeed_dot(k2, xt, rates, accel);
+  for (int j = 0; j < 3; j++) {
+    for (int i = 0; i < L; i++) {
+      xt[j][i] = k2[j][i] * dt2 + X[j][i];
+    }
+  }
+  airspeed_dot(k3, xt, rates, accel);
+  for (int j = 0; j < 3; j++) {
+    for (int i = 0; i < L; i++) {
+      xt[j][i] = dt * k3[j][i] + X[j][i];
+    }
+  }
+  airspeed_dot(k4, xt, rates, accel);
+  const float dt6 = dt / 6.f;
+  for (int j = 0; j < 3; j++) {
+    for (int i = 0; i < L; i++) {
+      X[j][i] += ((k2[j][i] + k3[j][i]) * 2.f + k1[j][i] + k4[j][i]) * dt6;
+    }
+  }
+}
+
+/** Observation model on all sigma points
+ * ground speed = body to NED rotation of the airspeed + wind,
+ * airspeed norm with scale factor, angle of attack and sideslip
+ */
+static void observe(float Z[M][L], float X[N][L], const float *quat)
+{
+  // body to NED rotation from the NED to body quaternion
+  const float qi = quat[0], qx = quat[1], qy = quat[2], qz = quat[3];
+  const float n2 = qi * qi + qx * qx + qy * qy + qz * qz;
+  const float r00 = (qi * qi + qx * qx - qy * qy - qz * qz) / n2;
+  const float r01 = 2.f * (qx * qy - qi * qz) / n2;
+  const float r02 = 2.f * (qx * qz + qi * qy) / n2;
+  const float r10 = 2.f * (qx * qy + qi * qz) / n2;
+  const float r11 = (qi * qi - qx * qx + qy * qy - qz * qz) / n2;
+  const float r12 = 2.f * (qy * qz - qi * qx) / n2;
+  const float r20 = 2.f * (qx * qz - qi * qy) / n2;
+  const float r21 = 2.f * (qy * qz + qi * qx) / n2;
+  const float r22 = (qi * qi - qx * qx - qy * qy + qz * qz) / n2;
+
+  for (int i = 0; i < L; i++) {
+    const float u = X[WE_UKF_U][i], v = X[WE_UKF_V][i], w = X[WE_UKF_W][i];
+    Z[WE_UKF_VN][i] = r00 * u + r01 * v + r02 * w + X[WE_UKF_WN][i];
+    Z[WE_UKF_VE][i] = r10 * u + r11 * v + r12 * w + X[WE_UKF_WE][i];
+    Z[WE_UKF_VD][i] = r20 * u + r21 * v + r22 * w + X[WE_UKF_WD][i];
+    Z[WE_UKF_VA][i] = sqrtf(u * u + v * v + w * w);
+  }
+  // trigonometric part is not vectorized
+  for (int i = 0; i < L; i++) {
+    const float va = Z[WE_UKF_VA][i];
+    if (va > 0.0001f) {
+      Z[WE_UKF_AOA][i] = atan2f(X[WE_UKF_W][i], X[WE_UKF_U][i]);
+      Z[WE_UKF_SSA][i] = asinf(X[WE_UKF_V][i] / va);
+    } else {
+      Z[WE_UKF_AOA][i] = 0.f;
+      Z[WE_UKF_SSA][i] = 0.f;
+    }
+    Z[WE_UKF_VA][i] = X[WE_UKF_SCALE][i] * va;
+  }
+}
+
+/** Weighted mean of the sigma points, and deviations from the mean */
+static inline void mean_and_dev(float *mean, float *dev, float *P, const int n, const float wm0, const float wi)
+{
+  for (int j = 0; j < n; j++) {
+    const float *p = P + j * L;
+    float *d = dev + j * L;
+    float m = p[0] * wm0;
+    for (int i = 1; i < L; i++) {
+      m += p[i] * wi;
+    }
+    mean[j] = m;
+    for (int i = 0; i < L; i++) {
+      d[i] = p[i] - m;
+    }
+  }
+}
+
+/** Square root covariance of the sigma points with additive noise
+ * S * St = wi * sum(dev_i * dev_it) + diag(sqrt_noise)^2 + sign(wc0) * wc0_update^2 * dev_0 * dev_0t
+ */
+static inline void sqrt_cov(float *S, const float *dev, const float *sqrt_noise, const int n,
+                            const struct WeUkf *ukf)
+{
+  float A[N * TRIA_MAX_COLS];
+  const int c = (L - 1) + n;
+  for (int j = 0; j < n; j++) {
+    float *a = A + j * c;
+    for (int i = 1; i < L; i++) {
+      a[i - 1] = ukf->sqrt_wi * dev[j * L + i];
+    }
+    for (int i = 0; i < n; i++) {
+      a[(L - 1) + i] = (i == j) ? sqrt_noise[j] : 0.f;
+    }
+  }
+  tria(S, A, n, c);
+
+  float x0[N];
+  for (int j = 0; j < n; j++) {
+    x0[j] = ukf->wc0_update * dev[j * L];
+  }
+  cholupdate(S, x0, n, ukf->wc0 < 0.f ? -1.f : 1.f);
+}
+
+void we_ukf_step(struct WeUkf *ukf, const float rates[3], const float accel[3],
+                 const float quat[4], const float z[M], float dt)
+{
+  float X[N][L];  // sigma points
+  float dX[N][L]; // sigma points deviations
+  float Z[M][L];  // measurement sigma points
+  float dZ[M][L]; // measurement sigma points deviations
+  float xp[N], zp[M];
+  float Sz[M][M];
+
+  // sigma points X = [x, x + gamma * S, x - gamma * S]
+  for (int j = 0; j < N; j++) {
+    X[j][0] = ukf->x[j];
+    for (int i = 0; i < N; i++) {
+      const float s = ukf->gamma * ukf->S[j][i];
+      X[j][1 + i] = ukf->x[j] + s;
+      X[j][1 + N + i] = ukf->x[j] - s;
+    }
+  }
+
+  // prediction
+  propagate(X, rates, accel, dt);
+  mean_and_dev(xp, &dX[0][0], &X[0][0], N, ukf->wm0, ukf->wi);
+  sqrt_cov(&ukf->S[0][0], &dX[0][0], ukf->sqrt_Q, N, ukf);
+
+  // predicted measurements from the propagated sigma points
+  observe(Z, X, quat);
+  mean_and_dev(zp, &dZ[0][0], &Z[0][0], M, ukf->wm0, ukf->wi);
+  sqrt_cov(&Sz[0][0], &dZ[0][0], ukf->sqrt_R, M, ukf);
+
+  // cross covariance Pxz = sum(wc_i * dX_i * dZ_it)
+  float K[N][M];
+  for (int j = 0; j < N; j++) {
+    for (int k = 0; k < M; k++) {
+      float s = ukf->wc0 * dX[j][0] * dZ[k][0];
+      for (int i = 1; i < L; i++) {
+        s += ukf->wi * dX[j][i] * dZ[k][i];
+      }
+      K[j][k] = s;
+    }
+  }
+
+  // Kalman gain K = Pxz * (Sz * Szt)^-1, by forward and back substitution on each row
+  for (int j = 0; j < N; j++) {
+    float *k = K[j];
+    for (int a = 0; a < M; a++) {
+      float s = k[a];
+      for (int b = 0; b < a; b++) {
+        s -= Sz[a][b] * k[b];
+      }
+      k[a] = s / Sz[a][a];
+    }
+    for (int a = M - 1; a >= 0; a--) {
+      float s = k[a];
+      for (int b = a + 1; b < M; b++) {
+        s -= Sz[b][a] * k[b];
+      }
+      k[a] = s / Sz[a][a];
+    }
+  }
+
+  // state update
+  float innov[M];
+  for (int k = 0; k < M; k++) {
+    innov[k] = z[k] - zp[k];
+  }
+  for (int j = 0; j < N; j++) {
+    float s = 0.f;
+    for (int k = 0; k < M; k++) {
+      s += K[j][k] * innov[k];
+    }
+    ukf->x[j] = xp[j] + s;
+  }
+
+  // covariance downdate with each column of U = K * Sz
+  for (int k = 0; k < M; k++) {
+    float u[N];
+    for (int j = 0; j < N; j++) {
+      float s = 0.f;
+      for (int a = k; a < M; a++) {
+        s += K[j][a] * Sz[a][k];
+      }
+      u[j] = s;
+    }
+    cholupdate(&ukf->S[0][0], u, N, -1.f);
+  }
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2016 Johan Maurin, Gautier Hattenberger
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/meteo/wind_estimator_ukf.h
+ *
+ * Square root UKF for the wind estimator.
+ *
+ * Fixed size implementation of the filter of the original Simulink model
+ * (https://github.com/enacuavlab/UKF_Wind_Estimation).
+ *
+ * State: airspeed in body frame (u, v, w), wind in NED frame (wn, we, wd)
+ * and airspeed scale factor.
+ * Inputs: body rates and accelerations, NED to body attitude.
+ * Measurements: ground speed in NED frame, airspeed norm, angle of attack
+ * and sideslip angle.
+ *
+ * The covariance is kept as its lower triangular square root S (P = S * St),
+ * updated with Householder triangularization and rank one Cholesky updates.
+ * Sigma points are stored by state component so that the loops over the
+ * sigma points can be vectorized by the compiler.
+ */
+
+#ifndef WIND_ESTIMATOR_UKF_H
+#define WIND_ESTIMATOR_UKF_H
+
+#include "std.h"
+
+#define WE_UKF_N 7                    ///< state size
+#define WE_UKF_M 6                    ///< measurement size
+#define WE_UKF_L (2 * WE_UKF_N + 1)   ///< number of sigma points
+
+/** State vector index */
+enum WeUkfState {
+  WE_UKF_U, WE_UKF_V, WE_UKF_W,
+  WE_UKF_WN, WE_UKF_WE, WE_UKF_WD,
+  WE_UKF_SCALE
+};
+
+/** Measurement vector index */
+enum WeUkfMeas {
+  WE_UKF_VN, WE_UKF_VE, WE_UKF_VD,
+  WE_UKF_VA, WE_UKF_AOA, WE_UKF_SSA
+};
+
+struct WeUkf {
+  float x[WE_UKF_N];              ///< state
+  float S[WE_UKF_N][WE_UKF_N];    ///< lower triangular square root of the covariance
+  float sqrt_Q[WE_UKF_N];         ///< square root of the diagonal process noise
+  float sqrt_R[WE_UKF_M];         ///< square root of the diagonal measurement noise
+
+  /* cached sigma points weights */
+  float gamma;                    ///< sigma points spread, sqrt(n + lambda)
+  float wm0;                      ///< mean weight of the central point
+  float wi;                       ///< mean and covariance weight of the other points
+  float wc0;                      ///< covariance weight of the central point
+  float sqrt_wi;                  ///< sqrt(wi)
+  float wc0_update;               ///< scaling of the central point in the rank one update
+};
+
+/** Init filter
+ * @param ukf filter structure
+ * @param x0 initial state
+ * @param P0 diagonal of the initial covariance
+ */
+extern void we_ukf_init(struct WeUkf *ukf, const float x0[WE_UKF_N], const float P0[WE_UKF_N]);
+
+/** Set sigma points parameters and compute the weights
+ * @param ukf filter structure
+ * @param alpha sigma point dispersion
+ * @param beta prior knowledge of the distribution (2 for gaussian)
+ * @param ki secondary scaling parameter (>= 0)
+ */
+extern void we_ukf_set_weights(struct WeUkf *ukf, float alpha, float beta, float ki);
+
+/** Set process noise
+ * @param ukf filter structure
+ * @param Q diagonal of the process noise covariance
+ */
+extern void we_ukf_set_Q(struct WeUkf *ukf, const float Q[WE_UKF_N]);
+
+/** Set measurement noise
+ * @param ukf filter structure
+ * @param R diagonal of the measurement noise covariance
+ */
+extern void we_ukf_set_R(struct WeUkf *ukf, const float R[WE_UKF_M]);
+
+/** Run one prediction and correction step
+ * @param ukf filter structure
+ * @param rates body rates (p, q, r)
+ * @param accel body accelerations without gravity (ax, ay, az)
+ * @param quat NED to body quaternion (qi, qx, qy, qz)
+ * @param z measurements
+ * @param dt time step
+ */
+extern void we_ukf_step(struct WeUkf *ukf, const float rates[3], const float accel[3],
+                        const float quat[4], const float z[WE_UKF_M], float dt);
+
+#endif /* WIND_ESTIMATOR_UKF_H */
@@ -29,6 +29,7 @@
 #include "modules/computer_vision/cv.h"
 
 #include <stdio.h>
+#include <string.h>
 
 #ifndef PANO_UNWRAP_CAMERA
 #define PANO_UNWRAP_CAMERA bottom_camera
@@ -75,6 +76,19 @@
 #define PANO_UNWRAP_FPS 0
 #endif
 
+#ifndef PANO_UNWRAP_BILINEAR
+#define PANO_UNWRAP_BILINEAR FALSE
+#endif
+
+/** Fractional bits of the sampling points, less for raw images larger than 4096 pixels */
+#define PANO_UNWRAP_FRAC_BITS 4
+
+/** Size of the square blocks of the unwrapped image filled one after the other,
+ *  so that the raw pixels they sample stay in cache (must be even) */
+#ifndef PANO_UNWRAP_TILE_SIZE
+#define PANO_UNWRAP_TILE_SIZE 32
+#endif
+
 struct pano_unwrap_t pano_unwrap = {
     .center = {
         .x = PANO_UNWRAP_CENTER_X,
@@ -92,6 +106,7 @@ struct pano_unwrap_t pano_unwrap = {
     .height = PANO_UNWRAP_HEIGHT,
 
     .overwrite_video_thread = PANO_UNWRAP_OVERWRITE_VIDEO_THREAD,
+    .bilinear = PANO_UNWRAP_BILINEAR,
 
     .show_calibration = FALSE,
 };
@@ -115,17 +130,21 @@ struct image_t pano_unwrapped_image;
 struct LUT_t
 {
   // Unwarping LUT
-  // For each pixel (u,v) in the unwrapped image, contains pixel coordinates of
-  // the same pixel in the raw image (x(u,v), y(u,v)).
+  // For each pixel (u,v) in the unwrapped image, row by row, contains pixel coordinates of
+  // the same pixel in the raw image (x(u,v), y(u,v)), in fixed point with frac_bits
+  // fractional bits and bounded to the raw image.
   uint16_t *x;
   uint16_t *y;
+  uint8_t frac_bits;
   // Derotate LUT
   // For each bearing/column (u), contains the direction in which sampling should be
   // shifted based on euler angles phi and theta dxy(phi|u) dxy(theta|u).
   struct FloatVect2 *dphi;
   struct FloatVect2 *dtheta;
-  // Settings for which the LUT was generated
+  // Settings and raw image size for which the LUT was generated
   struct pano_unwrap_t settings;
+  uint16_t raw_w;
+  uint16_t raw_h;
 };
 static struct LUT_t LUT;  // Note: initialized NULL
 
@@ -159,7 +178,8 @@ static void update_LUT(const struct image_t *img)
       LUT.settings.forward_direction == pano_unwrap.forward_direction &&
       LUT.settings.flip_horizontal == pano_unwrap.flip_horizontal &&
       LUT.settings.width == pano_unwrap.width &&
-      LUT.settings.height == pano_unwrap.height) {
+      LUT.settings.height == pano_unwrap.height &&
+      LUT.raw_w == img->w && LUT.raw_h == img->h) {
     // LUT is still valid, do nothing
     return;
   }
@@ -182,6 +202,12 @@ static void update_LUT(const struct image_t *img)
     free(LUT.dtheta);
     LUT.dtheta = NULL;
   }
+  // Fixed point coordinates have to fit in 16 bits
+  LUT.frac_bits = PANO_UNWRAP_FRAC_BITS;
+  while (LUT.frac_bits > 0 && ((uint32_t)Max(img->w, img->h) << LUT.frac_bits) > UINT16_MAX) {
+    LUT.frac_bits--;
+  }
+  const float one = 1 << LUT.frac_bits;
   // Generate unwarping LUT
   LUT.x = malloc(sizeof(*LUT.x) * pano_unwrap.width * pano_unwrap.height);
   LUT.y = malloc(sizeof(*LUT.y) * pano_unwrap.width * pano_unwrap.height);
@@ -198,10 +224,13 @@ static void update_LUT(const struct image_t *img)
         float radius = pano_unwrap.radius_top
             + (pano_unwrap.radius_bottom - pano_unwrap.radius_top)
                 * ((float) v / (pano_unwrap.height - 1));
-        LUT.x[v + u * pano_unwrap.height] = (uint16_t) (img->w
-            * pano_unwrap.center.x + c * radius * img->h + 0.5);
-        LUT.y[v + u * pano_unwrap.height] = (uint16_t) (img->h
-            * pano_unwrap.center.y - s * radius * img->h + 0.5);
+        float x = img->w * pano_unwrap.center.x + c * radius * img->h;
+        float y = img->h * pano_unwrap.center.y - s * radius * img->h;
+        Bound(x, 0.f, img->w - 1);
+        Bound(y, 0.f, img->h - 1);
+        // truncated, so that rounding to the nearest pixel gives the same pixel as rounding x and y
+        LUT.x[u + v * pano_unwrap.width] = (uint16_t) (x * one);
+        LUT.y[u + v * pano_unwrap.width] = (uint16_t) (y * one);
       }
     }
   }
@@ -224,76 +253,141 @@ static void update_LUT(const struct image_t *img)
   }
   // Keep track of settings for which this LUT was generated
   LUT.settings = pano_unwrap;
+  LUT.raw_w = img->w;
+  LUT.raw_h = img->h;
   printf("ok\n");
 }
 
-static void unwrap_LUT(struct image_t *img_raw, struct image_t *img)
+/**
+ * Draw the calibration pattern on the raw image, at the sampling points
+ * @param[in,out] img_raw The raw image
+ * @param[in] dx, dy The derotation offsets of the columns, in fixed point
+ */
+static void draw_calibration(struct image_t *img_raw, const int32_t *dx, const int32_t *dy)
 {
+  const int32_t x_max = (img_raw->w - 1) << LUT.frac_bits;
+  const int32_t y_max = (img_raw->h - 1) << LUT.frac_bits;
+  const int32_t half = (1 << LUT.frac_bits) >> 1;
+
   for (uint16_t u = 0; u < pano_unwrap.width; u++) {
-    // Derotation offset for this bearing
-    int16_t dx = 0;
-    int16_t dy = 0;
-    if (pano_unwrap.derotate_attitude) {
-      // Look up correction
-      const struct FloatRMat *R = stateGetNedToBodyRMat_f();
-      dx = (int16_t) (img_raw->h * pano_unwrap.vertical_resolution
-          * (LUT.dphi[u].x * MAT33_ELMT(*R, 1, 2)
-              + LUT.dtheta[u].x * MAT33_ELMT(*R, 0, 2)));
-      dy = (int16_t) (img_raw->h * pano_unwrap.vertical_resolution
-          * (LUT.dphi[u].y * MAT33_ELMT(*R, 1, 2)
-              + LUT.dtheta[u].y * MAT33_ELMT(*R, 0, 2)));
-    }
-    // Fill this column of unwrapped image
     for (uint16_t v = 0; v < pano_unwrap.height; v++) {
-      // Look up sampling point
-      int16_t x = (int16_t) LUT.x[v + u * pano_unwrap.height] + dx;
-      int16_t y = (int16_t) LUT.y[v + u * pano_unwrap.height] + dy;
-      // Check bounds
-      if (x < 0) {
-        x = 0;
-      } else if (x > img_raw->w - 1) {
-        x = img_raw->w - 1;
+      int32_t xq = LUT.x[u + v * pano_unwrap.width] + dx[u];
+      int32_t yq = LUT.y[u + v * pano_unwrap.width] + dy[u];
+      Bound(xq, 0, x_max);
+      Bound(yq, 0, y_max);
+      int16_t x = (xq + half) >> LUT.frac_bits;
+      int16_t y = (yq + half) >> LUT.frac_bits;
+      if (v == 0 || v == pano_unwrap.height - 1) {
+        PIXEL_U(img_raw,x,y) = BLUE_U;
+        PIXEL_V(img_raw,x,y) = BLUE_V;
       }
-      if (y < 0) {
-        y = 0;
-      } else if (y > img_raw->h - 1) {
-        y = img_raw->h - 1;
+      if ((u == pano_unwrap.width / 2)
+          || (u == pano_unwrap.width / 2 + 1)) {
+        PIXEL_Y(img_raw,x,y) = RED_Y;
+        PIXEL_U(img_raw,x,y) = RED_U;
+        PIXEL_V(img_raw,x,y) = RED_V;
       }
-      // Draw calibration pattern
-      if (pano_unwrap.show_calibration) {
-        if (v == 0 || v == pano_unwrap.height - 1) {
-          PIXEL_U(img_raw,x,y) = BLUE_U;
-          PIXEL_V(img_raw,x,y) = BLUE_V;
-        }
-        if ((u == pano_unwrap.width / 2)
-            || (u == pano_unwrap.width / 2 + 1)) {
-          PIXEL_Y(img_raw,x,y) = RED_Y;
-          PIXEL_U(img_raw,x,y) = RED_U;
-          PIXEL_V(img_raw,x,y) = RED_V;
-        }
-        if ((u == 3 * pano_unwrap.width / 4)
-            || (u == 3 * pano_unwrap.width / 4 + 1)) {
-          PIXEL_Y(img_raw,x,y) = GREEN_Y;
-          PIXEL_U(img_raw,x,y) = GREEN_U;
-          PIXEL_V(img_raw,x,y) = GREEN_V;
-        }
+      if ((u == 3 * pano_unwrap.width / 4)
+          || (u == 3 * pano_unwrap.width / 4 + 1)) {
+        PIXEL_Y(img_raw,x,y) = GREEN_Y;
+        PIXEL_U(img_raw,x,y) = GREEN_U;
+        PIXEL_V(img_raw,x,y) = GREEN_V;
       }
-      // Copy pixel values
-      PIXEL_Y(img,u,v) = PIXEL_Y(img_raw, x, y);
-      PIXEL_U(img,u,v) = PIXEL_U(img_raw, x, y);
-      PIXEL_V(img,u,v) = PIXEL_V(img_raw, x, y);
     }
   }
   // Draw lens center
+  uint16_t x = pano_unwrap.center.x * img_raw->w;
+  uint16_t y = pano_unwrap.center.y * img_raw->h;
+  for (int i = -5; i <= 5; i++) {
+    for (int j = -5; j <= 5; j++) {
+      if (i == 0 || j == 0) {
+        PIXEL_Y(img_raw, x+i, y+j) = BLUE_Y;
+        PIXEL_U(img_raw, x+i, y+j) = BLUE_U;
+        PIXEL_V(img_raw, x+i, y+j) = BLUE_V;
+      }
+    }
+  }
+}
+
+static void unwrap_LUT(struct image_t *img_raw, struct image_t *img)
+{
+  const uint16_t width = pano_unwrap.width;
+  const uint16_t height = pano_unwrap.height;
+  const uint16_t raw_w = img_raw->w;
+  const uint8_t frac_bits = LUT.frac_bits;
+  const int32_t one = 1 << frac_bits;
+  const int32_t half = one >> 1;
+  const int32_t x_max = (img_raw->w - 1) << frac_bits;
+  const int32_t y_max = (img_raw->h - 1) << frac_bits;
+  const bool derotate = pano_unwrap.derotate_attitude;
+  const bool bilinear = pano_unwrap.bilinear;
+  const uint8_t *raw = (const uint8_t *)img_raw->buf;
+  uint8_t *out = (uint8_t *)img->buf;
+
+  // Derotation offset for each bearing, in fixed point
+  int32_t dx[width];
+  int32_t dy[width];
+  if (derotate) {
+    // Look up correction
+    const struct FloatRMat *R = stateGetNedToBodyRMat_f();
+    for (uint16_t u = 0; u < width; u++) {
+      dx[u] = (int32_t) (one * img_raw->h * pano_unwrap.vertical_resolution
+          * (LUT.dphi[u].x * MAT33_ELMT(*R, 1, 2)
+              + LUT.dtheta[u].x * MAT33_ELMT(*R, 0, 2)));
+      dy[u] = (int32_t) (one * img_raw->h * pano_unwrap.vertical_resolution
+          * (LUT.dphi[u].y * MAT33_ELMT(*R, 1, 2)
+              + LUT.dtheta[u].y * MAT33_ELMT(*R, 0, 2)));
+    }
+  } else {
+    memset(dx, 0, sizeof(dx));
+    memset(dy, 0, sizeof(dy));
+  }
+
+  // Draw calibration pattern
   if (pano_unwrap.show_calibration) {
-    uint16_t x = pano_unwrap.center.x * img_raw->w;
-    uint16_t y = pano_unwrap.center.y * img_raw->h;
-    for (int i = -5; i <= 5; i++) {
-      for (int j = -5; j <= 5; j++) {
-        if (i == 0 || j == 0) {
-          PIXEL_Y(img_raw, x+i, y+j) = BLUE_Y;
-          PIXEL_U(img_raw, x+i, y+j) = BLUE_U;
-          PIXEL_V(img_raw, x+i, y+j) = BLUE_V;
+    draw_calibration(img_raw, dx, dy);
+  }
+
+  // Fill the unwrapped image block by block
+  for (uint16_t v0 = 0; v0 < height; v0 += PANO_UNWRAP_TILE_SIZE) {
+    uint16_t v_end = Min(v0 + PANO_UNWRAP_TILE_SIZE, height);
+    for (uint16_t u0 = 0; u0 < width; u0 += PANO_UNWRAP_TILE_SIZE) {
+      uint16_t u_end = Min(u0 + PANO_UNWRAP_TILE_SIZE, width);
+      for (uint16_t v = v0; v < v_end; v++) {
+        const uint16_t *lut_x = &LUT.x[v * width];
+        const uint16_t *lut_y = &LUT.y[v * width];
+        uint8_t *row = &out[2 * v * width];
+        for (uint16_t u = u0; u < u_end; u++) {
+          // Look up sampling point
+          int32_t xq = lut_x[u];
+          int32_t yq = lut_y[u];
+          if (derotate) {
+            xq += dx[u];
+            yq += dy[u];
+            Bound(xq, 0, x_max);
+            Bound(yq, 0, y_max);
+          }
+          // Nearest pixel
+          int32_t x = (xq + half) >> frac_bits;
+          int32_t y = (yq + half) >> frac_bits;
+
+          if (bilinear) {
+            int32_t fx = xq & (one - 1);
+            int32_t fy = yq & (one - 1);
+            // the next pixel is only read when it has a weight, so always inside the image
+            const uint8_t *p00 = &raw[2 * ((yq >> frac_bits) * raw_w + (xq >> frac_bits)) + 1];
+            const uint8_t *p10 = p00 + ((fy != 0) ? 2 * raw_w : 0);
+            int32_t x_step = (fx != 0) ? 2 : 0;
+            int32_t top = p00[0] * (one - fx) + p00[x_step] * fx;
+            int32_t bottom = p10[0] * (one - fx) + p10[x_step] * fx;
+            row[2 * u + 1] = (top * (one - fy) + bottom * fy + (one * one >> 1)) >> (2 * frac_bits);
+          } else {
+            row[2 * u + 1] = raw[2 * (y * raw_w + x) + 1];
+          }
+          // U and V of the pair, the odd pixel of the unwrapped pair overwrites the even one
+          const uint8_t *pair = &raw[2 * y * raw_w + 4 * (x / 2)];
+          row[4 * (u / 2)] = pair[0];
+          row[4 * (u / 2) + 2] = pair[2];
         }
       }
     }
@@ -43,6 +43,7 @@ struct pano_unwrap_t
   uint16_t height;  ///< Height of unwrapped image. Set to 0 (default) to determine automatically from unwrapped_width, radius_bottom, _top and vertical_resolution.
 
   bool overwrite_video_thread;  ///< Set to true if the unwrapped image should be returned to the video thread.
+  bool bilinear;  ///< Set to true to interpolate the luminance between the raw pixels, else the nearest pixel is taken.
 
   bool show_calibration;  ///< Draw calibration pattern on raw image.
 };
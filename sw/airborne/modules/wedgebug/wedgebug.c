@@ -41,6 +41,7 @@
 #include <stdio.h>
 #include "modules/wedgebug/wedgebug.h"
 #include "modules/wedgebug/wedgebug_opencv.h"
+#include "modules/wedgebug/wedgebug_stereo.h"
 #include "modules/computer_vision/cv.h" // Required for the "cv_add_to_device" function
 #include "modules/computer_vision/lib/vision/image.h"// For image-related structures
 #include "pthread.h"
@@ -64,6 +65,12 @@
 #ifndef WEDGEBUG_CAMERA_LEFT_FPS
 #define WEDGEBUG_CAMERA_LEFT_FPS 0 //< Default FPS (zero means run at camera fps)
 #endif
+// Extension of the saved images, they are PGM files without OpenCV
+#if WEDGEBUG_OPENCV
+#define WEDGEBUG_IMG_EXT ".bmp"
+#else
+#define WEDGEBUG_IMG_EXT ".pgm"
+#endif
 
 
 
@@ -71,8 +78,7 @@
 // Define global variables
 
 // Declaring images
-struct image_t img_left;        //! Image obtained from left camera (UYVY format)
-struct image_t img_right;       //! Image obtained from right camera (UYVY format)
+struct image_t img_YY;          //! Gray values of the left and right camera, interlaced (see UYVYs_interlacing_V)
 struct image_t img_left_int8;     //! Image obtained from left camera, converted into 8bit gray image
 struct image_t img_left_int8_cropped; // Image obtained from left camera, converted into 8bit gray image
 struct image_t img_right_int8;      //! Image obtained from right camera, converted into 8bit gray image
@@ -468,29 +474,39 @@ void kernel_free(struct kernel_C1 *kernel)
 // Function 5 - Calculates median of a 8bit image
 uint8_t getMedian(uint8_t *a, uint32_t n)
 {
-  // Allocate an array of the same size and sort it.
-  uint32_t i, j;
+  // Histogram of the values, the median is found by counting up to the middle
+  uint32_t hist[256] = {0};
+  uint32_t i;
 
-  uint8_t dpSorted[n];
+  if (n == 0) {
+    return 0;
+  }
   for (i = 0; i < n; ++i) {
-    dpSorted[i] = a[i];
+    hist[a[i]]++;
   }
-  for (i = n - 1; i > 0; --i) {
-    for (j = 0; j < i; ++j) {
-      if (dpSorted[j] > dpSorted[j + 1]) {
-        uint8_t dTemp = dpSorted[j];
-        dpSorted[j] = dpSorted[j + 1];
-        dpSorted[j + 1] = dTemp;
-      }
-    }
+
+  // Value at sorted position k
+  uint32_t k = n / 2;
+  uint32_t count = 0;
+  uint16_t v = 0;
+  while (count + hist[v] <= k) {
+    count += hist[v];
+    v++;
   }
 
   // Middle or average of middle values in the sorted array.
   uint8_t dMedian = 0;
   if ((n % 2) == 0) {
-    dMedian = (dpSorted[n / 2] + dpSorted[(n / 2) - 1]) / 2.0;
+    // value at position k - 1, either the same or the previous non empty bin
+    uint16_t v_prev = v;
+    if (count == k) {
+      do {
+        v_prev--;
+      } while (hist[v_prev] == 0);
+    }
+    dMedian = (v + v_prev) / 2.0;
   } else {
-    dMedian = dpSorted[n / 2];
+    dMedian = v;
   }
   return dMedian;
 }
@@ -499,29 +515,58 @@ uint8_t getMedian(uint8_t *a, uint32_t n)
 // Function 6 - Calculates median of a 16bit image
 uint16_t getMedian16bit(uint16_t *a, uint32_t n)
 {
-  // Allocate an array of the same size and sort it.
-  uint32_t i, j;
+  // Quickselect on a copy of the values
+  uint32_t i;
 
+  if (n == 0) {
+    return 0;
+  }
   uint16_t dpSorted[n];
   for (i = 0; i < n; ++i) {
     dpSorted[i] = a[i];
   }
-  for (i = n - 1; i > 0; --i) {
-    for (j = 0; j < i; ++j) {
-      if (dpSorted[j] > dpSorted[j + 1]) {
-        uint16_t dTemp = dpSorted[j];
-        dpSorted[j] = dpSorted[j + 1];
-        dpSorted[j + 1] = dTemp;
+
+  // Partitions until the value at position k = n / 2 is in place,
+  // all values before it are then smaller or equal
+  uint32_t k = n / 2;
+  uint32_t lo = 0, hi = n - 1;
+  while (lo < hi) {
+    uint16_t pivot = dpSorted[(lo + hi) / 2];
+    uint32_t l = lo, r = hi;
+    while (l <= r) {
+      while (dpSorted[l] < pivot) { l++; }
+      while (dpSorted[r] > pivot) { r--; }
+      if (l <= r) {
+        uint16_t dTemp = dpSorted[l];
+        dpSorted[l] = dpSorted[r];
+        dpSorted[r] = dTemp;
+        l++;
+        if (r == 0) { break; }
+        r--;
       }
     }
+    if (k <= r) {
+      hi = r;
+    } else if (k >= l) {
+      lo = l;
+    } else {
+      break;
+    }
   }
 
   // Middle or average of middle values in the sorted array.
   uint16_t dMedian = 0;
   if ((n % 2) == 0) {
-    dMedian = (dpSorted[n / 2] + dpSorted[(n / 2) - 1]) / 2.0;
+    // position k - 1 holds the largest of the values before k
+    uint16_t prev = dpSorted[0];
+    for (i = 1; i < k; ++i) {
+      if (dpSorted[i] > prev) {
+        prev = dpSorted[i];
+      }
+    }
+    dMedian = (dpSorted[k] + prev) / 2.0;
   } else {
-    dMedian = dpSorted[n / 2];
+    dMedian = dpSorted[k];
   }
   return dMedian;
 }
@@ -534,9 +579,8 @@ uint16_t getMedian16bit(uint16_t *a, uint32_t n)
 // Function 1
 static struct image_t *copy_left_img_func(struct image_t *img, uint8_t camera_id __attribute__((unused)))
 {
-  image_copy(img, &img_left);
+  YY_interlace_channel(&img_YY, img, 0);
   //show_image_data(img);
-  //show_image_entry(&img_left, 10, "img_left");
   return img;
 }
 
@@ -544,9 +588,8 @@ static struct image_t *copy_left_img_func(struct image_t *img, uint8_t camera_id
 // Function 2
 static struct image_t *copy_right_img_func(struct image_t *img, uint8_t camera_id __attribute__((unused)))
 {
-  image_copy(img, &img_right);
+  YY_interlace_channel(&img_YY, img, 1);
   //show_image_data(img);
-  //show_image_entry(&img_right, 10, "img_right");
   return img;
 }
 
@@ -559,7 +602,7 @@ void UYVYs_interlacing_V(struct image_t *merged, struct image_t *left, struct im
     printf("The dimensions of the left and right image to not match!");
     return;
   }
-  if ((merged->w * merged->h) != (2 * right->w) * right->w) {
+  if ((merged->w * merged->h) != (2 * right->w) * right->h) {
     printf("The dimensions of the empty image template for merger are not sufficient to merge gray left and right pixel values.");
     return;
   }
@@ -598,7 +641,7 @@ void UYVYs_interlacing_H(struct image_t *merged, struct image_t *left, struct im
     printf("The dimensions of the left and right image to not match!");
     return;
   }
-  if ((merged->w * merged->h) != (2 * right->w) * right->w) {
+  if ((merged->w * merged->h) != (2 * right->w) * right->h) {
     printf("The dimensions of the empty image template for merger are not sufficient to merge gray left and right pixel values.");
     return;
   }
@@ -1393,10 +1436,13 @@ void disp_to_depth_img(struct image_t *img_input, struct image_t *img16bit_outpu
   // Converting disparity values into depth (cm)
   for (int32_t i = 0; i < (img_input->h * img_input->w); i++) {
 
-    if (img_input->type == IMAGE_GRAYSCALE) {
+    // Invalid (negative) and zero disparities are infinitely far away
+    if (img_input->type == IMAGE_GRAYSCALE && ((uint8_t *)img_input->buf)[i] > 0) {
       disparity = disp_to_depth(((uint8_t *)img_input->buf)[i], b, f);
-    } else if (img_input->type == IMAGE_INT16) {
-      disparity = disp_to_depth_16bit(((uint16_t *)img_input->buf)[i], b, f);
+    } else if (img_input->type == IMAGE_INT16 && ((int16_t *)img_input->buf)[i] > 0) {
+      disparity = disp_to_depth_16bit(((int16_t *)img_input->buf)[i], b, f);
+    } else if (img_input->type == IMAGE_GRAYSCALE || img_input->type == IMAGE_INT16) {
+      disparity = INFINITY;
     } else {
       printf("ERROR: function does not support image type %d. Breaking out of function.", img_input->type);
     }
@@ -1416,7 +1462,7 @@ void disp_to_depth_img(struct image_t *img_input, struct image_t *img16bit_outpu
     }*/
 
 
-    ((uint16_t *)img16bit_output->buf)[i] = round(disparity);
+    ((uint16_t *)img16bit_output->buf)[i] = (disparity < UINT16_MAX) ? round(disparity) : UINT16_MAX;
   }
   //printf("Depth in cm at %d = %d\n", n, ((int16_t*)img16bit_output->buf)[n]);
 }
@@ -1428,14 +1474,14 @@ void background_processes(uint8_t _save_images_flag)
 {
   //Background processes
   // 1. Converting left and right image to 8bit grayscale for further processing
-  image_to_grayscale(&img_left, &img_left_int8); // Converting left image from UYVY to gray scale for saving function
-  image_to_grayscale(&img_right, &img_right_int8); // Converting right image from UYVY to gray scale for saving function
+  // The block matching works on the interlaced image directly, the separate images are only needed for saving
+  if (_save_images_flag) {YY_deinterlace(&img_left_int8, &img_right_int8, &img_YY);}
 
   // 2. Deriving disparity map from block matching (left image is reference image)
-  SBM_OCV(&img_disparity_int8_cropped, &img_left_int8, &img_right_int8, N_disparities, block_size_disparities,
-          1);// Creating cropped disparity map image
+  SBM_native(&img_disparity_int8_cropped, &img_YY, N_disparities, block_size_disparities,
+             1);// Creating cropped disparity map image
   // For report: creating image for saving 1
-  if (_save_images_flag) {save_image_HM(&img_disparity_int8_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b_img1_post_SBM.bmp", heat_map_type);}
+  if (_save_images_flag) {save_image_HM(&img_disparity_int8_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b_img1_post_SBM" WEDGEBUG_IMG_EXT, heat_map_type);}
 
   /*
   // Optional thresholding of disparity map
@@ -1451,27 +1497,27 @@ void background_processes(uint8_t _save_images_flag)
 
   // 3. Morphological operations 1
   // Needed to smoove object boundaries and to remove noise removing noise
-  opening_OCV(&img_disparity_int8_cropped, &img_middle_int8_cropped, SE_opening_OCV, 1);
+  opening_native(&img_disparity_int8_cropped, &img_middle_int8_cropped, SE_opening_OCV, 1);
   // For report: creating image for saving 2
-  if (_save_images_flag) {save_image_HM(&img_middle_int8_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b_img2_post_opening_8bit.bmp", heat_map_type);}
+  if (_save_images_flag) {save_image_HM(&img_middle_int8_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b_img2_post_opening_8bit" WEDGEBUG_IMG_EXT, heat_map_type);}
 
-  closing_OCV(&img_middle_int8_cropped, &img_middle_int8_cropped, SE_closing_OCV, 1);
+  closing_native(&img_middle_int8_cropped, &img_middle_int8_cropped, SE_closing_OCV, 1);
   // For report: creating image for saving 3
-  if (_save_images_flag) {save_image_HM(&img_middle_int8_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b_img3_post_closing_8bit.bmp", heat_map_type);}
+  if (_save_images_flag) {save_image_HM(&img_middle_int8_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b_img3_post_closing_8bit" WEDGEBUG_IMG_EXT, heat_map_type);}
 
-  dilation_OCV(&img_middle_int8_cropped, &img_middle_int8_cropped, SE_dilation_OCV_1, 1);
+  dilation_native(&img_middle_int8_cropped, &img_middle_int8_cropped, SE_dilation_OCV_1, 1);
   // For report: creating image for saving 4
-  if (_save_images_flag) {save_image_HM(&img_middle_int8_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b_img4_post_dilation_8bit.bmp", heat_map_type);}
+  if (_save_images_flag) {save_image_HM(&img_middle_int8_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b_img4_post_dilation_8bit" WEDGEBUG_IMG_EXT, heat_map_type);}
 
   // 4. Depth image
   disp_to_depth_img(&img_middle_int8_cropped, &img_depth_int16_cropped);
   // For report: creating image for saving 4
-  if (_save_images_flag) {save_image_HM(&img_depth_int16_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b_img5_post_depth_16bit.bmp", heat_map_type);}
+  if (_save_images_flag) {save_image_HM(&img_depth_int16_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b_img5_post_depth_16bit" WEDGEBUG_IMG_EXT, heat_map_type);}
 
   // 5. Sobel edge detection
-  sobel_OCV(&img_depth_int16_cropped, &img_edges_int8_cropped, SE_sobel_OCV, threshold_edge_magnitude);
+  sobel_native(&img_depth_int16_cropped, &img_edges_int8_cropped, SE_sobel_OCV, threshold_edge_magnitude);
   // For report: creating image for saving 5
-  if (_save_images_flag) {save_image_gray(&img_edges_int8_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b_img6_post_sobel_8bit.bmp");}
+  if (_save_images_flag) {save_image_gray(&img_edges_int8_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b_img6_post_sobel_8bit" WEDGEBUG_IMG_EXT);}
 }
 
 
@@ -1482,14 +1528,14 @@ void background_processes_16bit(uint8_t _save_images_flag)
 {
   //Background processes
   // 1. Converting left and right image to 8bit grayscale for further processing
-  image_to_grayscale(&img_left, &img_left_int8); // Converting left image from UYVY to gray scale for saving function
-  image_to_grayscale(&img_right, &img_right_int8); // Converting right image from UYVY to gray scale for saving function
+  // The block matching works on the interlaced image directly, the separate images are only needed for saving
+  if (_save_images_flag) {YY_deinterlace(&img_left_int8, &img_right_int8, &img_YY);}
 
   // 2. Deriving disparity map from block matching (left image is reference image)
-  SBM_OCV(&img_disparity_int16_cropped, &img_left_int8, &img_right_int8, N_disparities, block_size_disparities,
-          1);// Creating cropped disparity map image
+  SBM_native(&img_disparity_int16_cropped, &img_YY, N_disparities, block_size_disparities,
+             1);// Creating cropped disparity map image
   // For report: creating image for saving 1
-  if (_save_images_flag) {save_image_HM(&img_disparity_int16_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b2_img1_post_SBM_16bit.bmp", heat_map_type);}
+  if (_save_images_flag) {save_image_HM(&img_disparity_int16_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b2_img1_post_SBM_16bit" WEDGEBUG_IMG_EXT, heat_map_type);}
 
   //printf("maximum_intensity = %d\n", maximum_intensity(&img_disparity_int16_cropped));
 
@@ -1508,38 +1554,38 @@ void background_processes_16bit(uint8_t _save_images_flag)
   // 3. Morphological operations 1
   // Needed to smoove object boundaries and to remove noise removing noise
 
-  closing_OCV(&img_disparity_int16_cropped, &img_disparity_int16_cropped, SE_closing_OCV, 1);
+  closing_native(&img_disparity_int16_cropped, &img_disparity_int16_cropped, SE_closing_OCV, 1);
   // For report: creating image for saving 3
-  if (_save_images_flag) {save_image_HM(&img_disparity_int16_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b2_img2_post_closing_16bit.bmp", heat_map_type);}
+  if (_save_images_flag) {save_image_HM(&img_disparity_int16_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b2_img2_post_closing_16bit" WEDGEBUG_IMG_EXT, heat_map_type);}
 
 
-  opening_OCV(&img_disparity_int16_cropped, &img_disparity_int16_cropped, SE_opening_OCV, 1);
+  opening_native(&img_disparity_int16_cropped, &img_disparity_int16_cropped, SE_opening_OCV, 1);
   // For report: creating image for saving 2
-  if (_save_images_flag) {save_image_HM(&img_disparity_int16_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b2_img3_post_opening_16bit.bmp", heat_map_type);}
+  if (_save_images_flag) {save_image_HM(&img_disparity_int16_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b2_img3_post_opening_16bit" WEDGEBUG_IMG_EXT, heat_map_type);}
 
 
 
-  dilation_OCV(&img_disparity_int16_cropped, &img_disparity_int16_cropped, SE_dilation_OCV_1, 1);
+  dilation_native(&img_disparity_int16_cropped, &img_disparity_int16_cropped, SE_dilation_OCV_1, 1);
   // For report: creating image for saving 4
-  if (_save_images_flag) {save_image_HM(&img_disparity_int16_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b2_img4_post_dilation_16bit.bmp", heat_map_type);}
+  if (_save_images_flag) {save_image_HM(&img_disparity_int16_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b2_img4_post_dilation_16bit" WEDGEBUG_IMG_EXT, heat_map_type);}
 
 
   // 4. Depth image
   disp_to_depth_img(&img_disparity_int16_cropped, &img_depth_int16_cropped);
   // For report: creating image for saving 4
-  if (_save_images_flag) {save_image_HM(&img_depth_int16_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b2_img5_post_depth_16bit.bmp", heat_map_type);}
+  if (_save_images_flag) {save_image_HM(&img_depth_int16_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b2_img5_post_depth_16bit" WEDGEBUG_IMG_EXT, heat_map_type);}
 
 
   // 5. Sobel edge detection
-  sobel_OCV(&img_depth_int16_cropped, &img_edges_int8_cropped, SE_sobel_OCV, threshold_edge_magnitude);
+  sobel_native(&img_depth_int16_cropped, &img_edges_int8_cropped, SE_sobel_OCV, threshold_edge_magnitude);
   // For report: creating image for saving 5
-  if (_save_images_flag) {save_image_gray(&img_edges_int8_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b2_img6_post_sobel_8bit.bmp");}
+  if (_save_images_flag) {save_image_gray(&img_edges_int8_cropped, "/home/dureade/Documents/paparazzi_images/for_report/b2_img6_post_sobel_8bit" WEDGEBUG_IMG_EXT);}
 
   // 6. Morphological  operations 2
   // This is needed so that when using the edges as filters (to work on depth values
   // only found on edges) the underlying depth values are those of the foreground
   // and not the background
-  erosion_OCV(&img_depth_int16_cropped, &img_depth_int16_cropped, SE_erosion_OCV, 1);
+  erosion_native(&img_depth_int16_cropped, &img_depth_int16_cropped, SE_erosion_OCV, 1);
 }
 
 
@@ -1592,8 +1638,7 @@ void wedgebug_init()
   img_dims.w = WEDGEBUG_CAMERA_LEFT_WIDTH; img_dims.h = WEDGEBUG_CAMERA_LEFT_HEIGHT;
 
 
-  image_create(&img_left, img_dims.w, img_dims.h, IMAGE_YUV422);  // To store left camera image
-  image_create(&img_right, img_dims.w, img_dims.h, IMAGE_YUV422);// To store right camera image
+  image_create(&img_YY, 2 * img_dims.w, img_dims.h, IMAGE_GRAYSCALE);  // To store gray values of both cameras
   image_create(&img_left_int8, img_dims.w, img_dims.h, IMAGE_GRAYSCALE);  // To store gray scale version of left image
   image_create(&img_right_int8, img_dims.w, img_dims.h, IMAGE_GRAYSCALE);  // To store gray scale version of left image
 
@@ -2000,7 +2045,7 @@ void wedgebug_periodic()
 
 
 
-          if (save_images_flag) {save_image_gray(&img_edges_int8_cropped, "/home/dureade/Documents/paparazzi_images/img_edges_int8_cropped_marked.bmp");}
+          if (save_images_flag) {save_image_gray(&img_edges_int8_cropped, "/home/dureade/Documents/paparazzi_images/img_edges_int8_cropped_marked" WEDGEBUG_IMG_EXT);}
 
 
           if (is_setpoint_reached_flag) {
@@ -2322,7 +2367,7 @@ void wedgebug_periodic()
                 VPBESTEDGECOORDINATESwned.z = VEDGECOORDINATESwned.z;
 
                 // Making snapshot of image with edge coordinates highlighted. Comment out if not needed
-                if (save_images_flag) {save_image_gray(&img_edges_int8_cropped, "/home/dureade/Documents/paparazzi_images/img_edges_int8_cropped_marked.bmp");}
+                if (save_images_flag) {save_image_gray(&img_edges_int8_cropped, "/home/dureade/Documents/paparazzi_images/img_edges_int8_cropped_marked" WEDGEBUG_IMG_EXT);}
 
               }
               // If the no_edge_found_macro_confidence is high enough, set is_no_edge_found_macro_flag to 1 and reset edge_found_macro_confidence and no_edge_found_confidence
@@ -2729,7 +2774,7 @@ void wedgebug_periodic()
 
 
 
-      if (save_images_flag) {save_image_gray(&img_edges_int8_cropped, "/home/dureade/Documents/paparazzi_images/img_edges_int8_cropped_marked.bmp");}
+      if (save_images_flag) {save_image_gray(&img_edges_int8_cropped, "/home/dureade/Documents/paparazzi_images/img_edges_int8_cropped_marked" WEDGEBUG_IMG_EXT);}
 
 
 
@@ -2763,21 +2808,22 @@ void wedgebug_periodic()
 
 
 
-  save_image_gray(&img_left_int8, "/home/dureade/Documents/paparazzi_images/img_left_int8.bmp");
-  save_image_gray(&img_right_int8, "/home/dureade/Documents/paparazzi_images/img_right_int8.bmp");
-  save_image_HM(&img_disparity_int8_cropped, "/home/dureade/Documents/paparazzi_images/img_disparity_int8_cropped.bmp",
-                heat_map_type);
-  //save_image_gray(&img_left_int8_cropped, "/home/dureade/Documents/paparazzi_images/img_left_int8_cropped.bmp");
-  save_image_HM(&img_middle_int8_cropped, "/home/dureade/Documents/paparazzi_images/img_intermediate_int8_cropped.bmp",
-                heat_map_type);
-  save_image_gray(&img_edges_int8_cropped, "/home/dureade/Documents/paparazzi_images/img_edges_int8_cropped.bmp");
+  if (save_images_flag) {
+    save_image_gray(&img_left_int8, "/home/dureade/Documents/paparazzi_images/img_left_int8" WEDGEBUG_IMG_EXT);
+    save_image_gray(&img_right_int8, "/home/dureade/Documents/paparazzi_images/img_right_int8" WEDGEBUG_IMG_EXT);
+    save_image_HM(&img_disparity_int8_cropped, "/home/dureade/Documents/paparazzi_images/img_disparity_int8_cropped" WEDGEBUG_IMG_EXT,
+                  heat_map_type);
+    //save_image_gray(&img_left_int8_cropped, "/home/dureade/Documents/paparazzi_images/img_left_int8_cropped" WEDGEBUG_IMG_EXT);
+    save_image_HM(&img_middle_int8_cropped, "/home/dureade/Documents/paparazzi_images/img_intermediate_int8_cropped" WEDGEBUG_IMG_EXT,
+                  heat_map_type);
+    save_image_gray(&img_edges_int8_cropped, "/home/dureade/Documents/paparazzi_images/img_edges_int8_cropped" WEDGEBUG_IMG_EXT);
+  }
 
 
 
   /*
   // Size of variables
-  printf("img_left = %d\n", img_left.buf_size);
-  printf("img_right = %d\n", img_right.buf_size);
+  printf("img_YY = %d\n", img_YY.buf_size);
   printf("img_left_int8 = %d\n", img_left_int8.buf_size);
   printf("img_left_int8_cropped = %d\n", img_left_int8_cropped.buf_size);
   printf("img_right_int8 = %d\n", img_right_int8.buf_size);
@@ -0,0 +1,625 @@
+/*
+ * Copyright (C) Ralph Rudi schmidt <ralph.r.schmidt@outlook.com>
+
+ *
+ * This file is part of paparazzi
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+
+ */
+/** @file "modules/wedgebug/wedgebug_stereo.c"
+ * Native stereo block matching, morphology and edge detection for the wedgebug.
+ *
+ * The block matching works on the interlaced gray image of UYVYs_interlacing_V (left and right
+ * pixels side by side). Like OpenCV StereoBM, both images are filtered with a clipped horizontal
+ * Sobel and matched with the sum of absolute differences (SAD) over a square window. The SAD of all
+ * disparities is updated incrementally: column sums are updated with one line entering and one
+ * leaving the window, then summed along the line, so the cost does not depend on the window size.
+ *
+ * Morphology uses the van Herk/Gil-Werman running minimum/maximum, separable for rectangular
+ * structuring elements: 3 comparisons per pixel and pass whatever the structuring element size.
+ */
+
+#include "modules/wedgebug/wedgebug_stereo.h"
+#include "modules/wedgebug/wedgebug.h"
+#include "modules/wedgebug/wedgebug_opencv.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/** Clipping value of the prefilter (OpenCV StereoBM default) */
+#ifndef WEDGEBUG_SBM_PREFILTER_CAP
+#define WEDGEBUG_SBM_PREFILTER_CAP 31
+#endif
+
+/** Margin in percent by which the best match must win over all others (OpenCV StereoBM default) */
+#ifndef WEDGEBUG_SBM_UNIQUENESS
+#define WEDGEBUG_SBM_UNIQUENESS 15
+#endif
+
+/** Minimum sum of the prefiltered left image over the window, below it the pixel is invalid
+ * (OpenCV StereoBM default) */
+#ifndef WEDGEBUG_SBM_TEXTURE_THRESHOLD
+#define WEDGEBUG_SBM_TEXTURE_THRESHOLD 10
+#endif
+
+/** Disparity of the invalid pixels in 16bit images, (minimum disparity - 1) * 16 like OpenCV StereoBM */
+#define SBM_INVALID_DISP (-16)
+
+/** Use NEON for the SAD updates, only on ARM processors */
+#ifndef WEDGEBUG_USE_NEON
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define WEDGEBUG_USE_NEON TRUE
+#else
+#define WEDGEBUG_USE_NEON FALSE
+#endif
+#endif
+
+#if WEDGEBUG_USE_NEON
+#include <arm_neon.h>
+#endif
+
+/** Work buffer, only grows */
+struct work_buf_t {
+  void *buf;
+  size_t size;
+};
+
+static struct work_buf_t prefiltered_buf, colsum_buf, texsum_buf, cost_buf, best_buf, morph_buf, line_buf, edge_buf;
+
+static void *work_buf_get(struct work_buf_t *wb, size_t size)
+{
+  if (size > wb->size) {
+    free(wb->buf);
+    wb->buf = malloc(size);
+    wb->size = (wb->buf != NULL) ? size : 0;
+  }
+  return wb->buf;
+}
+
+
+// Stereo block matching
+
+void YY_interlace_channel(struct image_t *YY, struct image_t *uyvy, uint8_t offset)
+{
+  if (YY->w != 2 * uyvy->w || YY->h != uyvy->h) {
+    printf("The dimensions of the interlaced image do not match the camera image!\n");
+    return;
+  }
+
+  uint8_t *src = (uint8_t *)uyvy->buf + 1;
+  uint8_t *dst = (uint8_t *)YY->buf + offset;
+  uint32_t n = uyvy->w * uyvy->h;
+  for (uint32_t i = 0; i < n; i++) {
+    dst[2 * i] = src[2 * i];
+  }
+}
+
+void YY_deinterlace(struct image_t *left, struct image_t *right, struct image_t *YY)
+{
+  if (YY->w != 2 * left->w || YY->h != left->h || left->w != right->w || left->h != right->h) {
+    printf("The dimensions of the interlaced image do not match the left and right images!\n");
+    return;
+  }
+
+  uint8_t *src = YY->buf;
+  uint8_t *l = left->buf;
+  uint8_t *r = right->buf;
+  uint32_t n = left->w * left->h;
+  for (uint32_t i = 0; i < n; i++) {
+    l[i] = src[2 * i];
+    r[i] = src[2 * i + 1];
+  }
+}
+
+/**
+ * Clipped horizontal Sobel of both images of an interlaced image (OpenCV StereoBM prefilter).
+ * Outputs values in [0, 2 * cap], borders are set to cap.
+ */
+static void sbm_prefilter(uint8_t *out, const uint8_t *in, uint16_t w2, uint16_t h)
+{
+  const int16_t cap = WEDGEBUG_SBM_PREFILTER_CAP;
+
+  memset(out, cap, w2);
+  memset(out + (h - 1) * w2, cap, w2);
+  for (uint16_t y = 1; y < h - 1; y++) {
+    const uint8_t *up = in + (y - 1) * w2;
+    const uint8_t *row = in + y * w2;
+    const uint8_t *down = in + (y + 1) * w2;
+    uint8_t *o = out + y * w2;
+
+    // neighbours of the same image are 2 bytes away
+    o[0] = o[1] = o[w2 - 2] = o[w2 - 1] = cap;
+    for (uint16_t k = 2; k < w2 - 2; k++) {
+      int16_t d = (up[k + 2] - up[k - 2]) + 2 * (row[k + 2] - row[k - 2]) + (down[k + 2] - down[k - 2]);
+      d = d < -cap ? -cap : (d > cap ? cap : d);
+      o[k] = d + cap;
+    }
+  }
+}
+
+/**
+ * Add (sign > 0) or remove a line of absolute differences to the column sums of a disparity.
+ * @param col Column sums of the disparity, for the left pixels xs to xs + ncol - 1
+ * @param row Prefiltered interlaced line
+ */
+static inline void sbm_colsum_update(uint16_t *col, const uint8_t *row, int xs, int ncol, int d, int sign)
+{
+  const uint8_t *left = row + 2 * xs;
+  const uint8_t *right = row + 2 * (xs - d) + 1;
+  int j = 0;
+
+#if WEDGEBUG_USE_NEON
+  for (; j + 16 <= ncol; j += 16) {
+    // de-interlace 16 pixels of both images at once
+    uint8x16x2_t l = vld2q_u8(left + 2 * j);
+    uint8x16x2_t r = vld2q_u8(right - 1 + 2 * j);
+    uint8x16_t ad = vabdq_u8(l.val[0], r.val[1]);
+    uint16x8_t c_lo = vld1q_u16(col + j);
+    uint16x8_t c_hi = vld1q_u16(col + j + 8);
+    if (sign > 0) {
+      c_lo = vaddw_u8(c_lo, vget_low_u8(ad));
+      c_hi = vaddw_u8(c_hi, vget_high_u8(ad));
+    } else {
+      c_lo = vsubw_u8(c_lo, vget_low_u8(ad));
+      c_hi = vsubw_u8(c_hi, vget_high_u8(ad));
+    }
+    vst1q_u16(col + j, c_lo);
+    vst1q_u16(col + j + 8, c_hi);
+  }
+#endif
+
+  if (sign > 0) {
+    for (; j < ncol; j++) {
+      col[j] += abs(left[2 * j] - right[2 * j]);
+    }
+  } else {
+    for (; j < ncol; j++) {
+      col[j] -= abs(left[2 * j] - right[2 * j]);
+    }
+  }
+}
+
+/**
+ * Add (sign > 0) or remove a line of the left image texture to its column sums.
+ * The texture of a pixel is the absolute value of its prefiltered horizontal gradient.
+ */
+static inline void sbm_texsum_update(uint16_t *col, const uint8_t *row, int xs, int ncol, int sign)
+{
+  const uint8_t *left = row + 2 * xs;
+  const int16_t cap = WEDGEBUG_SBM_PREFILTER_CAP;
+  for (int j = 0; j < ncol; j++) {
+    col[j] += sign * abs(left[2 * j] - cap);
+  }
+}
+
+/**
+ * Block matching on an interlaced gray image, with the left image as reference.
+ * Pixels with too little texture or without a unique best match are invalid: -16 in 16bit images
+ * (like OpenCV StereoBM) and 0 in 8bit images.
+ * @param[out] img_disp Disparity image, IMAGE_GRAYSCALE (pixels) or IMAGE_INT16 (pixels * 16, with sub-pixel
+ * interpolation). Either cropped (see post_disparity_crop_rect) or of the size of the camera images.
+ * @param[in] img_YY Interlaced gray image (see UYVYs_interlacing_V)
+ * @param[in] ndisparities Number of disparities, from 0 to ndisparities - 1
+ * @param[in] SADWindowSize Size of the matching window, odd
+ * @param[in] cropped Whether the disparity image is cropped to the pixels where all disparities are evaluated
+ * @return 0 on success, -1 on error
+ */
+int SBM_native(struct image_t *img_disp, struct image_t *img_YY, const int ndisparities, const int SADWindowSize,
+               const bool cropped)
+{
+  const int w2 = img_YY->w;
+  const int w = w2 / 2;
+  const int h = img_YY->h;
+  const int bs = SADWindowSize;
+  const int r = bs / 2;
+
+  if (bs % 2 == 0 || ndisparities < 1 || w <= ndisparities + bs || h <= bs) {
+    printf("SBM_native: unsupported block size or disparity range\n");
+    return -1;
+  }
+  if (img_disp->type != IMAGE_GRAYSCALE && img_disp->type != IMAGE_INT16) {
+    printf("SBM_native: this function only works with images of type IMAGE_GRAYSCALE and IMAGE_INT16.\n");
+    return -1;
+  }
+
+  struct crop_t crop;
+  struct img_size_t dims = {w, h};
+  post_disparity_crop_rect(&crop, &dims, ndisparities, bs);
+  if ((cropped && (img_disp->w != crop.w || img_disp->h != crop.h)) ||
+      (!cropped && (img_disp->w != w || img_disp->h != h))) {
+    printf("SBM_native: the disparity image has the wrong dimensions\n");
+    return -1;
+  }
+
+  // columns of the window sums, the first column is the first right pixel of the largest disparity
+  const int xs = crop.x - r;
+  const int ncol = crop.w + bs - 1;
+  uint8_t *pf = work_buf_get(&prefiltered_buf, w2 * h);
+  uint16_t *colsum = work_buf_get(&colsum_buf, ndisparities * ncol * sizeof(uint16_t));
+  uint16_t *texsum = work_buf_get(&texsum_buf, ncol * sizeof(uint16_t));
+  uint32_t *cost = work_buf_get(&cost_buf, ndisparities * crop.w * sizeof(uint32_t));
+  uint32_t *best = work_buf_get(&best_buf, 2 * crop.w * sizeof(uint32_t));
+  if (pf == NULL || colsum == NULL || texsum == NULL || cost == NULL || best == NULL) {
+    return -1;
+  }
+  uint32_t *best_cost = best;
+  uint32_t *best_d = best + crop.w;
+
+  sbm_prefilter(pf, img_YY->buf, w2, h);
+
+  if (!cropped) {
+    if (img_disp->type == IMAGE_INT16) {
+      for (int i = 0; i < w * h; i++) {
+        ((int16_t *)img_disp->buf)[i] = SBM_INVALID_DISP;
+      }
+    } else {
+      memset(img_disp->buf, 0, img_disp->buf_size);
+    }
+  }
+
+  // window of the first line
+  memset(colsum, 0, ndisparities * ncol * sizeof(uint16_t));
+  memset(texsum, 0, ncol * sizeof(uint16_t));
+  for (int y = 0; y < bs; y++) {
+    sbm_texsum_update(texsum, pf + y * w2, xs, ncol, 1);
+    for (int d = 0; d < ndisparities; d++) {
+      sbm_colsum_update(colsum + d * ncol, pf + y * w2, xs, ncol, d, 1);
+    }
+  }
+
+  for (int cy = 0; cy < crop.h; cy++) {
+    const int y = crop.y + cy;
+
+    // slide the window one line down
+    if (cy > 0) {
+      sbm_texsum_update(texsum, pf + (y + r) * w2, xs, ncol, 1);
+      sbm_texsum_update(texsum, pf + (y - r - 1) * w2, xs, ncol, -1);
+      for (int d = 0; d < ndisparities; d++) {
+        sbm_colsum_update(colsum + d * ncol, pf + (y + r) * w2, xs, ncol, d, 1);
+        sbm_colsum_update(colsum + d * ncol, pf + (y - r - 1) * w2, xs, ncol, d, -1);
+      }
+    }
+
+    // window sums along the line and best disparity
+    for (int cx = 0; cx < crop.w; cx++) {
+      best_cost[cx] = UINT32_MAX;
+      best_d[cx] = 0;
+    }
+    for (int d = 0; d < ndisparities; d++) {
+      const uint16_t *col = colsum + d * ncol;
+      uint32_t *c = cost + d * crop.w;
+      uint32_t sum = 0;
+      for (int j = 0; j < bs; j++) {
+        sum += col[j];
+      }
+      c[0] = sum;
+      for (int cx = 1; cx < crop.w; cx++) {
+        sum += col[cx + bs - 1] - col[cx - 1];
+        c[cx] = sum;
+      }
+      for (int cx = 0; cx < crop.w; cx++) {
+        if (c[cx] < best_cost[cx]) {
+          best_cost[cx] = c[cx];
+          best_d[cx] = d;
+        }
+      }
+    }
+
+    // texture and uniqueness checks, sub-pixel interpolation and output
+    uint32_t tex = 0;
+    for (int j = 0; j < bs - 1; j++) {
+      tex += texsum[j];
+    }
+    for (int cx = 0; cx < crop.w; cx++) {
+      tex += texsum[cx + bs - 1];
+      const bool textured = tex >= WEDGEBUG_SBM_TEXTURE_THRESHOLD;
+      tex -= texsum[cx];
+
+      const int d = best_d[cx];
+      const uint32_t thresh = best_cost[cx] + best_cost[cx] * WEDGEBUG_SBM_UNIQUENESS / 100;
+      bool valid = textured;
+      for (int k = 0; valid && k < ndisparities; k++) {
+        if ((k < d - 1 || k > d + 1) && cost[k * crop.w + cx] <= thresh) {
+          valid = false;
+        }
+      }
+      int16_t disp = d * 16;
+      if (valid && d > 0 && d < ndisparities - 1) {
+        const int32_t n = cost[(d - 1) * crop.w + cx];
+        const int32_t p = cost[(d + 1) * crop.w + cx];
+        const int32_t denom = n + p - 2 * (int32_t)best_cost[cx];
+        if (denom > 0) {
+          disp += 16 * (n - p) / (2 * denom);
+        }
+      }
+
+      const int32_t idx = cropped ? cy * crop.w + cx : y * w + crop.x + cx;
+      if (img_disp->type == IMAGE_INT16) {
+        ((int16_t *)img_disp->buf)[idx] = valid ? disp : SBM_INVALID_DISP;
+      } else {
+        ((uint8_t *)img_disp->buf)[idx] = valid ? disp / 16 : 0;
+      }
+    }
+  }
+
+  return 0;
+}
+
+
+// Morphology
+
+/**
+ * Running minimum or maximum over a window of k values (van Herk/Gil-Werman).
+ * Values outside of the line are ignored, the window is anchored at its center (k / 2).
+ */
+static void minmax_line(int16_t *out, int out_stride, const int16_t *in, int in_stride, int n, int k, bool max,
+                        int16_t *pad, int16_t *g, int16_t *hs)
+{
+  const int left = k / 2;
+  const int m = ((n + 2 * k - 2) / k) * k; // padded length, multiple of k
+  const int16_t neutral = max ? INT16_MIN : INT16_MAX;
+
+  for (int i = 0; i < m; i++) {
+    pad[i] = (i >= left && i - left < n) ? in[(i - left) * in_stride] : neutral;
+  }
+
+  // running value from the start (g) and from the end (hs) of each block of k values
+  for (int b = 0; b < m; b += k) {
+    g[b] = pad[b];
+    hs[b + k - 1] = pad[b + k - 1];
+    for (int i = 1; i < k; i++) {
+      int16_t a = pad[b + i], c = pad[b + k - 1 - i];
+      g[b + i] = max ? Max(g[b + i - 1], a) : Min(g[b + i - 1], a);
+      hs[b + k - 1 - i] = max ? Max(hs[b + k - i], c) : Min(hs[b + k - i], c);
+    }
+  }
+
+  for (int x = 0; x < n; x++) {
+    out[x * out_stride] = max ? Max(hs[x], g[x + k - 1]) : Min(hs[x], g[x + k - 1]);
+  }
+}
+
+/** Dilation (max) or erosion (min) of an int16 image with a rectangular SE of size k x k, in place */
+static int morph_int16(int16_t *img, int16_t *tmp, int w, int h, int k, bool max)
+{
+  const int m = Max(w, h) + 2 * k;
+  int16_t *line = work_buf_get(&line_buf, 3 * m * sizeof(int16_t));
+  if (line == NULL) {
+    return -1;
+  }
+
+  for (int y = 0; y < h; y++) {
+    minmax_line(tmp + y * w, 1, img + y * w, 1, w, k, max, line, line + m, line + 2 * m);
+  }
+  for (int x = 0; x < w; x++) {
+    minmax_line(img + x, w, tmp + x, w, h, k, max, line, line + m, line + 2 * m);
+  }
+  return 0;
+}
+
+/**
+ * Apply a sequence of erosions and dilations
+ * @param ops Sequence of 'e' (erosion) and 'd' (dilation), each applied iteration times
+ */
+static int morph(struct image_t *img_input, struct image_t *img_output, int SE_size, int iteration, const char *ops)
+{
+  if ((img_input->type != IMAGE_GRAYSCALE && img_input->type != IMAGE_INT16) ||
+      (img_output->type != IMAGE_GRAYSCALE && img_output->type != IMAGE_INT16)) {
+    printf("This function only works with images of type IMAGE_GRAYSCALE and IMAGE_INT16. Leaving function.\n");
+    return -1;
+  }
+  if (img_input->w != img_output->w || img_input->h != img_output->h || SE_size < 1) {
+    return -1;
+  }
+
+  const int n = img_input->w * img_input->h;
+  int16_t *img = work_buf_get(&morph_buf, 2 * n * sizeof(int16_t));
+  if (img == NULL) {
+    return -1;
+  }
+  int16_t *tmp = img + n;
+
+  if (img_input->type == IMAGE_INT16) {
+    memcpy(img, img_input->buf, n * sizeof(int16_t));
+  } else {
+    for (int i = 0; i < n; i++) {
+      img[i] = ((uint8_t *)img_input->buf)[i];
+    }
+  }
+
+  for (; *ops != '\0'; ops++) {
+    for (int it = 0; it < iteration; it++) {
+      if (morph_int16(img, tmp, img_input->w, img_input->h, SE_size, *ops == 'd') != 0) {
+        return -1;
+      }
+    }
+  }
+
+  if (img_output->type == IMAGE_INT16) {
+    memcpy(img_output->buf, img, n * sizeof(int16_t));
+  } else {
+    for (int i = 0; i < n; i++) {
+      ((uint8_t *)img_output->buf)[i] = img[i] < 0 ? 0 : (img[i] > 255 ? 255 : img[i]);
+    }
+  }
+  return 0;
+}
+
+int opening_native(struct image_t *img_input, struct image_t *img_output, const int SE_size, const int iteration)
+{
+  return morph(img_input, img_output, SE_size, iteration, "ed");
+}
+
+int closing_native(struct image_t *img_input, struct image_t *img_output, const int SE_size, const int iteration)
+{
+  return morph(img_input, img_output, SE_size, iteration, "de");
+}
+
+int dilation_native(struct image_t *img_input, struct image_t *img_output, const int SE_size, const int iteration)
+{
+  return morph(img_input, img_output, SE_size, iteration, "d");
+}
+
+int erosion_native(struct image_t *img_input, struct image_t *img_output, const int SE_size, const int iteration)
+{
+  return morph(img_input, img_output, SE_size, iteration, "e");
+}
+
+
+// Edges
+
+/** Reflect an index at the borders (OpenCV BORDER_DEFAULT) */
+static inline int reflect101(int i, int n)
+{
+  if (i < 0) { return -i; }
+  if (i >= n) { return 2 * n - 2 - i; }
+  return i;
+}
+
+/**
+ * Sobel edge detection, with the same kernels as OpenCV (kernel_size 1, 3, 5 or 7)
+ * @param[in] img_input Image of type IMAGE_GRAYSCALE or IMAGE_INT16
+ * @param[out] img_output Image of type IMAGE_GRAYSCALE, 127 where the gradient magnitude is above thr, 0 elsewhere
+ * @return 1 on success, -1 on error
+ */
+int sobel_native(struct image_t *img_input, struct image_t *img_output, const int kernel_size, const int thr)
+{
+  if ((img_input->type != IMAGE_GRAYSCALE && img_input->type != IMAGE_INT16) || img_output->type != IMAGE_GRAYSCALE ||
+      img_input->w != img_output->w || img_input->h != img_output->h ||
+      kernel_size < 1 || kernel_size > 7 || kernel_size % 2 == 0) {
+    printf("This function only works with images of type IMAGE_GRAYSCALE and IMAGE_INT16. Leaving function.\n");
+    return -1;
+  }
+
+  // smoothing (binomial) and derivative kernels
+  int32_t smooth[7] = {1}, deriv[7] = {-1, 0, 1};
+  int ks = 3, kd = 3;
+  if (kernel_size == 1) {
+    ks = 1;
+  } else {
+    int32_t b[7] = {1};
+    ks = kd = kernel_size;
+    for (int n = 1; n < kernel_size - 1; n++) {
+      for (int i = n; i > 0; i--) {
+        b[i] += b[i - 1];
+      }
+    }
+    // derivative: binomial of order kernel_size - 2 convolved with [-1, 1]
+    for (int i = 0; i < kernel_size; i++) {
+      deriv[i] = (i > 0 ? b[i - 1] : 0) - (i < kernel_size - 1 ? b[i] : 0);
+    }
+    // smoothing: binomial of order kernel_size - 1
+    for (int i = kernel_size - 1; i > 0; i--) {
+      b[i] += b[i - 1];
+    }
+    memcpy(smooth, b, sizeof(b));
+  }
+
+  const int w = img_input->w;
+  const int h = img_input->h;
+  int32_t *dx = work_buf_get(&edge_buf, 2 * w * h * sizeof(int32_t));
+  if (dx == NULL) {
+    return -1;
+  }
+  int32_t *sx = dx + w * h;
+
+  // horizontal pass
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      int32_t vd = 0, vs = 0;
+      for (int i = 0; i < kd; i++) {
+        int xi = reflect101(x + i - kd / 2, w);
+        int32_t v = img_input->type == IMAGE_INT16 ? ((int16_t *)img_input->buf)[y * w + xi] :
+                    ((uint8_t *)img_input->buf)[y * w + xi];
+        vd += deriv[i] * v;
+      }
+      for (int i = 0; i < ks; i++) {
+        int xi = reflect101(x + i - ks / 2, w);
+        int32_t v = img_input->type == IMAGE_INT16 ? ((int16_t *)img_input->buf)[y * w + xi] :
+                    ((uint8_t *)img_input->buf)[y * w + xi];
+        vs += smooth[i] * v;
+      }
+      dx[y * w + x] = vd;
+      sx[y * w + x] = vs;
+    }
+  }
+
+  // vertical pass and magnitude
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      float gx = 0.f, gy = 0.f;
+      for (int i = 0; i < ks; i++) {
+        gx += (float)smooth[i] * dx[reflect101(y + i - ks / 2, h) * w + x];
+      }
+      for (int i = 0; i < kd; i++) {
+        gy += (float)deriv[i] * sx[reflect101(y + i - kd / 2, h) * w + x];
+      }
+      ((uint8_t *)img_output->buf)[y * w + x] = (sqrtf(gx * gx + gy * gy) > thr) ? 127 : 0;
+    }
+  }
+
+  return 1;
+}
+
+
+// Saving images without OpenCV: binary PGM files, heat maps are saved in gray scale
+#if !WEDGEBUG_OPENCV
+
+static int save_pgm(const char *filename, uint16_t w, uint16_t h, const uint8_t *buf, uint8_t step, bool wide)
+{
+  FILE *fp = fopen(filename, "wb");
+  if (fp == NULL) {
+    return -1;
+  }
+  fprintf(fp, "P5\n%d %d\n%d\n", w, h, wide ? 65535 : 255);
+  for (uint32_t i = 0; i < (uint32_t)w * h; i++) {
+    if (wide) {
+      // 16bit values are big endian
+      uint16_t v = ((uint16_t *)buf)[i];
+      fputc(v >> 8, fp);
+      fputc(v & 0xFF, fp);
+    } else {
+      fputc(buf[i * step], fp);
+    }
+  }
+  fclose(fp);
+  return 0;
+}
+
+int save_image_gray(struct image_t *img, char *myString)
+{
+  if (img->type == IMAGE_INT16) {
+    return save_pgm(myString, img->w, img->h, img->buf, 1, true);
+  } else if (img->type == IMAGE_GRAYSCALE) {
+    return save_pgm(myString, img->w, img->h, img->buf, 1, false);
+  }
+  printf("This function only works with images of type IMAGE_GRAYSCALE and IMAGE_INT16. Leaving function.\n");
+  return -1;
+}
+
+int save_image_color(struct image_t *img, char *myString)
+{
+  // gray values of the UYVY image
+  return save_pgm(myString, img->w, img->h, (uint8_t *)img->buf + 1, 2, false);
+}
+
+int save_image_HM(struct image_t *img, char *myString, int const heatmap __attribute__((unused)))
+{
+  return save_image_gray(img, myString);
+}
+
+#endif
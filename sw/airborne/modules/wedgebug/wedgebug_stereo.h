@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) Ralph Rudi schmidt <ralph.r.schmidt@outlook.com>
+
+ *
+ * This file is part of paparazzi
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+
+ */
+/** @file "modules/wedgebug/wedgebug_stereo.h"
+ * Native stereo block matching, morphology and edge detection for the wedgebug.
+ * These replace the OpenCV functions of wedgebug_opencv.h, with the same conventions
+ * (disparity in pixels * 16 for 16bit images, rectangular structuring elements, binary edges of value 127).
+ */
+
+#ifndef WEDGEBUG_STEREO_H
+#define WEDGEBUG_STEREO_H
+
+#include <stdbool.h>
+#include "modules/computer_vision/lib/vision/image.h"
+
+/** Copy the gray values of an UYVY image in the left (offset 0) or right (offset 1) pixels
+ * of an interlaced image, as made by UYVYs_interlacing_V */
+extern void YY_interlace_channel(struct image_t *YY, struct image_t *uyvy, uint8_t offset);
+/** Split an interlaced image in the left and right gray images */
+extern void YY_deinterlace(struct image_t *left, struct image_t *right, struct image_t *YY);
+
+extern int SBM_native(struct image_t *img_disp, struct image_t *img_YY, const int ndisparities,
+                      const int SADWindowSize, const bool cropped);
+extern int opening_native(struct image_t *img_input, struct image_t *img_output, const int SE_size,
+                          const int iteration);
+extern int closing_native(struct image_t *img_input, struct image_t *img_output, const int SE_size,
+                          const int iteration);
+extern int dilation_native(struct image_t *img_input, struct image_t *img_output, const int SE_size,
+                           const int iteration);
+extern int erosion_native(struct image_t *img_input, struct image_t *img_output, const int SE_size,
+                          const int iteration);
+extern int sobel_native(struct image_t *img_input, struct image_t *img_output, const int kernel_size, const int thr);
+
+#endif  // WEDGEBUG_STEREO_H
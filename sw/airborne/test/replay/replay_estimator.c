@@ -0,0 +1,454 @@
+/*
+ * Copyright (C) 2023 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test/replay/replay_estimator.c
+ *
+ * Offline replay of a flight log through an estimator.
+ *
+ * The scaled IMU, GPS and barometer messages of the log are turned back
+ * into the ABI sensor stream, as fast as possible, and fed to the estimator
+ * selected at build time (see Makefile). The IMU samples go through the
+ * imu module with an identity calibration so that the integrated and
+ * delta messages are produced as in flight.
+ *
+ * The simulated system time follows the log time and the estimator periodic
+ * function, if any, is called at PERIODIC_FREQUENCY.
+ *
+ * At the end, the CPU time spent in the estimator for each message type
+ * and the attitude error against the ATTITUDE messages of the log
+ * (the onboard estimate) are reported. The GPS position is used as
+ * position reference.
+ *
+ * Usage: replay_estimator [-a ac_id] [-s start] [-e end] [-o out.csv] [-t max_rms_deg] log
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+
+#define ABI_C
+#include "modules/core/abi.h"
+
+#include "replay_log.h"
+#include "std.h"
+#include "state.h"
+#include "mcu_periph/sys_time.h"
+#include "modules/imu/imu.h"
+#include "modules/gps/gps.h"
+#include "modules/energy/electrical.h"
+#include "math/pprz_geodetic_int.h"
+
+#ifdef REPLAY_INCLUDE_H
+#include REPLAY_INCLUDE_H
+#endif
+
+#ifndef REPLAY_INIT
+#error "REPLAY_INIT not set, select an estimator in the Makefile"
+#endif
+
+/** sender id of the replayed barometer */
+#ifndef REPLAY_BARO_ID
+#define REPLAY_BARO_ID BARO_BOARD_SENDER_ID
+#endif
+
+/** sender id of the replayed GPS */
+#ifndef REPLAY_GPS_ID
+#define REPLAY_GPS_ID GPS_MULTI_ID
+#endif
+
+/** attitude errors are only accumulated this long after the estimator is valid (s) */
+#ifndef REPLAY_SETTLE_TIME
+#define REPLAY_SETTLE_TIME 10.
+#endif
+
+/** needed by the imu magnetometer current compensation, not logged */
+struct Electrical electrical;
+
+struct ReplayStat {
+  uint32_t nb;
+  double sum;   ///< total CPU time (s)
+  double max;   ///< max CPU time (s)
+};
+
+struct ReplayErr {
+  uint32_t nb;
+  double sum2[3];
+  double max[3];
+};
+
+static struct ReplayStat stats[REPLAY_MSG_NB];
+static struct ReplayStat periodic_stat;
+static struct ReplayErr att_err;
+static struct ReplayErr pos_err;  ///< north, east, down
+static double valid_time = -1.;
+static FILE *out_file;
+
+static double cpu_time(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void stat_add(struct ReplayStat *s, double t)
+{
+  s->nb++;
+  s->sum += t;
+  if (t > s->max) { s->max = t; }
+}
+
+static void err_add(struct ReplayErr *e, const double err[3])
+{
+  e->nb++;
+  for (int i = 0; i < 3; i++) {
+    e->sum2[i] += err[i] * err[i];
+    if (fabs(err[i]) > e->max[i]) { e->max[i] = fabs(err[i]); }
+  }
+}
+
+static double err_rms(const struct ReplayErr *e, int i)
+{
+  return e->nb > 0 ? sqrt(e->sum2[i] / e->nb) : 0.;
+}
+
+/** Sensors with the replay calibration, whatever the calibration of the airframe */
+static bool gyro_replay_calib[IMU_MAX_SENSORS];
+static bool accel_replay_calib[IMU_MAX_SENSORS];
+static bool mag_replay_calib[IMU_MAX_SENSORS];
+
+/** Identity calibration, logged values are already scaled in body frame */
+static void replay_calib(struct imu_calib_t *calib, struct Int32RMat *body_to_sensor)
+{
+  calib->neutral = true;
+  calib->scale = true;
+  calib->rotation = true;
+  calib->filter = false;
+  int32_rmat_identity(body_to_sensor);
+}
+
+static void replay_gyro(struct ReplayMsg *msg, uint32_t stamp)
+{
+  struct imu_gyro_t *gyro = imu_get_gyro(msg->sensor_id, true);
+  if (gyro == NULL) { return; }
+  if (!gyro_replay_calib[gyro - imu.gyros]) {
+    gyro_replay_calib[gyro - imu.gyros] = true;
+    replay_calib(&gyro->calibrated, &gyro->body_to_sensor);
+    INT_RATES_ZERO(gyro->neutral);
+    RATES_ASSIGN(gyro->scale[0], 1, 1, 1);
+    RATES_ASSIGN(gyro->scale[1], 1, 1, 1);
+  }
+  // sample rate from the log, used for the integrated messages
+  float rate = NAN;
+  if (gyro->last_stamp > 0 && stamp > gyro->last_stamp) {
+    rate = 1e6f / (stamp - gyro->last_stamp);
+  }
+  AbiSendMsgIMU_GYRO_RAW(msg->sensor_id, stamp, &msg->data.gyro, 1, rate, NAN);
+}
+
+static void replay_accel(struct ReplayMsg *msg, uint32_t stamp)
+{
+  struct imu_accel_t *accel = imu_get_accel(msg->sensor_id, true);
+  if (accel == NULL) { return; }
+  if (!accel_replay_calib[accel - imu.accels]) {
+    accel_replay_calib[accel - imu.accels] = true;
+    replay_calib(&accel->calibrated, &accel->body_to_sensor);
+    INT_VECT3_ZERO(accel->neutral);
+    VECT3_ASSIGN(accel->scale[0], 1, 1, 1);
+    VECT3_ASSIGN(accel->scale[1], 1, 1, 1);
+  }
+  float rate = NAN;
+  if (accel->last_stamp > 0 && stamp > accel->last_stamp) {
+    rate = 1e6f / (stamp - accel->last_stamp);
+  }
+  AbiSendMsgIMU_ACCEL_RAW(msg->sensor_id, stamp, &msg->data.accel, 1, rate, NAN);
+}
+
+static void replay_mag(struct ReplayMsg *msg, uint32_t stamp)
+{
+  struct imu_mag_t *mag = imu_get_mag(msg->sensor_id, true);
+  if (mag == NULL) { return; }
+  if (!mag_replay_calib[mag - imu.mags]) {
+    mag_replay_calib[mag - imu.mags] = true;
+    replay_calib(&mag->calibrated, &mag->body_to_sensor);
+    mag->calibrated.current = false;
+    INT_VECT3_ZERO(mag->neutral);
+    VECT3_ASSIGN(mag->scale[0], 1, 1, 1);
+    VECT3_ASSIGN(mag->scale[1], 1, 1, 1);
+  }
+  AbiSendMsgIMU_MAG_RAW(msg->sensor_id, stamp, &msg->data.mag);
+}
+
+/** Rebuild the full GPS state, velocities in NED from the first position */
+static void replay_gps(struct ReplayMsg *msg, uint32_t stamp)
+{
+  static struct LtpDef_i ltp_def;
+  static bool ltp_initialized = false;
+  struct ReplayGps *in = &msg->data.gps;
+
+  gps.comp_id = in->comp_id;
+  gps.ecef_pos = in->ecef_pos;
+  gps.lla_pos = in->lla_pos;
+  gps.hmsl = in->hmsl;
+  gps.ecef_vel = in->ecef_vel;
+  gps.pacc = in->pacc;
+  gps.hacc = in->pacc;
+  gps.vacc = in->pacc;
+  gps.sacc = in->sacc;
+  gps.cacc = 0;
+  gps.tow = in->tow;
+  gps.pdop = in->pdop;
+  gps.num_sv = in->num_sv;
+  gps.fix = in->fix;
+  gps.valid_fields = 0;
+  SetBit(gps.valid_fields, GPS_VALID_POS_ECEF_BIT);
+  SetBit(gps.valid_fields, GPS_VALID_POS_LLA_BIT);
+  SetBit(gps.valid_fields, GPS_VALID_HMSL_BIT);
+  SetBit(gps.valid_fields, GPS_VALID_VEL_ECEF_BIT);
+
+  if (gps.fix >= GPS_FIX_3D) {
+    if (!ltp_initialized) {
+      ltp_def_from_ecef_i(&ltp_def, &gps.ecef_pos);
+      ltp_initialized = true;
+    }
+    ned_of_ecef_vect_i(&gps.ned_vel, &ltp_def, &gps.ecef_vel);
+    gps.gspeed = sqrtf((float)gps.ned_vel.x * gps.ned_vel.x + (float)gps.ned_vel.y * gps.ned_vel.y);
+    gps.speed_3d = sqrtf((float)gps.gspeed * gps.gspeed + (float)gps.ned_vel.z * gps.ned_vel.z);
+    float course = atan2f(gps.ned_vel.y, gps.ned_vel.x);
+    if (course < 0.f) { course += 2.f * M_PI; }
+    gps.course = course * 1e7f;
+    SetBit(gps.valid_fields, GPS_VALID_VEL_NED_BIT);
+    SetBit(gps.valid_fields, GPS_VALID_COURSE_BIT);
+    gps.last_3dfix_ticks = sys_time.nb_sec_rem;
+    gps.last_3dfix_time = sys_time.nb_sec;
+  }
+  gps.last_msg_ticks = sys_time.nb_sec_rem;
+  gps.last_msg_time = sys_time.nb_sec;
+
+  AbiSendMsgGPS(REPLAY_GPS_ID, stamp, &gps);
+}
+
+/** Position error of the estimator against the GPS, in local NED (m) */
+static void compare_position(struct ReplayMsg *msg)
+{
+  struct ReplayGps *ref = &msg->data.gps;
+  if (ref->fix < GPS_FIX_3D || !stateIsGlobalCoordinateValid() || valid_time < 0.
+      || msg->time < valid_time + REPLAY_SETTLE_TIME) {
+    return;
+  }
+  struct LtpDef_i ltp_ref;
+  ltp_def_from_ecef_i(&ltp_ref, &ref->ecef_pos);
+  struct EcefCoor_i ecef = *stateGetPositionEcef_i();
+  struct NedCoor_i ned;
+  ned_of_ecef_point_i(&ned, &ltp_ref, &ecef);
+  double err[3] = { ned.x / 100., ned.y / 100., ned.z / 100. };
+  err_add(&pos_err, err);
+}
+
+/** Attitude error of the estimator against the logged attitude (rad) */
+static void compare_attitude(struct ReplayMsg *msg)
+{
+  if (!stateIsAttitudeValid()) {
+    return;
+  }
+  if (valid_time < 0.) {
+    valid_time = msg->time;
+  }
+  struct FloatEulers *est = stateGetNedToBodyEulers_f();
+  struct FloatEulers *ref = &msg->data.att;
+  if (out_file) {
+    fprintf(out_file, "%.4f,%f,%f,%f,%f,%f,%f\n", msg->time,
+            est->phi, est->theta, est->psi, ref->phi, ref->theta, ref->psi);
+  }
+  if (msg->time < valid_time + REPLAY_SETTLE_TIME) {
+    return;
+  }
+  float dpsi = est->psi - ref->psi;
+  NormRadAngle(dpsi);
+  double err[3] = { est->phi - ref->phi, est->theta - ref->theta, dpsi };
+  err_add(&att_err, err);
+}
+
+/** Run the system time up to the message time, with the estimator periodic tasks */
+static void replay_time(double t)
+{
+  static uint32_t periodic_div = 0;
+  if (periodic_div == 0) {
+    periodic_div = Max(1, SYS_TIME_FREQUENCY / PERIODIC_FREQUENCY);
+  }
+  while (sys_time.nb_sec + (double)sys_time.nb_sec_rem / sys_time.cpu_ticks_per_sec < t) {
+    sys_tick_handler();
+#ifdef REPLAY_PERIODIC
+    if (sys_time.nb_tick % periodic_div == 0) {
+      double t0 = cpu_time();
+      REPLAY_PERIODIC;
+      stat_add(&periodic_stat, cpu_time() - t0);
+    }
+#endif
+  }
+}
+
+static void print_report(struct ReplayLog *log, double log_duration, double cpu)
+{
+  printf("log: %u messages, %u errors, %.1f s replayed in %.2f s of CPU time (x%.0f)\n",
+         log->nb_lines, log->nb_errors, log_duration, cpu, cpu > 0. ? log_duration / cpu : 0.);
+  printf("\n%-18s %10s %12s %12s\n", "message", "count", "cpu mean(us)", "cpu max(us)");
+  for (int i = 0; i < REPLAY_MSG_NB; i++) {
+    if (i == REPLAY_MSG_ATTITUDE || stats[i].nb == 0) { continue; }
+    printf("%-18s %10u %12.2f %12.2f\n", replay_msg_name(i), stats[i].nb,
+           1e6 * stats[i].sum / stats[i].nb, 1e6 * stats[i].max);
+  }
+  if (periodic_stat.nb > 0) {
+    printf("%-18s %10u %12.2f %12.2f\n", "periodic", periodic_stat.nb,
+           1e6 * periodic_stat.sum / periodic_stat.nb, 1e6 * periodic_stat.max);
+  }
+  if (att_err.nb > 0) {
+    printf("\nattitude error (deg) over %u samples:\n", att_err.nb);
+    printf("  rms   phi %6.2f theta %6.2f psi %6.2f\n", DegOfRad(err_rms(&att_err, 0)),
+           DegOfRad(err_rms(&att_err, 1)), DegOfRad(err_rms(&att_err, 2)));
+    printf("  max   phi %6.2f theta %6.2f psi %6.2f\n", DegOfRad(att_err.max[0]),
+           DegOfRad(att_err.max[1]), DegOfRad(att_err.max[2]));
+  } else {
+    printf("\nno attitude reference or estimator never valid\n");
+  }
+  if (pos_err.nb > 0) {
+    printf("position error to GPS (m) over %u samples:\n", pos_err.nb);
+    printf("  rms   north %6.2f east %6.2f down %6.2f\n", err_rms(&pos_err, 0),
+           err_rms(&pos_err, 1), err_rms(&pos_err, 2));
+    printf("  max   north %6.2f east %6.2f down %6.2f\n", pos_err.max[0], pos_err.max[1], pos_err.max[2]);
+  }
+}
+
+static void usage(const char *name)
+{
+  fprintf(stderr, "usage: %s [-a ac_id] [-s start] [-e end] [-o out.csv] [-t max_rms_deg] log\n", name);
+  fprintf(stderr, "  log: server/sd2log .data (or .log) file, or sdlog_chibios binary file\n");
+  fprintf(stderr, "  -a: aircraft id, default first one in the log\n");
+  fprintf(stderr, "  -s, -e: replay window in log time (s)\n");
+  fprintf(stderr, "  -o: write estimated and reference attitude to a csv file\n");
+  fprintf(stderr, "  -t: exit with an error if an attitude rms error is larger (deg)\n");
+}
+
+int main(int argc, char **argv)
+{
+  int ac_id = -1;
+  double start = 0., end = INFINITY;
+  float max_rms = -1.f;
+  int opt;
+  while ((opt = getopt(argc, argv, "a:s:e:o:t:h")) != -1) {
+    switch (opt) {
+      case 'a': ac_id = atoi(optarg); break;
+      case 's': start = atof(optarg); break;
+      case 'e': end = atof(optarg); break;
+      case 't': max_rms = atof(optarg); break;
+      case 'o':
+        out_file = fopen(optarg, "w");
+        if (out_file == NULL) {
+          perror(optarg);
+          return 1;
+        }
+        fprintf(out_file, "time,phi,theta,psi,phi_ref,theta_ref,psi_ref\n");
+        break;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+  if (optind >= argc) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  struct ReplayLog log;
+  if (replay_log_open(&log, argv[optind]) != 0) {
+    perror(argv[optind]);
+    return 1;
+  }
+
+  sys_time_init();
+  stateInit();
+  imu_init();
+  REPLAY_INIT;
+
+  struct ReplayMsg msg;
+  double first_time = -1., last_time = 0.;
+  double cpu0 = cpu_time();
+  while (replay_log_next(&log, &msg)) {
+    if (ac_id < 0) {
+      ac_id = msg.ac_id;
+    }
+    if (msg.ac_id != ac_id || msg.time < start) {
+      continue;
+    }
+    if (msg.time > end) {
+      break;
+    }
+    if (first_time < 0.) {
+      first_time = msg.time;
+    }
+    last_time = msg.time;
+
+    // log time relative to the start of the replay
+    replay_time(msg.time - first_time);
+    uint32_t stamp = get_sys_time_usec();
+
+    double t0 = cpu_time();
+    switch (msg.type) {
+      case REPLAY_MSG_GYRO: replay_gyro(&msg, stamp); break;
+      case REPLAY_MSG_ACCEL: replay_accel(&msg, stamp); break;
+      case REPLAY_MSG_MAG: replay_mag(&msg, stamp); break;
+      case REPLAY_MSG_GPS: replay_gps(&msg, stamp); break;
+      case REPLAY_MSG_BARO:
+        AbiSendMsgBARO_ABS(REPLAY_BARO_ID, stamp, msg.data.pressure);
+        break;
+      case REPLAY_MSG_ATTITUDE:
+        compare_attitude(&msg);
+        break;
+      default:
+        break;
+    }
+    stat_add(&stats[msg.type], cpu_time() - t0);
+
+    // not timed, only the estimator is
+    if (msg.type == REPLAY_MSG_GPS) {
+      compare_position(&msg);
+    }
+  }
+  double cpu = cpu_time() - cpu0;
+
+  print_report(&log, first_time < 0. ? 0. : last_time - first_time, cpu);
+  replay_log_close(&log);
+  if (out_file) {
+    fclose(out_file);
+  }
+
+  if (max_rms >= 0.f) {
+    for (int i = 0; i < 3; i++) {
+      if (att_err.nb == 0 || DegOfRad(err_rms(&att_err, i)) > max_rms) {
+        fprintf(stderr, "attitude rms error above %.2f deg\n", max_rms);
+        return 2;
+      }
+    }
+  }
+  return 0;
+}
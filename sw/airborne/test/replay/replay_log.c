@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2023 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test/replay/replay_log.c
+ *
+ * Reader for the sensor messages of recorded flight logs.
+ */
+
+#include "replay_log.h"
+#include <stdlib.h>
+#include <string.h>
+#include "pprzlink/messages.h"
+
+#ifndef PPRZLINK_DEFAULT_VER
+#define PPRZLINK_DEFAULT_VER 2
+#endif
+
+/** size of the pprzlink header in the payload (sender, [dest, class/component,] msg_id) */
+#if PPRZLINK_DEFAULT_VER == 2
+#define REPLAY_PPRZ_HEADER 4
+#else
+#define REPLAY_PPRZ_HEADER 2
+#endif
+
+#define PPRZLOG_STX 0x99
+#define PPRZLOG_SOURCE_TELEMETRY 0
+
+/** Fields in message order, as sent by the airborne code */
+static const struct {
+  const char *name;
+  uint8_t id;
+  const char *fields;   ///< b: uint8, h: uint16, i: int32, I: uint32, f: float
+} replay_msgs[REPLAY_MSG_NB] = {
+  [REPLAY_MSG_GYRO]     = { "IMU_GYRO_SCALED",  PPRZ_MSG_ID_IMU_GYRO_SCALED,  "biii" },
+  [REPLAY_MSG_ACCEL]    = { "IMU_ACCEL_SCALED", PPRZ_MSG_ID_IMU_ACCEL_SCALED, "biii" },
+  [REPLAY_MSG_MAG]      = { "IMU_MAG_SCALED",   PPRZ_MSG_ID_IMU_MAG_SCALED,   "biii" },
+  [REPLAY_MSG_GPS]      = { "GPS_INT",          PPRZ_MSG_ID_GPS_INT,          "iiiiiiiiiiIIIhbbb" },
+  [REPLAY_MSG_BARO]     = { "BARO_RAW",         PPRZ_MSG_ID_BARO_RAW,         "ff" },
+  [REPLAY_MSG_ATTITUDE] = { "ATTITUDE",         PPRZ_MSG_ID_ATTITUDE,         "fff" },
+};
+
+#define REPLAY_MAX_FIELDS 17
+
+/** Field values, integers and floats kept side by side */
+struct ReplayFields {
+  int64_t i[REPLAY_MAX_FIELDS];
+  float f[REPLAY_MAX_FIELDS];
+};
+
+const char *replay_msg_name(enum ReplayMsgType type)
+{
+  return type < REPLAY_MSG_NB ? replay_msgs[type].name : "?";
+}
+
+static void fill_msg(struct ReplayMsg *msg, const struct ReplayFields *v)
+{
+  switch (msg->type) {
+    case REPLAY_MSG_GYRO:
+      msg->sensor_id = v->i[0];
+      RATES_ASSIGN(msg->data.gyro, v->i[1], v->i[2], v->i[3]);
+      break;
+    case REPLAY_MSG_ACCEL:
+      msg->sensor_id = v->i[0];
+      VECT3_ASSIGN(msg->data.accel, v->i[1], v->i[2], v->i[3]);
+      break;
+    case REPLAY_MSG_MAG:
+      msg->sensor_id = v->i[0];
+      VECT3_ASSIGN(msg->data.mag, v->i[1], v->i[2], v->i[3]);
+      break;
+    case REPLAY_MSG_GPS: {
+      struct ReplayGps *gps = &msg->data.gps;
+      VECT3_ASSIGN(gps->ecef_pos, v->i[0], v->i[1], v->i[2]);
+      LLA_ASSIGN(gps->lla_pos, v->i[3], v->i[4], v->i[5]);
+      gps->hmsl = v->i[6];
+      VECT3_ASSIGN(gps->ecef_vel, v->i[7], v->i[8], v->i[9]);
+      gps->pacc = v->i[10];
+      gps->sacc = v->i[11];
+      gps->tow = v->i[12];
+      gps->pdop = v->i[13];
+      gps->num_sv = v->i[14];
+      gps->fix = v->i[15];
+      gps->comp_id = v->i[16];
+      break;
+    }
+    case REPLAY_MSG_BARO:
+      msg->data.pressure = v->f[0];
+      break;
+    case REPLAY_MSG_ATTITUDE:
+      // sent as phi, psi, theta
+      msg->data.att.phi = v->f[0];
+      msg->data.att.psi = v->f[1];
+      msg->data.att.theta = v->f[2];
+      break;
+    default:
+      break;
+  }
+}
+
+/** Parse a text line, return false if the message is not needed or malformed */
+static bool parse_line(struct ReplayLog *log, char *line, struct ReplayMsg *msg)
+{
+  char *tok = strtok(line, " \t\r\n");
+  if (tok == NULL) { return false; }
+  msg->time = strtod(tok, NULL);
+  if ((tok = strtok(NULL, " \t\r\n")) == NULL) { return false; }
+  msg->ac_id = atoi(tok);
+  if ((tok = strtok(NULL, " \t\r\n")) == NULL) { return false; }
+
+  int type;
+  for (type = 0; type < REPLAY_MSG_NB; type++) {
+    if (strcmp(tok, replay_msgs[type].name) == 0) { break; }
+  }
+  if (type == REPLAY_MSG_NB) { return false; }
+  msg->type = type;
+
+  struct ReplayFields v;
+  const char *fields = replay_msgs[type].fields;
+  for (int n = 0; fields[n] != '\0'; n++) {
+    if ((tok = strtok(NULL, " \t\r\n")) == NULL) {
+      log->nb_errors++;
+      return false;
+    }
+    if (fields[n] == 'f') {
+      v.f[n] = strtof(tok, NULL);
+    } else {
+      v.i[n] = strtoll(tok, NULL, 10);
+    }
+  }
+  fill_msg(msg, &v);
+  return true;
+}
+
+/** Decode a pprzlog payload, return false if the message is not needed */
+static bool parse_payload(uint8_t *buf, uint8_t len, struct ReplayMsg *msg)
+{
+  if (len < REPLAY_PPRZ_HEADER) { return false; }
+  const uint8_t msg_id = buf[REPLAY_PPRZ_HEADER - 1];
+  int type;
+  for (type = 0; type < REPLAY_MSG_NB; type++) {
+    if (msg_id == replay_msgs[type].id) { break; }
+  }
+  if (type == REPLAY_MSG_NB) { return false; }
+  msg->type = type;
+  msg->ac_id = buf[0];
+
+  // little endian, unaligned fields
+  struct ReplayFields v;
+  const char *fields = replay_msgs[type].fields;
+  uint8_t idx = REPLAY_PPRZ_HEADER;
+  for (int n = 0; fields[n] != '\0'; n++) {
+    uint8_t size = fields[n] == 'b' ? 1 : (fields[n] == 'h' ? 2 : 4);
+    if (idx + size > len) { return false; }
+    uint32_t u = 0;
+    for (int k = size - 1; k >= 0; k--) {
+      u = (u << 8) | buf[idx + k];
+    }
+    idx += size;
+    switch (fields[n]) {
+      case 'i': v.i[n] = (int32_t)u; break;
+      case 'f': memcpy(&v.f[n], &u, sizeof(float)); break;
+      default: v.i[n] = u; break;
+    }
+  }
+  fill_msg(msg, &v);
+  return true;
+}
+
+int replay_log_open(struct ReplayLog *log, const char *path)
+{
+  const char *ext = strrchr(path, '.');
+  log->binary = (ext == NULL || (strcmp(ext, ".data") != 0 && strcmp(ext, ".log") != 0));
+  log->nb_lines = 0;
+  log->nb_errors = 0;
+
+  if (ext != NULL && strcmp(ext, ".log") == 0) {
+    // the server .log only holds the configuration, messages are in the .data
+    char data_path[strlen(path) + 2];
+    strcpy(data_path, path);
+    strcpy(data_path + (ext - path), ".data");
+    log->file = fopen(data_path, "r");
+  } else {
+    log->file = fopen(path, log->binary ? "rb" : "r");
+  }
+  return log->file != NULL ? 0 : -1;
+}
+
+bool replay_log_next(struct ReplayLog *log, struct ReplayMsg *msg)
+{
+  if (!log->binary) {
+    char line[1024];
+    while (fgets(line, sizeof(line), log->file) != NULL) {
+      log->nb_lines++;
+      if (parse_line(log, line, msg)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  int c;
+  while ((c = fgetc(log->file)) != EOF) {
+    if (c != PPRZLOG_STX) {
+      continue;
+    }
+    uint8_t hdr[6];  // length, source, timestamp
+    uint8_t buf[256];
+    if (fread(hdr, 1, sizeof(hdr), log->file) != sizeof(hdr)) {
+      return false;
+    }
+    const uint8_t len = hdr[0];
+    if (fread(buf, 1, len + 1, log->file) != (size_t)len + 1) {
+      return false;
+    }
+    uint8_t ck = 0;
+    for (uint8_t i = 0; i < sizeof(hdr); i++) { ck += hdr[i]; }
+    for (uint16_t i = 0; i < len; i++) { ck += buf[i]; }
+    if (ck != buf[len]) {
+      // resync on the byte following the bad STX
+      log->nb_errors++;
+      fseek(log->file, -(long)(sizeof(hdr) + len + 1), SEEK_CUR);
+      continue;
+    }
+    log->nb_lines++;
+    if (hdr[1] != PPRZLOG_SOURCE_TELEMETRY) {
+      continue;
+    }
+    const uint32_t ts = hdr[2] | (hdr[3] << 8) | (hdr[4] << 16) | ((uint32_t)hdr[5] << 24);
+    msg->time = ts * 1e-4;
+    if (parse_payload(buf, len, msg)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void replay_log_close(struct ReplayLog *log)
+{
+  if (log->file != NULL) {
+    fclose(log->file);
+    log->file = NULL;
+  }
+}
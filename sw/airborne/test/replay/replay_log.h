@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2023 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test/replay/replay_log.h
+ *
+ * Reader for the sensor messages of recorded flight logs.
+ *
+ * Two formats are supported:
+ *  - text .data files written by the server or extracted with sd2log,
+ *    one message per line: "<time> <ac_id> <MSG_NAME> <fields...>"
+ *  - binary pprzlog files written by the sdlog_chibios logger:
+ *    STX(0x99) LENGTH SOURCE TIMESTAMP(4, 1e-4 s) PAYLOAD(LENGTH) CHECKSUM
+ *
+ * Only the messages needed to rebuild the sensor stream of the estimators
+ * and the reference attitude are decoded, all the others are skipped.
+ */
+
+#ifndef REPLAY_LOG_H
+#define REPLAY_LOG_H
+
+#include <stdio.h>
+#include "std.h"
+#include "math/pprz_algebra_int.h"
+#include "math/pprz_algebra_float.h"
+#include "math/pprz_geodetic_int.h"
+
+enum ReplayMsgType {
+  REPLAY_MSG_GYRO,        ///< IMU_GYRO_SCALED
+  REPLAY_MSG_ACCEL,       ///< IMU_ACCEL_SCALED
+  REPLAY_MSG_MAG,         ///< IMU_MAG_SCALED
+  REPLAY_MSG_GPS,         ///< GPS_INT
+  REPLAY_MSG_BARO,        ///< BARO_RAW
+  REPLAY_MSG_ATTITUDE,    ///< ATTITUDE, reference
+  REPLAY_MSG_NB
+};
+
+struct ReplayGps {
+  struct EcefCoor_i ecef_pos;   ///< cm
+  struct LlaCoor_i lla_pos;     ///< 1e7 deg, mm
+  int32_t hmsl;                 ///< mm
+  struct EcefCoor_i ecef_vel;   ///< cm/s
+  uint32_t pacc;                ///< cm
+  uint32_t sacc;                ///< cm/s
+  uint32_t tow;                 ///< ms
+  uint16_t pdop;
+  uint8_t num_sv;
+  uint8_t fix;
+  uint8_t comp_id;
+};
+
+struct ReplayMsg {
+  double time;                  ///< log time (s)
+  uint8_t ac_id;                ///< sender aircraft
+  enum ReplayMsgType type;
+  uint8_t sensor_id;            ///< ABI id of IMU sensors
+  union {
+    struct Int32Rates gyro;     ///< BFP rad/s, body frame
+    struct Int32Vect3 accel;    ///< BFP m/s2, body frame
+    struct Int32Vect3 mag;      ///< BFP, body frame
+    struct ReplayGps gps;
+    float pressure;             ///< absolute pressure (Pa)
+    struct FloatEulers att;     ///< rad
+  } data;
+};
+
+struct ReplayLog {
+  FILE *file;
+  bool binary;                  ///< pprzlog binary format
+  uint32_t nb_lines;            ///< number of lines or frames read
+  uint32_t nb_errors;           ///< number of malformed lines or bad checksums
+};
+
+/** Open a log
+ * The format is selected from the extension: .data is text, anything else
+ * is a pprzlog binary file. The .log file of a server log is replaced
+ * by the matching .data file.
+ * @return 0 on success, -1 if the file can't be opened
+ */
+extern int replay_log_open(struct ReplayLog *log, const char *path);
+
+/** Read the next decoded message
+ * @return false at end of file
+ */
+extern bool replay_log_next(struct ReplayLog *log, struct ReplayMsg *msg);
+
+extern void replay_log_close(struct ReplayLog *log);
+
+/** Message name, for reports */
+extern const char *replay_msg_name(enum ReplayMsgType type);
+
+#endif /* REPLAY_LOG_H */
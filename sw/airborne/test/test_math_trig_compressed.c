@@ -74,6 +74,17 @@
  PPRZ_TRIG_INT_COMPR_LOW       46 cycles
  -                             16 cycles
 
+
+ linear interpolation for sine table storage in flash
+
+ PPRZ_TRIG_INT_COMPR_INTERP
+   one Q15 entry every 32 angle steps, 406 bytes, no init
+   within 1 LSB of the full table
+
+ the float approximations of pprz_trig_float.h (PPRZ_TRIG_FLOAT_APPROX)
+ are timed against libm sinf/cosf and atan2f as well, cycles and max
+ errors are sent in a PAYLOAD_FLOAT message
+
 */
 
 #include BOARD_CONFIG
@@ -84,6 +95,9 @@
 #include "math/pprz_trig_int.h"
 #include "math/pprz_algebra_int.h"
 
+#define PPRZ_TRIG_FLOAT_APPROX TRUE
+#include "math/pprz_trig_float.h"
+
 /* cycle counter only exists for STM32 architecture */
 #if defined(STM32F1) || defined(STM32F4)
 #include <libopencm3/cm3/dwt.h>
@@ -97,6 +111,7 @@ static inline void main_periodic(void);
 static inline void main_event(void);
 
 int test_tables(void);
+static void test_float_trig(int16_t i);
 
 int32_t pprz_itrig_sin_4(int32_t angle);
 int32_t pprz_itrig_sin_8(int32_t angle);
@@ -113,6 +128,7 @@ int test_tables(void)
     if (pprz_trig_int[i] != pprz_trig_int_8(i)) return -1;
     if (pprz_trig_int[i] != pprz_trig_int_12(i)) return -1;
     if (pprz_trig_int[i] != pprz_trig_int_16(i)) return -1;
+    if (ABS(pprz_trig_int[i] - pprz_trig_int_interp(i)) > 1) return -1;
   }
   return 0;
 }
@@ -183,6 +199,62 @@ int32_t pprz_itrig_sin_16(int32_t angle)
   }
 }
 
+/** time the interpolated table and the float approximations against libm */
+static void test_float_trig(int16_t i)
+{
+  volatile float fs, fc;
+  volatile int32_t result;
+  uint32_t pre_time;
+  float data[7];
+  const float a = i * (M_PI_2 / TRIG_INT_SIZE) - 1.f;
+
+  pre_time = dwt_read_cycle_counter();
+  for (int k = 0; k < 10; k++) {
+    result = pprz_trig_int_interp(i);
+  }
+  data[0] = dwt_read_cycle_counter() - pre_time;
+
+  pre_time = dwt_read_cycle_counter();
+  for (int k = 0; k < 10; k++) {
+    fs = sinf(a);
+    fc = cosf(a);
+  }
+  data[1] = dwt_read_cycle_counter() - pre_time;
+
+  pre_time = dwt_read_cycle_counter();
+  for (int k = 0; k < 10; k++) {
+    pprz_sincosf(a, (float *)&fs, (float *)&fc);
+  }
+  data[2] = dwt_read_cycle_counter() - pre_time;
+
+  pre_time = dwt_read_cycle_counter();
+  for (int k = 0; k < 10; k++) {
+    fs = atan2f(a, 0.3f);
+  }
+  data[3] = dwt_read_cycle_counter() - pre_time;
+
+  pre_time = dwt_read_cycle_counter();
+  for (int k = 0; k < 10; k++) {
+    fs = pprz_atan2f(a, 0.3f);
+  }
+  data[4] = dwt_read_cycle_counter() - pre_time;
+
+  /* max errors over a sweep of angles */
+  float err_sc = 0.f, err_at = 0.f;
+  for (int k = -64; k <= 64; k++) {
+    const float b = k * (float)M_PI / 16.f;
+    float s, c;
+    pprz_sincosf(b, &s, &c);
+    err_sc = fmaxf(err_sc, fmaxf(fabsf(s - sinf(b)), fabsf(c - cosf(b))));
+    err_at = fmaxf(err_at, fabsf(pprz_atan2f(s, c) - atan2f(s, c)));
+  }
+  data[5] = err_sc;
+  data[6] = err_at;
+  (void)result;
+
+  DOWNLINK_SEND_PAYLOAD_FLOAT(DefaultChannel, DefaultDevice, 7, data);
+}
+
 int main(void)
 {
   main_init();
@@ -282,6 +354,8 @@ static inline void main_periodic(void)
     result = result;
 
     DOWNLINK_SEND_CSC_CAN_MSG(DefaultChannel, DefaultDevice, &result1, &result2, &result3, &result4);
+
+    test_float_trig(i);
   }
 }
 
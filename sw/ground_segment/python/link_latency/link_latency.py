@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2022 The Paparazzi Team
+#
+# This file is part of paparazzi.
+#
+# paparazzi is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# paparazzi is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with paparazzi.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+"""
+Datalink latency and loss statistics
+
+- round trip time and loss histograms per aircraft and per link, computed from
+  the CSV file written by the link agent with the '-latency_log <file>' option
+  (one PING in flight at a time, sent every '-ping_period' ms)
+- live downlink statistics per aircraft and per message name from the Ivy bus:
+  reception rate, inter-arrival time histogram and estimated losses (gaps larger
+  than twice the median period)
+"""
+
+from __future__ import print_function
+
+import sys
+import argparse
+import csv
+import time
+from os import path, getenv
+from collections import defaultdict
+
+PPRZ_HOME = getenv("PAPARAZZI_HOME", path.normpath(path.join(path.dirname(path.abspath(__file__)), '../../../..')))
+sys.path.append(PPRZ_HOME + "/var/lib/python")
+
+
+def percentile(values, p):
+    if not values:
+        return float('nan')
+    v = sorted(values)
+    k = min(len(v) - 1, max(0, int(round(p / 100. * (len(v) - 1)))))
+    return v[k]
+
+
+def histogram(values, bin_width, nb_bins):
+    """ Fixed width histogram, last bin is for overflow """
+    hist = [0] * (nb_bins + 1)
+    for v in values:
+        hist[min(nb_bins, int(v / bin_width))] += 1
+    return hist
+
+
+def print_histogram(values, bin_width, nb_bins, unit):
+    hist = histogram(values, bin_width, nb_bins)
+    top = max(hist) if hist else 0
+    for i, n in enumerate(hist):
+        if n == 0:
+            continue
+        if i < nb_bins:
+            label = "%7.1f-%-7.1f" % (i * bin_width, (i + 1) * bin_width)
+        else:
+            label = "   >%-11.1f" % (nb_bins * bin_width)
+        bar = '#' * int(40. * n / top) if top > 0 else ''
+        print("    %s%s %6d %s" % (label, unit, n, bar))
+
+
+def rtt_stats(log_file, bin_width, nb_bins):
+    """ Round trip time statistics from link latency log """
+    rtt = defaultdict(list)
+    lost = defaultdict(int)
+    with open(log_file) as f:
+        for row in csv.DictReader(f):
+            key = (int(row['ac_id']), int(row['link_id']))
+            value = float(row['rtt_ms'])
+            if value < 0.:
+                lost[key] += 1
+            else:
+                rtt[key].append(value)
+    for key in sorted(set(rtt.keys()) | set(lost.keys())):
+        samples = rtt[key]
+        total = len(samples) + lost[key]
+        print("AC %d link %d: %d PING, %d lost (%.1f%%)" % (key[0], key[1], total, lost[key], 100. * lost[key] / total))
+        if samples:
+            print("  RTT ms: min %.1f p50 %.1f p95 %.1f p99 %.1f max %.1f" % (
+                min(samples), percentile(samples, 50), percentile(samples, 95),
+                percentile(samples, 99), max(samples)))
+            print_histogram(samples, bin_width, nb_bins, "ms")
+
+
+class DownlinkStats(object):
+    """ Inter-arrival statistics of telemetry messages """
+    def __init__(self):
+        from pprzlink.ivy import IvyMessagesInterface
+        self.last = {}
+        self.periods = defaultdict(list)
+        self.start = time.time()
+        self._interface = IvyMessagesInterface("LinkLatency")
+        self._interface.subscribe(self.message_recv)
+
+    def message_recv(self, ac_id, msg):
+        now = time.time()
+        key = (int(ac_id), msg.name)
+        if key in self.last:
+            self.periods[key].append(1000. * (now - self.last[key]))
+        self.last[key] = now
+
+    def report(self, bin_width, nb_bins, verbose):
+        duration = time.time() - self.start
+        for key in sorted(self.periods.keys()):
+            p = self.periods[key]
+            med = percentile(p, 50)
+            lost = sum(int(round(dt / med)) - 1 for dt in p if med > 0. and dt > 2. * med)
+            print("AC %d %-24s rate %6.2f Hz, period ms p50 %7.1f p95 %7.1f max %7.1f, est. lost %d (%.1f%%)" % (
+                key[0], key[1], (len(p) + 1) / duration, med, percentile(p, 95), max(p),
+                lost, 100. * lost / (len(p) + lost)))
+            if verbose:
+                print_histogram(p, bin_width, nb_bins, "ms")
+
+    def shutdown(self):
+        self._interface.shutdown()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Datalink latency and loss statistics")
+    parser.add_argument('-l', '--log', help="latency log file written by link with -latency_log")
+    parser.add_argument('-d', '--duration', type=float, default=0.,
+                        help="listen to the Ivy bus for this duration (s) and report downlink statistics")
+    parser.add_argument('-b', '--bin', type=float, default=10., help="histogram bin width in ms (default 10)")
+    parser.add_argument('-n', '--nb_bins', type=int, default=50, help="number of histogram bins (default 50)")
+    parser.add_argument('-v', '--verbose', action='store_true', help="print histograms for each downlink message")
+    args = parser.parse_args()
+
+    if args.log is None and args.duration <= 0.:
+        parser.print_help()
+        sys.exit(1)
+
+    if args.log is not None:
+        rtt_stats(args.log, args.bin, args.nb_bins)
+
+    if args.duration > 0.:
+        stats = DownlinkStats()
+        try:
+            time.sleep(args.duration)
+        except KeyboardInterrupt:
+            pass
+        stats.shutdown()
+        stats.report(args.bin, args.nb_bins, args.verbose)
+
+
+if __name__ == '__main__':
+    main()
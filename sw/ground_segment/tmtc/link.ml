@@ -78,6 +78,20 @@ let ping_msg_period = ref 5000 (** ms  *)
 *)
 let dead_aircraft_time_ms = ref 5000
 
+(* Log round trip time of each PING/PONG exchange (and lost PINGs) to a CSV file *)
+let latency_log = ref None
+
+let open_latency_log = fun file ->
+  let c = open_out file in
+  fprintf c "time,ac_id,link_id,seq,rtt_ms\n%!";
+  latency_log := Some c
+
+(* rtt is negative for lost PING *)
+let log_latency = fun ac_id seq rtt ->
+  match !latency_log with
+  | None -> ()
+  | Some c -> fprintf c "%.3f,%d,%d,%d,%.2f\n%!" (Unix.gettimeofday ()) ac_id !link_id seq rtt
+
 let send_message_over_ivy = fun sender name vs ->
   let timestamp =
     match !add_timestamp with
@@ -107,6 +121,8 @@ type status = {
   mutable ms_since_last_msg : int;
   mutable last_ping : float; (* s *)
   mutable last_pong : float; (* s *)
+  mutable ping_seq : int; (* sequence number of last PING sent *)
+  mutable ping_pending : bool; (* last PING not answered yet *)
   udp_peername : Unix.sockaddr option
 }
 
@@ -118,6 +134,7 @@ let initial_status = {
   tx_msg = 0;
   ms_since_last_msg = !dead_aircraft_time_ms;
   last_ping = 0.; last_pong = 0.;
+  ping_seq = 0; ping_pending = false;
   udp_peername = None
 }
 
@@ -139,8 +156,14 @@ let update_status = fun ?udp_peername ac_id buf_size is_pong ->
   status.rx_msg <- status.rx_msg + 1;
   status.rx_err <- !PprzTransport.nb_err;
   status.ms_since_last_msg <- 0;
-  if is_pong then
-    status.last_pong <- Unix.gettimeofday ();;
+  if is_pong then begin
+    let now = Unix.gettimeofday () in
+    status.last_pong <- now;
+    if status.ping_pending then begin
+      status.ping_pending <- false;
+      log_latency ac_id status.ping_seq (1000. *. (now -. status.last_ping))
+    end
+  end;;
 
 let status_ping_diff = 500 (* ms *)
 
@@ -426,6 +449,10 @@ let message_uplink = fun device ->
 let send_ping_msg = fun device ->
   Hashtbl.iter
     (fun ac_id status ->
+      (* only one PING in flight, an unanswered one is counted as lost *)
+      if status.ping_pending then log_latency ac_id status.ping_seq (-1.);
+      status.ping_seq <- status.ping_seq + 1;
+      status.ping_pending <- true;
       let msg_id, _ = Dl_Pprz.message_of_name "PING" in
       let s = Dl_Pprz.payload_of_values msg_id my_id ac_id [] in
       send ac_id device s High;
@@ -469,6 +496,7 @@ let () =
       "-redlink", Arg.Set red_link, (sprintf "Sets whether the link is a redundant link. Set this flag and the id flag to use multiple links");
       "-id", Arg.Set_int link_id, (sprintf "<id> Sets the link id. If multiple links are used, each must have a unique id. Default is %i" !link_id);
       "-status_period", Arg.Set_int status_msg_period, (sprintf "<period> Sets the period (in ms) of the LINK_REPORT status message. Default is %i" !status_msg_period);
+      "-latency_log", Arg.String open_latency_log, "<file> Log PING/PONG round trip times and lost PINGs to a CSV file";
       "-ping_period", Arg.Set_int ping_msg_period, (sprintf "<period> Sets the period (in ms) of the PING message sent to aircrafs. Default is %i" !ping_msg_period);
       "-ac_timeout", Arg.Set_int dead_aircraft_time_ms, (sprintf "<time> Sets the time (in ms) after which an aircraft is regarded as dead/off if no messages are received. Default is %ims, set to zero to disable." !ping_msg_period)
     ] in
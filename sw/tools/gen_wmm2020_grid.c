@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2023 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file gen_wmm2020_grid.c
+ *
+ * Generate the grid of sw/airborne/math/pprz_geodetic_wmm2020_grid.h
+ * from the full WMM2020 model:
+ *
+ *   gen_wmm2020_grid > ../airborne/math/pprz_geodetic_wmm2020_grid.h
+ *
+ * Each node holds the field at sea level at the model epoch and its
+ * secular variation over one year.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "math/pprz_geodetic_wmm2020.h"
+
+static void field(double date, double lat, double lon, double b[3])
+{
+  double gh[MAXCOEFF];
+  int16_t nmax = extrapsh(date, GEO_EPOCH, NMAX_1, NMAX_2, gh);
+  mag_calc(1, lat, lon, 0., nmax, gh, &b[0], &b[1], &b[2], IEXT, EXT_COEFF1, EXT_COEFF2, EXT_COEFF3);
+}
+
+int main(void)
+{
+  printf("/*\n * Generated by sw/tools/gen_wmm2020_grid, do not edit\n */\n\n");
+  printf("/**\n * @file pprz_geodetic_wmm2020_grid.h\n");
+  printf(" * @brief WMM2020 field on a %d deg grid.\n *\n", WMM2020_GRID_RES);
+  printf(" * [lat][lon]: north, east, down field at %.0f (%g nT), then\n", GEO_EPOCH, WMM2020_GRID_FIELD_UNIT);
+  printf(" * their secular variation (%g nT/year), from lat -90 and lon -180.\n */\n\n", WMM2020_GRID_SV_UNIT);
+  printf("#ifndef WMM2020_GRID_H\n#define WMM2020_GRID_H\n\n");
+  printf("static const int16_t wmm2020_grid[WMM2020_GRID_NLAT][WMM2020_GRID_NLON][6] = {\n");
+  for (int i = 0; i < WMM2020_GRID_NLAT; i++) {
+    printf("  { // lat %d\n", -90 + i * WMM2020_GRID_RES);
+    for (int j = 0; j < WMM2020_GRID_NLON; j++) {
+      double lat = -90. + i * WMM2020_GRID_RES;
+      double lon = -180. + j * WMM2020_GRID_RES;
+      double b0[3], b1[3];
+      field(GEO_EPOCH, lat, lon, b0);
+      field(GEO_EPOCH + 1., lat, lon, b1);
+      printf("    { %ld, %ld, %ld, %ld, %ld, %ld },\n",
+             lround(b0[0] / WMM2020_GRID_FIELD_UNIT), lround(b0[1] / WMM2020_GRID_FIELD_UNIT),
+             lround(b0[2] / WMM2020_GRID_FIELD_UNIT), lround((b1[0] - b0[0]) / WMM2020_GRID_SV_UNIT),
+             lround((b1[1] - b0[1]) / WMM2020_GRID_SV_UNIT), lround((b1[2] - b0[2]) / WMM2020_GRID_SV_UNIT));
+    }
+    printf("  },\n");
+  }
+  printf("};\n\n#endif /* WMM2020_GRID_H */\n");
+  return 0;
+}
@@ -124,6 +124,21 @@ module Gen_onboard = struct
     Printf.fprintf h "  ABI_PREPEND(abi_queues[ABI_%s_ID],ev);\n" name;
     Printf.fprintf h "}\n"
 
+  (* Print trace recording of a message, pointed values are stored instead of pointers *)
+  let print_msg_trace = fun h msg ->
+    let name = String.capitalize_ascii msg.name in
+    Printf.fprintf h "#if ABI_TRACE\n";
+    Printf.fprintf h "  struct abi_trace_event *_te = abi_trace_new(ABI_%s_ID, sender_id);\n" name;
+    Printf.fprintf h "  if (_te != NULL) {\n";
+    List.iter (fun (n, t) ->
+      if String.contains t '*' then
+        Printf.fprintf h "    abi_trace_add(_te, %s, sizeof(*%s));\n" n n
+      else
+        Printf.fprintf h "    abi_trace_add(_te, &%s, sizeof(%s));\n" n n
+    ) msg.fields;
+    Printf.fprintf h "  }\n";
+    Printf.fprintf h "#endif\n"
+
   (* Print a send function *)
   let print_msg_send = fun h msg ->
     (* print arguments *)
@@ -138,6 +153,7 @@ module Gen_onboard = struct
     print_args h msg.fields;
     Printf.fprintf h " {\n";
     Printf.fprintf h "  abi_event* e;\n";
+    print_msg_trace h msg;
     Printf.fprintf h "  ABI_FOREACH(abi_queues[ABI_%s_ID],e) {\n" name;
     Printf.fprintf h "    if (e->id == ABI_BROADCAST || e->id == sender_id) {\n";
     Printf.fprintf h "      abi_callback%s cb = (abi_callback%s)(e->cb);\n" name name;
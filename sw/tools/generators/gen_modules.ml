@@ -310,23 +310,23 @@ let print_event_functions = fun out modules ->
   lprintf out "}\n"
 
 
+(** Datalink messages are dispatched through constant tables indexed by class id
+ * and message id. For each class and message, a handler function calling all
+ * registered callbacks is generated, wildcard callbacks are called after
+ * the message specific ones for all messages of their class.
+ *)
 let print_datalink_functions = fun out modules ->
   lprintf out "\n#include \"pprzlink/messages.h\"\n";
   lprintf out "\n#include \"pprzlink/dl_protocol.h\"\n";
   lprintf out "\n#include \"pprzlink/intermcu_msg.h\"\n";
   lprintf out "#include \"generated/airframe.h\"\n";
-  lprintf out "static inline void modules_parse_datalink(uint8_t msg_id __attribute__((unused)),
-                                          uint8_t class_id __attribute__((unused)),
-                                          struct link_device *dev __attribute__((unused)),
-                                          struct transport_tx *trans __attribute__((unused)),
-                                          uint8_t *buf __attribute__((unused))) {\n";
-  right ();
   let msgs = Hashtbl.create 3 in
   List.iter (fun m ->
     List.iter (fun d ->
-      if not (Hashtbl.mem msgs d.Module.dl_class) then
-        Hashtbl.add msgs d.Module.dl_class (Hashtbl.create 15);
-      let c = Hashtbl.find msgs d.Module.dl_class in
+      let class_name = match d.Module.dl_class with None -> "datalink" | Some x -> x in
+      if not (Hashtbl.mem msgs class_name) then
+        Hashtbl.add msgs class_name (Hashtbl.create 15);
+      let c = Hashtbl.find msgs class_name in
       let new_cb = (d.Module.func, d.Module.cond) in
       if Hashtbl.mem c d.Module.message then
         Hashtbl.replace c d.Module.message (new_cb :: Hashtbl.find c d.Module.message)
@@ -335,40 +335,70 @@ let print_datalink_functions = fun out modules ->
     ) m.Module.datalinks
   ) modules;
 
-  lprintf out "switch (class_id) {\n";
+  let handler_name = fun class_name msg_name ->
+    if compare msg_name "*" = 0 then sprintf "modules_dl_%s_all" class_name
+    else sprintf "modules_dl_%s_%s" class_name msg_name in
+
+  lprintf out "\ntypedef void (*modules_dl_handler_t)(struct link_device *dev, struct transport_tx *trans, uint8_t *buf);\n";
+  lprintf out "\nstruct modules_dl_class {\n";
   right ();
+  lprintf out "const modules_dl_handler_t *handlers; ///< handlers indexed by message id\n";
+  lprintf out "uint16_t nb_handlers;                  ///< size of handlers table\n";
+  lprintf out "modules_dl_handler_t all;              ///< handler for all messages of the class\n";
+  left ();
+  lprintf out "};\n";
+
+  (* handler functions and message tables for each class *)
   Hashtbl.iter (fun class_name msg_tbl ->
-    let class_name = match class_name with None -> "datalink" | Some x -> x in
-    lprintf out "case DL_%s_CLASS_ID: {\n" class_name;
-    right ();
-    lprintf out "switch (msg_id) {\n";
+    Hashtbl.iter (fun msg_name cbs ->
+      lprintf out "\nstatic void %s(struct link_device *dev __attribute__((unused)),\n" (handler_name class_name msg_name);
+      lprintf out "    struct transport_tx *trans __attribute__((unused)), uint8_t *buf __attribute__((unused))) {\n";
+      right ();
+      List.iter (fun (cb, cond) -> lprintf_with_cond out cb cond) cbs;
+      left ();
+      lprintf out "}\n"
+    ) msg_tbl;
+    lprintf out "\nstatic const modules_dl_handler_t modules_dl_%s_handlers[] = {\n" class_name;
     right ();
+    let nb = ref 0 in
     Hashtbl.iter (fun msg_name _ ->
       if compare msg_name "*" != 0 then begin (* skip wildcard *)
-        lprintf out "case DL_%s: {\n" msg_name;
-        right ();
-        List.iter (fun (cb, cond) ->
-          lprintf_with_cond out cb cond;
-        ) (Hashtbl.find msg_tbl msg_name);
-        lprintf out "break;\n";
-        left ();
-        lprintf out "}\n" (* close msg case *)
+        lprintf out "[DL_%s] = %s,\n" msg_name (handler_name class_name msg_name);
+        incr nb
       end
     ) msg_tbl;
-    lprintf out "default: break;\n";
-    left ();
-    lprintf out "}\n"; (* close msg switch *)
-    Hashtbl.iter (fun msg_name _ ->
-      if compare msg_name "*" = 0 then (* callbacks for wildcard *)
-        List.iter (fun (cb, cond) -> lprintf_with_cond out cb cond) (Hashtbl.find msg_tbl msg_name)
-    ) msg_tbl;
+    if !nb = 0 then lprintf out "NULL\n";
     left ();
-    lprintf out "  break;\n";
-    lprintf out "}\n"; (* close class case *)
+    lprintf out "};\n"
+  ) msgs;
+
+  (* class table *)
+  lprintf out "\nstatic const struct modules_dl_class modules_dl_classes[] = {\n";
+  right ();
+  Hashtbl.iter (fun class_name msg_tbl ->
+    let all = if Hashtbl.mem msg_tbl "*" then handler_name class_name "*" else "NULL" in
+    lprintf out "[DL_%s_CLASS_ID] = { modules_dl_%s_handlers, sizeof(modules_dl_%s_handlers) / sizeof(modules_dl_handler_t), %s },\n" class_name class_name class_name all
   ) msgs;
-  lprintf out "default: break;\n";
+  if Hashtbl.length msgs = 0 then lprintf out "{ NULL, 0, NULL }\n";
   left ();
-  lprintf out "}\n"; (* close class switch *)
+  lprintf out "};\n";
+
+  lprintf out "\nstatic inline void modules_parse_datalink(uint8_t msg_id __attribute__((unused)),
+                                          uint8_t class_id __attribute__((unused)),
+                                          struct link_device *dev __attribute__((unused)),
+                                          struct transport_tx *trans __attribute__((unused)),
+                                          uint8_t *buf __attribute__((unused))) {\n";
+  right ();
+  lprintf out "if (class_id >= sizeof(modules_dl_classes) / sizeof(struct modules_dl_class)) {\n";
+  lprintf out "  return;\n";
+  lprintf out "}\n";
+  lprintf out "const struct modules_dl_class *dl_class = &modules_dl_classes[class_id];\n";
+  lprintf out "if (msg_id < dl_class->nb_handlers && dl_class->handlers[msg_id] != NULL) {\n";
+  lprintf out "  dl_class->handlers[msg_id](dev, trans, buf);\n";
+  lprintf out "}\n";
+  lprintf out "if (dl_class->all != NULL) {\n";
+  lprintf out "  dl_class->all(dev, trans, buf);\n";
+  lprintf out "}\n";
   left ();
   lprintf out "}\n" (* close function *)
 
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2023 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_ins_delay_buffer.c
+ * @brief Tests for the INS delayed measurement buffer.
+ *
+ * A 1D position/speed filter with a position reset is run twice: once
+ * with the measurement applied at its time of validity, once with the
+ * same measurement received late and fused through the delay buffer.
+ *
+ * Using libtap to create a TAP (TestAnythingProtocol) producer:
+ * https://github.com/zorgnax/libtap
+ *
+ */
+
+#include <math.h>
+#include "tap.h"
+#include "modules/ins/ins_delay_buffer.h"
+
+#define HIST_SIZE 32
+#define DT 0.01f
+#define DELAY_N 10
+#define BUDGET 4
+
+struct State {
+  float pos;
+  float speed;
+};
+
+static void propagate(void *state, const void *input, float dt)
+{
+  struct State *s = (struct State *)state;
+  const float *accel = (const float *)input;
+  s->pos += s->speed * dt;
+  s->speed += *accel * dt;
+}
+
+static void update(struct State *s, float pos)
+{
+  s->pos = 0.5f * (s->pos + pos);
+}
+
+static float accel_at(int k)
+{
+  return sinf(0.1f * k);
+}
+
+int main()
+{
+  note("running INS delay buffer tests");
+  plan(7);
+
+  struct InsDelayBuffer hist;
+  struct State states[HIST_SIZE];
+  float inputs[HIST_SIZE];
+  float stamps[HIST_SIZE], dts[HIST_SIZE];
+  struct State replay;
+  ins_delay_buffer_init(&hist, states, sizeof(struct State), inputs, sizeof(float),
+                        stamps, dts, HIST_SIZE, &replay, propagate, BUDGET);
+
+  ok(ins_delay_buffer_rewind(&hist, 0.f) == NULL, "rewind on empty buffer fails");
+
+  // reference: measurement applied at step 20
+  struct State ref = { 0.f, 1.f };
+  for (int k = 0; k < 60; k++) {
+    if (k == 20) { update(&ref, 3.f); }
+    float a = accel_at(k);
+    propagate(&ref, &a, DT);
+  }
+
+  // delayed: same measurement received at step 20 + DELAY_N
+  struct State s = { 0.f, 1.f };
+  int replay_done = -1;
+  for (int k = 0; k < 60; k++) {
+    float a = accel_at(k);
+    *(struct State *)ins_delay_buffer_push(&hist, k * DT, DT, &a) = s;
+    if (k == 20 + DELAY_N) {
+      struct State *past = ins_delay_buffer_rewind(&hist, 20 * DT + DT / 2.f);
+      if (past) { update(past, 3.f); }
+      ok(past != NULL, "rewind to step 20 from step %d", k);
+      ok(ins_delay_buffer_rewind(&hist, 20 * DT) == NULL, "rewind refused while replaying");
+    }
+    propagate(&s, &a, DT);
+    if (ins_delay_buffer_replay(&hist, &s) && replay_done < 0) {
+      replay_done = k;
+    }
+  }
+  // DELAY_N + 1 steps to replay, BUDGET on the first call then BUDGET - 1 net steps per call
+  ok(replay_done == 20 + DELAY_N + (DELAY_N + 1 - BUDGET + BUDGET - 2) / (BUDGET - 1),
+     "replay caught up at step %d", replay_done);
+  ok(fabsf(s.pos - ref.pos) < 1e-5f && fabsf(s.speed - ref.speed) < 1e-5f,
+     "delayed fusion matches reference: pos %f / %f, speed %f / %f", s.pos, ref.pos, s.speed, ref.speed);
+
+  ok(ins_delay_buffer_rewind(&hist, 0.f) == NULL, "rewind older than history fails");
+
+  // overrun: a replay from the oldest entry is aborted when it is overwritten
+  struct State *past = ins_delay_buffer_rewind(&hist, (60 - HIST_SIZE) * DT + DT / 2.f);
+  float a = 0.f;
+  ins_delay_buffer_push(&hist, 60 * DT, DT, &a);
+  ok(past != NULL && !hist.replaying && hist.nb_aborts == 1, "replay aborted on overrun");
+
+  done_testing();
+}
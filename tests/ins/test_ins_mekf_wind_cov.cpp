@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2022 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_ins_mekf_wind_cov.cpp
+ * @brief Tests for the MEKF wind covariance propagation.
+ *
+ * Check that the block sparse propagation gives the same result as the
+ * dense reference implementation.
+ *
+ * Using libtap to create a TAP (TestAnythingProtocol) producer:
+ * https://github.com/zorgnax/libtap
+ *
+ */
+
+// Eigen before tap.h as its short macro names clash with the C++ headers
+#include <Eigen/Dense>
+#include "modules/ins/ins_mekf_wind_cov.h"
+#include "tap.h"
+
+using namespace Eigen;
+
+#define NB_STEPS 500
+#define DT (1.f / 100.f)
+
+static Matrix3f skew_sym(const Vector3f &v)
+{
+  Matrix3f m;
+  m << 0.f, -v(2), v(1),
+       v(2), 0.f, -v(0),
+       -v(1), v(0), 0.f;
+  return m;
+}
+
+/** relative error between two covariance matrices */
+static float cov_rel_error(const MEKFWCov &P1, const MEKFWCov &P2)
+{
+  return (P1 - P2).cwiseAbs().maxCoeff() / P2.cwiseAbs().maxCoeff();
+}
+
+int main()
+{
+  note("running MEKF wind covariance propagation tests");
+  plan(4);
+
+  srand(42);
+
+  // random symmetric positive definite initial covariance
+  const MEKFWCov M = MEKFWCov::Random();
+  MEKFWCov P0 = M * M.transpose() + MEKFWCov::Identity();
+
+  // diagonal process noise
+  MEKFWPNoise Q = MEKFWPNoise::Zero();
+  Q.diagonal() = Matrix<float, MEKF_WIND_PROC_NOISE_SIZE, 1>::Random().cwiseAbs();
+
+  // single step
+  Quaternionf q(Vector4f::Random());
+  q.normalize();
+  Matrix3f Rq = q.toRotationMatrix();
+  Matrix3f RqA = skew_sym(Rq * Vector3f(0.5f, -0.3f, -9.81f));
+  MEKFWCov Pd = P0, Ps = P0;
+  ins_mekf_wind_cov_propagate_dense(Pd, Q, Rq, RqA, DT);
+  ins_mekf_wind_cov_propagate(Ps, Q, Rq, RqA, DT);
+  float err = cov_rel_error(Ps, Pd);
+  ok(err < 1e-6f, "single step sparse vs dense relative error %g", err);
+
+  // large time step to excite the higher order terms
+  Pd = P0;
+  Ps = P0;
+  ins_mekf_wind_cov_propagate_dense(Pd, Q, Rq, RqA, 0.5f);
+  ins_mekf_wind_cov_propagate(Ps, Q, Rq, RqA, 0.5f);
+  err = cov_rel_error(Ps, Pd);
+  ok(err < 1e-5f, "large step sparse vs dense relative error %g", err);
+
+  // several steps with varying attitude and accel
+  Pd = P0;
+  Ps = P0;
+  for (int i = 0; i < NB_STEPS; i++) {
+    q = q * Quaternionf(AngleAxisf(0.01f, Vector3f::Random().normalized()));
+    q.normalize();
+    Rq = q.toRotationMatrix();
+    RqA = skew_sym(Rq * (Vector3f(0.f, 0.f, -9.81f) + Vector3f::Random()));
+    ins_mekf_wind_cov_propagate_dense(Pd, Q, Rq, RqA, DT);
+    ins_mekf_wind_cov_propagate(Ps, Q, Rq, RqA, DT);
+  }
+  err = cov_rel_error(Ps, Pd);
+  ok(err < 1e-4f, "%d steps sparse vs dense relative error %g", NB_STEPS, err);
+
+  // symmetry is preserved
+  err = (Ps - Ps.transpose()).cwiseAbs().maxCoeff() / Ps.cwiseAbs().maxCoeff();
+  ok(err < 1e-6f, "sparse propagation keeps P symmetric, error %g", err);
+
+  done_testing();
+}
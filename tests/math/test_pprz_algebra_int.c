@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2023 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_pprz_algebra_int.c
+ * @brief Bit-exactness of the optimized integer algebra.
+ *
+ * The optimized functions are compared with the plain C reference
+ * versions they replace.
+ *
+ * Using libtap to create a TAP (TestAnythingProtocol) producer:
+ * https://github.com/zorgnax/libtap
+ *
+ */
+
+#include <time.h>
+#include <string.h>
+#include "tap.h"
+
+#include "math/pprz_algebra_int.c"
+
+#define NB_TESTS 100000
+
+/*
+ * Reference versions
+ */
+
+static void ref_quat_integrate_fi(struct Int32Quat *q, struct Int64Quat *hr, struct Int32Rates *omega, int freq)
+{
+  hr->qi += - ((int64_t) omega->p) * q->qx - ((int64_t) omega->q) * q->qy - ((int64_t) omega->r) * q->qz;
+  hr->qx += ((int64_t) omega->p) * q->qi + ((int64_t) omega->r) * q->qy - ((int64_t) omega->q) * q->qz;
+  hr->qy += ((int64_t) omega->q) * q->qi - ((int64_t) omega->r) * q->qx + ((int64_t) omega->p) * q->qz;
+  hr->qz += ((int64_t) omega->r) * q->qi + ((int64_t) omega->q) * q->qx - ((int64_t) omega->p) * q->qy;
+
+  int64_t *h[4] = { &hr->qi, &hr->qx, &hr->qy, &hr->qz };
+  int32_t *v[4] = { &q->qi, &q->qx, &q->qy, &q->qz };
+  for (int i = 0; i < 4; i++) {
+    lldiv_t _div = lldiv(*h[i], ((1 << INT32_RATE_FRAC) * freq * 2));
+    *v[i] += (int32_t) _div.quot;
+    *h[i] = _div.rem;
+  }
+}
+
+/*
+ * Deterministic random inputs
+ */
+
+static uint32_t rand_u32(void)
+{
+  static uint32_t x = 2463534242u;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return x;
+}
+
+static int32_t rand_range(int32_t max)
+{
+  return (int32_t)(rand_u32() % (2 * (uint32_t)max + 1)) - max;
+}
+
+static void rand_quat(struct Int32Quat *q)
+{
+  QUAT_ASSIGN(*q, rand_range(QUAT1_BFP_OF_REAL(1)), rand_range(QUAT1_BFP_OF_REAL(1)),
+              rand_range(QUAT1_BFP_OF_REAL(1)), rand_range(QUAT1_BFP_OF_REAL(1)));
+  if (q->qi == 0 && q->qx == 0) { q->qi = 1; }
+  int32_quat_normalize(q);
+}
+
+static void test_integrate(void)
+{
+  note("--- quaternion integration");
+  uint32_t nb_err = 0;
+  const int freqs[3] = { 500, 512, 1000 };
+  for (int f = 0; f < 3; f++) {
+    struct Int32Quat q, q_ref;
+    struct Int64Quat hr = { 0, 0, 0, 0 };
+    struct Int64Quat hr_ref = { 0, 0, 0, 0 };
+    rand_quat(&q);
+    q_ref = q;
+    for (int i = 0; i < NB_TESTS; i++) {
+      // up to 2000 deg/s, to use the 64 bit division as well
+      const int32_t max_rate = RATE_BFP_OF_REAL(RadOfDeg((i % 4) ? 200. : 2000.));
+      struct Int32Rates omega = { rand_range(max_rate), rand_range(max_rate), rand_range(max_rate) };
+      int32_quat_integrate_fi(&q, &hr, &omega, freqs[f]);
+      ref_quat_integrate_fi(&q_ref, &hr_ref, &omega, freqs[f]);
+      if (memcmp(&q, &q_ref, sizeof(q)) != 0 || memcmp(&hr, &hr_ref, sizeof(hr)) != 0) {
+        nb_err++;
+        q = q_ref;
+        hr = hr_ref;
+      }
+      if (i % 16 == 0) {
+        int32_quat_normalize(&q);
+        int32_quat_normalize(&q_ref);
+      }
+    }
+  }
+  ok(nb_err == 0, "int32_quat_integrate_fi bit-exact with reference (%u errors)", nb_err);
+}
+
+int main()
+{
+  note("running integer algebra tests");
+  plan(1);
+
+  test_integrate();
+
+  done_testing();
+}
@@ -27,6 +27,7 @@
  *
  */
 
+#include <time.h>
 #include "tap.h"
 
 #include "math/pprz_geodetic_int.h"
@@ -376,10 +377,181 @@ static void test_lla_of_ecef(void)
   cmp_ok(lla_i.alt, "==", lla_ref_i.alt, "altitude (int) matches reference");
 }
 
+#define NB_BATCH 2000
+
+/** max of the differences between two sets of 3 arrays */
+static double max_diff_d(const double *a0, const double *a1, const double *a2,
+                         const double *b0, const double *b1, const double *b2, int n)
+{
+  double max = 0.;
+  for (int i = 0; i < n; i++) {
+    double d = fmax(fabs(a0[i] - b0[i]), fmax(fabs(a1[i] - b1[i]), fabs(a2[i] - b2[i])));
+    if (d > max) { max = d; }
+  }
+  return max;
+}
+
+static void test_batch_double(void)
+{
+  note("--- compare batch conversions with the scalar versions in double");
+
+  struct EcefCoor_d ref_coor = { 4624497.0 , 116475.0, 4376563.0};
+  struct LtpDef_d ltp_def;
+  ltp_def_from_ecef_d(&ltp_def, &ref_coor);
+
+  /* points spread around the reference, up to ~50km away and 3km high */
+  static double lat[NB_BATCH], lon[NB_BATCH], alt[NB_BATCH];
+  static double x[NB_BATCH], y[NB_BATCH], z[NB_BATCH];
+  static double x_ref[NB_BATCH], y_ref[NB_BATCH], z_ref[NB_BATCH];
+  static double o0[NB_BATCH], o1[NB_BATCH], o2[NB_BATCH];
+  static double r0[NB_BATCH], r1[NB_BATCH], r2[NB_BATCH];
+  for (int i = 0; i < NB_BATCH; i++) {
+    lat[i] = ltp_def.lla.lat + 0.008 * sin(0.37 * i);
+    lon[i] = ltp_def.lla.lon + 0.008 * cos(0.91 * i);
+    alt[i] = 1500. + 1500. * sin(0.13 * i);
+  }
+
+  ecef_of_lla_array_d(x, y, z, lat, lon, alt, NB_BATCH);
+  for (int i = 0; i < NB_BATCH; i++) {
+    struct LlaCoor_d lla = { lat[i], lon[i], alt[i] };
+    struct EcefCoor_d ecef;
+    ecef_of_lla_d(&ecef, &lla);
+    x_ref[i] = ecef.x; y_ref[i] = ecef.y; z_ref[i] = ecef.z;
+  }
+  double err = max_diff_d(x, y, z, x_ref, y_ref, z_ref, NB_BATCH);
+  ok(err < 1e-6, "ecef_of_lla_array_d matches scalar version (max error %g m)", err);
+
+  lla_of_ecef_array_d(o0, o1, o2, x_ref, y_ref, z_ref, NB_BATCH);
+  double err_lat = 0., err_alt = 0.;
+  for (int i = 0; i < NB_BATCH; i++) {
+    struct EcefCoor_d ecef = { x_ref[i], y_ref[i], z_ref[i] };
+    struct LlaCoor_d lla;
+    lla_of_ecef_d(&lla, &ecef);
+    err_lat = fmax(err_lat, fmax(fabs(o0[i] - lla.lat), fabs(o1[i] - lla.lon)));
+    err_alt = fmax(err_alt, fabs(o2[i] - lla.alt));
+  }
+  ok(err_lat < 1e-12 && err_alt < 1e-6, "lla_of_ecef_array_d matches scalar version (max error %g rad, %g m)",
+     err_lat, err_alt);
+
+  enu_of_ecef_point_array_d(o0, o1, o2, &ltp_def, x_ref, y_ref, z_ref, NB_BATCH);
+  ned_of_ecef_point_array_d(r0, r1, r2, &ltp_def, x_ref, y_ref, z_ref, NB_BATCH);
+  double err_enu = 0., err_ned = 0.;
+  for (int i = 0; i < NB_BATCH; i++) {
+    struct EcefCoor_d ecef = { x_ref[i], y_ref[i], z_ref[i] };
+    struct EnuCoor_d enu;
+    struct NedCoor_d ned;
+    enu_of_ecef_point_d(&enu, &ltp_def, &ecef);
+    ned_of_ecef_point_d(&ned, &ltp_def, &ecef);
+    err_enu = fmax(err_enu, max_diff_d(&o0[i], &o1[i], &o2[i], &enu.x, &enu.y, &enu.z, 1));
+    err_ned = fmax(err_ned, max_diff_d(&r0[i], &r1[i], &r2[i], &ned.x, &ned.y, &ned.z, 1));
+  }
+  ok(err_enu < 1e-6, "enu_of_ecef_point_array_d matches scalar version (max error %g m)", err_enu);
+  ok(err_ned < 1e-6, "ned_of_ecef_point_array_d matches scalar version (max error %g m)", err_ned);
+
+  /* back to ECEF from the ENU and NED points just computed */
+  ecef_of_enu_point_array_d(x, y, z, &ltp_def, o0, o1, o2, NB_BATCH);
+  err = max_diff_d(x, y, z, x_ref, y_ref, z_ref, NB_BATCH);
+  ok(err < 1e-6, "ECEF -> ENU -> ECEF batch error below 1e-6m (max error %g m)", err);
+  ecef_of_ned_point_array_d(x, y, z, &ltp_def, r0, r1, r2, NB_BATCH);
+  err = max_diff_d(x, y, z, x_ref, y_ref, z_ref, NB_BATCH);
+  ok(err < 1e-6, "ECEF -> NED -> ECEF batch error below 1e-6m (max error %g m)", err);
+
+  enu_of_lla_point_array_d(o0, o1, o2, &ltp_def, lat, lon, alt, NB_BATCH);
+  ned_of_lla_point_array_d(r0, r1, r2, &ltp_def, lat, lon, alt, NB_BATCH);
+  err_enu = 0.;
+  err_ned = 0.;
+  for (int i = 0; i < NB_BATCH; i++) {
+    struct LlaCoor_d lla = { lat[i], lon[i], alt[i] };
+    struct EnuCoor_d enu;
+    struct NedCoor_d ned;
+    enu_of_lla_point_d(&enu, &ltp_def, &lla);
+    ned_of_lla_point_d(&ned, &ltp_def, &lla);
+    err_enu = fmax(err_enu, max_diff_d(&o0[i], &o1[i], &o2[i], &enu.x, &enu.y, &enu.z, 1));
+    err_ned = fmax(err_ned, max_diff_d(&r0[i], &r1[i], &r2[i], &ned.x, &ned.y, &ned.z, 1));
+  }
+  ok(err_enu < 1e-6, "enu_of_lla_point_array_d matches scalar version (max error %g m)", err_enu);
+  ok(err_ned < 1e-6, "ned_of_lla_point_array_d matches scalar version (max error %g m)", err_ned);
+
+  /* timing of the most common case, only informative */
+  const int nb_runs = 100;
+  clock_t t0 = clock();
+  for (int k = 0; k < nb_runs; k++) {
+    for (int i = 0; i < NB_BATCH; i++) {
+      struct LlaCoor_d lla = { lat[i], lon[i], alt[i] };
+      struct EnuCoor_d enu;
+      enu_of_lla_point_d(&enu, &ltp_def, &lla);
+      o0[i] = enu.x; o1[i] = enu.y; o2[i] = enu.z;
+    }
+  }
+  clock_t t1 = clock();
+  for (int k = 0; k < nb_runs; k++) {
+    enu_of_lla_point_array_d(o0, o1, o2, &ltp_def, lat, lon, alt, NB_BATCH);
+  }
+  clock_t t2 = clock();
+  note("enu_of_lla: scalar %.1f ns/point, batch %.1f ns/point",
+       1e9 * (t1 - t0) / CLOCKS_PER_SEC / (nb_runs * NB_BATCH),
+       1e9 * (t2 - t1) / CLOCKS_PER_SEC / (nb_runs * NB_BATCH));
+}
+
+static void test_batch_float(void)
+{
+  note("--- compare batch conversions in float with the scalar versions");
+
+  struct EcefCoor_f ref_coor = { 4624497.0 , 116475.0, 4376563.0};
+  struct LtpDef_f ltp_def;
+  ltp_def_from_ecef_f(&ltp_def, &ref_coor);
+
+  static float lat[NB_BATCH], lon[NB_BATCH], alt[NB_BATCH];
+  static float x[NB_BATCH], y[NB_BATCH], z[NB_BATCH];
+  static float o0[NB_BATCH], o1[NB_BATCH], o2[NB_BATCH];
+  static float r0[NB_BATCH], r1[NB_BATCH], r2[NB_BATCH];
+  for (int i = 0; i < NB_BATCH; i++) {
+    lat[i] = ltp_def.lla.lat + 0.008 * sin(0.37 * i);
+    lon[i] = ltp_def.lla.lon + 0.008 * cos(0.91 * i);
+    alt[i] = 1500. + 1500. * sin(0.13 * i);
+    x[i] = ref_coor.x + 20000.f * sinf(0.21 * i);
+    y[i] = ref_coor.y + 20000.f * cosf(0.53 * i);
+    z[i] = ref_coor.z + 3000.f * sinf(0.07 * i);
+  }
+
+  enu_of_ecef_point_array_f(o0, o1, o2, &ltp_def, x, y, z, NB_BATCH);
+  ned_of_ecef_point_array_f(r0, r1, r2, &ltp_def, x, y, z, NB_BATCH);
+  float err_enu = 0.f, err_ned = 0.f;
+  for (int i = 0; i < NB_BATCH; i++) {
+    struct EcefCoor_f ecef = { x[i], y[i], z[i] };
+    struct EnuCoor_f enu;
+    struct NedCoor_f ned;
+    enu_of_ecef_point_f(&enu, &ltp_def, &ecef);
+    ned_of_ecef_point_f(&ned, &ltp_def, &ecef);
+    err_enu = fmaxf(err_enu, fmaxf(fabsf(o0[i] - enu.x), fmaxf(fabsf(o1[i] - enu.y), fabsf(o2[i] - enu.z))));
+    err_ned = fmaxf(err_ned, fmaxf(fabsf(r0[i] - ned.x), fmaxf(fabsf(r1[i] - ned.y), fabsf(r2[i] - ned.z))));
+  }
+  ok(err_enu < 0.01f, "enu_of_ecef_point_array_f matches scalar version (max error %g m)", err_enu);
+  ok(err_ned < 0.01f, "ned_of_ecef_point_array_f matches scalar version (max error %g m)", err_ned);
+
+  /* computed in double, compare with the double scalar version on the same inputs */
+  struct LtpDef_d ltp_def_d;
+  struct EcefCoor_d ref_coor_d = { ltp_def.ecef.x, ltp_def.ecef.y, ltp_def.ecef.z };
+  ltp_def_from_ecef_d(&ltp_def_d, &ref_coor_d);
+  enu_of_lla_point_array_f(o0, o1, o2, &ltp_def, lat, lon, alt, NB_BATCH);
+  ned_of_lla_point_array_f(r0, r1, r2, &ltp_def, lat, lon, alt, NB_BATCH);
+  err_enu = 0.f;
+  err_ned = 0.f;
+  for (int i = 0; i < NB_BATCH; i++) {
+    struct LlaCoor_d lla = { lat[i], lon[i], alt[i] };
+    struct EnuCoor_d enu;
+    enu_of_lla_point_d(&enu, &ltp_def_d, &lla);
+    err_enu = fmaxf(err_enu, fmaxf(fabs(o0[i] - enu.x), fmaxf(fabs(o1[i] - enu.y), fabs(o2[i] - enu.z))));
+    err_ned = fmaxf(err_ned, fmaxf(fabs(r0[i] - enu.y), fmaxf(fabs(r1[i] - enu.x), fabs(r2[i] + enu.z))));
+  }
+  ok(err_enu < 0.01f, "enu_of_lla_point_array_f below 1cm from double version (max error %g m)", err_enu);
+  ok(err_ned < 0.01f, "ned_of_lla_point_array_f below 1cm from double version (max error %g m)", err_ned);
+}
+
 int main()
 {
   note("runing geodetic math tests");
-  plan(13);
+  plan(25);
 
   test_ecef_of_ned_int();
   test_enu_of_ecef_int();
@@ -387,6 +559,8 @@ int main()
   test_ecef_to_enu_to_ecef_float();
   test_lla_of_utm();
   test_lla_of_ecef();
+  test_batch_double();
+  test_batch_float();
 
   done_testing();
 }
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2023 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_pprz_geodetic_wmm.c
+ * @brief Tests for the cached and grid evaluations of the WMM2020 model.
+ *
+ * Using libtap to create a TAP (TestAnythingProtocol) producer:
+ * https://github.com/zorgnax/libtap
+ *
+ */
+
+#include <time.h>
+#include "tap.h"
+
+#include "math/pprz_geodetic_wmm2020.h"
+
+#define DATE 2022.5
+
+static void full_field(double lat, double lon, double alt, double b[3])
+{
+  double gh[MAXCOEFF];
+  int16_t nmax = extrapsh(DATE, GEO_EPOCH, NMAX_1, NMAX_2, gh);
+  mag_calc(1, lat, lon, alt, nmax, gh, &b[0], &b[1], &b[2], IEXT, EXT_COEFF1, EXT_COEFF2, EXT_COEFF3);
+}
+
+/** angle between two field vectors in deg */
+static double angle(const double a[3], const double b[3])
+{
+  double na = sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+  double nb = sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]);
+  double c = (a[0] * b[0] + a[1] * b[1] + a[2] * b[2]) / (na * nb);
+  return DegOfRad(acos(Min(c, 1.)));
+}
+
+static void test_cache(void)
+{
+  note("--- cached evaluation compared with mag_calc");
+  struct Wmm2020Cache cache;
+  wmm2020_cache_init(&cache, DATE);
+
+  /* exact at the position of the update, all over the globe */
+  double max_err = 0.;
+  for (double lat = -89.; lat <= 89.; lat += 7.) {
+    for (double lon = -180.; lon < 180.; lon += 11.) {
+      double b[3], b_ref[3];
+      cache.valid = false;
+      wmm2020_cache_field(&cache, lat, lon, 0.3, &b[0], &b[1], &b[2]);
+      full_field(lat, lon, 0.3, b_ref);
+      for (int k = 0; k < 3; k++) {
+        max_err = Max(max_err, fabs(b[k] - b_ref[k]));
+      }
+    }
+  }
+  ok(max_err < 2., "cached field matches mag_calc (max error %.3f nT)", max_err);
+
+  /* flight around Toulouse: the sums are reused inside the latitude band */
+  double max_angle = 0.;
+  int nb_updates = 0;
+  const int nb_steps = 10000;
+  for (int i = 0; i < nb_steps; i++) {
+    double lat = 43.6 + 0.2 * sin(0.001 * i);
+    double lon = 1.44 + 0.3 * cos(0.0013 * i);
+    double alt = 0.2 + 0.3 * (1. + sin(0.002 * i));
+    double b[3], b_ref[3];
+    if (wmm2020_cache_field(&cache, lat, lon, alt, &b[0], &b[1], &b[2])) {
+      nb_updates++;
+    }
+    if (i % 100 == 0) {
+      full_field(lat, lon, alt, b_ref);
+      max_angle = Max(max_angle, angle(b, b_ref));
+    }
+  }
+  ok(max_angle < 0.1, "cached direction error below 0.1 deg (max %.4f deg)", max_angle);
+  ok(nb_updates < nb_steps / 50, "cached sums reused (%d updates for %d queries)", nb_updates, nb_steps);
+
+  clock_t t0 = clock();
+  double b[3];
+  for (int i = 0; i < nb_steps; i++) {
+    full_field(43.6, 1.44 + 1e-5 * i, 0.2, b);
+  }
+  clock_t t1 = clock();
+  for (int i = 0; i < nb_steps; i++) {
+    wmm2020_cache_field(&cache, 43.6, 1.44 + 1e-5 * i, 0.2, &b[0], &b[1], &b[2]);
+  }
+  clock_t t2 = clock();
+  note("mag_calc %.2f us, cached %.2f us per query",
+       1e6 * (t1 - t0) / CLOCKS_PER_SEC / nb_steps, 1e6 * (t2 - t1) / CLOCKS_PER_SEC / nb_steps);
+}
+
+static void test_grid(void)
+{
+  note("--- grid evaluation compared with mag_calc");
+
+  /* nodes of the grid, exact up to the quantization */
+  double max_err = 0.;
+  for (int lat = -80; lat <= 80; lat += WMM2020_GRID_RES) {
+    for (int lon = -180; lon < 180; lon += WMM2020_GRID_RES) {
+      float x, y, z;
+      double b_ref[3];
+      wmm2020_grid_field(DATE, lat, lon, 0.f, &x, &y, &z);
+      full_field(lat, lon, 0., b_ref);
+      max_err = Max(max_err, Max(fabs(x - b_ref[0]), Max(fabs(y - b_ref[1]), fabs(z - b_ref[2]))));
+    }
+  }
+  ok(max_err < 5., "grid nodes match mag_calc (max error %.2f nT)", max_err);
+
+  /* between the nodes, outside the polar regions */
+  double max_angle = 0., sum_angle = 0.;
+  int nb = 0;
+  for (double lat = -59.3; lat <= 60.; lat += 3.1) {
+    for (double lon = -179.7; lon < 180.; lon += 4.3) {
+      float x, y, z;
+      double b_ref[3];
+      wmm2020_grid_field(DATE, lat, lon, 0.5f, &x, &y, &z);
+      full_field(lat, lon, 0.5, b_ref);
+      double b[3] = { x, y, z };
+      double a = angle(b, b_ref);
+      max_angle = Max(max_angle, a);
+      sum_angle += a;
+      nb++;
+    }
+  }
+  ok(max_angle < 3., "grid direction error below 3 deg (mean %.2f deg, max %.2f deg)", sum_angle / nb, max_angle);
+
+  float x, y, z;
+  wmm2020_grid_field(DATE, 43.6f, 181.44f, 0.f, &x, &y, &z);
+  float x2, y2, z2;
+  wmm2020_grid_field(DATE, 43.6f, -178.56f, 0.f, &x2, &y2, &z2);
+  ok(fabsf(x - x2) < 1e-2f && fabsf(y - y2) < 1e-2f && fabsf(z - z2) < 1e-2f, "grid longitude wraps around");
+}
+
+int main()
+{
+  note("running WMM2020 tests");
+  plan(6);
+
+  test_cache();
+  test_grid();
+
+  done_testing();
+}
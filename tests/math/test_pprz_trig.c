@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2023 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_pprz_trig.c
+ * @brief Accuracy of the approximated trig functions.
+ *
+ * Using libtap to create a TAP (TestAnythingProtocol) producer:
+ * https://github.com/zorgnax/libtap
+ *
+ */
+
+#include <time.h>
+#include "tap.h"
+
+#define PPRZ_TRIG_FLOAT_APPROX TRUE
+#include "math/pprz_trig_float.h"
+
+/* interpolated table built here, full table from the math library */
+#define PPRZ_TRIG_INT_COMPR_INTERP
+#include "math/pprz_trig_int.c"
+
+extern PPRZ_TRIG_CONST int16_t pprz_trig_int[];
+
+#define NB_TESTS 1000000
+
+static void test_sincos(void)
+{
+  note("--- pprz_sincosf");
+  double max_err = 0., max_err_large = 0.;
+  for (int i = 0; i <= NB_TESTS; i++) {
+    float a = -4.f * M_PI + 8.f * M_PI * i / NB_TESTS;
+    float s, c;
+    pprz_sincosf(a, &s, &c);
+    max_err = Max(max_err, Max(fabs(s - sin(a)), fabs(c - cos(a))));
+  }
+  ok(max_err < 2e-7, "sin and cos error below 2e-7 in [-4pi, 4pi] (max %g)", max_err);
+
+  for (int i = 0; i <= NB_TESTS; i++) {
+    float a = -8192.f + 16384.f * i / NB_TESTS;
+    float s, c;
+    pprz_sincosf(a, &s, &c);
+    max_err_large = Max(max_err_large, Max(fabs(s - sin(a)), fabs(c - cos(a))));
+  }
+  ok(max_err_large < 2e-7, "sin and cos error below 2e-7 in [-8192, 8192] (max %g)", max_err_large);
+
+  float s, c;
+  pprz_sincosf(1e6f, &s, &c);
+  ok(s == sinf(1e6f) && c == cosf(1e6f), "libm used for large angles");
+
+  volatile float sum = 0.f;
+  clock_t t0 = clock();
+  for (int i = 0; i < NB_TESTS; i++) {
+    float a = 1e-5f * i;
+    sum += sinf(a) + cosf(a);
+  }
+  clock_t t1 = clock();
+  for (int i = 0; i < NB_TESTS; i++) {
+    float a = 1e-5f * i;
+    pprz_sincosf(a, &s, &c);
+    sum += s + c;
+  }
+  clock_t t2 = clock();
+  note("sinf + cosf %.1f ns, pprz_sincosf %.1f ns", 1e9 * (t1 - t0) / CLOCKS_PER_SEC / NB_TESTS,
+       1e9 * (t2 - t1) / CLOCKS_PER_SEC / NB_TESTS);
+}
+
+static void test_atan2(void)
+{
+  note("--- pprz_atan2f");
+  double max_err = 0.;
+  for (int i = 0; i < NB_TESTS; i++) {
+    float a = -M_PI + 2.f * M_PI * i / NB_TESTS;
+    float r = 1e-3f + 1e3f * (i % 7) / 7.f;
+    float y = r * sinf(a), x = r * cosf(a);
+    max_err = Max(max_err, fabs(pprz_atan2f(y, x) - atan2((double)y, (double)x)));
+  }
+  ok(max_err < 4e-7, "atan2 error below 4e-7 rad (max %g)", max_err);
+  ok(pprz_atan2f(0.f, -1.f) == atan2f(0.f, -1.f) && pprz_atan2f(-0.f, -1.f) == atan2f(-0.f, -1.f) &&
+     pprz_atan2f(1.f, 0.f) == atan2f(1.f, 0.f) && pprz_atan2f(0.f, 0.f) == 0.f,
+     "atan2 special values");
+
+  volatile float sum = 0.f;
+  clock_t t0 = clock();
+  for (int i = 0; i < NB_TESTS; i++) {
+    sum += atan2f(1.f - 1e-6f * i, 0.5f + 1e-6f * i);
+  }
+  clock_t t1 = clock();
+  for (int i = 0; i < NB_TESTS; i++) {
+    sum += pprz_atan2f(1.f - 1e-6f * i, 0.5f + 1e-6f * i);
+  }
+  clock_t t2 = clock();
+  note("atan2f %.1f ns, pprz_atan2f %.1f ns", 1e9 * (t1 - t0) / CLOCKS_PER_SEC / NB_TESTS,
+       1e9 * (t2 - t1) / CLOCKS_PER_SEC / NB_TESTS);
+}
+
+static void test_int_interp(void)
+{
+  note("--- interpolated integer sine table");
+  int max_err = 0, nb_exact = 0;
+  for (int32_t a = 0; a < TRIG_INT_SIZE; a++) {
+    int err = abs(pprz_trig_int_interp(a) - pprz_trig_int[a]);
+    max_err = Max(max_err, err);
+    if (err == 0) { nb_exact++; }
+  }
+  ok(max_err <= 1, "interpolated table within 1 LSB of the full table (%d/%d exact)", nb_exact, TRIG_INT_SIZE);
+}
+
+int main()
+{
+  note("running trig tests");
+  plan(6);
+
+  test_sincos();
+  test_atan2();
+  test_int_interp();
+
+  done_testing();
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2023 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_wind_estimator_ukf.c
+ * @brief Tests for the wind estimator square root UKF.
+ *
+ * The filter is run side by side with the Simulink generated one
+ * on a simulated flight with constant wind and compared at each step.
+ *
+ * Using libtap to create a TAP (TestAnythingProtocol) producer:
+ * https://github.com/zorgnax/libtap
+ *
+ */
+
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include "tap.h"
+#include "modules/meteo/wind_estimator_ukf.h"
+#include "modules/meteo/lib_ukf_wind_estimator/UKF_Wind_Estimator.h"
+
+#define NB_STEPS 1000
+#define DT 0.1f
+
+#define P_0 0.2f
+#define R_GS 0.5f
+#define R_VA 0.5f
+#define R_AOA 0.002f
+#define R_SSA 0.002f
+#define Q_VA 0.1f
+#define Q_WIND 0.001f
+#define Q_VA_SCALE 0.0001f
+
+static const float wind_ned[3] = { 3.f, -2.f, 0.3f };
+
+/** deterministic noise in [-a, a] */
+static float noise(float a)
+{
+  static uint32_t seed = 12345;
+  seed = seed * 1103515245u + 12345u;
+  return a * (((seed >> 8) & 0xFFFF) / 32768.f - 1.f);
+}
+
+/** Simulated flight: constant body airspeed, oscillating roll, constant turn */
+struct Sim {
+  float rates[3];
+  float accel[3];
+  float quat[4];
+  float z[6];
+};
+
+static void sim_step(struct Sim *s, float t)
+{
+  const float phi = 0.4f * sinf(0.2f * t);
+  const float theta = 0.05f;
+  const float psi = 0.1f * t;
+  const float airspeed[3] = { 15.f, 0.4f, 0.8f };
+
+  const float cphi = cosf(phi / 2.f), sphi = sinf(phi / 2.f);
+  const float ctheta = cosf(theta / 2.f), stheta = sinf(theta / 2.f);
+  const float cpsi = cosf(psi / 2.f), spsi = sinf(psi / 2.f);
+  s->quat[0] = cphi * ctheta * cpsi + sphi * stheta * spsi;
+  s->quat[1] = -cphi * stheta * spsi + sphi * ctheta * cpsi;
+  s->quat[2] = cphi * stheta * cpsi + sphi * ctheta * spsi;
+  s->quat[3] = cphi * ctheta * spsi - sphi * stheta * cpsi;
+
+  // body rates of the euler trajectory, small theta approximation
+  const float phi_dot = 0.08f * cosf(0.2f * t);
+  s->rates[0] = phi_dot - 0.1f * sinf(theta);
+  s->rates[1] = 0.1f * cosf(theta) * sinf(phi);
+  s->rates[2] = 0.1f * cosf(theta) * cosf(phi);
+
+  // accelerations keeping the body airspeed constant
+  s->accel[0] = s->rates[1] * airspeed[2] - s->rates[2] * airspeed[1];
+  s->accel[1] = s->rates[2] * airspeed[0] - s->rates[0] * airspeed[2];
+  s->accel[2] = s->rates[0] * airspeed[1] - s->rates[1] * airspeed[0];
+
+  // ground speed
+  const float qi = s->quat[0], qx = s->quat[1], qy = s->quat[2], qz = s->quat[3];
+  const float R[3][3] = {
+    { 1.f - 2.f * (qy * qy + qz * qz), 2.f * (qx * qy - qi * qz), 2.f * (qx * qz + qi * qy) },
+    { 2.f * (qx * qy + qi * qz), 1.f - 2.f * (qx * qx + qz * qz), 2.f * (qy * qz - qi * qx) },
+    { 2.f * (qx * qz - qi * qy), 2.f * (qy * qz + qi * qx), 1.f - 2.f * (qx * qx + qy * qy) }
+  };
+  for (int i = 0; i < 3; i++) {
+    s->z[i] = R[i][0] * airspeed[0] + R[i][1] * airspeed[1] + R[i][2] * airspeed[2]
+              + wind_ned[i] + noise(0.3f);
+  }
+  const float va = sqrtf(airspeed[0] * airspeed[0] + airspeed[1] * airspeed[1] + airspeed[2] * airspeed[2]);
+  s->z[3] = va + noise(0.3f);
+  s->z[4] = atan2f(airspeed[2], airspeed[0]) + noise(0.002f);
+  s->z[5] = asinf(airspeed[1] / va) + noise(0.002f);
+}
+
+static void ref_init(void)
+{
+  memset(&ukf_U, 0, sizeof(ExtU));
+  memset(&ukf_Y, 0, sizeof(ExtY));
+  memset(&ukf_DW, 0, sizeof(DW));
+  memset(&ukf_init, 0, sizeof(ukf_init_type));
+  memset(&ukf_params, 0, sizeof(ukf_params_type));
+  ukf_init.x0[6] = 1.f;
+  for (int i = 0; i < 7; i++) {
+    ukf_init.P0[i * 8] = P_0;
+  }
+  const float R[6] = { R_GS, R_GS, R_GS, R_VA, R_AOA, R_SSA };
+  for (int i = 0; i < 6; i++) {
+    ukf_params.R[i * 7] = R[i] * R[i];
+  }
+  const float Q[7] = { Q_VA, Q_VA, Q_VA, Q_WIND, Q_WIND, Q_WIND, Q_VA_SCALE };
+  for (int i = 0; i < 7; i++) {
+    ukf_params.Q[i * 8] = Q[i] * Q[i];
+  }
+  ukf_init.ki = 0.f;
+  ukf_init.alpha = 0.5f;
+  ukf_init.beta = 2.f;
+  ukf_params.dt = DT;
+}
+
+static void ref_step(struct Sim *s)
+{
+  memcpy(ukf_U.rates, s->rates, sizeof(ukf_U.rates));
+  memcpy(ukf_U.accel, s->accel, sizeof(ukf_U.accel));
+  memcpy(ukf_U.q, s->quat, sizeof(ukf_U.q));
+  memcpy(ukf_U.vk, s->z, sizeof(ukf_U.vk));
+  ukf_U.va = s->z[3];
+  ukf_U.aoa = s->z[4];
+  ukf_U.sideslip = s->z[5];
+  UKF_Wind_Estimator_step();
+}
+
+static void ukf_setup(struct WeUkf *ukf)
+{
+  const float x0[WE_UKF_N] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f };
+  const float p0[WE_UKF_N] = { P_0, P_0, P_0, P_0, P_0, P_0, P_0 };
+  const float Q[WE_UKF_N] = { Q_VA * Q_VA, Q_VA * Q_VA, Q_VA * Q_VA,
+                              Q_WIND * Q_WIND, Q_WIND * Q_WIND, Q_WIND * Q_WIND, Q_VA_SCALE * Q_VA_SCALE };
+  const float R[WE_UKF_M] = { R_GS * R_GS, R_GS * R_GS, R_GS * R_GS, R_VA * R_VA, R_AOA * R_AOA, R_SSA * R_SSA };
+  we_ukf_init(ukf, x0, p0);
+  we_ukf_set_weights(ukf, 0.5f, 2.f, 0.f);
+  we_ukf_set_Q(ukf, Q);
+  we_ukf_set_R(ukf, R);
+}
+
+int main(int argc __attribute__((unused)), char **argv __attribute__((unused)))
+{
+  note("running wind estimator UKF tests");
+  plan(5);
+
+  struct WeUkf ukf;
+  struct Sim sim;
+  ukf_setup(&ukf);
+  ref_init();
+
+  float max_x_err = 0.f;
+  float max_p_err = 0.f;
+  for (int k = 0; k < NB_STEPS; k++) {
+    sim_step(&sim, k * DT);
+    ref_step(&sim);
+    we_ukf_step(&ukf, sim.rates, sim.accel, sim.quat, sim.z, DT);
+
+    for (int i = 0; i < WE_UKF_N; i++) {
+      float err = fabsf(ukf.x[i] - ukf_Y.xout[i]);
+      if (err > max_x_err) { max_x_err = err; }
+    }
+    // compare covariance diagonals, Pout is the lower triangular square root (column major)
+    for (int i = 0; i < WE_UKF_N; i++) {
+      float p = 0.f, p_ref = 0.f;
+      for (int j = 0; j < WE_UKF_N; j++) {
+        p += ukf.S[i][j] * ukf.S[i][j];
+        p_ref += ukf_Y.Pout[i + 7 * j] * ukf_Y.Pout[i + 7 * j];
+      }
+      float err = fabsf(sqrtf(p) - sqrtf(p_ref));
+      if (err > max_p_err) { max_p_err = err; }
+    }
+  }
+
+  ok(max_x_err < 1e-2f, "state matches reference (max error %f)", max_x_err);
+  ok(max_p_err < 1e-3f, "standard deviations match reference (max error %f)", max_p_err);
+  ok(fabsf(ukf.x[WE_UKF_WN] - wind_ned[0]) < 0.5f && fabsf(ukf.x[WE_UKF_WE] - wind_ned[1]) < 0.5f,
+     "horizontal wind converged (%f %f)", ukf.x[WE_UKF_WN], ukf.x[WE_UKF_WE]);
+  ok(fabsf(ukf.x[WE_UKF_U] - 15.f) < 1.f, "airspeed converged (%f)", ukf.x[WE_UKF_U]);
+
+  // same inputs for both filters, only compare run time
+  clock_t t0 = clock();
+  for (int k = 0; k < NB_STEPS; k++) {
+    sim_step(&sim, k * DT);
+    we_ukf_step(&ukf, sim.rates, sim.accel, sim.quat, sim.z, DT);
+  }
+  clock_t t1 = clock();
+  for (int k = 0; k < NB_STEPS; k++) {
+    sim_step(&sim, k * DT);
+    ref_step(&sim);
+  }
+  clock_t t2 = clock();
+  double us = 1e6 * (double)(t1 - t0) / CLOCKS_PER_SEC / NB_STEPS;
+  double us_ref = 1e6 * (double)(t2 - t1) / CLOCKS_PER_SEC / NB_STEPS;
+  diag("step time: %.2f us, reference: %.2f us", us, us_ref);
+  ok(isfinite(ukf.x[WE_UKF_WN]), "filter still finite after timing run");
+
+  done_testing();
+}